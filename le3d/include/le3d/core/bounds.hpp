@@ -0,0 +1,67 @@
+#pragma once
+#include <array>
+#include <limits>
+#include <vector>
+#include <glm/glm.hpp>
+#include "le3d/core/std_types.hpp"
+
+namespace le
+{
+// \brief Axis-aligned bounding box; a default (inverted) box is empty, ie its extents are unknown
+struct AABB
+{
+	glm::vec3 min = glm::vec3(std::numeric_limits<f32>::max());
+	glm::vec3 max = glm::vec3(std::numeric_limits<f32>::lowest());
+
+	bool isEmpty() const;
+	glm::vec3 centre() const;
+	// Half-size along each axis
+	glm::vec3 extents() const;
+
+	void add(glm::vec3 const& point);
+	void add(AABB const& aabb);
+	// Bounds of this box after transforming it by mat (empty boxes stay empty)
+	AABB transformed(glm::mat4 const& mat) const;
+};
+
+// \brief Six inward-facing planes (xyz: normal, w: distance), extracted from a view-projection matrix
+struct Frustum
+{
+	enum Plane : u8
+	{
+		Left = 0,
+		Right,
+		Bottom,
+		Top,
+		Near,
+		Far,
+		COUNT_
+	};
+
+	std::array<glm::vec4, (size_t)Plane::COUNT_> planes;
+
+	// Empty boxes are never culled
+	bool intersects(AABB const& aabb) const;
+
+	static Frustum fromViewProj(glm::mat4 const& viewProj);
+};
+
+// \brief Structure-of-arrays storage for a batch of boxes, culled together by cull()
+struct AABBBatch
+{
+	std::vector<f32> cx;
+	std::vector<f32> cy;
+	std::vector<f32> cz;
+	std::vector<f32> ex;
+	std::vector<f32> ey;
+	std::vector<f32> ez;
+
+	void clear();
+	void reserve(size_t count);
+	void push_back(AABB const& aabb);
+	size_t size() const;
+};
+
+// Sets outVisible[i] to 1 if boxes[i] intersects frustum, else 0 (empty boxes are always visible); returns the visible count
+size_t cull(Frustum const& frustum, AABBBatch const& boxes, std::vector<u32>& outVisible);
+} // namespace le
@@ -0,0 +1,102 @@
+#pragma once
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include "le3d/core/bounds.hpp"
+#include "le3d/core/std_types.hpp"
+
+namespace le
+{
+// \brief Dynamic bounding volume hierarchy: a height-balanced AABB tree over keyed boxes
+// Leaves store a "fat" box (tight bounds + s_fatMargin), so small movements don't change the tree (see update())
+// Queries are safe to run concurrently with each other, but not with any modification
+class BVH final
+{
+public:
+	using Key = s64;
+
+	struct Item final
+	{
+		Key key = 0;
+		AABB bounds;
+	};
+
+	struct RayHit final
+	{
+		Key key = 0;
+		// Distance along the ray (in units of its direction)
+		f32 t = 0.0f;
+	};
+
+public:
+	// Added to every side of a leaf's box
+	static f32 s_fatMargin;
+
+private:
+	static constexpr s32 s_null = -1;
+
+	struct Node final
+	{
+		// Fat bounds (union of children for internal nodes)
+		AABB bounds;
+		// Exact bounds of a leaf's item
+		AABB tight;
+		Key key = 0;
+		// Next free node when unused
+		s32 parent = s_null;
+		s32 left = s_null;
+		s32 right = s_null;
+		// Leaves are 0, unused nodes -1
+		s32 height = -1;
+
+		bool isLeaf() const;
+	};
+
+private:
+	std::vector<Node> m_nodes;
+	std::unordered_map<Key, s32> m_leaves;
+	s32 m_root = s_null;
+	s32 m_free = s_null;
+
+public:
+	// Replaces the tree with a top-down (median split) build over items; much faster than inserting them one by one
+	void build(std::vector<Item> items);
+	void clear();
+
+	// Returns false if key is already present (or bounds is empty)
+	bool insert(Key key, AABB const& bounds);
+	// Rebuilds the whole tree if items outnumber the existing leaves, else inserts them one by one
+	void insert(std::vector<Item> const& items);
+	bool remove(Key key);
+	// Rebuilds the tree from the survivors if keys covers at least half of it; returns the number removed
+	size_t remove(std::vector<Key> const& keys);
+	// Inserts key if absent; else refits its leaf, re-inserting it only if bounds escaped its fat box
+	// Returns true if the tree's structure changed
+	bool update(Key key, AABB const& bounds);
+
+	bool contains(Key key) const;
+	size_t size() const;
+	// Longest root-to-leaf path (0 for a single leaf, -1 if empty)
+	s32 height() const;
+	// Exact bounds of key (empty if absent)
+	AABB bounds(Key key) const;
+
+	// Appends keys whose bounds intersect aabb / frustum to outKeys
+	void query(AABB const& aabb, std::vector<Key>& outKeys) const;
+	void query(Frustum const& frustum, std::vector<Key>& outKeys) const;
+	// Closest item whose bounds are hit by the ray within maxT (direction need not be normalised)
+	std::optional<RayHit> raycast(glm::vec3 const& origin, glm::vec3 const& direction, f32 maxT = 1e30f) const;
+
+private:
+	s32 allocate();
+	void release(s32 idx);
+	s32 build(std::vector<s32>& leaves, size_t begin, size_t end, s32 parent);
+	void insertLeaf(s32 leaf);
+	void removeLeaf(s32 leaf);
+	// Rotates the subtree at idx if its children's heights differ by more than one; returns the new subtree root
+	s32 balance(s32 idx);
+	void refitUp(s32 idx);
+	void collect(s32 idx, std::vector<Key>& outKeys) const;
+};
+} // namespace le
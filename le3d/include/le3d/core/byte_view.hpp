@@ -0,0 +1,47 @@
+#pragma once
+#include <istream>
+#include <memory>
+#include <streambuf>
+#include <string_view>
+#include "le3d/core/std_types.hpp"
+
+namespace le
+{
+// \brief Read-only view over bytes kept alive by a refcounted token (a file mapping, a buffer, ...)
+// Copies share the token: the data stays valid until the last copy is destroyed
+struct ByteView final
+{
+	std::shared_ptr<void const> token;
+	std::byte const* pData = nullptr;
+	size_t size = 0;
+
+	// Views an owned buffer (no copy)
+	static ByteView from(bytearray bytes);
+
+	bool empty() const;
+	std::string_view str() const;
+	bytearray bytes() const;
+};
+
+// \brief std::istream over a ByteView (no copy), for APIs that only take streams
+class ByteViewStream final : public std::istream
+{
+private:
+	class Buf final : public std::streambuf
+	{
+	public:
+		explicit Buf(ByteView const& view);
+
+	protected:
+		pos_type seekoff(off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode mode) override;
+		pos_type seekpos(pos_type pos, std::ios_base::openmode mode) override;
+	};
+
+private:
+	ByteView m_view;
+	Buf m_buf;
+
+public:
+	explicit ByteViewStream(ByteView view);
+};
+} // namespace le
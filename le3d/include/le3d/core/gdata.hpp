@@ -1,20 +1,30 @@
 #pragma once
+#include <memory>
 #include <unordered_map>
+#include <utility>
 #include <vector>
+#include "le3d/core/byte_view.hpp"
+#include "le3d/core/json.hpp"
 #include "le3d/core/std_types.hpp"
 
 namespace le
 {
-// \brief Pseudo-JSON serialisable data container
+// \brief JSON data container: a view into a shared, parsed json::Document
+// Nested GData (getGData/getGDatas/allGDatas) share the parent's document instead of re-parsing text
 class GData
 {
 protected:
+	std::shared_ptr<json::Document const> m_shDoc;
+	json::Value m_value;
+	// Fields set via setString/addField; shadow the document's members
 	std::unordered_map<std::string, std::string> m_fieldMap;
 
 public:
 	GData();
 	// Pass serialised data to marhshall and load fields
 	explicit GData(std::string serialised);
+	// Parses in place: the document shares serialised's token instead of copying the text
+	explicit GData(ByteView serialised);
 	GData(GData&&);
 	GData& operator=(GData&&);
 	GData(GData const& rhs);
@@ -23,7 +33,8 @@ public:
 
 	// Marhshalls and load fields from serialised data
 	bool marshall(std::string serialised);
-	// Returns original raw data, without whitespaces and enclosing braces
+	bool marshall(ByteView serialised);
+	// Returns compact JSON for all fields
 	std::string unmarshall() const;
 	// Clears raw data and fields
 	void clear();
@@ -36,12 +47,23 @@ public:
 
 	GData getGData(std::string const& key) const;
 	std::vector<GData> getGDatas(std::string const& key) const;
+	// All members, in document order, as GData views (no copying or re-parsing)
+	std::vector<std::pair<std::string, GData>> allGDatas() const;
 
-	std::unordered_map<std::string, std::string> const& allFields() const;
+	// Builds a map of raw field strings (nested objects/arrays as JSON text); prefer allGDatas
+	std::unordered_map<std::string, std::string> allFields() const;
 	bool addField(std::string key, GData& gData);
 	bool setString(std::string key, std::string value);
 
 	u32 fieldCount() const;
 	bool contains(std::string const& id) const;
+	json::Value const& value() const;
+
+private:
+	GData(std::shared_ptr<json::Document const> shDoc, json::Value value);
+	bool setDocument(std::shared_ptr<json::Document> shDoc, bool bParsed);
+
+	json::Value find(std::string const& key) const;
+	std::string const* findOverride(std::string const& key) const;
 };
 } // namespace le
@@ -1,14 +1,56 @@
 #pragma once
 #include <filesystem>
+#include <functional>
+#include <memory>
 #include <sstream>
+#include "le3d/core/byte_view.hpp"
 #include "le3d/core/std_types.hpp"
 
 namespace le
 {
 namespace stdfs = std::filesystem;
 
+// \brief Handle to a read queued by IOReader::readAsync(); cheap to copy
+class HRead final
+{
+public:
+	struct Request;
+
+private:
+	std::shared_ptr<Request> m_pRequest;
+
+public:
+	HRead() noexcept;
+
+public:
+	// Blocks until the read has completed; returns an empty view if it was cancelled
+	ByteView wait() const;
+	bool isReady() const;
+	// Returns false if the read has already started (its result will still be delivered)
+	bool cancel() const;
+
+	explicit operator bool() const;
+
+private:
+	explicit HRead(std::shared_ptr<Request> pRequest) noexcept;
+
+	friend class IOReader;
+};
+
 class IOReader
 {
+public:
+	enum class Priority : u8
+	{
+		Low = 0,
+		Normal,
+		High,
+		COUNT_
+	};
+
+	// Runs on the I/O thread: keep it short (hand heavy work to jobs); not called for cancelled reads
+	using OnRead = std::function<void(ByteView const&)>;
+
 public:
 	struct FBytes
 	{
@@ -49,21 +91,33 @@ public:
 	virtual ~IOReader();
 
 public:
+	// Copies out of getView()
 	[[nodiscard]] std::string getString(stdfs::path const& id) const;
 	[[nodiscard]] FBytes bytesFunctor() const;
 	[[nodiscard]] FStr strFunctor() const;
 	std::string_view medium() const;
 	[[nodiscard]] bool checkPresence(stdfs::path const& id) const;
 	[[nodiscard]] bool checkPresence(std::initializer_list<stdfs::path> ids) const;
+	// Queues getView(id) on the I/O thread (started on first use), which serves reads in batches, highest priority first
+	// This reader must outlive the read
+	HRead readAsync(stdfs::path id, Priority priority = Priority::Normal, OnRead onRead = {}) const;
 
 public:
 	[[nodiscard]] virtual bool isPresent(stdfs::path const& id) const = 0;
 	[[nodiscard]] virtual bytearray getBytes(stdfs::path const& id) const = 0;
 	[[nodiscard]] virtual std::stringstream getStr(stdfs::path const& id) const = 0;
+	// Read-only contents of id; the base implementation wraps getBytes()
+	[[nodiscard]] virtual ByteView getView(stdfs::path const& id) const;
+	// Hint that id is about to be read (the I/O thread hints a whole batch before reading any of it); does nothing by default
+	virtual void prefetch(stdfs::path const& id) const;
 };
 
 class FileReader : public IOReader
 {
+public:
+	// Files at least this large are memory-mapped by getView(); smaller ones are read into a buffer (cheaper than a mapping)
+	static size_t s_mapThreshold;
+
 public:
 	FileReader(stdfs::path prefix = "") noexcept;
 
@@ -71,13 +125,36 @@ public:
 	bool isPresent(stdfs::path const& id) const override;
 	bytearray getBytes(stdfs::path const& id) const override;
 	std::stringstream getStr(stdfs::path const& id) const override;
+	// Zero-copy: views a read-only mapping of the file (unmapped when the last view is destroyed)
+	ByteView getView(stdfs::path const& id) const override;
+	// Starts OS readahead of the file
+	void prefetch(stdfs::path const& id) const override;
 };
 
+// \brief Reads entries of a (memory-mapped) zip archive; thread safe
+// The central directory is indexed once on construction; stored entries are viewed zero-copy, deflated ones inflated per call
 class ZIPReader : public IOReader
 {
+public:
+	struct Entry final
+	{
+		u64 localOffset = 0;
+		u64 compressedSize = 0;
+		u64 size = 0;
+		u32 crc = 0;
+		u16 method = 0;
+	};
+
+private:
+	struct Archive;
+
 protected:
 	stdfs::path m_zipPath;
 
+private:
+	// Immutable after construction: shared by copies and read concurrently
+	std::shared_ptr<Archive const> m_pArchive;
+
 public:
 	ZIPReader(stdfs::path zipPath, stdfs::path idPrefix = "");
 
@@ -85,5 +162,14 @@ public:
 	bool isPresent(stdfs::path const& id) const override;
 	bytearray getBytes(stdfs::path const& id) const override;
 	std::stringstream getStr(stdfs::path const& id) const override;
+	// Zero-copy for stored entries (a slice of the archive mapping)
+	ByteView getView(stdfs::path const& id) const override;
+	// Starts OS readahead of the entry's pages
+	void prefetch(stdfs::path const& id) const override;
+
+private:
+	Entry const* find(stdfs::path const& id) const;
+	std::byte const* data(Entry const& entry, stdfs::path const& id) const;
+	bool extract(Entry const& entry, std::byte const* pData, bytearray& out, stdfs::path const& id) const;
 };
 } // namespace le
@@ -1,6 +1,7 @@
 #pragma once
 #include <any>
 #include "jobs/job_handle.hpp"
+#include "jobs/job_task.hpp"
 #include "jobs/job_catalogue.hpp"
 
 namespace le
@@ -10,15 +11,39 @@ namespace jobs
 void init(u32 workerCount);
 void cleanup();
 
-std::shared_ptr<HJob> enqueue(std::function<std::any()> task, std::string name = "", bool bSilent = false);
-std::shared_ptr<HJob> enqueue(std::function<void()> task, std::string name = "", bool bSilent = false);
+HJob enqueue(std::function<std::any()> task, std::string_view name = "", bool bSilent = false);
+HJob enqueue(JobTask task, std::string_view name = "", bool bSilent = false);
+// Runs task on the worker that completes predecessor (no main thread round-trip); task runs even if predecessor threw
+HJob then(HJob const& predecessor, JobTask task, std::string_view name = "", bool bSilent = false);
+// Fan-in: runs task (if any) once every predecessor has completed; the returned handle completes after it
+HJob whenAll(std::vector<HJob> const& predecessors, JobTask task = {}, std::string_view name = "", bool bSilent = true);
 JobCatalog* createCatalogue(std::string name);
-std::vector<std::shared_ptr<HJob>> forEach(IndexedTask const& indexedTask);
+std::vector<HJob> forEach(IndexedTask const& indexedTask);
+// Splits [begin, end) adaptively across workers (the calling thread participates) and returns once every index is done;
+// rethrows the first exception thrown by rangeTask. grainSize 0 picks one based on range size and worker count
+void parallelForRanges(size_t begin, size_t end, std::function<void(size_t, size_t)> const& rangeTask, size_t grainSize = 0);
+template <typename F>
+void parallelFor(size_t begin, size_t end, F&& task, size_t grainSize = 0);
 
-void waitAll(std::vector<std::shared_ptr<HJob>> const& handles);
+void waitAll(std::vector<HJob> const& handles);
 
 void update();
 bool areWorkersIdle();
 void waitForIdle();
 } // namespace jobs
+
+template <typename F>
+void jobs::parallelFor(size_t begin, size_t end, F&& task, size_t grainSize)
+{
+	parallelForRanges(
+		begin, end,
+		[&task](size_t rangeBegin, size_t rangeEnd) {
+			for (size_t idx = rangeBegin; idx < rangeEnd; ++idx)
+			{
+				task(idx);
+			}
+		},
+		grainSize);
+	return;
+}
 } // namespace le
@@ -15,8 +15,8 @@ private:
 
 	std::string m_logName;
 	std::vector<SubJob> m_subJobs;
-	std::list<std::shared_ptr<HJob>> m_pendingJobs;
-	std::list<std::shared_ptr<HJob>> m_completedJobs;
+	std::list<HJob> m_pendingJobs;
+	std::list<HJob> m_completedJobs;
 	Task m_onComplete = nullptr;
 	class JobManager* m_pManager;
 	Time m_startTime;
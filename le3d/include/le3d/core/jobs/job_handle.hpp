@@ -1,30 +1,39 @@
 #pragma once
 #include <any>
-#include <future>
-#include <memory>
+#include <functional>
+#include <string>
 #include "le3d/core/std_types.hpp"
 
 namespace le
 {
+// Intrusively refcounted handle to a pooled job record; cheap to copy, no heap allocation
 class HJob final
 {
 private:
-	std::future<std::any> m_future;
-	s64 m_jobID = -1;
+	class JobRecord* m_pRecord = nullptr;
 
 public:
-	HJob(s64 jobID, std::future<std::any>&& future) noexcept;
+	HJob() noexcept;
+	HJob(HJob const& rhs) noexcept;
+	HJob(HJob&& rhs) noexcept;
+	HJob& operator=(HJob const& rhs) noexcept;
+	HJob& operator=(HJob&& rhs) noexcept;
 	~HJob();
 
 	s64 ID() const;
 
+	// Blocks (running other queued jobs meanwhile, then sleeping) until complete; rethrows any exception thrown by the task.
+	// Returns a copy of the result: safe to call repeatedly and from any copy of the handle
 	std::any wait();
 	bool hasCompleted() const;
 	bool isReady() const;
 
+	explicit operator bool() const;
+
 private:
-	friend class JobWorker;
-	friend class JobManager;
+	explicit HJob(JobRecord* pRecord) noexcept;
+
+	friend class JobRecord;
 };
 
 struct IndexedTask final
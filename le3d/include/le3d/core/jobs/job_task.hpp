@@ -0,0 +1,132 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "le3d/core/std_types.hpp"
+
+namespace le
+{
+// Move-only `void()` callable; closures up to INLINE_SIZE bytes are stored in place (no heap allocation)
+class JobTask final
+{
+public:
+	static constexpr size_t INLINE_SIZE = 48;
+
+private:
+	struct VTable
+	{
+		void (*invoke)(void* pSelf);
+		void (*relocate)(void* pDst, void* pSrc);
+		void (*destroy)(void* pSelf);
+	};
+
+	template <typename F>
+	static constexpr bool s_bInline = sizeof(F) <= INLINE_SIZE && alignof(F) <= alignof(std::max_align_t)
+									  && std::is_nothrow_move_constructible_v<F>;
+
+	template <typename F>
+	static VTable const s_inlineVTable;
+	template <typename F>
+	static VTable const s_heapVTable;
+
+private:
+	alignas(std::max_align_t) std::byte m_storage[INLINE_SIZE];
+	VTable const* m_pVTable = nullptr;
+
+public:
+	JobTask() noexcept;
+	template <typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, JobTask> && std::is_void_v<std::invoke_result_t<F&>>>>
+	JobTask(F&& f);
+	JobTask(JobTask&& rhs) noexcept;
+	JobTask& operator=(JobTask&& rhs) noexcept;
+	JobTask(JobTask const&) = delete;
+	JobTask& operator=(JobTask const&) = delete;
+	~JobTask();
+
+public:
+	void operator()();
+	explicit operator bool() const;
+	void reset();
+};
+
+template <typename F>
+JobTask::VTable const JobTask::s_inlineVTable = {
+	[](void* pSelf) { (*static_cast<F*>(pSelf))(); },
+	[](void* pDst, void* pSrc) {
+		new (pDst) F(std::move(*static_cast<F*>(pSrc)));
+		static_cast<F*>(pSrc)->~F();
+	},
+	[](void* pSelf) { static_cast<F*>(pSelf)->~F(); },
+};
+
+template <typename F>
+JobTask::VTable const JobTask::s_heapVTable = {
+	[](void* pSelf) { (**static_cast<F**>(pSelf))(); },
+	[](void* pDst, void* pSrc) { *static_cast<F**>(pDst) = *static_cast<F**>(pSrc); },
+	[](void* pSelf) { delete *static_cast<F**>(pSelf); },
+};
+
+inline JobTask::JobTask() noexcept = default;
+
+template <typename F, typename>
+JobTask::JobTask(F&& f)
+{
+	using Fn = std::decay_t<F>;
+	if constexpr (s_bInline<Fn>)
+	{
+		new (m_storage) Fn(std::forward<F>(f));
+		m_pVTable = &s_inlineVTable<Fn>;
+	}
+	else
+	{
+		*reinterpret_cast<Fn**>(m_storage) = new Fn(std::forward<F>(f));
+		m_pVTable = &s_heapVTable<Fn>;
+	}
+}
+
+inline JobTask::JobTask(JobTask&& rhs) noexcept
+{
+	*this = std::move(rhs);
+}
+
+inline JobTask& JobTask::operator=(JobTask&& rhs) noexcept
+{
+	if (&rhs != this)
+	{
+		reset();
+		if (rhs.m_pVTable)
+		{
+			rhs.m_pVTable->relocate(m_storage, rhs.m_storage);
+			m_pVTable = rhs.m_pVTable;
+			rhs.m_pVTable = nullptr;
+		}
+	}
+	return *this;
+}
+
+inline JobTask::~JobTask()
+{
+	reset();
+}
+
+inline void JobTask::operator()()
+{
+	m_pVTable->invoke(m_storage);
+}
+
+inline JobTask::operator bool() const
+{
+	return m_pVTable != nullptr;
+}
+
+inline void JobTask::reset()
+{
+	if (m_pVTable)
+	{
+		m_pVTable->destroy(m_storage);
+		m_pVTable = nullptr;
+	}
+	return;
+}
+} // namespace le
@@ -0,0 +1,136 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "le3d/core/std_types.hpp"
+
+namespace le::json
+{
+enum class Type : u8
+{
+	Null = 0,
+	Bool,
+	Number,
+	String,
+	Array,
+	Object
+};
+
+class Document;
+
+// \brief Non-owning view of a node in a Document; default constructed (or missing) values are invalid
+class Value final
+{
+public:
+	class Iter;
+
+private:
+	Document const* m_pDoc = nullptr;
+	u32 m_idx = 0;
+
+public:
+	Value() = default;
+	Value(Document const& doc, u32 idx);
+
+public:
+	explicit operator bool() const;
+	Type type() const;
+	bool isObject() const;
+	bool isArray() const;
+	bool isString() const;
+
+	// String contents (escape sequences not decoded), literal text for numbers/bools/null, or full source text for objects/arrays
+	std::string_view raw() const;
+	// Member key if this value is in an object (escape sequences not decoded)
+	std::string_view key() const;
+
+	std::string asString(std::string_view defaultValue = "") const;
+	bool asBool(bool bDefaultValue) const;
+	s32 asS32(s32 defaultValue) const;
+	f64 asF64(f64 defaultValue) const;
+
+	// Number of members / elements
+	u32 size() const;
+	// Linear search over members; returns an invalid Value if not found
+	Value operator[](std::string_view key) const;
+
+	Iter begin() const;
+	Iter end() const;
+
+	friend bool operator==(Value const& lhs, Value const& rhs);
+	friend bool operator!=(Value const& lhs, Value const& rhs);
+};
+
+class Value::Iter final
+{
+private:
+	Value m_value;
+
+public:
+	Iter() = default;
+	explicit Iter(Value value);
+
+public:
+	Value const& operator*() const;
+	Value const* operator->() const;
+	Iter& operator++();
+	bool operator==(Iter const& rhs) const;
+	bool operator!=(Iter const& rhs) const;
+};
+
+// \brief Single pass JSON DOM: owns (or shares, via a token) the source text and a flat node array; Values are views into both
+class Document final
+{
+private:
+	class Parser;
+
+	struct Node final
+	{
+		u32 begin = 0;
+		u32 length = 0;
+		u32 keyBegin = 0;
+		u32 keyLength = 0;
+		u32 firstChild = 0;
+		u32 childCount = 0;
+		// 0 => no next sibling (root is never a sibling)
+		u32 next = 0;
+		Type type = Type::Null;
+		bool bEscaped = false;
+		bool bKeyEscaped = false;
+	};
+
+private:
+	std::string m_source;
+	// Set instead of m_source when parsing text in place
+	std::string_view m_external;
+	std::shared_ptr<void const> m_token;
+	bool m_bExternal = false;
+	std::vector<Node> m_nodes;
+	std::string m_error;
+
+public:
+	Document() = default;
+	explicit Document(std::string source);
+
+public:
+	// Replaces existing data; returns false (and leaves the document empty) on malformed input
+	bool parse(std::string source);
+	// Parses text without copying it; token must keep text alive (eg a ByteView's)
+	bool parse(std::string_view text, std::shared_ptr<void const> token);
+	void clear();
+
+	Value root() const;
+	std::string_view error() const;
+
+private:
+	std::string_view text() const;
+	bool parse();
+
+private:
+	friend class Value;
+};
+
+// Decodes JSON escape sequences (\n, \", \uXXXX, ...) in the contents of a string
+std::string unescape(std::string_view escaped);
+} // namespace le::json
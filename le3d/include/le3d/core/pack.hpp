@@ -0,0 +1,67 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "le3d/core/io.hpp"
+
+namespace le
+{
+// \brief Reads entries of an engine pack (written by pack::write()); thread safe
+// The pack is mapped and faulted in on construction (one large sequential read); lookups binary search its hashed path table,
+// stored entries are viewed zero-copy and LZ4 entries decompressed per call
+class PackReader : public IOReader
+{
+private:
+	struct Pack;
+	struct Entry;
+
+protected:
+	stdfs::path m_packPath;
+
+private:
+	// Immutable after construction: shared by copies and read concurrently
+	std::shared_ptr<Pack const> m_pPack;
+
+public:
+	PackReader(stdfs::path packPath, stdfs::path idPrefix = "");
+
+public:
+	bool isPresent(stdfs::path const& id) const override;
+	bytearray getBytes(stdfs::path const& id) const override;
+	std::stringstream getStr(stdfs::path const& id) const override;
+	ByteView getView(stdfs::path const& id) const override;
+
+private:
+	bool find(stdfs::path const& id, Entry& outEntry) const;
+	// Zero-copy view of a stored entry
+	ByteView slice(Entry const& entry, stdfs::path const& id) const;
+	bool decompress(Entry const& entry, bytearray& out, stdfs::path const& id) const;
+};
+
+namespace pack
+{
+enum class Compression : u8
+{
+	None = 0,
+	LZ4,
+	COUNT_
+};
+
+struct Input final
+{
+	// Pack path (what PackReader is queried with)
+	std::string id;
+	stdfs::path file;
+};
+
+struct Options final
+{
+	// Every blob starts at a multiple of this (power of two)
+	u32 alignment = 64;
+	// Compressed entries are only kept if LZ4 saves at least 1/8th; the rest are stored (and viewed zero-copy)
+	bool bCompress = true;
+};
+
+// Blobs are written in input order: list files that load together adjacently
+bool write(stdfs::path const& packPath, std::vector<Input> const& inputs, Options const& options = {});
+} // namespace pack
+} // namespace le
@@ -0,0 +1,77 @@
+#pragma once
+#include <array>
+#include <vector>
+#include "le3d/core/std_types.hpp"
+
+namespace le
+{
+// \brief Two-level segregated fit (TLSF) allocator of [offset, offset + size) ranges within [0, capacity)
+// Manages offsets only (no memory), so it can sub-allocate GPU buffers; allocate() and release() are O(1)
+// Free sizes are binned by a float-like encoding (5-bit exponent, 3-bit mantissa): each bin spans at most 12.5% of its size
+// Not thread safe
+class RangeAllocator final
+{
+public:
+	static constexpr u32 s_invalid = 0xffffffff;
+
+	struct Allocation final
+	{
+		u32 offset = s_invalid;
+		// Internal: identifies the allocation for release()
+		u32 node = s_invalid;
+
+		bool isValid() const;
+	};
+
+private:
+	static constexpr u32 s_leafBins = 8;
+	static constexpr u32 s_topBins = 32;
+	static constexpr u32 s_binCount = s_topBins * s_leafBins;
+
+	struct Node final
+	{
+		u32 offset = 0;
+		u32 size = 0;
+		// Free list of this node's bin
+		u32 binPrev = s_invalid;
+		u32 binNext = s_invalid;
+		// Neighbouring ranges (by offset)
+		u32 prev = s_invalid;
+		u32 next = s_invalid;
+		bool bUsed = false;
+	};
+
+private:
+	std::vector<Node> m_nodes;
+	std::vector<u32> m_unusedNodes;
+	std::array<u32, s_binCount> m_binHeads;
+	std::array<u8, s_topBins> m_leafMasks;
+	u32 m_topMask = 0;
+	u32 m_capacity = 0;
+	u32 m_free = 0;
+	u32 m_allocations = 0;
+
+public:
+	explicit RangeAllocator(u32 capacity = 0);
+
+public:
+	// Releases every allocation and sets the capacity
+	void reset(u32 capacity);
+
+	// Returns an invalid Allocation if no free range is large enough (or size is 0)
+	Allocation allocate(u32 size);
+	void release(Allocation allocation);
+
+	u32 capacity() const;
+	u32 freeSpace() const;
+	u32 allocationCount() const;
+	u32 sizeOf(Allocation allocation) const;
+	// Size of the largest range allocate() is guaranteed to succeed for
+	u32 largestFree() const;
+
+private:
+	u32 newNode(u32 offset, u32 size, u32 prev, u32 next);
+	void insertFree(u32 node);
+	void removeFree(u32 node);
+};
+} // namespace le
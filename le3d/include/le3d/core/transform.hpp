@@ -1,19 +1,25 @@
 #pragma once
-#include <list>
+#include <vector>
 #include <glm/glm.hpp>
 #include <glm/gtx/quaternion.hpp>
 #include "le3d/core/std_types.hpp"
 
 namespace le
 {
+// \brief Local TRS with cached world state: setters dirty the whole subtree, world values are recomputed once on demand
+// (or in a batched pass, see TransformSystem). Lazily updating a dirty Transform is not thread safe.
 class Transform final
 {
 private:
-	mutable glm::mat4 m_mat = glm::mat4(1.0f);
+	// Cached world state (valid when !m_bDirty)
+	mutable glm::mat4 m_world = glm::mat4(1.0f);
+	mutable glm::mat4 m_normal = glm::mat4(1.0f);
+	mutable glm::quat m_worldOrn = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+	mutable glm::vec3 m_worldScl = glm::vec3(1.0f);
 	glm::vec3 m_position = glm::vec3(0.0f);
 	glm::quat m_orientation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
 	glm::vec3 m_scale = glm::vec3(1.0f);
-	std::list<Transform*> m_children;
+	std::vector<Transform*> m_children;
 	Transform* m_pParent = nullptr;
 	mutable bool m_bDirty = false;
 
@@ -41,5 +47,17 @@ public:
 
 	glm::mat4 model() const;
 	glm::mat4 normalModel() const;
+
+public:
+	Transform const* parent() const;
+	bool isDirty() const;
+	// Recomputes cached world state from the parent's (updated first if dirty)
+	void updateWorld() const;
+
+	// Incremented whenever any parent / child link changes or a Transform is destroyed
+	static u32 hierarchyVersion();
+
+private:
+	void setDirty();
 };
 } // namespace le
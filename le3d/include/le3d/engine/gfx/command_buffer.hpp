@@ -0,0 +1,148 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "le3d/core/std_types.hpp"
+
+namespace le::gfx
+{
+// \brief Linear, bump-allocated stream of type-erased commands (POD header + inline closure)
+// Blocks are retained across flushes, so a steady-state frame performs no allocations
+class CommandBuffer final
+{
+public:
+	static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+private:
+	struct Header final
+	{
+		// Runs (if bRun) and destroys the payload
+		void (*consume)(void* pPayload, bool bRun);
+		u32 payloadOffset;
+		u32 stride;
+	};
+
+	struct Block final
+	{
+		std::unique_ptr<std::byte[]> uBytes;
+		size_t capacity = 0;
+		size_t size = 0;
+	};
+
+	// Closure followed (in the same payload) by count trivially copyable Ts
+	template <typename F, typename T>
+	struct ArrayCommand final
+	{
+		F command;
+		size_t count;
+
+		static constexpr size_t dataOffset();
+		void operator()();
+	};
+
+	template <typename F>
+	static void consume(void* pPayload, bool bRun);
+
+private:
+	std::vector<Block> m_blocks;
+	size_t m_active = 0;
+	u32 m_count = 0;
+
+public:
+	CommandBuffer();
+	CommandBuffer(CommandBuffer&&);
+	CommandBuffer& operator=(CommandBuffer&&);
+	~CommandBuffer();
+
+public:
+	template <typename F>
+	void push(F&& command);
+	// Copies [pData, pData + count) inline after the command, which is invoked as command(T const* pData, size_t count)
+	template <typename F, typename T>
+	void push(F&& command, T const* pData, size_t count);
+
+	// Runs every command in recorded order (or only destroys them, if !bRun) and resets the stream
+	void flush(bool bRun = true);
+	// Destroys all commands without running them
+	void clear();
+
+	bool empty() const;
+	u32 count() const;
+	size_t bytesUsed() const;
+
+private:
+	void* allocate(size_t payloadSize, size_t payloadAlign, u32& outPayloadOffset, u32& outStride, Header*& outHeader);
+};
+
+template <typename F, typename T>
+constexpr size_t CommandBuffer::ArrayCommand<F, T>::dataOffset()
+{
+	return (sizeof(ArrayCommand) + alignof(T) - 1) & ~(alignof(T) - 1);
+}
+
+template <typename F, typename T>
+void CommandBuffer::ArrayCommand<F, T>::operator()()
+{
+	command(reinterpret_cast<T const*>(reinterpret_cast<std::byte const*>(this) + dataOffset()), count);
+	return;
+}
+
+template <typename F>
+void CommandBuffer::consume(void* pPayload, bool bRun)
+{
+	auto pCommand = static_cast<F*>(pPayload);
+	if (bRun)
+	{
+		(*pCommand)();
+	}
+	pCommand->~F();
+	return;
+}
+
+template <typename F>
+void CommandBuffer::push(F&& command)
+{
+	using Fn = std::decay_t<F>;
+	static_assert(alignof(Fn) <= alignof(std::max_align_t), "Over-aligned commands are not supported!");
+	u32 payloadOffset = 0;
+	u32 stride = 0;
+	Header* pHeader = nullptr;
+	void* pPayload = allocate(sizeof(Fn), alignof(Fn), payloadOffset, stride, pHeader);
+	new (pPayload) Fn(std::forward<F>(command));
+	pHeader->consume = &consume<Fn>;
+	pHeader->payloadOffset = payloadOffset;
+	pHeader->stride = stride;
+	m_blocks[m_active].size += stride;
+	++m_count;
+	return;
+}
+
+template <typename F, typename T>
+void CommandBuffer::push(F&& command, T const* pData, size_t count)
+{
+	using Cmd = ArrayCommand<std::decay_t<F>, T>;
+	static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable!");
+	static_assert(alignof(Cmd) <= alignof(std::max_align_t) && alignof(T) <= alignof(std::max_align_t),
+				  "Over-aligned commands are not supported!");
+	u32 payloadOffset = 0;
+	u32 stride = 0;
+	Header* pHeader = nullptr;
+	void* pPayload = allocate(Cmd::dataOffset() + sizeof(T) * count, std::max(alignof(Cmd), alignof(T)), payloadOffset, stride, pHeader);
+	new (pPayload) Cmd{std::forward<F>(command), count};
+	if (count > 0)
+	{
+		std::memcpy(static_cast<std::byte*>(pPayload) + Cmd::dataOffset(), pData, sizeof(T) * count);
+	}
+	pHeader->consume = &consume<Cmd>;
+	pHeader->payloadOffset = payloadOffset;
+	pHeader->stride = stride;
+	m_blocks[m_active].size += stride;
+	++m_count;
+	return;
+}
+} // namespace le::gfx
@@ -0,0 +1,78 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "le3d/core/range_allocator.hpp"
+#include "le3d/core/std_types.hpp"
+#include "le3d/core/zero.hpp"
+#include "le3d/engine/gfx/gfx_enums.hpp"
+
+namespace le::gfx
+{
+using GFXID = TZero<u32>;
+struct Geometry;
+
+// \brief Packs static geometry into a few large shared buffers, so loading many small meshes doesn't create a VAO / VBO / EBO each
+// Every Page is one VAO over an interleaved vertex buffer (Vertex / PackedVertex, per its VertexFormat) and an index buffer,
+// sub-allocated by RangeAllocators; meshes in the same Page draw with the same VAO (indices are rebased to the page on upload)
+class GeometryArena final
+{
+public:
+	struct Page final
+	{
+		// Set on the render thread
+		GFXID vao;
+		GFXID vbo;
+		GFXID ebo;
+		RangeAllocator vertices;
+		RangeAllocator indices;
+		std::mutex mutex;
+		VertexFormat format = VertexFormat::Float32;
+	};
+
+	// \brief Move-only: releasing an Allocation frees its ranges (even after the arena is destroyed)
+	struct Allocation final
+	{
+		std::shared_ptr<Page> pPage;
+		RangeAllocator::Allocation vertices;
+		RangeAllocator::Allocation indices;
+
+		Allocation();
+		Allocation(Allocation&&) noexcept;
+		Allocation& operator=(Allocation&&) noexcept;
+		~Allocation();
+
+		bool isValid() const;
+		u32 firstVertex() const;
+		u32 firstIndex() const;
+	};
+
+public:
+	// Capacity of each Page (in vertices / indices); larger geometry is not pooled
+	static u32 s_pageVertices;
+	static u32 s_pageIndices;
+
+private:
+	std::vector<std::shared_ptr<Page>> m_pages;
+	mutable std::mutex m_mutex;
+
+public:
+	static GeometryArena* instance();
+	static bool destroyInstance();
+
+public:
+	GeometryArena();
+	~GeometryArena();
+
+public:
+	// Allocates ranges for geometry (in a Page of the same format) and records its upload; returns an invalid Allocation if it cannot be pooled
+	Allocation add(Geometry const& geometry, VertexFormat format = VertexFormat::Float32);
+	static void release(Allocation& outAllocation);
+
+	size_t pageCount() const;
+
+private:
+	Allocation allocate(std::shared_ptr<Page> const& pPage, u32 vertexCount, u32 indexCount);
+	std::shared_ptr<Page> newPage(VertexFormat format);
+};
+} // namespace le::gfx
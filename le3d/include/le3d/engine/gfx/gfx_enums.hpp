@@ -10,6 +10,13 @@ enum class DrawType : u8
 	Static
 };
 
+// Float32: 32 bytes / vertex; Packed: 20 bytes / vertex (10:10:10:2 normals, half-float UVs)
+enum class VertexFormat : u8
+{
+	Float32 = 0,
+	Packed
+};
+
 enum class TexType : u8
 {
 	Diffuse = 0,
@@ -10,12 +10,14 @@
 #include <glm/gtx/norm.hpp>
 #include <glm/gtx/quaternion.hpp>
 #include <glm/gtx/rotate_vector.hpp>
+#include "le3d/core/bounds.hpp"
 #include "le3d/core/colour.hpp"
 #include "le3d/core/flags.hpp"
 #include "le3d/core/gdata.hpp"
 #include "le3d/core/io.hpp"
 #include "le3d/core/std_types.hpp"
 #include "le3d/core/zero.hpp"
+#include "le3d/engine/gfx/geometry_arena.hpp"
 #include "le3d/engine/gfx/gfx_enums.hpp"
 
 namespace le::gfx
@@ -48,6 +50,8 @@ struct Geometry final
 
 	u32 byteCount() const;
 	u32 vertexCount() const;
+	// Local-space bounds of all points (empty if there are none)
+	AABB bounds() const;
 
 	void addPoint(glm::vec3 const& point);
 	void addNormals(glm::vec3 const& normal, u16 count = 1);
@@ -66,9 +70,13 @@ bool operator!=(Geometry::V2 const& lhs, Geometry::V2 const& rhs);
 struct InstanceBuffer
 {
 	std::vector<glm::mat4> models;
+	// Optional per-instance normal matrices (models are used if empty)
+	std::vector<glm::mat4> normals;
 	DrawType drawType = DrawType::Static;
 
 	u32 instanceCount() const;
+	// [model, normals] per instance: the layout of VertexArray's instance buffer
+	std::vector<glm::mat4> interleaved() const;
 };
 
 struct Albedo final
@@ -187,9 +195,38 @@ public:
 		glm::mat4 normals = model;
 	};
 
+	// Interned uniform name; locations are reflected into a per-shader table at link time
+	using UniformID = u32;
+
+private:
+	struct Uniforms;
+
+	struct UniformWrite final
+	{
+		enum class Type : u8
+		{
+			S32,
+			F32,
+			V2,
+			V3,
+			V4,
+			Mat4
+		};
+
+		std::array<f32, 16> data;
+		UniformID id;
+		Type type;
+	};
+
 public:
 	Flags m_flags;
 
+private:
+	// Owned by the render thread once set up (freed along with the program)
+	std::unique_ptr<Uniforms> m_uUniforms;
+	// Uniform writes staged since the last flush(); applied in one render command
+	mutable std::vector<UniformWrite> m_staged;
+
 public:
 	Shader();
 	explicit Shader(Descriptor);
@@ -200,11 +237,16 @@ public:
 private:
 	static void bind(GFXID shaderID);
 
+public:
+	static constexpr UniformID uniformID(std::string_view name);
+
 public:
 	bool setup(Descriptor descriptor);
 
 public:
 	void use() const;
+	// Setters stage writes (no render commands); flush() (called by VertexArray::draw) submits them in one command
+	// Setters and flush() must be called from the same thread
 	void setBool(std::string_view id, bool bVal) const;
 	void setS32(std::string_view id, s32 val) const;
 	void setF32(std::string_view id, f32 val) const;
@@ -221,10 +263,29 @@ public:
 	void bind(std::vector<Texture const*> const& textures) const;
 	void unbind(std::initializer_list<TexType> units) const;
 
+	void flush() const;
+
+private:
+	void stage(std::string_view id, UniformWrite::Type type, f32 const* pData, size_t count) const;
+
 private:
 	friend class Skybox;
 };
 
+constexpr Shader::UniformID Shader::uniformID(std::string_view name)
+{
+	// FNV-1a
+	UniformID hash = 2166136261U;
+	for (auto c : name)
+	{
+		hash ^= (u8)c;
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+// Static geometry is packed into a shared GeometryArena page (m_glID is then the page's VAO), dynamic geometry gets its own buffers
+// VertexFormat::Packed geometry is converted (vertexFormat::pack()) into one interleaved stream of PackedVertex
 class VertexArray : public GFXObject
 {
 public:
@@ -232,14 +293,19 @@ public:
 	{
 		stdfs::path id;
 		DrawType drawType = DrawType::Static;
+		VertexFormat format = VertexFormat::Float32;
 	};
 
 private:
 	static const u16 s_instanceAttribLoc = 5;
+	static const u16 s_instanceNormalsAttribLoc = 9;
 
 private:
 	Descriptor m_descriptor;
+	GeometryArena::Allocation m_allocation;
 	GFXID m_instanceVBO;
+	// Instances passed to drawInstanced() are streamed through this, so they never replace those set via setInstances()
+	GFXID m_batchVBO;
 	GFXID m_geometryVBO;
 	GFXID m_ebo;
 	u32 m_vertexCount = 0;
@@ -260,9 +326,13 @@ public:
 	void setInstances(InstanceBuffer instances);
 
 	void draw(Shader const& shader) const;
+	// Uploads instances into this VertexArray's batch buffer (any set via setInstances are kept) and draws them all at once
+	void drawInstanced(Shader const& shader, InstanceBuffer const& instances) const;
 
 private:
-	static void setGeometryAttributes(Geometry geometry, GFXID vao, GFXID vbo, GFXID ebo, DrawType type);
+	static void setGeometryAttributes(Geometry geometry, GFXID vao, GFXID vbo, GFXID ebo, DrawType type, VertexFormat format);
+	static void setInstanceAttributes(std::vector<glm::mat4> const& interleaved, GFXID vao, GFXID vbo, DrawType type);
+	static void bindInstanceAttributes(GFXID vao, GFXID vbo);
 
 	friend class VertexBuffer;
 };
@@ -315,9 +385,23 @@ public:
 		void deserialise(JSONObj const& json);
 	};
 
+	// \brief Decoded pixels: height rows of width x channels bytes (empty if decoding failed)
+	struct Image final
+	{
+		bytearray pixels;
+		u16 width = 0;
+		u16 height = 0;
+		u8 channels = 0;
+	};
+
 private:
 	Descriptor m_descriptor;
 
+public:
+	// Decodes a PNG / JPG / etc; thread safe (touches no global stb state), so it can run on job workers
+	static Image decode(bytearray const& image, bool bFlipV = true);
+	static Image decode(ByteView const& image, bool bFlipV = true);
+
 public:
 	Texture();
 	Texture(Descriptor descriptor, bytearray image);
@@ -327,6 +411,7 @@ public:
 
 public:
 	bool setup(Descriptor descriptor, bytearray texBytes, u8 ch, u16 w, u16 h);
+	// Decodes image on the calling thread; prefer decode() on a worker + setup(texBytes, ...) when loading many
 	bool setup(Descriptor descriptor, bytearray image);
 
 	void setSampler(Sampler const* pSampler);
@@ -472,7 +557,9 @@ public:
 		Geometry geometry;
 		Material material;
 		stdfs::path id;
-		DrawType drawType;
+		DrawType drawType = DrawType::Dynamic;
+		// Packed: ~40% less vertex memory; normals / UVs are quantised (see vertexFormat)
+		VertexFormat vertexFormat = VertexFormat::Float32;
 	};
 
 private:
@@ -486,7 +573,9 @@ private:
 	VertexArray m_verts;
 	Geometry m_geometry;
 	InstanceBuffer m_instances;
+	AABB m_bounds;
 	DrawType m_drawType;
+	VertexFormat m_vertexFormat = VertexFormat::Float32;
 
 public:
 	Mesh();
@@ -501,12 +590,16 @@ public:
 	bool setInstances(InstanceBuffer instances);
 
 	void draw(Shader const& shader) const;
-	void render(Shader const& shader, Material const* pMaterial = nullptr) const;
+	void drawInstanced(Shader const& shader, InstanceBuffer const& instances) const;
+	void render(Shader const& shader, Material const* pMaterial = nullptr, InstanceBuffer const* pInstances = nullptr) const;
 
 	DrawType drawType() const;
+	VertexFormat vertexFormat() const;
 	VertexArray const& verts() const;
 	Geometry const& geometry() const;
 	InstanceBuffer const& instances() const;
+	// Local-space bounds of the current geometry
+	AABB const& bounds() const;
 };
 
 template <typename T>
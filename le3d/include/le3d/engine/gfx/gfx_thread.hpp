@@ -1,5 +1,7 @@
 #pragma once
+#include <functional>
 #include <future>
+#include "le3d/engine/gfx/command_buffer.hpp"
 #include "gfx_enums.hpp"
 
 namespace le::gfx
@@ -9,6 +11,71 @@ using Deferred = std::function<void()>;
 bool setMode(GFXMode mode);
 GFXMode mode();
 
-void enqueue(Deferred task);
+// Records task (any void() callable) inline into the current command buffer, or runs it immediately in ImmediateMainThread mode
+// (headless: counted and destroyed without running)
+template <typename F>
+void enqueue(F&& task);
+// Records task (callable as void(T const* pData, size_t count)) with a copy of [pData, pData + count) in the command buffer's
+// payload (no heap allocation), or runs it immediately on the caller's data
+template <typename F, typename T>
+void enqueue(F&& task, T const* pData, size_t count);
 void present(Deferred onSwap);
+// Headless: commands are never run and the GL context is not touched (recorded closures are destroyed in order on replay,
+// immediate ones on enqueue)
+void setHeadless(bool bHeadless);
+bool isHeadless();
+// Number of render commands enqueued for the last presented frame
+u32 lastFrameCommandCount();
+// Number of draw calls (instanced or not) recorded for the last presented frame
+u32 lastFrameDrawCount();
+
+namespace threadImpl
+{
+// Returns the locked buffer to record into, or nullptr if the command should be run immediately (or dropped, if headless)
+CommandBuffer* lockRecordBuffer();
+void unlockRecordBuffer();
+void countDraw();
+} // namespace threadImpl
+
+template <typename F>
+void enqueue(F&& task)
+{
+	if (auto pBuffer = threadImpl::lockRecordBuffer())
+	{
+		struct Unlock final
+		{
+			~Unlock()
+			{
+				threadImpl::unlockRecordBuffer();
+			}
+		} unlock;
+		pBuffer->push(std::forward<F>(task));
+	}
+	else if (!isHeadless())
+	{
+		task();
+	}
+	return;
+}
+
+template <typename F, typename T>
+void enqueue(F&& task, T const* pData, size_t count)
+{
+	if (auto pBuffer = threadImpl::lockRecordBuffer())
+	{
+		struct Unlock final
+		{
+			~Unlock()
+			{
+				threadImpl::unlockRecordBuffer();
+			}
+		} unlock;
+		pBuffer->push(std::forward<F>(task), pData, count);
+	}
+	else if (!isHeadless())
+	{
+		task(pData, count);
+	}
+	return;
+}
 } // namespace le::gfx
@@ -13,7 +13,9 @@ public:
 	{
 		std::string id;
 		stdfs::path filename;
+		// Encoded bytes: only used (decoded in setup()) if image is empty
 		bytearray bytes;
+		Texture::Image image;
 		std::string samplerID;
 		TexType type;
 	};
@@ -31,11 +33,15 @@ public:
 		std::vector<TexData> textures;
 		std::vector<MeshData> meshes;
 		std::vector<Mesh const*> meshRefs;
+		// Format of the loaded meshes (set via "vertexFormat": "packed" in the model's json)
+		VertexFormat vertexFormat = VertexFormat::Float32;
 	};
 	struct LoadRequest
 	{
 		stdfs::path jsonID;
 		IOReader const* pReader = nullptr;
+		// Directory for binary mesh caches (keyed by a hash of the json/obj/mtl sources); empty to disable
+		stdfs::path cacheDir;
 	};
 
 #if defined(LE3D_DEBUG)
@@ -51,6 +57,7 @@ public:
 private:
 	std::vector<std::unique_ptr<Mesh>> m_loadedMeshes;
 	std::unordered_map<std::string, std::unique_ptr<Texture>> m_loadedTextures;
+	AABB m_bounds;
 
 private:
 	static GFXID s_nextID;
@@ -68,8 +75,13 @@ public:
 public:
 	bool setup(Descriptor descriptor);
 	void addMesh(Mesh const& mesh);
-	void render(Shader const& shader) const;
+	// Draws every mesh once per instance in pInstances (if set), else once with the shader's current model matrices
+	void render(Shader const& shader, InstanceBuffer const* pInstances = nullptr) const;
+	// Draws one of this model's meshes (with its material / textures)
+	void render(Shader const& shader, Mesh const& mesh, InstanceBuffer const* pInstances = nullptr) const;
 
 	u32 meshCount() const;
+	// Union of all meshes' local-space bounds
+	AABB const& bounds() const;
 };
 } // namespace le::gfx
@@ -0,0 +1,73 @@
+#pragma once
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include "le3d/core/std_types.hpp"
+#include "le3d/engine/gfx/gfx_objects.hpp"
+
+namespace le::gfx
+{
+class Model;
+
+// \brief Collects draws with 64-bit sort keys and submits them radix-sorted, minimising state changes
+// Opaque: [pass | wireframe | shader | material | textures | depth (front to back)]
+// Translucent: [pass | depth (back to front) | wireframe | shader | material | textures]
+class RenderQueue final
+{
+public:
+	enum class Pass : u8
+	{
+		Opaque = 0,
+		Translucent,
+		COUNT_
+	};
+
+	struct Draw final
+	{
+		Shader const* pShader = nullptr;
+		// Owner of pMesh (if any): supplies texture fallbacks
+		Model const* pModel = nullptr;
+		Mesh const* pMesh = nullptr;
+		// Range in instance storage (see addInstance); drawn instanced if instanceCount > 1
+		u32 firstInstance = 0;
+		u32 instanceCount = 0;
+		bool bWireframe = false;
+	};
+
+private:
+	struct Item final
+	{
+		u64 key;
+		u32 draw;
+	};
+
+private:
+	std::vector<Draw> m_draws;
+	std::vector<Item> m_items;
+	std::vector<Item> m_scratch;
+	std::vector<glm::mat4> m_models;
+	std::vector<glm::mat4> m_normals;
+	InstanceBuffer m_batch;
+	std::unordered_map<void const*, u32> m_ids;
+	u32 m_lastFlushCount = 0;
+
+public:
+	// Returns the index of the stored instance (for Draw::firstInstance)
+	u32 addInstance(glm::mat4 const& model, glm::mat4 const& normals);
+	// depth: distance from the viewer (>= 0)
+	void submit(Draw const& draw, Pass pass, f32 depth);
+
+	// Sorts and draws everything submitted, then clears
+	void flush();
+	void clear();
+
+	u32 size() const;
+	u32 lastFlushCount() const;
+
+private:
+	u64 makeKey(Draw const& draw, Pass pass, f32 depth);
+	u32 id(void const* ptr, u32 bits);
+	void sort();
+	void execute(Draw const& draw);
+};
+} // namespace le::gfx
@@ -0,0 +1,51 @@
+#pragma once
+#include <vector>
+#include <glm/glm.hpp>
+#include "le3d/core/std_types.hpp"
+#include "le3d/engine/gfx/gfx_enums.hpp"
+
+namespace le::gfx
+{
+struct Geometry;
+
+// \brief Interleaved VertexFormat::Float32 vertex
+struct Vertex final
+{
+	f32 position[3];
+	f32 normal[3];
+	f32 texCoord[2];
+};
+
+// \brief Interleaved VertexFormat::Packed vertex: same attribute locations, decoded by the vertex fetch (no shader changes)
+// normal: GL_INT_2_10_10_10_REV, normalised (xyz: signed 10-bit, w: unused)
+// texCoord: GL_HALF_FLOAT x2
+struct PackedVertex final
+{
+	f32 position[3];
+	u32 normal;
+	u16 texCoord[2];
+};
+
+static_assert(sizeof(Vertex) == 32, "Unexpected padding!");
+static_assert(sizeof(PackedVertex) == 20, "Unexpected padding!");
+
+namespace vertexFormat
+{
+// Worst-case absolute error of a unit normal component after packNormal() (half a 10-bit step)
+constexpr f32 g_normalEpsilon = 0.5f / 511.0f;
+
+u32 vertexSize(VertexFormat format);
+
+// Signed normalised 10:10:10:2 (components are clamped to [-1, 1]); decoding matches GL's rule for normalised signed integers
+u32 packNormal(glm::vec3 const& normal);
+glm::vec3 unpackNormal(u32 packed);
+
+// IEEE 754 binary16, rounded to nearest even: relative error <= 2^-11 in the normal range
+u16 packHalf(f32 value);
+f32 unpackHalf(u16 half);
+
+// Conversion passes over Geometry; missing normals / UVs are zeroed
+std::vector<Vertex> interleave(Geometry const& geometry);
+std::vector<PackedVertex> pack(Geometry const& geometry);
+} // namespace vertexFormat
+} // namespace le::gfx
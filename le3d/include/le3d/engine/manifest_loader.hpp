@@ -24,6 +24,8 @@ struct Request
 	Manifest manifest;
 	Colour clearColour;
 	u16 extraSwaps = 1;
+	// Forwarded to Model::LoadRequest::cacheDir
+	stdfs::path meshCacheDir;
 };
 
 void load(Request request);
@@ -5,6 +5,7 @@
 #include <unordered_set>
 #include <utility>
 #include "le3d/core/flags.hpp"
+#include "le3d/core/io.hpp"
 #include "le3d/core/std_types.hpp"
 #include "le3d/core/jobs.hpp"
 
@@ -26,6 +27,9 @@ public:
 	{
 		std::function<void()> task;
 		std::string name;
+		// Async reads the task consumes: issue them when enqueueing, so that the I/O thread fetches them while workers run earlier tasks
+		// Cancelled on abort()
+		std::vector<HRead> reads;
 	};
 
 protected:
@@ -33,7 +37,8 @@ protected:
 	{
 		std::function<void()> task;
 		std::string name;
-		std::shared_ptr<HJob> shJob;
+		std::vector<HRead> reads;
+		HJob hJob;
 		u64 id = 0;
 		bool bRun = false;
 	};
@@ -42,8 +47,10 @@ protected:
 	{
 		std::string name;
 		std::deque<Task> tasks;
+		HJob hDone;
 		u16 mainThreadUpdateCount = 1;
 		Flags flags;
+		bool bStarted = false;
 	};
 
 private:
@@ -60,11 +67,14 @@ public:
 	void enqueue(s32 stageIdx, Request request);
 	void start();
 	bool update();
+	// Cancels pending reads, waits for running jobs and drops every remaining stage
+	void abort();
 
 	std::pair<u64, u64> progress() const;
 	bool isDone() const;
 
 protected:
 	bool runActive();
+	void startJobs(Stage& stage, HJob const& after);
 };
 } // namespace le
@@ -10,3 +10,5 @@
 #include "ecs/systems/freecam_controller.hpp"
 #include "ecs/systems/gizmo_system.hpp"
 #include "ecs/systems/prop_renderer.hpp"
+#include "ecs/systems/spatial_system.hpp"
+#include "ecs/systems/transform_system.hpp"
@@ -0,0 +1,119 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "le3d/core/std_types.hpp"
+#include "le3d/game/ecs/ecs_common.hpp"
+
+namespace le
+{
+class Component;
+
+namespace ecs
+{
+// \brief Type-erased owner of one component type's storage
+class ComponentPool
+{
+public:
+	virtual ~ComponentPool();
+
+public:
+	virtual void destroy(Component* pComponent) = 0;
+	virtual size_t count() const = 0;
+};
+
+// \brief Chunked pool: components are constructed in place and never relocated, so pointers to them stay valid
+template <typename Comp>
+class TComponentPool final : public ComponentPool
+{
+public:
+	static constexpr size_t CHUNK_SIZE = 256;
+
+private:
+	struct alignas(Comp) Slot
+	{
+		std::byte bytes[sizeof(Comp)];
+	};
+
+private:
+	std::vector<std::unique_ptr<Slot[]>> m_chunks;
+	std::vector<Slot*> m_free;
+	size_t m_nextInChunk = CHUNK_SIZE;
+	size_t m_count = 0;
+
+public:
+	template <typename... Args>
+	Comp* create(Args&&... args);
+	void destroy(Component* pComponent) override;
+	size_t count() const override;
+};
+
+// \brief All entities with one exact set of component types; columns[c][row] is entity row's component of type signs[c]
+class Archetype final
+{
+public:
+	std::vector<Signature> m_signs;
+	std::vector<SpawnID> m_entities;
+	std::vector<std::vector<Component*>> m_columns;
+	// Cached transitions (by added / removed component type)
+	std::unordered_map<Signature, Archetype*> m_addEdges;
+	std::unordered_map<Signature, Archetype*> m_removeEdges;
+
+public:
+	explicit Archetype(std::vector<Signature> signs);
+
+public:
+	// Returns -1 if sign is not in this archetype
+	s32 column(Signature sign) const;
+	Component* get(Signature sign, size_t row) const;
+	size_t size() const;
+
+	// Appends a row with null components
+	size_t addRow(SpawnID entityID);
+	// Swap-removes row; returns the ID of the entity moved into row (or zero if row was last)
+	SpawnID removeRow(size_t row);
+};
+
+template <typename Comp>
+template <typename... Args>
+Comp* TComponentPool<Comp>::create(Args&&... args)
+{
+	Slot* pSlot = nullptr;
+	if (!m_free.empty())
+	{
+		pSlot = m_free.back();
+		m_free.pop_back();
+	}
+	else
+	{
+		if (m_nextInChunk == CHUNK_SIZE)
+		{
+			m_chunks.push_back(std::make_unique<Slot[]>(CHUNK_SIZE));
+			m_nextInChunk = 0;
+		}
+		pSlot = &m_chunks.back()[m_nextInChunk++];
+	}
+	auto pComp = new (pSlot->bytes) Comp(std::forward<Args>(args)...);
+	++m_count;
+	return pComp;
+}
+
+template <typename Comp>
+void TComponentPool<Comp>::destroy(Component* pComponent)
+{
+	auto pComp = static_cast<Comp*>(pComponent);
+	pComp->~Comp();
+	m_free.push_back(reinterpret_cast<Slot*>(pComp));
+	--m_count;
+	return;
+}
+
+template <typename Comp>
+size_t TComponentPool<Comp>::count() const
+{
+	return m_count;
+}
+} // namespace ecs
+} // namespace le
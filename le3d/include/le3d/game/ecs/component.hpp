@@ -41,5 +41,5 @@ private:
 	friend class ECSDB;
 };
 
-// Template implementations in ecImpl.hpp
+// Template implementations in ecs_impl.hpp
 } // namespace le
@@ -8,7 +8,7 @@
 
 namespace le
 {
-// Template implementations for entity.hpp, component.hpp, and ecdb.hpp
+// Template implementations for entity.hpp, component.hpp, system.hpp, and ecsdb.hpp
 
 template <typename Comp>
 Comp const* Entity::getComponent() const
@@ -33,18 +33,14 @@ Comp* Entity::getComponent(Ent* pThis)
 {
 	static_assert(std::is_base_of_v<Component, Comp>, "Comp must derive from Component!");
 	auto const sign = ECSDB::getSignature<Comp>();
-	return dynamic_cast<Comp*>(getComponent(pThis, sign));
+	// Signatures identify exact types, no need for dynamic_cast
+	return static_cast<Comp*>(getComponent(pThis, sign));
 }
 
 template <typename Ent>
 Component* Entity::getComponent(Ent* pThis, ecs::Signature sign)
 {
-	auto search = pThis->m_components.find(sign);
-	if (search != pThis->m_components.end())
-	{
-		return search->second;
-	}
-	return nullptr;
+	return pThis->m_pArchetype ? pThis->m_pArchetype->get(sign, pThis->m_row) : nullptr;
 }
 
 template <typename Ent>
@@ -65,13 +61,31 @@ Comp* Component::getComponent()
 	return m_pOwner ? m_pOwner->getComponent<Comp>() : nullptr;
 }
 
+template <typename... Comps>
+void System::reads()
+{
+	static_assert((std::is_base_of_v<Component, Comps> && ...), "Comp must derive from Component!");
+	(m_access.reads.push_back(ECSDB::getSignature<Comps>()), ...);
+	m_access.bDeclared = true;
+	return;
+}
+
+template <typename... Comps>
+void System::writes()
+{
+	static_assert((std::is_base_of_v<Component, Comps> && ...), "Comp must derive from Component!");
+	(m_access.writes.push_back(ECSDB::getSignature<Comps>()), ...);
+	m_access.bDeclared = true;
+	return;
+}
+
 template <typename Comp>
 Comp const* CompQuery::get() const
 {
 	static_assert(std::is_base_of_v<Component, Comp>, "Comp must derive from Component!");
 	auto const sign = ECSDB::getSignature<Comp>();
 	auto const search = m_results.find(sign);
-	return search != m_results.end() ? dynamic_cast<Comp const*>(search->second) : nullptr;
+	return search != m_results.end() ? static_cast<Comp const*>(search->second) : nullptr;
 }
 
 template <typename Comp>
@@ -80,7 +94,7 @@ Comp* CompQuery::get()
 	static_assert(std::is_base_of_v<Component, Comp>, "Comp must derive from Component!");
 	auto const sign = ECSDB::getSignature<Comp>();
 	auto search = m_results.find(sign);
-	return search != m_results.end() ? dynamic_cast<Comp*>(search->second) : nullptr;
+	return search != m_results.end() ? static_cast<Comp*>(search->second) : nullptr;
 }
 
 template <typename T>
@@ -109,8 +123,8 @@ Comp* ECSDB::addComponent(ecs::SpawnID entityID, Args... args)
 	if (auto pEntity = getEntity(entityID))
 	{
 		auto const sign = getSignature<Comp>();
-		auto uComp = std::make_unique<Comp>(std::forward<Args>(args)...);
-		return dynamic_cast<Comp*>(attach(sign, std::move(uComp), *pEntity));
+		auto pComp = pool<Comp>().create(std::forward<Args>(args)...);
+		return static_cast<Comp*>(attach(sign, pComp, *pEntity));
 	}
 	return nullptr;
 }
@@ -142,19 +156,10 @@ bool ECSDB::destroyComponent(ecs::SpawnID entityID)
 	static_assert(std::is_base_of_v<Component, Comp>, "Comp must derive from Component!");
 	if (auto pEntity = getEntity(entityID))
 	{
-		auto const sign = getSignature<Comp>();
-		auto cSearch = m_components.find(sign);
-		if (cSearch != m_components.end())
+		if (auto pComp = Entity::getComponent(pEntity, getSignature<Comp>()))
 		{
-			auto& cmap = cSearch->second;
-			auto search = cmap.find(entityID);
-			if (search != cmap.end())
-			{
-				auto& uC = search->second;
-				pEntity->m_components.erase(sign);
-				detach(*uC, entityID);
-				return true;
-			}
+			detach(*pComp, entityID);
+			return true;
 		}
 	}
 	return false;
@@ -210,6 +215,20 @@ void ECSDB::destroySystem()
 	return;
 }
 
+template <typename Comp1, typename... Comps>
+ecs::View<Comp1, Comps...> ECSDB::view()
+{
+	static_assert((std::is_base_of_v<Component, Comp1> && ... && std::is_base_of_v<Component, Comps>), "Comp must derive from Component!");
+	return ecs::View<Comp1, Comps...>(viewCache<Comp1, Comps...>());
+}
+
+template <typename Comp1, typename... Comps>
+ecs::View<Comp1 const, Comps const...> ECSDB::view() const
+{
+	static_assert((std::is_base_of_v<Component, Comp1> && ... && std::is_base_of_v<Component, Comps>), "Comp must derive from Component!");
+	return ecs::View<Comp1 const, Comps const...>(viewCache<Comp1, Comps...>());
+}
+
 template <typename Comp1, typename... Comps>
 ECSDB::Query ECSDB::any() const
 {
@@ -228,18 +247,8 @@ template <typename T, typename Comp>
 Comp* ECSDB::getComponent(T* pThis, ecs::SpawnID entityID)
 {
 	static_assert(std::is_base_of_v<Component, Comp>, "Comp must derive from Component!");
-	auto const sign = getSignature<Comp>();
-	auto cSearch = pThis->m_components.find(sign);
-	if (cSearch != pThis->m_components.end())
-	{
-		auto& cmap = cSearch->second;
-		auto search = cmap.find(entityID);
-		if (search != cmap.end())
-		{
-			return dynamic_cast<Comp*>(search->second.get());
-		}
-	}
-	return nullptr;
+	auto pEntity = pThis->getEntity(entityID);
+	return pEntity ? Entity::getComponent<Comp>(pEntity) : nullptr;
 }
 
 template <typename T, typename Sys>
@@ -255,6 +264,17 @@ Sys* ECSDB::getSystem(T* pThis)
 	return nullptr;
 }
 
+template <typename Comp>
+ecs::TComponentPool<Comp>& ECSDB::pool()
+{
+	auto& uPool = m_pools[getSignature<Comp>()];
+	if (!uPool)
+	{
+		uPool = std::make_unique<ecs::TComponentPool<Comp>>();
+	}
+	return static_cast<ecs::TComponentPool<Comp>&>(*uPool);
+}
+
 template <typename Comp>
 u32 ECSDB::enumerate()
 {
@@ -289,16 +309,16 @@ void ECSDB::fill(T* pThis, Query& outQuery)
 {
 	static_assert(std::is_base_of_v<Component, Comp>, "Comp must derive from Component!");
 	auto const sign = getSignature<Comp>();
-	auto cSearch = pThis->m_components.find(sign);
-	if (cSearch != pThis->m_components.end())
+	for (auto const& kvp : pThis->m_archetypes)
 	{
-		auto& cmap = cSearch->second;
-		for (auto& kvp : cmap)
+		auto const& archetype = *kvp.second;
+		s32 const col = archetype.column(sign);
+		if (col >= 0)
 		{
-			auto& uC = kvp.second;
-			if (uC->m_pOwner)
+			auto const& column = archetype.m_columns[(size_t)col];
+			for (size_t row = 0; row < archetype.size(); ++row)
 			{
-				outQuery[uC->m_pOwner->m_id].m_results[sign] = uC.get();
+				outQuery[archetype.m_entities[row]].m_results[sign] = column[row];
 			}
 		}
 	}
@@ -313,6 +333,24 @@ void ECSDB::fill(T* pThis, Query& outQuery)
 	return;
 }
 
+template <typename Comp1, typename... Comps>
+ecs::ViewCache const* ECSDB::viewCache() const
+{
+	static size_t const s_slot = nextViewSlot();
+	auto const pSlot = s_slot < m_uViewSlots->size() ? &(*m_uViewSlots)[s_slot] : nullptr;
+	ecs::ViewCache const* pRet = pSlot ? pSlot->load(std::memory_order_acquire) : nullptr;
+	if (!pRet)
+	{
+		std::array<ecs::Signature, 1 + sizeof...(Comps)> const signs = {getSignature<Comp1>(), getSignature<Comps>()...};
+		pRet = viewCache(signs.data(), signs.size());
+		if (pSlot)
+		{
+			pSlot->store(pRet, std::memory_order_release);
+		}
+	}
+	return pRet;
+}
+
 #define LE3D_ECS_USE_ANY_FOR_ALL 0
 template <typename T, typename Comp1, typename... Comps>
 ECSDB::Query ECSDB::all(T* pThis)
@@ -336,14 +374,25 @@ ECSDB::Query ECSDB::all(T* pThis)
 #else
 	std::deque<ecs::Signature> signs;
 	setSigns<Comp1, Comps...>(signs);
-	for (auto& kvp : pThis->m_entities)
+	std::vector<s32> columns(signs.size());
+	for (auto const& kvp : pThis->m_archetypes)
 	{
-		auto& entity = kvp.second;
-		if (Entity::hasComponents(&entity, signs))
+		auto const& archetype = *kvp.second;
+		bool bMatch = archetype.size() > 0;
+		for (size_t idx = 0; bMatch && idx < signs.size(); ++idx)
+		{
+			columns[idx] = archetype.column(signs[idx]);
+			bMatch = columns[idx] >= 0;
+		}
+		if (bMatch)
 		{
-			for (auto sign : signs)
+			for (size_t row = 0; row < archetype.size(); ++row)
 			{
-				ret[entity.m_id].m_results[sign] = Entity::getComponent(&entity, sign);
+				auto& results = ret[archetype.m_entities[row]].m_results;
+				for (size_t idx = 0; idx < signs.size(); ++idx)
+				{
+					results[signs[idx]] = archetype.m_columns[(size_t)columns[idx]][row];
+				}
 			}
 		}
 	}
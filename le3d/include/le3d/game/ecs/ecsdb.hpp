@@ -1,14 +1,21 @@
 #pragma once
+#include <array>
+#include <atomic>
 #include <deque>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include "le3d/core/delegate.hpp"
 #include "le3d/core/std_types.hpp"
 #include "le3d/core/time.hpp"
+#include "archetype.hpp"
 #include "ecs_common.hpp"
 #include "entity.hpp"
 #include "system.hpp"
+#include "view.hpp"
 
 namespace le
 {
@@ -27,26 +34,47 @@ public:
 
 class ECSDB
 {
-protected:
-	using EntToComp = std::unordered_map<s64, std::unique_ptr<class Component>>;
-
 public:
 	using EntityMap = std::unordered_map<s64, Entity>;
-	using ComponentMap = std::unordered_map<ecs::Signature, EntToComp>;
+	using PoolMap = std::unordered_map<ecs::Signature, std::unique_ptr<ecs::ComponentPool>>;
+	using ArchetypeMap = std::map<std::vector<ecs::Signature>, std::unique_ptr<ecs::Archetype>>;
+	using ViewMap = std::map<std::vector<ecs::Signature>, std::unique_ptr<ecs::ViewCache>, ecs::SignsLess>;
 	using SystemMap = std::unordered_map<ecs::Signature, std::unique_ptr<System>>;
 	using Query = std::unordered_map<s64, CompQuery>;
 	using OnTick = Delegate<ECSDB&, Time>;
 	using OnRender = Delegate<ECSDB const&>;
 
+private:
+	using ViewSlots = std::array<std::atomic<ecs::ViewCache const*>, 64>;
+
+	// Systems and slots in Timing order, rebuilt only when the set (or a timing) changes
+	struct Schedule final
+	{
+		std::vector<System*> ordered;
+		std::vector<ecs::Timing> timings;
+		// Groups of mutually non-conflicting systems (ticked concurrently); conflicting ones are in Timing order across waves
+		std::vector<std::vector<System*>> waves;
+		bool bDirty = true;
+	};
+
 protected:
 	EntityMap m_entities;
-	ComponentMap m_components;
+	// Components are pooled per type; entities with the same set of types share an Archetype (dense columns)
+	PoolMap m_pools;
+	ArchetypeMap m_archetypes;
+	// Keyed by combined signatures; created on first use, kept in sync as Archetypes are created
+	mutable ViewMap m_views;
+	mutable std::unique_ptr<std::mutex> m_uViewsMutex;
+	// Per query type (see viewSlot()): the ViewCache once it exists, so view() skips the mutex and map lookup
+	mutable std::unique_ptr<ViewSlots> m_uViewSlots;
 	SystemMap m_systems;
 	std::unordered_map<s64, std::string> m_entityNames;
 	std::deque<std::unique_ptr<System>> m_tickSlots;
 	mutable std::deque<std::unique_ptr<System>> m_renderSlots;
 
 private:
+	Schedule m_tickSchedule;
+	mutable Schedule m_renderSchedule;
 	ecs::SpawnID m_nextEID;
 
 public:
@@ -103,6 +131,13 @@ public:
 
 	void setAll(System::Flag flag, bool bValue);
 
+	// Prefer view() in per-frame code: all() / any() build a new Query on every call
+	template <typename Comp1, typename... Comps>
+	ecs::View<Comp1, Comps...> view();
+
+	template <typename Comp1, typename... Comps>
+	ecs::View<Comp1 const, Comps const...> view() const;
+
 	template <typename Comp1, typename... Comps>
 	Query any() const;
 
@@ -126,6 +161,9 @@ private:
 	template <typename T, typename Sys>
 	static Sys* getSystem(T* pThis);
 
+	template <typename Comp>
+	ecs::TComponentPool<Comp>& pool();
+
 	template <typename Comp>
 	static u32 enumerate();
 
@@ -147,12 +185,26 @@ private:
 	template <typename T, typename Comp1, typename... Comps>
 	static Query all(T* pThis);
 
-	Component* attach(ecs::Signature sign, std::unique_ptr<Component>&& uComp, Entity& entity);
+	template <typename Comp1, typename... Comps>
+	ecs::ViewCache const* viewCache() const;
+	ecs::ViewCache const* viewCache(ecs::Signature const* pSigns, size_t count) const;
+	// Process-wide index of a query type into m_uViewSlots (may be out of range, if there are more query types than slots)
+	static size_t nextViewSlot();
+
+	Component* attach(ecs::Signature sign, Component* pComp, Entity& entity);
 	System* attach(ecs::Signature sign, std::unique_ptr<System>&& uSys);
 	void detach(Component& component, ecs::SpawnID id);
+	void detachAll(Entity& entity);
 	void detach(System& system);
+	ecs::Archetype* archetype(std::vector<ecs::Signature> signs);
+	ecs::Archetype* withAdded(ecs::Archetype* pSource, ecs::Signature sign);
+	ecs::Archetype* withRemoved(ecs::Archetype* pSource, ecs::Signature sign);
+	void migrate(Entity& entity, ecs::Archetype* pTarget);
+	void destroy(Component& component);
+	static void build(Schedule& out, SystemMap const& systems, std::deque<std::unique_ptr<System>> const& slots, bool bWaves);
+	static bool isStale(Schedule const& schedule);
 	EntityMap::iterator destroyEntity(EntityMap::iterator iter, ecs::SpawnID id);
 };
 
-// Template implementations in ecImpl.hpp
+// Template implementations in ecs_impl.hpp
 } // namespace le
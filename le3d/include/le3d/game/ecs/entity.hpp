@@ -1,12 +1,18 @@
 #pragma once
 #include <deque>
-#include <unordered_map>
 #include "le3d/core/std_types.hpp"
 #include "le3d/core/flags.hpp"
 #include "ecs_common.hpp"
 
 namespace le
 {
+class Component;
+
+namespace ecs
+{
+class Archetype;
+}
+
 class Entity final
 {
 public:
@@ -18,14 +24,14 @@ public:
 	};
 	using Flags = TFlags<Flag>;
 
-private:
-	std::unordered_map<ecs::Signature, class Component*> m_components;
-
 public:
 	Flags m_flags;
 
 private:
 	class ECSDB* m_pDB = nullptr;
+	// Null if the entity has no components
+	ecs::Archetype* m_pArchetype = nullptr;
+	size_t m_row = 0;
 	ecs::SpawnID m_id;
 
 public:
@@ -65,5 +71,5 @@ private:
 	static bool hasComponents(Ent* pThis, std::deque<ecs::Signature> const& signs);
 };
 
-// Template implementations in ecImpl.hpp
+// Template implementations in ecs_impl.hpp
 } // namespace le
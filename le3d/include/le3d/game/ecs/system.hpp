@@ -1,4 +1,5 @@
 #pragma once
+#include <vector>
 #include "le3d/core/flags.hpp"
 #include "le3d/core/time.hpp"
 #include "le3d/game/ecs/ecs_common.hpp"
@@ -16,12 +17,24 @@ public:
 	};
 	using Flags = TFlags<Flag>;
 
+	// \brief Component types accessed in tick(): ECSDB runs systems whose accesses don't conflict concurrently
+	struct Access final
+	{
+		std::vector<ecs::Signature> reads;
+		std::vector<ecs::Signature> writes;
+		// Systems that declare nothing run exclusively (and on the ticking thread)
+		bool bDeclared = false;
+		// Cleared by renderOnly(): the system is left out of the tick schedule
+		bool bTicks = true;
+	};
+
 public:
 	ecs::Timing m_defaultTiming = 0.0f;
 
 private:
 	ecs::Signature m_signature = 0;
 	Flags m_flags;
+	Access m_access;
 
 public:
 	System() noexcept;
@@ -34,9 +47,21 @@ public:
 	bool isRendering() const;
 	void setFlag(Flag flag, bool bValue);
 
+	Access const& access() const;
+	bool conflicts(System const& rhs) const;
+
 public:
 	virtual ecs::Timing timing() const;
 
+protected:
+	// Call in the constructor; a declared system must not spawn/destroy entities or add/remove components in tick()
+	template <typename... Comps>
+	void reads();
+	template <typename... Comps>
+	void writes();
+	// Call in the constructor of a system that doesn't override tick()
+	void renderOnly();
+
 protected:
 	virtual void tick(class ECSDB& db, Time dt);
 	virtual void render(ECSDB const& db) const;
@@ -44,4 +69,6 @@ protected:
 private:
 	friend class ECSDB;
 };
+
+// Template implementations in ecs_impl.hpp
 } // namespace le
@@ -13,6 +13,10 @@ protected:
 	ForEachCam m_forEachCam;
 
 public:
+	FreeCamController();
+
+public:
+	// Callback may be invoked on a jobs worker (concurrently with systems that don't access CFreeCam)
 	ForEachCam::Token setCallback(ForEachCam::Callback callback);
 
 protected:
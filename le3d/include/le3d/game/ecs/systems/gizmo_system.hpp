@@ -8,6 +8,9 @@ class GizmoSystem : public System
 public:
 	static ecs::Timing s_timingDelta;
 
+public:
+	GizmoSystem();
+
 public:
 	ecs::Timing timing() const override;
 
@@ -1,11 +1,72 @@
 #pragma once
+#include <optional>
+#include <vector>
+#include <glm/glm.hpp>
+#include "le3d/core/bounds.hpp"
+#include "le3d/engine/gfx/render_queue.hpp"
 #include "le3d/game/ecs/system.hpp"
 
 namespace le
 {
+// \brief Groups opaque fixtures by (wireframe, shader, model / mesh) into instanced draws, and submits every mesh draw
+// through a sorted RenderQueue (translucent props back-to-front); fixtures outside the view frustum are culled first
 class PropRenderer : public System
 {
+public:
+	struct CullStats final
+	{
+		u32 visible = 0;
+		u32 culled = 0;
+	};
+
+public:
+	// Groups smaller than this are drawn one fixture at a time
+	static size_t s_minInstances;
+
+public:
+	// Viewer position, for depth sorting (set by the owner every frame)
+	glm::vec3 m_viewPos = glm::vec3(0.0f);
+	// Camera projection * view, for frustum culling (set by the owner every frame; nothing is culled if unset)
+	std::optional<glm::mat4> m_oViewProj;
+
+private:
+	struct Instance final
+	{
+		glm::mat4 model;
+		glm::mat4 normals;
+		gfx::Shader const* pShader = nullptr;
+		gfx::Model const* pModel = nullptr;
+		gfx::Mesh const* pMesh = nullptr;
+		f32 depth = 0.0f;
+		bool bWireframe = false;
+		bool bTranslucent = false;
+	};
+
+private:
+	// Reused across frames
+	mutable std::vector<Instance> m_instances;
+	mutable AABBBatch m_bounds;
+	mutable std::vector<u32> m_visible;
+	mutable gfx::RenderQueue m_queue;
+	mutable CullStats m_cullStats;
+
+public:
+	PropRenderer();
+
+public:
+	// Fixtures drawn / culled by the last render
+	CullStats cullStats() const;
+
 protected:
 	void render(ECSDB const& db) const override;
+
+private:
+	static bool sameBatch(Instance const& lhs, Instance const& rhs);
+	// Whether instance's mesh (or any of its model's meshes) has instances of its own (set via setInstances())
+	static bool hasOwnInstances(Instance const& instance);
+	// Drops every instance outside the frustum (keeps order)
+	void cull(Frustum const& frustum) const;
+	// Submits a draw per mesh of instance's model / mesh, covering instanceCount instances from firstInstance
+	void submit(Instance const& instance, u32 firstInstance, u32 instanceCount) const;
 };
 } // namespace le
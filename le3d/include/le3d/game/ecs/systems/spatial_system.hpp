@@ -0,0 +1,59 @@
+#pragma once
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include "le3d/core/bvh.hpp"
+#include "le3d/game/ecs/system.hpp"
+
+namespace le
+{
+class CProp;
+class CTransform;
+
+// \brief Keeps a BVH of every enabled CTransform entity's world bounds (its CProp fixtures, else a point at its position)
+// Refreshed once per tick after TransformSystem; query it from render, or from systems ticking in a later wave
+class SpatialSystem : public System
+{
+public:
+	struct RayHit final
+	{
+		ecs::SpawnID entityID;
+		f32 t = 0.0f;
+	};
+
+public:
+	// Runs after TransformSystem
+	static ecs::Timing s_timingDelta;
+
+private:
+	BVH m_bvh;
+	// Tick on which each indexed entity was last seen
+	std::unordered_map<s64, u32> m_stamps;
+	// Reused across ticks
+	std::vector<BVH::Item> m_added;
+	std::vector<BVH::Key> m_removed;
+	u32 m_tick = 0;
+
+public:
+	SpatialSystem();
+
+public:
+	ecs::Timing timing() const override;
+
+	// Appends entities whose world bounds intersect aabb / frustum to outIDs
+	void query(AABB const& aabb, std::vector<ecs::SpawnID>& outIDs) const;
+	void query(Frustum const& frustum, std::vector<ecs::SpawnID>& outIDs) const;
+	// Closest entity whose world bounds are hit by the ray
+	std::optional<RayHit> raycast(glm::vec3 const& origin, glm::vec3 const& direction, f32 maxT = 1e30f) const;
+
+	BVH const& bvh() const;
+
+	static AABB worldBounds(CTransform const& transform, CProp const* pProp);
+
+protected:
+	void tick(ECSDB& db, Time dt) override;
+
+private:
+	static void append(std::vector<BVH::Key> const& keys, std::vector<ecs::SpawnID>& outIDs);
+};
+} // namespace le
@@ -0,0 +1,36 @@
+#pragma once
+#include <vector>
+#include "le3d/game/ecs/system.hpp"
+
+namespace le
+{
+// \brief Refreshes every dirty CTransform (and its ancestors) once per tick, in one parent-before-child pass
+class TransformSystem : public System
+{
+public:
+	// Runs after all gameplay systems / slots
+	static ecs::Timing s_timingDelta;
+	// Depth levels at least this large are updated across jobs workers
+	static size_t s_parallelThreshold;
+
+private:
+	// Sorted by depth: every parent precedes its children
+	std::vector<class Transform const*> m_ordered;
+	// Start offset of each depth level in m_ordered (plus end)
+	std::vector<size_t> m_levels;
+	size_t m_count = 0;
+	u32 m_version = 0;
+
+public:
+	TransformSystem();
+
+public:
+	ecs::Timing timing() const override;
+
+protected:
+	void tick(ECSDB& db, Time dt) override;
+
+private:
+	void rebuild(ECSDB& db);
+};
+} // namespace le
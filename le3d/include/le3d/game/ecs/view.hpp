@@ -0,0 +1,196 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "le3d/core/std_types.hpp"
+#include "le3d/game/ecs/archetype.hpp"
+
+namespace le::ecs
+{
+// \brief Persistent match list of one query: every Archetype that has all of m_signs (updated as Archetypes are created)
+class ViewCache final
+{
+public:
+	struct Match final
+	{
+		Archetype const* pArchetype = nullptr;
+		// Column in pArchetype of each of m_signs (in query order)
+		std::vector<size_t> columns;
+	};
+
+public:
+	std::vector<Signature> m_signs;
+	std::vector<Match> m_matches;
+
+public:
+	explicit ViewCache(std::vector<Signature> signs);
+
+public:
+	// Adds archetype if it has all of m_signs
+	bool tryAdd(Archetype const& archetype);
+};
+
+// \brief Lexicographic order over signature lists; transparent, so a query's signatures can be looked up as a SignSpan
+// without building a std::vector key
+struct SignsLess final
+{
+	struct SignSpan final
+	{
+		Signature const* pData = nullptr;
+		size_t count = 0;
+	};
+
+	using is_transparent = void;
+
+	bool operator()(std::vector<Signature> const& lhs, std::vector<Signature> const& rhs) const;
+	bool operator()(std::vector<Signature> const& lhs, SignSpan rhs) const;
+	bool operator()(SignSpan lhs, std::vector<Signature> const& rhs) const;
+};
+
+// \brief Iterates tuples of typed pointers to every entity's Comps...; does not allocate
+// Attaching / detaching components invalidates iterators (rows are swap-removed)
+template <typename... Comps>
+class View final
+{
+public:
+	static constexpr size_t N = sizeof...(Comps);
+	using Tuple = std::tuple<Comps*...>;
+
+	class Iter final
+	{
+	private:
+		ViewCache::Match const* m_pMatch = nullptr;
+		ViewCache::Match const* m_pEnd = nullptr;
+		std::array<Component* const*, N> m_columns = {};
+		size_t m_row = 0;
+		size_t m_size = 0;
+
+	public:
+		Iter(ViewCache::Match const* pMatch, ViewCache::Match const* pEnd);
+
+	public:
+		Tuple operator*() const;
+		Iter& operator++();
+		bool operator==(Iter const& rhs) const;
+		bool operator!=(Iter const& rhs) const;
+
+	private:
+		// Skips empty archetypes and caches column pointers of the next non-empty one
+		void seek();
+		template <size_t... I>
+		Tuple get(std::index_sequence<I...>) const;
+	};
+
+private:
+	ViewCache const* m_pCache = nullptr;
+
+public:
+	explicit View(ViewCache const* pCache);
+
+public:
+	Iter begin() const;
+	Iter end() const;
+	size_t size() const;
+	bool empty() const;
+};
+
+template <typename... Comps>
+View<Comps...>::Iter::Iter(ViewCache::Match const* pMatch, ViewCache::Match const* pEnd) : m_pMatch(pMatch), m_pEnd(pEnd)
+{
+	seek();
+}
+
+template <typename... Comps>
+typename View<Comps...>::Tuple View<Comps...>::Iter::operator*() const
+{
+	return get(std::index_sequence_for<Comps...>{});
+}
+
+template <typename... Comps>
+typename View<Comps...>::Iter& View<Comps...>::Iter::operator++()
+{
+	if (++m_row == m_size)
+	{
+		++m_pMatch;
+		m_row = 0;
+		seek();
+	}
+	return *this;
+}
+
+template <typename... Comps>
+bool View<Comps...>::Iter::operator==(Iter const& rhs) const
+{
+	return m_pMatch == rhs.m_pMatch && m_row == rhs.m_row;
+}
+
+template <typename... Comps>
+bool View<Comps...>::Iter::operator!=(Iter const& rhs) const
+{
+	return !(*this == rhs);
+}
+
+template <typename... Comps>
+void View<Comps...>::Iter::seek()
+{
+	for (; m_pMatch != m_pEnd; ++m_pMatch)
+	{
+		m_size = m_pMatch->pArchetype->size();
+		if (m_size > 0)
+		{
+			for (size_t idx = 0; idx < N; ++idx)
+			{
+				m_columns[idx] = m_pMatch->pArchetype->m_columns[m_pMatch->columns[idx]].data();
+			}
+			return;
+		}
+	}
+	m_size = 0;
+	return;
+}
+
+template <typename... Comps>
+template <size_t... I>
+typename View<Comps...>::Tuple View<Comps...>::Iter::get(std::index_sequence<I...>) const
+{
+	return Tuple(static_cast<Comps*>(m_columns[I][m_row])...);
+}
+
+template <typename... Comps>
+View<Comps...>::View(ViewCache const* pCache) : m_pCache(pCache)
+{
+}
+
+template <typename... Comps>
+typename View<Comps...>::Iter View<Comps...>::begin() const
+{
+	auto const pEnd = m_pCache->m_matches.data() + m_pCache->m_matches.size();
+	return Iter(m_pCache->m_matches.data(), pEnd);
+}
+
+template <typename... Comps>
+typename View<Comps...>::Iter View<Comps...>::end() const
+{
+	auto const pEnd = m_pCache->m_matches.data() + m_pCache->m_matches.size();
+	return Iter(pEnd, pEnd);
+}
+
+template <typename... Comps>
+size_t View<Comps...>::size() const
+{
+	size_t ret = 0;
+	for (auto const& match : m_pCache->m_matches)
+	{
+		ret += match.pArchetype->size();
+	}
+	return ret;
+}
+
+template <typename... Comps>
+bool View<Comps...>::empty() const
+{
+	return begin() == end();
+}
+} // namespace le::ecs
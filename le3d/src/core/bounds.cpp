@@ -0,0 +1,181 @@
+#include <algorithm>
+#include <cmath>
+#include "le3d/core/bounds.hpp"
+
+namespace le
+{
+namespace
+{
+// Used as the extents of empty boxes in a batch: large enough to intersect every plane
+constexpr f32 g_unbounded = std::numeric_limits<f32>::max();
+} // namespace
+
+bool AABB::isEmpty() const
+{
+	return min.x > max.x || min.y > max.y || min.z > max.z;
+}
+
+glm::vec3 AABB::centre() const
+{
+	return (min + max) * 0.5f;
+}
+
+glm::vec3 AABB::extents() const
+{
+	return (max - min) * 0.5f;
+}
+
+void AABB::add(glm::vec3 const& point)
+{
+	min = glm::min(min, point);
+	max = glm::max(max, point);
+	return;
+}
+
+void AABB::add(AABB const& aabb)
+{
+	if (!aabb.isEmpty())
+	{
+		min = glm::min(min, aabb.min);
+		max = glm::max(max, aabb.max);
+	}
+	return;
+}
+
+AABB AABB::transformed(glm::mat4 const& mat) const
+{
+	if (isEmpty())
+	{
+		return *this;
+	}
+	// Transform the centre, and project the extents onto each world axis (Arvo)
+	glm::vec3 const c = glm::vec3(mat * glm::vec4(centre(), 1.0f));
+	glm::vec3 const e = extents();
+	glm::vec3 worldE(0.0f);
+	for (s32 col = 0; col < 3; ++col)
+	{
+		worldE += glm::abs(glm::vec3(mat[col])) * e[col];
+	}
+	AABB ret;
+	ret.min = c - worldE;
+	ret.max = c + worldE;
+	return ret;
+}
+
+bool Frustum::intersects(AABB const& aabb) const
+{
+	if (aabb.isEmpty())
+	{
+		return true;
+	}
+	glm::vec3 const c = aabb.centre();
+	glm::vec3 const e = aabb.extents();
+	for (auto const& plane : planes)
+	{
+		glm::vec3 const n(plane);
+		if (glm::dot(n, c) + plane.w + glm::dot(glm::abs(n), e) < 0.0f)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+Frustum Frustum::fromViewProj(glm::mat4 const& viewProj)
+{
+	// Gribb-Hartmann: each plane is row 3 +/- one of rows 0-2 (glm is column-major)
+	auto row = [&viewProj](s32 idx) { return glm::vec4(viewProj[0][idx], viewProj[1][idx], viewProj[2][idx], viewProj[3][idx]); };
+	glm::vec4 const r0 = row(0);
+	glm::vec4 const r1 = row(1);
+	glm::vec4 const r2 = row(2);
+	glm::vec4 const r3 = row(3);
+	Frustum ret;
+	ret.planes[Left] = r3 + r0;
+	ret.planes[Right] = r3 - r0;
+	ret.planes[Bottom] = r3 + r1;
+	ret.planes[Top] = r3 - r1;
+	ret.planes[Near] = r3 + r2;
+	ret.planes[Far] = r3 - r2;
+	for (auto& plane : ret.planes)
+	{
+		f32 const length = glm::length(glm::vec3(plane));
+		if (length > 0.0f)
+		{
+			plane /= length;
+		}
+	}
+	return ret;
+}
+
+void AABBBatch::clear()
+{
+	cx.clear();
+	cy.clear();
+	cz.clear();
+	ex.clear();
+	ey.clear();
+	ez.clear();
+	return;
+}
+
+void AABBBatch::reserve(size_t count)
+{
+	cx.reserve(count);
+	cy.reserve(count);
+	cz.reserve(count);
+	ex.reserve(count);
+	ey.reserve(count);
+	ez.reserve(count);
+	return;
+}
+
+void AABBBatch::push_back(AABB const& aabb)
+{
+	bool const bEmpty = aabb.isEmpty();
+	glm::vec3 const c = bEmpty ? glm::vec3(0.0f) : aabb.centre();
+	glm::vec3 const e = bEmpty ? glm::vec3(g_unbounded) : aabb.extents();
+	cx.push_back(c.x);
+	cy.push_back(c.y);
+	cz.push_back(c.z);
+	ex.push_back(e.x);
+	ey.push_back(e.y);
+	ez.push_back(e.z);
+	return;
+}
+
+size_t AABBBatch::size() const
+{
+	return cx.size();
+}
+
+size_t cull(Frustum const& frustum, AABBBatch const& boxes, std::vector<u32>& outVisible)
+{
+	size_t const count = boxes.size();
+	outVisible.assign(count, 1);
+	u32* pOut = outVisible.data();
+	f32 const* pCX = boxes.cx.data();
+	f32 const* pCY = boxes.cy.data();
+	f32 const* pCZ = boxes.cz.data();
+	f32 const* pEX = boxes.ex.data();
+	f32 const* pEY = boxes.ey.data();
+	f32 const* pEZ = boxes.ez.data();
+	// One branch-free pass per plane over contiguous arrays, so the compiler vectorises the inner loop
+	for (auto const& plane : frustum.planes)
+	{
+		f32 const nx = plane.x;
+		f32 const ny = plane.y;
+		f32 const nz = plane.z;
+		f32 const nw = plane.w;
+		f32 const ax = std::abs(nx);
+		f32 const ay = std::abs(ny);
+		f32 const az = std::abs(nz);
+		for (size_t idx = 0; idx < count; ++idx)
+		{
+			f32 const distance = nx * pCX[idx] + ny * pCY[idx] + nz * pCZ[idx] + nw;
+			f32 const radius = ax * pEX[idx] + ay * pEY[idx] + az * pEZ[idx];
+			pOut[idx] &= (u32)(distance + radius >= 0.0f);
+		}
+	}
+	return (size_t)std::count(outVisible.begin(), outVisible.end(), 1U);
+}
+} // namespace le
@@ -0,0 +1,606 @@
+#include <algorithm>
+#include <unordered_set>
+#include <utility>
+#include "le3d/core/bvh.hpp"
+#include "le3d/core/log.hpp"
+
+namespace le
+{
+namespace
+{
+enum class Side : u8
+{
+	Outside = 0,
+	Intersecting,
+	Inside
+};
+
+AABB merged(AABB lhs, AABB const& rhs)
+{
+	lhs.add(rhs);
+	return lhs;
+}
+
+f32 area(AABB const& aabb)
+{
+	glm::vec3 const d = aabb.max - aabb.min;
+	return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+bool overlaps(AABB const& lhs, AABB const& rhs)
+{
+	return lhs.min.x <= rhs.max.x && lhs.max.x >= rhs.min.x && lhs.min.y <= rhs.max.y && lhs.max.y >= rhs.min.y
+		   && lhs.min.z <= rhs.max.z && lhs.max.z >= rhs.min.z;
+}
+
+bool encloses(AABB const& outer, AABB const& inner)
+{
+	return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z && outer.max.x >= inner.max.x
+		   && outer.max.y >= inner.max.y && outer.max.z >= inner.max.z;
+}
+
+Side classify(Frustum const& frustum, AABB const& aabb)
+{
+	glm::vec3 const c = aabb.centre();
+	glm::vec3 const e = aabb.extents();
+	Side ret = Side::Inside;
+	for (auto const& plane : frustum.planes)
+	{
+		glm::vec3 const n(plane);
+		f32 const distance = glm::dot(n, c) + plane.w;
+		f32 const radius = glm::dot(glm::abs(n), e);
+		if (distance + radius < 0.0f)
+		{
+			return Side::Outside;
+		}
+		if (distance - radius < 0.0f)
+		{
+			ret = Side::Intersecting;
+		}
+	}
+	return ret;
+}
+
+// Slab test: sets outT to the entry distance (clamped to 0) if the ray hits aabb within maxT
+bool hit(AABB const& aabb, glm::vec3 const& origin, glm::vec3 const& invDir, f32 maxT, f32& outT)
+{
+	glm::vec3 const t0 = (aabb.min - origin) * invDir;
+	glm::vec3 const t1 = (aabb.max - origin) * invDir;
+	glm::vec3 const tMin = glm::min(t0, t1);
+	glm::vec3 const tMax = glm::max(t0, t1);
+	f32 const tNear = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.0f));
+	f32 const tFar = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, maxT));
+	outT = tNear;
+	return tNear <= tFar;
+}
+} // namespace
+
+f32 BVH::s_fatMargin = 0.1f;
+
+bool BVH::Node::isLeaf() const
+{
+	return left == s_null;
+}
+
+void BVH::build(std::vector<Item> items)
+{
+	clear();
+	m_nodes.reserve(items.size() * 2);
+	m_leaves.reserve(items.size());
+	std::vector<s32> leaves;
+	leaves.reserve(items.size());
+	for (auto& item : items)
+	{
+		if (item.bounds.isEmpty() || m_leaves.find(item.key) != m_leaves.end())
+		{
+			LOGIF_W(!item.bounds.isEmpty(), "[BVH] Duplicate key [%lld] ignored", (long long)item.key);
+			continue;
+		}
+		s32 const leaf = allocate();
+		auto& node = m_nodes[(size_t)leaf];
+		node.key = item.key;
+		node.tight = item.bounds;
+		node.bounds.min = item.bounds.min - glm::vec3(s_fatMargin);
+		node.bounds.max = item.bounds.max + glm::vec3(s_fatMargin);
+		node.height = 0;
+		m_leaves.emplace(item.key, leaf);
+		leaves.push_back(leaf);
+	}
+	if (!leaves.empty())
+	{
+		m_root = build(leaves, 0, leaves.size(), s_null);
+	}
+	return;
+}
+
+void BVH::clear()
+{
+	m_nodes.clear();
+	m_leaves.clear();
+	m_root = m_free = s_null;
+	return;
+}
+
+bool BVH::insert(Key key, AABB const& bounds)
+{
+	if (bounds.isEmpty() || m_leaves.find(key) != m_leaves.end())
+	{
+		return false;
+	}
+	s32 const leaf = allocate();
+	auto& node = m_nodes[(size_t)leaf];
+	node.key = key;
+	node.tight = bounds;
+	node.bounds.min = bounds.min - glm::vec3(s_fatMargin);
+	node.bounds.max = bounds.max + glm::vec3(s_fatMargin);
+	node.height = 0;
+	m_leaves.emplace(key, leaf);
+	insertLeaf(leaf);
+	return true;
+}
+
+void BVH::insert(std::vector<Item> const& items)
+{
+	if (items.size() > m_leaves.size())
+	{
+		std::vector<Item> all;
+		all.reserve(m_leaves.size() + items.size());
+		for (auto const& kvp : m_leaves)
+		{
+			all.push_back({kvp.first, m_nodes[(size_t)kvp.second].tight});
+		}
+		std::copy(items.begin(), items.end(), std::back_inserter(all));
+		build(std::move(all));
+	}
+	else
+	{
+		for (auto const& item : items)
+		{
+			insert(item.key, item.bounds);
+		}
+	}
+	return;
+}
+
+bool BVH::remove(Key key)
+{
+	auto search = m_leaves.find(key);
+	if (search == m_leaves.end())
+	{
+		return false;
+	}
+	s32 const leaf = search->second;
+	m_leaves.erase(search);
+	removeLeaf(leaf);
+	release(leaf);
+	return true;
+}
+
+size_t BVH::remove(std::vector<Key> const& keys)
+{
+	size_t const before = m_leaves.size();
+	if (keys.size() * 2 >= before)
+	{
+		std::unordered_set<Key> const removed(keys.begin(), keys.end());
+		std::vector<Item> survivors;
+		survivors.reserve(before);
+		for (auto const& kvp : m_leaves)
+		{
+			if (removed.find(kvp.first) == removed.end())
+			{
+				survivors.push_back({kvp.first, m_nodes[(size_t)kvp.second].tight});
+			}
+		}
+		build(std::move(survivors));
+	}
+	else
+	{
+		for (auto key : keys)
+		{
+			remove(key);
+		}
+	}
+	return before - m_leaves.size();
+}
+
+bool BVH::update(Key key, AABB const& bounds)
+{
+	if (bounds.isEmpty())
+	{
+		return remove(key);
+	}
+	auto search = m_leaves.find(key);
+	if (search == m_leaves.end())
+	{
+		return insert(key, bounds);
+	}
+	s32 const leaf = search->second;
+	m_nodes[(size_t)leaf].tight = bounds;
+	if (encloses(m_nodes[(size_t)leaf].bounds, bounds))
+	{
+		return false;
+	}
+	removeLeaf(leaf);
+	m_nodes[(size_t)leaf].bounds.min = bounds.min - glm::vec3(s_fatMargin);
+	m_nodes[(size_t)leaf].bounds.max = bounds.max + glm::vec3(s_fatMargin);
+	insertLeaf(leaf);
+	return true;
+}
+
+bool BVH::contains(Key key) const
+{
+	return m_leaves.find(key) != m_leaves.end();
+}
+
+size_t BVH::size() const
+{
+	return m_leaves.size();
+}
+
+s32 BVH::height() const
+{
+	return m_root == s_null ? -1 : m_nodes[(size_t)m_root].height;
+}
+
+AABB BVH::bounds(Key key) const
+{
+	auto search = m_leaves.find(key);
+	return search != m_leaves.end() ? m_nodes[(size_t)search->second].tight : AABB();
+}
+
+void BVH::query(AABB const& aabb, std::vector<Key>& outKeys) const
+{
+	if (m_root == s_null || aabb.isEmpty())
+	{
+		return;
+	}
+	std::vector<s32> stack;
+	stack.reserve(64);
+	stack.push_back(m_root);
+	while (!stack.empty())
+	{
+		auto const& node = m_nodes[(size_t)stack.back()];
+		stack.pop_back();
+		if (!overlaps(node.bounds, aabb))
+		{
+			continue;
+		}
+		if (node.isLeaf())
+		{
+			if (overlaps(node.tight, aabb))
+			{
+				outKeys.push_back(node.key);
+			}
+		}
+		else
+		{
+			stack.push_back(node.left);
+			stack.push_back(node.right);
+		}
+	}
+	return;
+}
+
+void BVH::query(Frustum const& frustum, std::vector<Key>& outKeys) const
+{
+	if (m_root == s_null)
+	{
+		return;
+	}
+	std::vector<s32> stack;
+	stack.reserve(64);
+	stack.push_back(m_root);
+	while (!stack.empty())
+	{
+		s32 const idx = stack.back();
+		auto const& node = m_nodes[(size_t)idx];
+		stack.pop_back();
+		switch (classify(frustum, node.bounds))
+		{
+		case Side::Outside:
+			break;
+		case Side::Inside:
+			// Every leaf's exact bounds are within its fat bounds: no more tests needed
+			collect(idx, outKeys);
+			break;
+		case Side::Intersecting:
+			if (node.isLeaf())
+			{
+				if (frustum.intersects(node.tight))
+				{
+					outKeys.push_back(node.key);
+				}
+			}
+			else
+			{
+				stack.push_back(node.left);
+				stack.push_back(node.right);
+			}
+			break;
+		}
+	}
+	return;
+}
+
+std::optional<BVH::RayHit> BVH::raycast(glm::vec3 const& origin, glm::vec3 const& direction, f32 maxT) const
+{
+	std::optional<RayHit> ret;
+	f32 t = 0.0f;
+	glm::vec3 const invDir = 1.0f / direction;
+	if (m_root == s_null || !hit(m_nodes[(size_t)m_root].bounds, origin, invDir, maxT, t))
+	{
+		return ret;
+	}
+	// (node, entry distance): nearer children are visited first, and anything beyond the closest hit so far is skipped
+	std::vector<std::pair<s32, f32>> stack;
+	stack.reserve(64);
+	stack.push_back({m_root, t});
+	while (!stack.empty())
+	{
+		auto const [idx, tEntry] = stack.back();
+		stack.pop_back();
+		if (tEntry > maxT)
+		{
+			continue;
+		}
+		auto const& node = m_nodes[(size_t)idx];
+		if (node.isLeaf())
+		{
+			if (hit(node.tight, origin, invDir, maxT, t))
+			{
+				maxT = t;
+				ret = RayHit{node.key, t};
+			}
+			continue;
+		}
+		f32 tLeft = 0.0f;
+		f32 tRight = 0.0f;
+		bool const bLeft = hit(m_nodes[(size_t)node.left].bounds, origin, invDir, maxT, tLeft);
+		bool const bRight = hit(m_nodes[(size_t)node.right].bounds, origin, invDir, maxT, tRight);
+		if (bLeft && bRight)
+		{
+			bool const bLeftFirst = tLeft <= tRight;
+			stack.push_back(bLeftFirst ? std::make_pair(node.right, tRight) : std::make_pair(node.left, tLeft));
+			stack.push_back(bLeftFirst ? std::make_pair(node.left, tLeft) : std::make_pair(node.right, tRight));
+		}
+		else if (bLeft)
+		{
+			stack.push_back({node.left, tLeft});
+		}
+		else if (bRight)
+		{
+			stack.push_back({node.right, tRight});
+		}
+	}
+	return ret;
+}
+
+s32 BVH::allocate()
+{
+	if (m_free != s_null)
+	{
+		s32 const ret = m_free;
+		m_free = m_nodes[(size_t)ret].parent;
+		m_nodes[(size_t)ret] = Node();
+		return ret;
+	}
+	m_nodes.push_back(Node());
+	return (s32)m_nodes.size() - 1;
+}
+
+void BVH::release(s32 idx)
+{
+	m_nodes[(size_t)idx] = Node();
+	m_nodes[(size_t)idx].parent = m_free;
+	m_free = idx;
+	return;
+}
+
+s32 BVH::build(std::vector<s32>& leaves, size_t begin, size_t end, s32 parent)
+{
+	if (end - begin == 1)
+	{
+		m_nodes[(size_t)leaves[begin]].parent = parent;
+		return leaves[begin];
+	}
+	// Split at the median centroid along the longest axis of the centroids' bounds
+	AABB centroids;
+	for (size_t idx = begin; idx < end; ++idx)
+	{
+		centroids.add(m_nodes[(size_t)leaves[idx]].bounds.centre());
+	}
+	glm::vec3 const size = centroids.max - centroids.min;
+	s32 const axis = size.x >= size.y && size.x >= size.z ? 0 : (size.y >= size.z ? 1 : 2);
+	size_t const mid = begin + (end - begin) / 2;
+	std::nth_element(leaves.begin() + (std::ptrdiff_t)begin, leaves.begin() + (std::ptrdiff_t)mid, leaves.begin() + (std::ptrdiff_t)end,
+					 [this, axis](s32 lhs, s32 rhs) {
+						 auto const& l = m_nodes[(size_t)lhs].bounds;
+						 auto const& r = m_nodes[(size_t)rhs].bounds;
+						 return l.min[axis] + l.max[axis] < r.min[axis] + r.max[axis];
+					 });
+	s32 const ret = allocate();
+	s32 const left = build(leaves, begin, mid, ret);
+	s32 const right = build(leaves, mid, end, ret);
+	auto& node = m_nodes[(size_t)ret];
+	node.parent = parent;
+	node.left = left;
+	node.right = right;
+	node.bounds = merged(m_nodes[(size_t)left].bounds, m_nodes[(size_t)right].bounds);
+	node.height = 1 + std::max(m_nodes[(size_t)left].height, m_nodes[(size_t)right].height);
+	return ret;
+}
+
+void BVH::insertLeaf(s32 leaf)
+{
+	if (m_root == s_null)
+	{
+		m_root = leaf;
+		m_nodes[(size_t)leaf].parent = s_null;
+		return;
+	}
+	// Descend towards the sibling that minimises the added surface area (the cost of the new parent plus the growth of its ancestors)
+	AABB const leafBounds = m_nodes[(size_t)leaf].bounds;
+	s32 idx = m_root;
+	while (!m_nodes[(size_t)idx].isLeaf())
+	{
+		auto const& node = m_nodes[(size_t)idx];
+		f32 const nodeArea = area(node.bounds);
+		f32 const combinedArea = area(merged(node.bounds, leafBounds));
+		f32 const cost = 2.0f * combinedArea;
+		f32 const inheritedCost = 2.0f * (combinedArea - nodeArea);
+		auto childCost = [this, &leafBounds, inheritedCost](s32 child) {
+			auto const& childNode = m_nodes[(size_t)child];
+			f32 const grown = area(merged(childNode.bounds, leafBounds));
+			return (childNode.isLeaf() ? grown : grown - area(childNode.bounds)) + inheritedCost;
+		};
+		f32 const leftCost = childCost(node.left);
+		f32 const rightCost = childCost(node.right);
+		if (cost < leftCost && cost < rightCost)
+		{
+			break;
+		}
+		idx = leftCost < rightCost ? node.left : node.right;
+	}
+	s32 const sibling = idx;
+	s32 const oldParent = m_nodes[(size_t)sibling].parent;
+	s32 const newParent = allocate();
+	auto& parentNode = m_nodes[(size_t)newParent];
+	parentNode.parent = oldParent;
+	parentNode.bounds = merged(leafBounds, m_nodes[(size_t)sibling].bounds);
+	parentNode.height = m_nodes[(size_t)sibling].height + 1;
+	parentNode.left = sibling;
+	parentNode.right = leaf;
+	if (oldParent != s_null)
+	{
+		auto& oldParentNode = m_nodes[(size_t)oldParent];
+		(oldParentNode.left == sibling ? oldParentNode.left : oldParentNode.right) = newParent;
+	}
+	else
+	{
+		m_root = newParent;
+	}
+	m_nodes[(size_t)sibling].parent = newParent;
+	m_nodes[(size_t)leaf].parent = newParent;
+	refitUp(m_nodes[(size_t)leaf].parent);
+	return;
+}
+
+void BVH::removeLeaf(s32 leaf)
+{
+	if (leaf == m_root)
+	{
+		m_root = s_null;
+		return;
+	}
+	s32 const parent = m_nodes[(size_t)leaf].parent;
+	s32 const grandParent = m_nodes[(size_t)parent].parent;
+	s32 const sibling = m_nodes[(size_t)parent].left == leaf ? m_nodes[(size_t)parent].right : m_nodes[(size_t)parent].left;
+	m_nodes[(size_t)sibling].parent = grandParent;
+	if (grandParent != s_null)
+	{
+		auto& grandParentNode = m_nodes[(size_t)grandParent];
+		(grandParentNode.left == parent ? grandParentNode.left : grandParentNode.right) = sibling;
+		release(parent);
+		refitUp(grandParent);
+	}
+	else
+	{
+		m_root = sibling;
+		release(parent);
+	}
+	m_nodes[(size_t)leaf].parent = s_null;
+	return;
+}
+
+s32 BVH::balance(s32 idx)
+{
+	auto& a = m_nodes[(size_t)idx];
+	if (a.isLeaf() || a.height < 2)
+	{
+		return idx;
+	}
+	s32 const iB = a.left;
+	s32 const iC = a.right;
+	auto& b = m_nodes[(size_t)iB];
+	auto& c = m_nodes[(size_t)iC];
+	s32 const diff = c.height - b.height;
+	// Promotes child iUp to replace idx; aSlot (idx's link to iUp) receives iUp's shorter child
+	auto rotate = [this, idx, &a](s32 iUp, Node& up, s32& aSlot, AABB const& other, s32 otherHeight) {
+		s32 const iF = up.left;
+		s32 const iG = up.right;
+		auto& f = m_nodes[(size_t)iF];
+		auto& g = m_nodes[(size_t)iG];
+		up.left = idx;
+		up.parent = a.parent;
+		a.parent = iUp;
+		if (up.parent != s_null)
+		{
+			auto& upParent = m_nodes[(size_t)up.parent];
+			(upParent.left == idx ? upParent.left : upParent.right) = iUp;
+		}
+		else
+		{
+			m_root = iUp;
+		}
+		// The taller grandchild stays with up; the shorter one moves under idx
+		bool const bKeepF = f.height > g.height;
+		s32 const iMoved = bKeepF ? iG : iF;
+		auto& kept = bKeepF ? f : g;
+		auto& moved = bKeepF ? g : f;
+		up.right = bKeepF ? iF : iG;
+		aSlot = iMoved;
+		moved.parent = idx;
+		a.bounds = merged(other, moved.bounds);
+		a.height = 1 + std::max(otherHeight, moved.height);
+		up.bounds = merged(a.bounds, kept.bounds);
+		up.height = 1 + std::max(a.height, kept.height);
+		return iUp;
+	};
+	if (diff > 1)
+	{
+		return rotate(iC, c, a.right, b.bounds, b.height);
+	}
+	if (diff < -1)
+	{
+		return rotate(iB, b, a.left, c.bounds, c.height);
+	}
+	return idx;
+}
+
+void BVH::refitUp(s32 idx)
+{
+	while (idx != s_null)
+	{
+		idx = balance(idx);
+		auto& node = m_nodes[(size_t)idx];
+		auto const& left = m_nodes[(size_t)node.left];
+		auto const& right = m_nodes[(size_t)node.right];
+		node.height = 1 + std::max(left.height, right.height);
+		node.bounds = merged(left.bounds, right.bounds);
+		idx = node.parent;
+	}
+	return;
+}
+
+void BVH::collect(s32 idx, std::vector<Key>& outKeys) const
+{
+	std::vector<s32> stack;
+	stack.reserve(64);
+	stack.push_back(idx);
+	while (!stack.empty())
+	{
+		auto const& node = m_nodes[(size_t)stack.back()];
+		stack.pop_back();
+		if (node.isLeaf())
+		{
+			outKeys.push_back(node.key);
+		}
+		else
+		{
+			stack.push_back(node.left);
+			stack.push_back(node.right);
+		}
+	}
+	return;
+}
+} // namespace le
@@ -0,0 +1,76 @@
+#include <cstring>
+#include "le3d/core/byte_view.hpp"
+
+namespace le
+{
+ByteView ByteView::from(bytearray bytes)
+{
+	ByteView ret;
+	auto pBytes = std::make_shared<bytearray const>(std::move(bytes));
+	ret.pData = pBytes->data();
+	ret.size = pBytes->size();
+	ret.token = std::move(pBytes);
+	return ret;
+}
+
+bool ByteView::empty() const
+{
+	return size == 0;
+}
+
+std::string_view ByteView::str() const
+{
+	return pData ? std::string_view(reinterpret_cast<char const*>(pData), size) : std::string_view();
+}
+
+bytearray ByteView::bytes() const
+{
+	bytearray ret(size);
+	if (size > 0)
+	{
+		std::memcpy(ret.data(), pData, size);
+	}
+	return ret;
+}
+
+ByteViewStream::Buf::Buf(ByteView const& view)
+{
+	// streambuf's get area is non-const, but an istream never writes through it
+	auto pBegin = const_cast<char*>(reinterpret_cast<char const*>(view.pData));
+	setg(pBegin, pBegin, pBegin + view.size);
+}
+
+ByteViewStream::Buf::pos_type ByteViewStream::Buf::seekoff(off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode mode)
+{
+	if (!(mode & std::ios_base::in))
+	{
+		return pos_type(off_type(-1));
+	}
+	off_type base = 0;
+	if (dir == std::ios_base::cur)
+	{
+		base = gptr() - eback();
+	}
+	else if (dir == std::ios_base::end)
+	{
+		base = egptr() - eback();
+	}
+	off_type const pos = base + offset;
+	if (pos < 0 || pos > egptr() - eback())
+	{
+		return pos_type(off_type(-1));
+	}
+	setg(eback(), eback() + pos, egptr());
+	return pos_type(pos);
+}
+
+ByteViewStream::Buf::pos_type ByteViewStream::Buf::seekpos(pos_type pos, std::ios_base::openmode mode)
+{
+	return seekoff(off_type(pos), std::ios_base::beg, mode);
+}
+
+ByteViewStream::ByteViewStream(ByteView view) : std::istream(nullptr), m_view(std::move(view)), m_buf(m_view)
+{
+	rdbuf(&m_buf);
+}
+} // namespace le
@@ -1,22 +1,44 @@
 #include "le3d/core/gdata.hpp"
+#include "le3d/core/log.hpp"
 #include "le3d/core/utils.hpp"
 
 namespace le
 {
 namespace
 {
-std::initializer_list<std::pair<char, char>> gDataEscapes = {{'{', '}'}, {'[', ']'}, {'"', '"'}};
+std::string toString(json::Value const& value)
+{
+	// Nested objects / arrays / numbers yield their source text, strings their decoded contents
+	return value.asString();
+}
+
+std::vector<std::string> toVecString(json::Value const& value)
+{
+	std::vector<std::string> ret;
+	if (value.isArray())
+	{
+		ret.reserve(value.size());
+		for (auto const& element : value)
+		{
+			ret.push_back(toString(element));
+		}
+	}
+	return ret;
+}
 
-template <typename T>
-T Get(std::unordered_map<std::string, std::string> const& table, std::string const& key, T (*Adaptor)(std::string, T),
-	  T const& defaultValue)
+void appendQuoted(std::string& out, std::string_view str)
 {
-	auto search = table.find(key);
-	if (search != table.end())
+	out += '"';
+	for (auto c : str)
 	{
-		return Adaptor(search->second, defaultValue);
+		if (c == '"' || c == '\\')
+		{
+			out += '\\';
+		}
+		out += c;
 	}
-	return defaultValue;
+	out += '"';
+	return;
 }
 } // namespace
 
@@ -28,6 +50,16 @@ GData::GData(std::string serialised)
 	}
 }
 
+GData::GData(ByteView serialised)
+{
+	if (!serialised.empty())
+	{
+		marshall(std::move(serialised));
+	}
+}
+
+GData::GData(std::shared_ptr<json::Document const> shDoc, json::Value value) : m_shDoc(std::move(shDoc)), m_value(value) {}
+
 GData::GData() = default;
 GData::GData(GData&&) = default;
 GData& GData::operator=(GData&&) = default;
@@ -37,89 +69,138 @@ GData::~GData() = default;
 
 bool GData::marshall(std::string serialised)
 {
-	utils::strings::removeChars(serialised, {'\t', '\r', '\n'});
-	utils::strings::trim(serialised, {' '});
-	if (serialised[0] == '{' && serialised[serialised.size() - 1] == '}')
+	clear();
+	auto shDoc = std::make_shared<json::Document>();
+	bool const bParsed = shDoc->parse(std::move(serialised));
+	return setDocument(std::move(shDoc), bParsed);
+}
+
+bool GData::marshall(ByteView serialised)
+{
+	clear();
+	auto shDoc = std::make_shared<json::Document>();
+	auto const text = serialised.str();
+	bool const bParsed = shDoc->parse(text, std::move(serialised.token));
+	return setDocument(std::move(shDoc), bParsed);
+}
+
+bool GData::setDocument(std::shared_ptr<json::Document> shDoc, bool bParsed)
+{
+	if (!bParsed)
 	{
-		clear();
-		std::string rawText = serialised.substr(1, serialised.size() - 2);
-		std::vector<std::string> tokens = utils::strings::tokenise(rawText, ',', gDataEscapes);
-		for (auto const& token : tokens)
-		{
-			std::pair<std::string, std::string> kvp = utils::strings::bisect(token, ':');
-			if (!kvp.second.empty() && !kvp.first.empty())
-			{
-				utils::strings::trim(kvp.first, {' '});
-				utils::strings::trim(kvp.first, {'"'});
-				if (kvp.first != " ")
-				{
-					utils::strings::trim(kvp.first, {' '});
-				}
-				utils::strings::trim(kvp.second, {' ', '"'});
-				m_fieldMap.emplace(std::move(kvp.first), std::move(kvp.second));
-			}
-		}
-		return true;
+		LOG_W("[%s] Failed to parse JSON: %s", typeName<GData>().data(), shDoc->error().data());
+		return false;
 	}
-
-	return false;
+	if (!shDoc->root().isObject())
+	{
+		return false;
+	}
+	m_value = shDoc->root();
+	m_shDoc = std::move(shDoc);
+	return true;
 }
 
 std::string GData::unmarshall() const
 {
 	std::string ret = "{";
-	size_t slice = 0;
+	auto append = [&ret](std::string_view key, std::string_view value, bool bString) {
+		if (ret.size() > 1)
+		{
+			ret += ',';
+		}
+		ret += '"';
+		ret += key;
+		ret += "\":";
+		if (bString)
+		{
+			ret += '"';
+			ret += value;
+			ret += '"';
+		}
+		else
+		{
+			ret += value;
+		}
+	};
+	for (auto const& member : m_value)
+	{
+		if (!findOverride(json::unescape(member.key())))
+		{
+			append(member.key(), member.raw(), member.isString());
+		}
+	}
 	for (auto const& kvp : m_fieldMap)
 	{
-		std::string value = kvp.second;
-		utils::strings::trim(value, {' '});
-		auto space = value.find(' ');
-		if (utils::strings::isCharEnclosedIn(value, space, {'"', '"'}))
+		if (json::Document(kvp.second).root())
+		{
+			append(kvp.first, kvp.second, false);
+		}
+		else
 		{
-			value = '\"' + value + '\"';
+			std::string quoted;
+			appendQuoted(quoted, kvp.second);
+			append(kvp.first, quoted, false);
 		}
-		ret += (kvp.first + ':' + value + ',');
-		slice = 1;
 	}
-	return ret.substr(0, ret.size() - slice) + '}';
+	ret += '}';
+	return ret;
 }
 
 void GData::clear()
 {
+	m_shDoc.reset();
+	m_value = {};
 	m_fieldMap.clear();
+	return;
 }
 
 std::string GData::getString(std::string const& key, std::string defaultValue) const
 {
-	auto search = m_fieldMap.find(key);
-	if (search != m_fieldMap.end())
+	if (auto pOverride = findOverride(key))
 	{
-		return search->second;
+		return *pOverride;
 	}
-	return defaultValue;
+	auto const value = find(key);
+	return value ? toString(value) : defaultValue;
 }
 
 bool GData::getBool(std::string const& key, bool defaultValue) const
 {
-	return Get<bool>(m_fieldMap, key, &utils::strings::toBool, defaultValue);
+	if (auto pOverride = findOverride(key))
+	{
+		return utils::strings::toBool(*pOverride, defaultValue);
+	}
+	return find(key).asBool(defaultValue);
 }
 
 s32 GData::getS32(std::string const& key, s32 defaultValue) const
 {
-	return Get<s32>(m_fieldMap, key, &utils::strings::toS32, defaultValue);
+	if (auto pOverride = findOverride(key))
+	{
+		return utils::strings::toS32(*pOverride, defaultValue);
+	}
+	return find(key).asS32(defaultValue);
 }
 
 f64 GData::getF64(std::string const& key, f64 defaultValue) const
 {
-	return Get<f64>(m_fieldMap, key, &utils::strings::toF64, defaultValue);
+	if (auto pOverride = findOverride(key))
+	{
+		return utils::strings::toF64(*pOverride, defaultValue);
+	}
+	return find(key).asF64(defaultValue);
 }
 
 GData GData::getGData(std::string const& key) const
 {
-	auto search = m_fieldMap.find(key);
-	if (search != m_fieldMap.end())
+	if (auto pOverride = findOverride(key))
 	{
-		return GData(search->second);
+		return GData(*pOverride);
+	}
+	auto const value = find(key);
+	if (value.isObject())
+	{
+		return GData(m_shDoc, value);
 	}
 	return {};
 }
@@ -127,50 +208,69 @@ GData GData::getGData(std::string const& key) const
 std::vector<GData> GData::getGDatas(std::string const& key) const
 {
 	std::vector<GData> ret;
-	std::vector<std::string> rawStrings = getVecString(key);
-	for (auto& rawString : rawStrings)
+	if (auto pOverride = findOverride(key))
+	{
+		json::Document doc(*pOverride);
+		for (auto const& element : doc.root())
+		{
+			ret.push_back(GData(std::string(element.raw())));
+		}
+		return ret;
+	}
+	auto const value = find(key);
+	if (value.isArray())
 	{
-		utils::strings::trim(rawString, {'"', ' '});
-		ret.push_back(GData(std::move(rawString)));
+		ret.reserve(value.size());
+		for (auto const& element : value)
+		{
+			ret.push_back(element.isObject() ? GData(m_shDoc, element) : GData());
+		}
 	}
 	return ret;
 }
 
-std::vector<std::string> GData::getVecString(std::string const& key) const
+std::vector<std::pair<std::string, GData>> GData::allGDatas() const
 {
-	auto search = m_fieldMap.find(key);
-	if (search != m_fieldMap.end())
+	std::vector<std::pair<std::string, GData>> ret;
+	ret.reserve(m_value.size() + m_fieldMap.size());
+	for (auto const& member : m_value)
 	{
-		std::string value = search->second;
-		if (value.size() > 2)
+		auto key = json::unescape(member.key());
+		if (!findOverride(key))
 		{
-			utils::strings::trim(value, {' '});
-			if (value[0] == '[' && value[value.size() - 1] == ']')
-			{
-				value = value.substr(1, value.size() - 2);
-				utils::strings::trim(value, {' '});
-				std::vector<std::string> ret = utils::strings::tokenise(value, ',', gDataEscapes);
-				for (auto& str : ret)
-				{
-					utils::strings::trim(str, {'"', ' '});
-				}
-				return ret;
-			}
+			ret.emplace_back(std::move(key), member.isObject() ? GData(m_shDoc, member) : GData());
 		}
 	}
-	return {};
+	for (auto const& kvp : m_fieldMap)
+	{
+		ret.emplace_back(kvp.first, GData(kvp.second));
+	}
+	return ret;
+}
+
+std::vector<std::string> GData::getVecString(std::string const& key) const
+{
+	if (auto pOverride = findOverride(key))
+	{
+		json::Document doc(*pOverride);
+		return toVecString(doc.root());
+	}
+	return toVecString(find(key));
 }
 
-std::unordered_map<std::string, std::string> const& GData::allFields() const
+std::unordered_map<std::string, std::string> GData::allFields() const
 {
-	return m_fieldMap;
+	std::unordered_map<std::string, std::string> ret = m_fieldMap;
+	for (auto const& member : m_value)
+	{
+		ret.emplace(json::unescape(member.key()), toString(member));
+	}
+	return ret;
 }
 
 bool GData::addField(std::string key, GData& gData)
 {
-	std::string value = gData.unmarshall();
-	utils::strings::removeChars(value, {'\"'});
-	return setString(std::move(key), std::move(value));
+	return setString(std::move(key), gData.unmarshall());
 }
 
 bool GData::setString(std::string key, std::string value)
@@ -185,11 +285,39 @@ bool GData::setString(std::string key, std::string value)
 
 u32 GData::fieldCount() const
 {
-	return u32(m_fieldMap.size());
+	u32 ret = m_value.size();
+	for (auto const& kvp : m_fieldMap)
+	{
+		if (!find(kvp.first))
+		{
+			++ret;
+		}
+	}
+	return ret;
 }
 
 bool GData::contains(std::string const& id) const
 {
-	return m_fieldMap.find(id) != m_fieldMap.end();
+	return findOverride(id) || find(id);
+}
+
+json::Value const& GData::value() const
+{
+	return m_value;
+}
+
+json::Value GData::find(std::string const& key) const
+{
+	return m_value[key];
+}
+
+std::string const* GData::findOverride(std::string const& key) const
+{
+	if (m_fieldMap.empty())
+	{
+		return nullptr;
+	}
+	auto search = m_fieldMap.find(key);
+	return search != m_fieldMap.end() ? &search->second : nullptr;
 }
 } // namespace le
@@ -0,0 +1,447 @@
+#include <array>
+#include <cstring>
+#include "core/inflate.hpp"
+
+namespace le
+{
+namespace
+{
+constexpr u32 g_maxBits = 15;
+// Codes up to this long decode with one table lookup; longer ones walk the canonical code
+constexpr u32 g_fastBits = 10;
+constexpr u32 g_maxLitLen = 288;
+constexpr u32 g_maxDist = 32;
+
+constexpr std::array<u16, 29> g_lengthBase = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+											  31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr std::array<u8, 29> g_lengthExtra = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr std::array<u16, 30> g_distBase = {1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+											193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+constexpr std::array<u8, 30> g_distExtra = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+constexpr std::array<u8, 19> g_codeLengthOrder = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+// Canonical Huffman decoding table
+struct Huffman final
+{
+	// (length << 9) | symbol for codes <= g_fastBits (indexed by the next g_fastBits input bits); 0 => longer code
+	std::array<u16, 1 << g_fastBits> fast;
+	std::array<u16, g_maxBits + 1> counts;
+	std::array<u16, g_maxLitLen> symbols;
+
+	// Incomplete codes are accepted (a lone distance code is legal), over-subscribed ones are not
+	bool build(u8 const* pLengths, u32 count);
+};
+
+bool Huffman::build(u8 const* pLengths, u32 count)
+{
+	counts.fill(0);
+	for (u32 idx = 0; idx < count; ++idx)
+	{
+		++counts[pLengths[idx]];
+	}
+	counts[0] = 0;
+	s32 left = 1;
+	for (u32 len = 1; len <= g_maxBits; ++len)
+	{
+		left = (left << 1) - counts[len];
+		if (left < 0)
+		{
+			return false;
+		}
+	}
+	std::array<u16, g_maxBits + 2> offsets;
+	offsets[1] = 0;
+	for (u32 len = 1; len <= g_maxBits; ++len)
+	{
+		offsets[len + 1] = offsets[len] + counts[len];
+	}
+	for (u32 idx = 0; idx < count; ++idx)
+	{
+		if (pLengths[idx] != 0)
+		{
+			symbols[offsets[pLengths[idx]]++] = (u16)idx;
+		}
+	}
+	// Codes are assigned in (length, symbol) order; the stream stores them MSB first, so the table is indexed by reversed codes
+	fast.fill(0);
+	u32 code = 0;
+	u32 symbolIdx = 0;
+	for (u32 len = 1; len <= g_fastBits; ++len)
+	{
+		for (u32 n = 0; n < counts[len]; ++n, ++code, ++symbolIdx)
+		{
+			u32 reversed = 0;
+			for (u32 bit = 0; bit < len; ++bit)
+			{
+				reversed |= ((code >> bit) & 1) << (len - 1 - bit);
+			}
+			auto const entry = (u16)((len << 9) | symbols[symbolIdx]);
+			for (u32 fill = reversed; fill < (1U << g_fastBits); fill += (1U << len))
+			{
+				fast[fill] = entry;
+			}
+		}
+		code <<= 1;
+	}
+	return true;
+}
+
+struct Inflater final
+{
+	Huffman litLen;
+	Huffman dist;
+	Huffman codeLengths;
+
+	u8 const* pIn = nullptr;
+	u8 const* pInEnd = nullptr;
+	u64 bits = 0;
+	u32 bitCount = 0;
+	// Zero bytes fed past the end of input (only an error if they are consumed)
+	u32 padding = 0;
+
+	u8* pOut = nullptr;
+	u8* pOutStart = nullptr;
+	u8* pOutEnd = nullptr;
+
+	bool run();
+
+	void refill();
+	u32 take(u32 count);
+	bool decode(Huffman const& huffman, u32& outSymbol);
+	bool stored();
+	bool dynamicTables();
+	bool codes(Huffman const& lit, Huffman const& distance);
+	bool overrun() const;
+};
+
+void Inflater::refill()
+{
+	while (bitCount <= 56)
+	{
+		u64 byte = 0;
+		if (pIn < pInEnd)
+		{
+			byte = *pIn++;
+		}
+		else
+		{
+			++padding;
+		}
+		bits |= byte << bitCount;
+		bitCount += 8;
+	}
+	return;
+}
+
+u32 Inflater::take(u32 count)
+{
+	if (bitCount < count)
+	{
+		refill();
+	}
+	auto const ret = (u32)(bits & ((1ULL << count) - 1));
+	bits >>= count;
+	bitCount -= count;
+	return ret;
+}
+
+bool Inflater::decode(Huffman const& huffman, u32& outSymbol)
+{
+	if (bitCount < g_maxBits)
+	{
+		refill();
+	}
+	u16 const entry = huffman.fast[bits & ((1U << g_fastBits) - 1)];
+	if (entry != 0)
+	{
+		u32 const len = entry >> 9;
+		bits >>= len;
+		bitCount -= len;
+		outSymbol = entry & 0x1ff;
+		return true;
+	}
+	// Walk the canonical code one bit at a time (codes longer than g_fastBits are rare)
+	s32 code = 0;
+	s32 first = 0;
+	s32 index = 0;
+	for (u32 len = 1; len <= g_maxBits; ++len)
+	{
+		code |= (s32)(bits & 1);
+		bits >>= 1;
+		--bitCount;
+		s32 const count = huffman.counts[len];
+		if (code - count < first)
+		{
+			outSymbol = huffman.symbols[(size_t)(index + (code - first))];
+			return true;
+		}
+		index += count;
+		first = (first + count) << 1;
+		code <<= 1;
+	}
+	return false;
+}
+
+bool Inflater::overrun() const
+{
+	// Bits still buffered include the padding; anything beyond that was consumed
+	return padding * 8 > bitCount;
+}
+
+bool Inflater::stored()
+{
+	// Discard to the byte boundary, then un-read whole buffered bytes
+	take(bitCount % 8);
+	u32 const buffered = bitCount / 8;
+	if (buffered > padding)
+	{
+		pIn -= (buffered - padding);
+	}
+	else if (padding > buffered)
+	{
+		return false;
+	}
+	bits = 0;
+	bitCount = 0;
+	padding = 0;
+	if (pInEnd - pIn < 4)
+	{
+		return false;
+	}
+	u32 const len = (u32)pIn[0] | ((u32)pIn[1] << 8);
+	u32 const nlen = (u32)pIn[2] | ((u32)pIn[3] << 8);
+	pIn += 4;
+	if (len != (~nlen & 0xffff) || (size_t)(pInEnd - pIn) < len || (size_t)(pOutEnd - pOut) < len)
+	{
+		return false;
+	}
+	std::memcpy(pOut, pIn, len);
+	pOut += len;
+	pIn += len;
+	return true;
+}
+
+bool Inflater::dynamicTables()
+{
+	u32 const litCount = take(5) + 257;
+	u32 const distCount = take(5) + 1;
+	u32 const clCount = take(4) + 4;
+	if (litCount > 286 || distCount > 30)
+	{
+		return false;
+	}
+	std::array<u8, 19> clLengths = {};
+	for (u32 idx = 0; idx < clCount; ++idx)
+	{
+		clLengths[g_codeLengthOrder[idx]] = (u8)take(3);
+	}
+	if (!codeLengths.build(clLengths.data(), (u32)clLengths.size()))
+	{
+		return false;
+	}
+	std::array<u8, g_maxLitLen + g_maxDist> lengths = {};
+	u32 idx = 0;
+	while (idx < litCount + distCount)
+	{
+		u32 symbol = 0;
+		if (!decode(codeLengths, symbol))
+		{
+			return false;
+		}
+		if (symbol < 16)
+		{
+			lengths[idx++] = (u8)symbol;
+			continue;
+		}
+		u8 repeat = 0;
+		u32 times = 0;
+		if (symbol == 16)
+		{
+			if (idx == 0)
+			{
+				return false;
+			}
+			repeat = lengths[idx - 1];
+			times = 3 + take(2);
+		}
+		else if (symbol == 17)
+		{
+			times = 3 + take(3);
+		}
+		else
+		{
+			times = 11 + take(7);
+		}
+		if (idx + times > litCount + distCount)
+		{
+			return false;
+		}
+		std::memset(lengths.data() + idx, repeat, times);
+		idx += times;
+	}
+	// End of block must be encodable
+	if (lengths[256] == 0)
+	{
+		return false;
+	}
+	return litLen.build(lengths.data(), litCount) && dist.build(lengths.data() + litCount, distCount);
+}
+
+bool Inflater::codes(Huffman const& lit, Huffman const& distance)
+{
+	while (true)
+	{
+		u32 symbol = 0;
+		if (!decode(lit, symbol))
+		{
+			return false;
+		}
+		if (symbol < 256)
+		{
+			if (pOut == pOutEnd)
+			{
+				return false;
+			}
+			*pOut++ = (u8)symbol;
+			continue;
+		}
+		if (symbol == 256)
+		{
+			return !overrun();
+		}
+		symbol -= 257;
+		if (symbol >= 29)
+		{
+			return false;
+		}
+		u32 const len = g_lengthBase[symbol] + take(g_lengthExtra[symbol]);
+		u32 distSymbol = 0;
+		if (!decode(distance, distSymbol) || distSymbol >= 30)
+		{
+			return false;
+		}
+		u32 const dist = g_distBase[distSymbol] + take(g_distExtra[distSymbol]);
+		if ((size_t)(pOut - pOutStart) < dist || (size_t)(pOutEnd - pOut) < len)
+		{
+			return false;
+		}
+		u8 const* pFrom = pOut - dist;
+		if (dist >= len)
+		{
+			std::memcpy(pOut, pFrom, len);
+			pOut += len;
+		}
+		else
+		{
+			// Overlapping: the match repeats bytes it is producing
+			for (u32 n = 0; n < len; ++n)
+			{
+				*pOut++ = pFrom[n];
+			}
+		}
+	}
+}
+
+bool Inflater::run()
+{
+	static Huffman const s_fixedLitLen = []() {
+		std::array<u8, g_maxLitLen> lengths;
+		std::memset(lengths.data(), 8, 144);
+		std::memset(lengths.data() + 144, 9, 112);
+		std::memset(lengths.data() + 256, 7, 24);
+		std::memset(lengths.data() + 280, 8, 8);
+		Huffman ret;
+		ret.build(lengths.data(), (u32)lengths.size());
+		return ret;
+	}();
+	static Huffman const s_fixedDist = []() {
+		std::array<u8, 30> lengths;
+		lengths.fill(5);
+		Huffman ret;
+		ret.build(lengths.data(), (u32)lengths.size());
+		return ret;
+	}();
+	bool bFinal = false;
+	while (!bFinal)
+	{
+		bFinal = take(1) != 0;
+		u32 const type = take(2);
+		bool bOK = false;
+		switch (type)
+		{
+		case 0:
+			bOK = stored();
+			break;
+		case 1:
+			bOK = codes(s_fixedLitLen, s_fixedDist);
+			break;
+		case 2:
+			bOK = dynamicTables() && codes(litLen, dist);
+			break;
+		default:
+			break;
+		}
+		if (!bOK || overrun())
+		{
+			return false;
+		}
+	}
+	return pOut == pOutEnd;
+}
+
+// Slicing-by-8: table[n][b] is the CRC of byte b followed by n zero bytes
+std::array<std::array<u32, 256>, 8> const g_crcTables = []() {
+	std::array<std::array<u32, 256>, 8> ret;
+	for (u32 idx = 0; idx < 256; ++idx)
+	{
+		u32 crc = idx;
+		for (u32 bit = 0; bit < 8; ++bit)
+		{
+			crc = (crc & 1) ? (crc >> 1) ^ 0xedb88320U : crc >> 1;
+		}
+		ret[0][idx] = crc;
+	}
+	for (size_t slice = 1; slice < ret.size(); ++slice)
+	{
+		for (u32 idx = 0; idx < 256; ++idx)
+		{
+			u32 const prev = ret[slice - 1][idx];
+			ret[slice][idx] = ret[0][prev & 0xff] ^ (prev >> 8);
+		}
+	}
+	return ret;
+}();
+} // namespace
+
+bool inflate::decompress(u8 const* pIn, size_t inSize, u8* pOut, size_t outSize)
+{
+	// Tables are ~3KB: keep one set per thread instead of rebuilding / allocating them per call
+	thread_local Inflater t_inflater;
+	Inflater& inflater = t_inflater;
+	inflater.pIn = pIn;
+	inflater.pInEnd = pIn + inSize;
+	inflater.bits = 0;
+	inflater.bitCount = 0;
+	inflater.padding = 0;
+	inflater.pOut = inflater.pOutStart = pOut;
+	inflater.pOutEnd = pOut + outSize;
+	return inflater.run();
+}
+
+u32 inflate::crc32(u8 const* pData, size_t size, u32 crc)
+{
+	auto const& t = g_crcTables;
+	crc = ~crc;
+	for (; size >= 8; size -= 8, pData += 8)
+	{
+		u32 const lo = crc ^ ((u32)pData[0] | ((u32)pData[1] << 8) | ((u32)pData[2] << 16) | ((u32)pData[3] << 24));
+		crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^ t[3][pData[4]] ^ t[2][pData[5]]
+			  ^ t[1][pData[6]] ^ t[0][pData[7]];
+	}
+	for (; size > 0; --size, ++pData)
+	{
+		crc = t[0][(crc ^ *pData) & 0xff] ^ (crc >> 8);
+	}
+	return ~crc;
+}
+} // namespace le
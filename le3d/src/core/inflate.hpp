@@ -0,0 +1,12 @@
+#pragma once
+#include "le3d/core/std_types.hpp"
+
+namespace le::inflate
+{
+// Decompresses a raw DEFLATE stream (RFC 1951: no zlib / gzip header) into exactly outSize bytes
+// Returns false on malformed / truncated input or a size mismatch; thread safe (every thread decodes with its own tables)
+bool decompress(u8 const* pIn, size_t inSize, u8* pOut, size_t outSize);
+
+// CRC-32 (ISO-HDLC / zip); pass a previous result as crc to continue it
+u32 crc32(u8 const* pData, size_t size, u32 crc = 0);
+} // namespace le::inflate
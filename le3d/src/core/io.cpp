@@ -1,10 +1,27 @@
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
 #include <fstream>
+#include <future>
+#include <mutex>
+#include <unordered_map>
 #include <physfs/physfs.h>
 #include "le3d/core/assert.hpp"
 #include "le3d/core/io.hpp"
 #include "le3d/core/log.hpp"
 #include "le3d/env/env.hpp"
+#include "le3d/env/threads.hpp"
+#include "inflate.hpp"
 #include "io_impl.hpp"
+#if defined(LE3D_OS_WINX)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 namespace le
 {
@@ -27,8 +44,448 @@ PhysfsHandle::~PhysfsHandle()
 }
 
 std::unique_ptr<PhysfsHandle> g_uPhysfsHandle;
+
+struct Mapping final
+{
+	void* pData = nullptr;
+	size_t size = 0;
+#if defined(LE3D_OS_WINX)
+	HANDLE hFile = INVALID_HANDLE_VALUE;
+	HANDLE hMapping = nullptr;
+#endif
+
+	~Mapping();
+};
+
+Mapping::~Mapping()
+{
+#if defined(LE3D_OS_WINX)
+	if (pData)
+	{
+		UnmapViewOfFile(pData);
+	}
+	if (hMapping)
+	{
+		CloseHandle(hMapping);
+	}
+	if (hFile != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(hFile);
+	}
+#else
+	if (pData)
+	{
+		munmap(pData, size);
+	}
+#endif
+}
+
+} // namespace
+
+ByteView ioImpl::readFile(stdfs::path const& path, size_t size)
+{
+	bytearray buf(size);
+	std::ifstream file(path, std::ios::binary);
+	if (!file.good() || !file.read((char*)buf.data(), (std::streamsize)size))
+	{
+		return {};
+	}
+	return ByteView::from(std::move(buf));
+}
+
+ByteView ioImpl::mapFile(stdfs::path const& path, size_t size, bool bPopulate)
+{
+	auto pMapping = std::make_shared<Mapping>();
+	pMapping->size = size;
+#if defined(LE3D_OS_WINX)
+	pMapping->hFile = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (pMapping->hFile == INVALID_HANDLE_VALUE)
+	{
+		return {};
+	}
+	pMapping->hMapping = CreateFileMappingW(pMapping->hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!pMapping->hMapping)
+	{
+		return {};
+	}
+	pMapping->pData = MapViewOfFile(pMapping->hMapping, FILE_MAP_READ, 0, 0, size);
+	if (!pMapping->pData)
+	{
+		return {};
+	}
+#else
+	s32 const fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		return {};
+	}
+#if defined(MAP_POPULATE)
+	s32 const flags = bPopulate ? MAP_PRIVATE | MAP_POPULATE : MAP_PRIVATE;
+#else
+	s32 const flags = MAP_PRIVATE;
+#endif
+	void* pData = mmap(nullptr, size, PROT_READ, flags, fd, 0);
+	// The mapping keeps the file referenced
+	close(fd);
+	if (pData == MAP_FAILED)
+	{
+		return {};
+	}
+	pMapping->pData = pData;
+#endif
+	ByteView ret;
+	ret.pData = static_cast<std::byte const*>(pMapping->pData);
+	ret.size = size;
+	ret.token = std::move(pMapping);
+	return ret;
+}
+
+namespace
+{
+using ZIPEntries = std::unordered_map<std::string, ZIPReader::Entry>;
+
+u32 constexpr g_zipLocalSig = 0x04034b50;
+u32 constexpr g_zipCentralSig = 0x02014b50;
+u32 constexpr g_zipEndSig = 0x06054b50;
+u32 constexpr g_zip64EndSig = 0x06064b50;
+u32 constexpr g_zip64LocatorSig = 0x07064b50;
+size_t constexpr g_zipLocalSize = 30;
+size_t constexpr g_zipCentralSize = 46;
+size_t constexpr g_zipEndSize = 22;
+
+// Zip fields are little-endian and unaligned
+u16 readU16(u8 const* pData)
+{
+	return (u16)(pData[0] | (pData[1] << 8));
+}
+
+u32 readU32(u8 const* pData)
+{
+	return (u32)readU16(pData) | ((u32)readU16(pData + 2) << 16);
+}
+
+u64 readU64(u8 const* pData)
+{
+	return (u64)readU32(pData) | ((u64)readU32(pData + 4) << 32);
+}
+
+// Replaces saturated 32-bit fields with their values in the ZIP64 extended information extra field
+void readZIP64Extra(u8 const* pExtra, size_t extraSize, ZIPReader::Entry& outEntry)
+{
+	u8 const* pEnd = pExtra + extraSize;
+	while (pEnd - pExtra >= 4)
+	{
+		u16 const id = readU16(pExtra);
+		u16 const size = readU16(pExtra + 2);
+		pExtra += 4;
+		if ((size_t)(pEnd - pExtra) < size)
+		{
+			return;
+		}
+		if (id == 0x0001)
+		{
+			// Only the saturated fields are present, in this order
+			u8 const* pField = pExtra;
+			u8 const* pFieldEnd = pExtra + size;
+			for (u64* pValue : {&outEntry.size, &outEntry.compressedSize, &outEntry.localOffset})
+			{
+				if (*pValue == 0xffffffff && pFieldEnd - pField >= 8)
+				{
+					*pValue = readU64(pField);
+					pField += 8;
+				}
+			}
+			return;
+		}
+		pExtra += size;
+	}
+	return;
+}
+
+// Indexes the central directory (files only); returns false if the archive is malformed
+bool indexZIP(ByteView const& archive, ZIPEntries& outEntries, stdfs::path const& zipPath)
+{
+	auto const pBase = reinterpret_cast<u8 const*>(archive.pData);
+	size_t const size = archive.size;
+	if (size < g_zipEndSize)
+	{
+		return false;
+	}
+	// The end of central directory record is last, followed by a comment of up to 64KiB
+	size_t const minPos = size - g_zipEndSize > 0xffff ? size - g_zipEndSize - 0xffff : 0;
+	size_t endPos = size - g_zipEndSize;
+	while (readU32(pBase + endPos) != g_zipEndSig)
+	{
+		if (endPos == minPos)
+		{
+			return false;
+		}
+		--endPos;
+	}
+	u64 count = readU16(pBase + endPos + 10);
+	u64 directorySize = readU32(pBase + endPos + 12);
+	u64 directoryOffset = readU32(pBase + endPos + 16);
+	if (count == 0xffff || directorySize == 0xffffffff || directoryOffset == 0xffffffff)
+	{
+		if (endPos < 20 || readU32(pBase + endPos - 20) != g_zip64LocatorSig)
+		{
+			return false;
+		}
+		u64 const end64Pos = readU64(pBase + endPos - 20 + 8);
+		if (end64Pos > size || size - end64Pos < 56 || readU32(pBase + end64Pos) != g_zip64EndSig)
+		{
+			return false;
+		}
+		count = readU64(pBase + end64Pos + 32);
+		directorySize = readU64(pBase + end64Pos + 40);
+		directoryOffset = readU64(pBase + end64Pos + 48);
+	}
+	if (directoryOffset > size || size - directoryOffset < directorySize)
+	{
+		return false;
+	}
+	outEntries.reserve((size_t)count);
+	u8 const* pRecord = pBase + directoryOffset;
+	u8 const* pEnd = pRecord + directorySize;
+	for (u64 idx = 0; idx < count; ++idx)
+	{
+		if ((size_t)(pEnd - pRecord) < g_zipCentralSize || readU32(pRecord) != g_zipCentralSig)
+		{
+			return false;
+		}
+		u16 const flags = readU16(pRecord + 8);
+		u16 const nameSize = readU16(pRecord + 28);
+		u16 const extraSize = readU16(pRecord + 30);
+		u16 const commentSize = readU16(pRecord + 32);
+		size_t const recordSize = g_zipCentralSize + nameSize + extraSize + commentSize;
+		if ((size_t)(pEnd - pRecord) < recordSize)
+		{
+			return false;
+		}
+		ZIPReader::Entry entry;
+		entry.method = readU16(pRecord + 10);
+		entry.crc = readU32(pRecord + 16);
+		entry.compressedSize = readU32(pRecord + 20);
+		entry.size = readU32(pRecord + 24);
+		entry.localOffset = readU32(pRecord + 42);
+		readZIP64Extra(pRecord + g_zipCentralSize + nameSize, extraSize, entry);
+		std::string name(reinterpret_cast<char const*>(pRecord + g_zipCentralSize), nameSize);
+		pRecord += recordSize;
+		if (name.empty() || name.back() == '/')
+		{
+			// Directory
+			continue;
+		}
+		if (flags & 0x1)
+		{
+			LOG_W("[%s] [%s] is encrypted in [%s], ignoring", typeName<ZIPReader>().data(), name.data(), zipPath.generic_string().data());
+			continue;
+		}
+		outEntries.emplace(std::move(name), entry);
+	}
+	return true;
+}
+} // namespace
+
+struct ZIPReader::Archive final
+{
+	ByteView bytes;
+	ZIPEntries entries;
+};
+
+struct HRead::Request final
+{
+	enum class State : u8
+	{
+		Queued = 0,
+		Reading,
+		Done,
+		Cancelled
+	};
+
+	IOReader const* pReader = nullptr;
+	stdfs::path id;
+	IOReader::OnRead onRead;
+	// Fulfilled exactly once: by the I/O thread, or by whoever cancels the read while it is still queued
+	std::promise<ByteView> promise;
+	std::shared_future<ByteView> result;
+	std::atomic<State> state = State::Queued;
+};
+
+namespace
+{
+// \brief Dedicated I/O thread serving IOReader::readAsync()
+class IOQueue final
+{
+public:
+	using Request = std::shared_ptr<HRead::Request>;
+
+public:
+	static constexpr size_t s_batchSize = 8;
+
+private:
+	std::array<std::deque<Request>, (size_t)IOReader::Priority::COUNT_> m_queues;
+	std::mutex m_mutex;
+	std::condition_variable m_wakeCV;
+	HThread m_hThread;
+	bool m_bWork = false;
+
+public:
+	~IOQueue();
+
+public:
+	void push(Request pRequest, IOReader::Priority priority);
+	// Joins the thread; reads still queued are cancelled
+	void stop();
+
+private:
+	void work();
+	bool hasQueued() const;
+};
+
+IOQueue g_ioQueue;
+
+void cancelRequest(HRead::Request& request)
+{
+	auto expected = HRead::Request::State::Queued;
+	if (request.state.compare_exchange_strong(expected, HRead::Request::State::Cancelled))
+	{
+		request.promise.set_value({});
+	}
+	return;
+}
+
+IOQueue::~IOQueue()
+{
+	stop();
+}
+
+void IOQueue::push(Request pRequest, IOReader::Priority priority)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_bWork)
+		{
+			m_bWork = true;
+			m_hThread = threads::newThread([this]() { work(); });
+			LOG_D("[%s] I/O thread started", typeName<IOReader>().data());
+		}
+		m_queues[(size_t)priority].push_back(std::move(pRequest));
+	}
+	m_wakeCV.notify_one();
+	return;
+}
+
+void IOQueue::stop()
+{
+	std::vector<Request> remaining;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_bWork)
+		{
+			return;
+		}
+		m_bWork = false;
+		for (auto& queue : m_queues)
+		{
+			std::move(queue.begin(), queue.end(), std::back_inserter(remaining));
+			queue.clear();
+		}
+	}
+	m_wakeCV.notify_one();
+	threads::join(m_hThread);
+	for (auto& pRequest : remaining)
+	{
+		cancelRequest(*pRequest);
+	}
+	LOG_D("[%s] I/O thread stopped", typeName<IOReader>().data());
+	return;
+}
+
+void IOQueue::work()
+{
+	std::vector<Request> batch;
+	batch.reserve(s_batchSize);
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wakeCV.wait(lock, [this]() { return !m_bWork || hasQueued(); });
+			if (!m_bWork)
+			{
+				break;
+			}
+			// Highest priority first, FIFO within a priority
+			for (auto iter = m_queues.rbegin(); iter != m_queues.rend() && batch.size() < s_batchSize; ++iter)
+			{
+				while (!iter->empty() && batch.size() < s_batchSize)
+				{
+					batch.push_back(std::move(iter->front()));
+					iter->pop_front();
+				}
+			}
+		}
+		// Claim the batch (dropping cancelled reads), and hint all of it before reading any so that the OS can fetch it concurrently
+		batch.erase(std::remove_if(batch.begin(), batch.end(),
+								   [](Request const& pRequest) {
+									   auto expected = HRead::Request::State::Queued;
+									   return !pRequest->state.compare_exchange_strong(expected, HRead::Request::State::Reading);
+								   }),
+					batch.end());
+		for (auto const& pRequest : batch)
+		{
+			pRequest->pReader->prefetch(pRequest->id);
+		}
+		for (auto const& pRequest : batch)
+		{
+			auto view = pRequest->pReader->getView(pRequest->id);
+			if (pRequest->onRead)
+			{
+				pRequest->onRead(view);
+			}
+			pRequest->state = HRead::Request::State::Done;
+			pRequest->promise.set_value(std::move(view));
+		}
+		batch.clear();
+	}
+	return;
+}
+
+bool IOQueue::hasQueued() const
+{
+	return std::any_of(m_queues.begin(), m_queues.end(), [](std::deque<Request> const& queue) { return !queue.empty(); });
+}
 } // namespace
 
+HRead::HRead() noexcept = default;
+
+HRead::HRead(std::shared_ptr<Request> pRequest) noexcept : m_pRequest(std::move(pRequest)) {}
+
+ByteView HRead::wait() const
+{
+	return m_pRequest ? m_pRequest->result.get() : ByteView();
+}
+
+bool HRead::isReady() const
+{
+	return m_pRequest && m_pRequest->result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+bool HRead::cancel() const
+{
+	if (m_pRequest)
+	{
+		cancelRequest(*m_pRequest);
+		return m_pRequest->state == Request::State::Cancelled;
+	}
+	return false;
+}
+
+HRead::operator bool() const
+{
+	return m_pRequest != nullptr;
+}
+
 bytearray IOReader::FBytes::operator()(stdfs::path const& id) const
 {
 	return pReader->getBytes(pReader->m_prefix / id);
@@ -53,7 +510,12 @@ IOReader::~IOReader() = default;
 
 std::string IOReader::getString(stdfs::path const& id) const
 {
-	return getStr(id).str();
+	return std::string(getView(id).str());
+}
+
+ByteView IOReader::getView(stdfs::path const& id) const
+{
+	return ByteView::from(getBytes(id));
 }
 
 IOReader::FBytes IOReader::bytesFunctor() const
@@ -91,6 +553,24 @@ bool IOReader::checkPresence(std::initializer_list<stdfs::path> ids) const
 	return bRet;
 }
 
+HRead IOReader::readAsync(stdfs::path id, Priority priority, OnRead onRead) const
+{
+	auto pRequest = std::make_shared<HRead::Request>();
+	pRequest->pReader = this;
+	pRequest->id = std::move(id);
+	pRequest->onRead = std::move(onRead);
+	pRequest->result = pRequest->promise.get_future().share();
+	g_ioQueue.push(pRequest, priority);
+	return HRead(std::move(pRequest));
+}
+
+void IOReader::prefetch(stdfs::path const&) const
+{
+	return;
+}
+
+size_t FileReader::s_mapThreshold = 64 * 1024;
+
 FileReader::FileReader(stdfs::path prefix) noexcept : IOReader(std::move(prefix))
 {
 	m_medium = "Filesystem (";
@@ -135,62 +615,214 @@ bytearray FileReader::getBytes(stdfs::path const& id) const
 	return buf;
 }
 
+ByteView FileReader::getView(stdfs::path const& id) const
+{
+	ByteView ret;
+	if (checkPresence(id))
+	{
+		auto const path = m_prefix / id;
+		std::error_code errCode;
+		auto const size = (size_t)stdfs::file_size(path, errCode);
+		if (errCode || size == 0)
+		{
+			return ret;
+		}
+		if (size >= s_mapThreshold)
+		{
+			ret = ioImpl::mapFile(path, size);
+			LOGIF_W(ret.empty(), "[%s] Failed to map [%s], reading instead", typeName<FileReader>().data(), id.generic_string().data());
+		}
+		if (ret.empty())
+		{
+			ret = ioImpl::readFile(path, size);
+		}
+	}
+	return ret;
+}
+
+void FileReader::prefetch(stdfs::path const& id) const
+{
+#if defined(POSIX_FADV_WILLNEED)
+	s32 const fd = open((m_prefix / id).c_str(), O_RDONLY);
+	if (fd >= 0)
+	{
+		// Asynchronous: returns once readahead has been queued
+		posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+		close(fd);
+	}
+#else
+	(void)id;
+#endif
+	return;
+}
+
 ZIPReader::ZIPReader(stdfs::path zipPath, stdfs::path idPrefix /* = "" */) : IOReader(std::move(idPrefix)), m_zipPath(std::move(zipPath))
 {
-	ioImpl::initPhysfs();
 	m_medium = "ZIP (";
 	m_medium += std::move(m_zipPath.generic_string());
 	m_medium += ")";
-	if (!stdfs::is_regular_file(m_zipPath))
+	std::error_code errCode;
+	auto const size = stdfs::is_regular_file(m_zipPath) ? (size_t)stdfs::file_size(m_zipPath, errCode) : 0;
+	if (size == 0 || errCode)
 	{
 		LOG_E("[%s] [%s] not found on Filesystem!", typeName<ZIPReader>().data(), m_zipPath.generic_string().data());
+		return;
+	}
+	auto pArchive = std::make_shared<Archive>();
+	// Entries are read on demand: don't fault in the whole archive
+	pArchive->bytes = ioImpl::mapFile(m_zipPath, size, false);
+	if (pArchive->bytes.empty())
+	{
+		LOG_W("[%s] Failed to map [%s], reading instead", typeName<ZIPReader>().data(), m_zipPath.generic_string().data());
+		pArchive->bytes = ioImpl::readFile(m_zipPath, size);
 	}
-	else
+	if (!indexZIP(pArchive->bytes, pArchive->entries, m_zipPath))
 	{
-		PHYSFS_mount(m_zipPath.string().data(), nullptr, 0);
-		LOG_D("[%s] [%s] archive mounted, idPrefix: [%s]", typeName(*this).data(), m_zipPath.generic_string().data(),
-			  m_prefix.generic_string().data());
+		LOG_E("[%s] [%s] is not a valid zip archive!", typeName<ZIPReader>().data(), m_zipPath.generic_string().data());
+		return;
 	}
+	LOG_D("[%s] [%s] archive indexed (%u entries), idPrefix: [%s]", typeName(*this).data(), m_zipPath.generic_string().data(),
+		  (u32)pArchive->entries.size(), m_prefix.generic_string().data());
+	m_pArchive = std::move(pArchive);
 }
 
 bool ZIPReader::isPresent(stdfs::path const& id) const
 {
-	return PHYSFS_exists((m_prefix / id).generic_string().data()) != 0;
+	return m_pArchive && m_pArchive->entries.find((m_prefix / id).generic_string()) != m_pArchive->entries.end();
 }
 
 std::stringstream ZIPReader::getStr(stdfs::path const& id) const
 {
 	std::stringstream buf;
-	if (checkPresence(id))
+	auto const view = getView(id);
+	buf.write(reinterpret_cast<char const*>(view.pData), (std::streamsize)view.size);
+	return buf;
+}
+
+bytearray ZIPReader::getBytes(stdfs::path const& id) const
+{
+	bytearray buf;
+	if (auto pEntry = find(id))
 	{
-		auto pFile = PHYSFS_openRead((m_prefix / id).generic_string().data());
-		if (pFile)
+		if (auto pData = data(*pEntry, id))
 		{
-			auto length = PHYSFS_fileLength(pFile);
-			std::string charBuf((size_t)length, 0);
-			PHYSFS_readBytes(pFile, charBuf.data(), (PHYSFS_uint64)length);
-			buf << charBuf;
+			if (pEntry->method == 0)
+			{
+				buf = bytearray((size_t)pEntry->size);
+				std::memcpy(buf.data(), pData, buf.size());
+			}
+			else if (!extract(*pEntry, pData, buf, id))
+			{
+				buf.clear();
+			}
 		}
-		PHYSFS_close(pFile);
 	}
 	return buf;
 }
 
-bytearray ZIPReader::getBytes(stdfs::path const& id) const
+ByteView ZIPReader::getView(stdfs::path const& id) const
 {
-	bytearray buf;
-	if (checkPresence(id))
+	ByteView ret;
+	if (auto pEntry = find(id))
 	{
-		auto pFile = PHYSFS_openRead((m_prefix / id).generic_string().data());
-		if (pFile)
+		if (auto pData = data(*pEntry, id))
 		{
-			auto length = PHYSFS_fileLength(pFile);
-			buf = bytearray((size_t)length);
-			PHYSFS_readBytes(pFile, buf.data(), (PHYSFS_uint64)length);
+			if (pEntry->method == 0)
+			{
+				ret.pData = pData;
+				ret.size = (size_t)pEntry->size;
+				ret.token = m_pArchive->bytes.token;
+			}
+			else
+			{
+				bytearray buf;
+				if (extract(*pEntry, pData, buf, id))
+				{
+					ret = ByteView::from(std::move(buf));
+				}
+			}
 		}
-		PHYSFS_close(pFile);
 	}
-	return buf;
+	return ret;
+}
+
+void ZIPReader::prefetch(stdfs::path const& id) const
+{
+#if defined(MADV_WILLNEED)
+	if (!m_pArchive)
+	{
+		return;
+	}
+	auto search = m_pArchive->entries.find((m_prefix / id).generic_string());
+	if (search != m_pArchive->entries.end())
+	{
+		// Reading the local header here would fault synchronously: advise from its start, with a page of slack for its name / extra field
+		auto const& bytes = m_pArchive->bytes;
+		auto const& entry = search->second;
+		auto const pageSize = (uintptr_t)sysconf(_SC_PAGESIZE);
+		u64 const size = g_zipLocalSize + entry.compressedSize + pageSize;
+		auto const begin = (uintptr_t)bytes.pData + (uintptr_t)std::min<u64>(entry.localOffset, bytes.size);
+		auto const end = (uintptr_t)bytes.pData + (uintptr_t)std::min<u64>(entry.localOffset + size, bytes.size);
+		auto const alignedBegin = begin & ~(pageSize - 1);
+		madvise((void*)alignedBegin, end - alignedBegin, MADV_WILLNEED);
+	}
+#else
+	(void)id;
+#endif
+	return;
+}
+
+ZIPReader::Entry const* ZIPReader::find(stdfs::path const& id) const
+{
+	if (m_pArchive)
+	{
+		auto search = m_pArchive->entries.find((m_prefix / id).generic_string());
+		if (search != m_pArchive->entries.end())
+		{
+			return &search->second;
+		}
+	}
+	LOG_E("!! [%s] not found in %s!", id.generic_string().data(), m_medium.data());
+	return nullptr;
+}
+
+std::byte const* ZIPReader::data(Entry const& entry, stdfs::path const& id) const
+{
+	auto const& bytes = m_pArchive->bytes;
+	auto const pBase = reinterpret_cast<u8 const*>(bytes.pData);
+	// The local header's name / extra sizes may differ from the central directory's
+	if (entry.localOffset > bytes.size || bytes.size - entry.localOffset < g_zipLocalSize
+		|| readU32(pBase + entry.localOffset) != g_zipLocalSig)
+	{
+		LOG_E("[%s] [%s] Corrupt local header in %s!", typeName<ZIPReader>().data(), id.generic_string().data(), m_medium.data());
+		return nullptr;
+	}
+	u64 const offset = entry.localOffset + g_zipLocalSize + readU16(pBase + entry.localOffset + 26) + readU16(pBase + entry.localOffset + 28);
+	if (offset > bytes.size || bytes.size - offset < entry.compressedSize)
+	{
+		LOG_E("[%s] [%s] Truncated entry in %s!", typeName<ZIPReader>().data(), id.generic_string().data(), m_medium.data());
+		return nullptr;
+	}
+	if ((entry.method == 0 && entry.compressedSize != entry.size) || (entry.method != 0 && entry.method != 8))
+	{
+		LOG_E("[%s] [%s] Unsupported compression (method: %u) in %s!", typeName<ZIPReader>().data(), id.generic_string().data(),
+			  (u32)entry.method, m_medium.data());
+		return nullptr;
+	}
+	return bytes.pData + offset;
+}
+
+bool ZIPReader::extract(Entry const& entry, std::byte const* pData, bytearray& out, stdfs::path const& id) const
+{
+	out = bytearray((size_t)entry.size);
+	auto const pOut = reinterpret_cast<u8*>(out.data());
+	if (!inflate::decompress(reinterpret_cast<u8 const*>(pData), (size_t)entry.compressedSize, pOut, out.size())
+		|| inflate::crc32(pOut, out.size()) != entry.crc)
+	{
+		LOG_E("[%s] [%s] Corrupt data in %s!", typeName<ZIPReader>().data(), id.generic_string().data(), m_medium.data());
+		return false;
+	}
+	return true;
 }
 
 void ioImpl::initPhysfs()
@@ -202,6 +834,12 @@ void ioImpl::initPhysfs()
 	}
 }
 
+void ioImpl::stopIOThread()
+{
+	g_ioQueue.stop();
+	return;
+}
+
 void ioImpl::deinitPhysfs()
 {
 	LOG_D("PhysFS deinitialised");
@@ -1,8 +1,18 @@
 #pragma once
+#include <filesystem>
 #include <memory>
+#include "le3d/core/byte_view.hpp"
 
 namespace le::ioImpl
 {
 void initPhysfs();
 void deinitPhysfs();
+// Joins the readAsync() thread, cancelling reads still queued (it restarts on the next readAsync())
+void stopIOThread();
+
+// Reads a whole file into a buffer; returns an empty view on failure
+ByteView readFile(std::filesystem::path const& path, size_t size);
+// Returns an empty view if the file cannot be mapped
+// bPopulate: fault every page in up front (for callers that consume the whole file) rather than one at a time
+ByteView mapFile(std::filesystem::path const& path, size_t size, bool bPopulate = true);
 } // namespace le::ioImpl
@@ -1,10 +1,11 @@
-#include <optional>
 #include <sstream>
+#include <thread>
 #include "le3d/core/jobs.hpp"
 #include "le3d/core/assert.hpp"
 #include "le3d/core/log.hpp"
 #include "le3d/env/threads.hpp"
 #include "jobs/job_manager.hpp"
+#include "jobs/job_record.hpp"
 
 namespace le
 {
@@ -12,24 +13,22 @@ namespace
 {
 std::unique_ptr<JobManager> uManager;
 
-std::shared_ptr<HJob> doNow(std::packaged_task<std::any()> task, std::optional<std::string> oName)
+HJob doNow(JobRecord* pJob, std::string_view name)
 {
-	std::string name = oName ? *oName : "unnamed";
-	LOG_E("[%s] Not initialised! Running [%s] Task on this thread!", typeName<JobManager>().data(), name.data());
-	std::shared_ptr<HJob> ret = std::make_shared<HJob>(-1, task.get_future());
-	task();
-	if (oName)
+	if (name.empty())
 	{
-		LOG_D("NOWORKER Completed [%s]", oName->data());
+		name = "unnamed";
 	}
+	LOG_E("[%s] Not initialised! Running [%.*s] Task on this thread!", typeName<JobManager>().data(), (s32)name.size(), name.data());
+	HJob ret = pJob->handle();
+	pJob->run();
+	LOGIF_D(!pJob->bSilent, "NOWORKER Completed [%s]", pJob->logName.data());
+	pJob->release();
 	return ret;
 }
 } // namespace
 
-namespace jobs
-{
-JobManager* g_pJobManager = nullptr;
-} // namespace jobs
+JobManager* jobs::g_pJobManager = nullptr;
 
 void jobs::init(u32 workerCount)
 {
@@ -54,7 +53,7 @@ void jobs::cleanup()
 	return;
 }
 
-std::shared_ptr<HJob> jobs::enqueue(std::function<std::any()> task, std::string name /* = "" */, bool bSilent /* = false */)
+HJob jobs::enqueue(std::function<std::any()> task, std::string_view name /* = "" */, bool bSilent /* = false */)
 {
 	if (uManager)
 	{
@@ -62,26 +61,45 @@ std::shared_ptr<HJob> jobs::enqueue(std::function<std::any()> task, std::string
 	}
 	else
 	{
-		return doNow(std::packaged_task<std::any()>(std::move(task)), bSilent ? std::nullopt : std::optional<std::string>(name));
+		return doNow(JobRecord::acquire(-1, std::move(task), name, bSilent), name);
 	}
 }
 
-std::shared_ptr<HJob> jobs::enqueue(std::function<void()> task, std::string name /* = "" */, bool bSilent /* = false */)
+HJob jobs::enqueue(JobTask task, std::string_view name /* = "" */, bool bSilent /* = false */)
 {
-	auto doTask = [task]() -> std::any {
-		task();
-		return {};
-	};
 	if (uManager)
 	{
-		return uManager->enqueue(doTask, name, bSilent);
+		return uManager->enqueue(std::move(task), name, bSilent);
 	}
 	else
 	{
-		return doNow(std::packaged_task<std::any()>(doTask), bSilent ? std::nullopt : std::optional<std::string>(name));
+		return doNow(JobRecord::acquire(-1, std::move(task), name, bSilent), name);
 	}
 }
 
+HJob jobs::then(HJob const& predecessor, JobTask task, std::string_view name /* = "" */, bool bSilent /* = false */)
+{
+	return whenAll({predecessor}, std::move(task), name, bSilent);
+}
+
+HJob jobs::whenAll(std::vector<HJob> const& predecessors, JobTask task /* = {} */, std::string_view name /* = "" */, bool bSilent /* = true */)
+{
+	JobRecord* pJob = JobRecord::acquire(uManager ? uManager->nextID() : -1, std::move(task), name, bSilent);
+	HJob ret = pJob->handle();
+	// Hold one extra count while wiring so that the job cannot be released before every predecessor is registered
+	pJob->pendingCount.store(u32(predecessors.size() + 1), std::memory_order_relaxed);
+	for (auto const& predecessor : predecessors)
+	{
+		JobRecord* pPredecessor = JobRecord::from(predecessor);
+		if (!pPredecessor || !pPredecessor->addDependent(pJob))
+		{
+			pJob->pendingCount.fetch_sub(1, std::memory_order_acq_rel);
+		}
+	}
+	pJob->releaseDependency();
+	return ret;
+}
+
 JobCatalog* jobs::createCatalogue(std::string name)
 {
 	ASSERT(uManager, "JobManager is null!");
@@ -96,7 +114,7 @@ JobCatalog* jobs::createCatalogue(std::string name)
 	}
 }
 
-std::vector<std::shared_ptr<HJob>> jobs::forEach(IndexedTask const& indexedTask)
+std::vector<HJob> jobs::forEach(IndexedTask const& indexedTask)
 {
 	if (uManager)
 	{
@@ -106,31 +124,39 @@ std::vector<std::shared_ptr<HJob>> jobs::forEach(IndexedTask const& indexedTask)
 	{
 		for (size_t startIdx = indexedTask.startIdx; startIdx < indexedTask.iterationCount * indexedTask.iterationsPerJob; ++startIdx)
 		{
-			std::optional<std::string> oName;
+			std::string name;
 			if (!indexedTask.bSilent)
 			{
-				std::stringstream name;
-				name << indexedTask.name << startIdx << "-" << (startIdx + indexedTask.iterationsPerJob - 1);
-				oName = name.str();
+				std::stringstream str;
+				str << indexedTask.name << startIdx << "-" << (startIdx + indexedTask.iterationsPerJob - 1);
+				name = str.str();
 			}
-			doNow(std::packaged_task<std::any()>([&indexedTask, startIdx]() -> std::any {
-					  indexedTask.task(startIdx);
-					  return {};
-				  }),
-				  oName);
+			doNow(JobRecord::acquire(
+					  -1, [&indexedTask, startIdx]() { indexedTask.task(startIdx); }, name, indexedTask.bSilent),
+				  name);
 		}
 	}
 	return {};
 }
 
-void jobs::waitAll(std::vector<std::shared_ptr<HJob>> const& handles)
+void jobs::parallelForRanges(size_t begin, size_t end, std::function<void(size_t, size_t)> const& rangeTask, size_t grainSize /* = 0 */)
 {
-	for (auto& handle : handles)
+	if (uManager && uManager->workerCount() > 0)
 	{
-		if (handle)
-		{
-			handle->wait();
-		}
+		uManager->parallelFor(begin, end, rangeTask, grainSize);
+	}
+	else if (begin < end)
+	{
+		rangeTask(begin, end);
+	}
+	return;
+}
+
+void jobs::waitAll(std::vector<HJob> const& handles)
+{
+	for (auto handle : handles)
+	{
+		handle.wait();
 	}
 	return;
 }
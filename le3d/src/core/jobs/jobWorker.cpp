@@ -1,5 +1,6 @@
 #include "jobWorker.hpp"
 #include "job_manager.hpp"
+#include "job_record.hpp"
 #include "le3d/core/utils.hpp"
 #include "le3d/core/log.hpp"
 
@@ -24,38 +25,33 @@ JobWorker::~JobWorker()
 
 void JobWorker::run()
 {
+	JobManager::s_pThisWorker = this;
 	while (s_bWork.load(std::memory_order_relaxed))
 	{
-		m_state = State::Idle;
-		std::unique_lock<std::mutex> lock(m_pManager->m_wakeMutex);
-		// Sleep until notified and new job exists / exiting
-		m_pManager->m_wakeCV.wait(lock, [&]() { return !m_pManager->m_jobQueue.empty() || !s_bWork.load(std::memory_order_relaxed); });
-		JobManager::Job job;
-		if (!m_pManager->m_jobQueue.empty())
+		// Flag Busy before popping so that areWorkersIdle() never observes an empty queue and an idle worker mid-handover
+		m_state.store(State::Busy);
+		JobRecord* pJob = nullptr;
+		if (!m_pManager->popJob(id, true, pJob))
 		{
-			job = std::move(m_pManager->m_jobQueue.front());
-			m_pManager->m_jobQueue.pop();
+			m_state.store(State::Idle);
+			m_pManager->sleep();
+			continue;
 		}
-		lock.unlock();
-		// Wake a sleeping worker (in case queue is not empty yet)
-		m_pManager->m_wakeCV.notify_one();
-		if (job.m_id >= 0)
+		if (!pJob->bSilent)
 		{
-			m_state = State::Busy;
-			if (!job.m_bSilent)
-			{
-				LOG_D("%s Starting Job %s", m_logName.data(), job.m_logName.data());
-			}
-			job.run();
-			if (!job.m_bSilent && job.m_exception.empty())
-			{
-				LOG_D("%s Completed Job %s", m_logName.data(), job.m_logName.data());
-			}
-			if (!job.m_exception.empty())
-			{
-				LOG_E("%s Threw an exception running Job %s\n\t%s!", m_logName.data(), job.m_logName.data(), job.m_exception.data());
-			}
+			LOG_D("%s Starting Job %s", m_logName.data(), pJob->logName.data());
 		}
+		if (pJob->run())
+		{
+			LOGIF_D(!pJob->bSilent, "%s Completed Job %s", m_logName.data(), pJob->logName.data());
+		}
+		else
+		{
+			pJob->logError(m_logName);
+		}
+		pJob->release();
 	}
+	m_state.store(State::Idle);
+	JobManager::s_pThisWorker = nullptr;
 }
 } // namespace le
@@ -48,9 +48,9 @@ void JobCatalog::update()
 	while (iter != m_pendingJobs.end())
 	{
 		auto const& subJob = *iter;
-		if (subJob->hasCompleted())
+		if (subJob.hasCompleted())
 		{
-			[[maybe_unused]] auto id = subJob->ID();
+			[[maybe_unused]] auto id = subJob.ID();
 			iter = m_pendingJobs.erase(iter);
 #if defined(LE3D_DEBUG_LOG)
 			LOG_D("%s Job %d completed. %d jobs remaining", m_logName.c_str(), id, m_pendingJobs.size());
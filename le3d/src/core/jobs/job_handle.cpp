@@ -1,33 +1,120 @@
+#include <chrono>
+#include <thread>
 #include "le3d/core/jobs/job_handle.hpp"
+#include "job_manager.hpp"
+#include "job_record.hpp"
 
 namespace le
 {
-HJob::HJob(s64 jobID, std::future<std::any>&& future) noexcept : m_future(std::move(future)), m_jobID(jobID) {}
+namespace
+{
+// Help / yield for this long before blocking: short jobs complete without a sleep / wake round-trip
+constexpr std::chrono::microseconds g_spinTime = std::chrono::microseconds(50);
+// Blocked waiters still wake this often to run queued jobs (the awaited job may be queued behind this thread)
+constexpr std::chrono::microseconds g_blockTime = std::chrono::milliseconds(1);
+} // namespace
+
+HJob::HJob() noexcept = default;
+
+HJob::HJob(JobRecord* pRecord) noexcept : m_pRecord(pRecord)
+{
+	if (m_pRecord)
+	{
+		m_pRecord->addRef();
+	}
+}
+
+HJob::HJob(HJob const& rhs) noexcept : HJob(rhs.m_pRecord) {}
+
+HJob::HJob(HJob&& rhs) noexcept : m_pRecord(rhs.m_pRecord)
+{
+	rhs.m_pRecord = nullptr;
+}
+
+HJob& HJob::operator=(HJob const& rhs) noexcept
+{
+	if (rhs.m_pRecord)
+	{
+		rhs.m_pRecord->addRef();
+	}
+	if (m_pRecord)
+	{
+		m_pRecord->release();
+	}
+	m_pRecord = rhs.m_pRecord;
+	return *this;
+}
 
-HJob::~HJob() = default;
+HJob& HJob::operator=(HJob&& rhs) noexcept
+{
+	if (&rhs != this)
+	{
+		if (m_pRecord)
+		{
+			m_pRecord->release();
+		}
+		m_pRecord = rhs.m_pRecord;
+		rhs.m_pRecord = nullptr;
+	}
+	return *this;
+}
+
+HJob::~HJob()
+{
+	if (m_pRecord)
+	{
+		m_pRecord->release();
+	}
+}
 
 s64 HJob::ID() const
 {
-	return m_jobID;
+	return m_pRecord ? m_pRecord->id : -1;
 }
 
 std::any HJob::wait()
 {
-	if (m_future.valid())
+	if (!m_pRecord)
+	{
+		static std::any fail = false;
+		return fail;
+	}
+	auto const spinUntil = std::chrono::steady_clock::now() + g_spinTime;
+	while (m_pRecord->status.load(std::memory_order_acquire) != JobRecord::Status::Done)
+	{
+		if (jobs::g_pJobManager && jobs::g_pJobManager->helpOne())
+		{
+			continue;
+		}
+		if (std::chrono::steady_clock::now() < spinUntil)
+		{
+			std::this_thread::yield();
+		}
+		else
+		{
+			m_pRecord->waitFor(g_blockTime);
+		}
+	}
+	if (m_pRecord->exception)
 	{
-		return m_future.get();
+		std::rethrow_exception(m_pRecord->exception);
 	}
-	static std::any fail = false;
-	return fail;
+	// Copied out: every handle to this job gets the same result, however many times it waits
+	return m_pRecord->uResult ? *m_pRecord->uResult : std::any();
 }
 
 bool HJob::hasCompleted() const
 {
-	return !m_future.valid() || m_future.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready;
+	return !m_pRecord || m_pRecord->status.load(std::memory_order_acquire) == JobRecord::Status::Done;
 }
 
 bool HJob::isReady() const
 {
-	return m_future.valid() && m_future.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready;
+	return m_pRecord && m_pRecord->status.load(std::memory_order_acquire) == JobRecord::Status::Done;
+}
+
+HJob::operator bool() const
+{
+	return m_pRecord != nullptr;
 }
 } // namespace le
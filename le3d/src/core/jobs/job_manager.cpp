@@ -1,48 +1,115 @@
 #include <algorithm>
 #include <string>
 #include <sstream>
+#include <thread>
 #include "le3d/core/jobs/job_catalogue.hpp"
 #include "le3d/core/assert.hpp"
 #include "le3d/core/log.hpp"
 #include "job_manager.hpp"
+#include "job_record.hpp"
 #include "jobWorker.hpp"
 
 namespace le
 {
 using Lock = std::lock_guard<std::mutex>;
 
-JobManager::Job::Job() = default;
+namespace
+{
+struct ParallelFor final
+{
+	std::function<void(size_t, size_t)> const* pTask = nullptr;
+	JobManager* pManager = nullptr;
+	size_t grainSize = 1;
+	std::atomic<size_t> remaining = 0;
+	std::exception_ptr exception;
+	std::atomic_flag exceptionLock = ATOMIC_FLAG_INIT;
+};
 
-JobManager::Job::Job(s64 id, Task task, std::string name, bool bSilent) : m_task(std::move(task)), m_id(id), m_bSilent(bSilent)
+// Lazy binary splitting: keep the left half, push the right half as a stealable job while the split budget lasts.
+// A range that is stolen (runs on a different thread than its parent) gets its budget topped up, so work keeps
+// splitting only where there are idle workers to take it.
+void runRange(ParallelFor& state, size_t begin, size_t end, u8 budget, std::thread::id parent)
 {
-	m_logName = "[";
-	m_logName += std::to_string(id);
-	if (!name.empty())
+	if (std::this_thread::get_id() != parent)
+	{
+		budget = u8(budget + 2);
+	}
+	auto const self = std::this_thread::get_id();
+	while (end - begin > state.grainSize && budget > 0)
+	{
+		size_t const mid = begin + (end - begin) / 2;
+		--budget;
+		auto pState = &state;
+		state.pManager->enqueue([pState, mid, end, budget, self]() { runRange(*pState, mid, end, budget, self); }, "", true);
+		end = mid;
+	}
+	try
+	{
+		(*state.pTask)(begin, end);
+	}
+	catch (...)
 	{
-		m_logName += "-";
-		m_logName += std::move(name);
+		while (state.exceptionLock.test_and_set(std::memory_order_acquire))
+		{
+		}
+		if (!state.exception)
+		{
+			state.exception = std::current_exception();
+		}
+		state.exceptionLock.clear(std::memory_order_release);
 	}
-	m_logName += "]";
-	m_shJob = std::make_shared<HJob>(id, m_task.get_future());
+	state.remaining.fetch_sub(end - begin, std::memory_order_acq_rel);
+	return;
 }
+} // namespace
 
-void JobManager::Job::run()
+void JobManager::Queue::push(JobRecord* pJob)
 {
-	try
+	Lock lock(m_mutex);
+	m_jobs.push_back(pJob);
+	return;
+}
+
+bool JobManager::Queue::pop(JobRecord*& out)
+{
+	Lock lock(m_mutex);
+	if (m_jobs.empty())
 	{
-		m_task();
+		return false;
 	}
-	catch (std::exception const& e)
+	out = m_jobs.back();
+	m_jobs.pop_back();
+	return true;
+}
+
+bool JobManager::Queue::steal(JobRecord*& out)
+{
+	Lock lock(m_mutex);
+	if (m_jobs.empty())
 	{
-		ASSERT_STR(false, e.what());
-		m_exception = e.what();
+		return false;
 	}
+	out = m_jobs.front();
+	m_jobs.pop_front();
+	return true;
+}
+
+bool JobManager::Queue::isEmpty() const
+{
+	Lock lock(m_mutex);
+	return m_jobs.empty();
 }
 
+thread_local JobWorker* JobManager::s_pThisWorker = nullptr;
+
 JobManager::JobManager(u8 workerCount)
 {
 	JobWorker::s_bWork.store(true, std::memory_order_seq_cst);
 	for (u8 i = 0; i < workerCount; ++i)
+	{
+		m_queues.push_back(std::make_unique<Queue>());
+	}
+	for (u8 i = 0; i < workerCount; ++i)
 	{
 		m_jobWorkers.push_back(std::make_unique<JobWorker>(*this, i));
 	}
@@ -52,22 +119,32 @@ JobManager::~JobManager()
 {
 	JobWorker::s_bWork.store(false, std::memory_order_seq_cst);
 	// Wake all sleeping workers
-	m_wakeCV.notify_all();
+	{
+		Lock lock(m_wakeMutex);
+		m_wakeCV.notify_all();
+	}
 	// Join all worker threads
 	m_jobWorkers.clear();
+	// Complete (as broken promises) any jobs that never ran, so that waiting handles don't block forever
+	for (auto& uQueue : m_queues)
+	{
+		JobRecord* pJob = nullptr;
+		while (uQueue->pop(pJob))
+		{
+			pJob->cancel();
+			pJob->release();
+		}
+	}
 }
 
-std::shared_ptr<HJob> JobManager::enqueue(Task task, std::string name, bool bSilent)
+HJob JobManager::enqueue(JobTask task, std::string_view name, bool bSilent)
 {
-	std::shared_ptr<HJob> ret;
-	{
-		Lock lock(m_wakeMutex);
-		m_jobQueue.emplace(++m_nextJobID, std::move(task), std::move(name), bSilent);
-		ret = m_jobQueue.back().m_shJob;
-	}
-	// Wake a sleeping worker
-	m_wakeCV.notify_one();
-	return ret;
+	return submit(JobRecord::acquire(nextID(), std::move(task), name, bSilent));
+}
+
+HJob JobManager::enqueue(std::function<std::any()> task, std::string_view name, bool bSilent)
+{
+	return submit(JobRecord::acquire(nextID(), std::move(task), name, bSilent));
 }
 
 JobCatalog* JobManager::createCatalogue(std::string name)
@@ -76,11 +153,12 @@ JobCatalog* JobManager::createCatalogue(std::string name)
 	return m_catalogs.back().get();
 }
 
-std::vector<std::shared_ptr<HJob>> JobManager::forEach(IndexedTask const& indexedTask)
+std::vector<HJob> JobManager::forEach(IndexedTask const& indexedTask)
 {
 	size_t idx = indexedTask.startIdx;
-	std::vector<std::shared_ptr<HJob>> handles;
+	std::vector<HJob> handles;
 	u16 buckets = u16(indexedTask.iterationCount / indexedTask.iterationsPerJob);
+	handles.reserve(buckets + 1);
 	for (u16 bucket = 0; bucket < buckets; ++bucket)
 	{
 		size_t start = idx;
@@ -94,12 +172,11 @@ std::vector<std::shared_ptr<HJob>> JobManager::forEach(IndexedTask const& indexe
 			taskName = name.str();
 		}
 		handles.push_back(enqueue(
-			[start, end, &indexedTask]() -> std::any {
+			[start, end, &indexedTask]() {
 				for (size_t i = start; i < end; ++i)
 				{
 					indexedTask.task(i);
 				}
-				return {};
 			},
 			taskName, indexedTask.bSilent));
 		idx += indexedTask.iterationsPerJob;
@@ -116,18 +193,106 @@ std::vector<std::shared_ptr<HJob>> JobManager::forEach(IndexedTask const& indexe
 			taskName = name.str();
 		}
 		handles.push_back(enqueue(
-			[start, end, &indexedTask]() -> std::any {
+			[start, end, &indexedTask]() {
 				for (size_t i = start; i < end; ++i)
 				{
 					indexedTask.task(i);
 				}
-				return {};
 			},
 			taskName, indexedTask.bSilent));
 	}
 	return handles;
 }
 
+void JobManager::schedule(JobRecord* pJob)
+{
+	if (m_queues.empty())
+	{
+		pJob->run();
+		pJob->release();
+		return;
+	}
+	// Workers push onto their own queue (hot in cache, no contention); other threads distribute round-robin
+	size_t idx;
+	if (s_pThisWorker && s_pThisWorker->m_pManager == this)
+	{
+		idx = s_pThisWorker->id;
+	}
+	else
+	{
+		idx = m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+	}
+	m_queues[idx]->push(pJob);
+	m_queuedCount.fetch_add(1);
+	// Only pay for the wake mutex if some worker is actually asleep
+	if (m_sleepingCount.load() > 0)
+	{
+		Lock lock(m_wakeMutex);
+		m_wakeCV.notify_one();
+	}
+	return;
+}
+
+s64 JobManager::nextID()
+{
+	return ++m_nextJobID;
+}
+
+void JobManager::parallelFor(size_t begin, size_t end, std::function<void(size_t, size_t)> const& rangeTask, size_t grainSize)
+{
+	if (end <= begin)
+	{
+		return;
+	}
+	size_t const count = end - begin;
+	size_t const workers = std::max(m_queues.size(), (size_t)1);
+	ParallelFor state;
+	state.pTask = &rangeTask;
+	state.pManager = this;
+	state.grainSize = grainSize > 0 ? grainSize : std::max(count / (workers * 32), (size_t)1);
+	state.remaining.store(count);
+	u8 budget = 2;
+	for (size_t w = workers; w > 0; w >>= 1)
+	{
+		++budget;
+	}
+	runRange(state, begin, end, budget, std::this_thread::get_id());
+	// Participate until every sub-range (including ones stolen by workers) has completed
+	while (state.remaining.load(std::memory_order_acquire) > 0)
+	{
+		if (!helpOne())
+		{
+			std::this_thread::yield();
+		}
+	}
+	if (state.exception)
+	{
+		std::rethrow_exception(state.exception);
+	}
+	return;
+}
+
+bool JobManager::helpOne()
+{
+	if (m_queues.empty())
+	{
+		return false;
+	}
+	bool const bWorker = s_pThisWorker && s_pThisWorker->m_pManager == this;
+	size_t const idx = bWorker ? s_pThisWorker->id : m_nextQueue.load(std::memory_order_relaxed) % m_queues.size();
+	JobRecord* pJob = nullptr;
+	if (!popJob(idx, bWorker, pJob))
+	{
+		return false;
+	}
+	if (!pJob->run())
+	{
+		pJob->logError(bWorker ? std::string_view(s_pThisWorker->m_logName) : "[JobManager]");
+	}
+	pJob->release();
+	return true;
+}
+
 void JobManager::update()
 {
 	auto iter = m_catalogs.begin();
@@ -149,19 +314,59 @@ void JobManager::update()
 
 bool JobManager::areWorkersIdle() const
 {
-	Lock lock(m_wakeMutex);
+	// Read the queued count first: workers flag themselves Busy before popping
+	if (m_queuedCount.load() > 0)
+	{
+		return false;
+	}
 	for (auto& gameWorker : m_jobWorkers)
 	{
-		if (gameWorker->m_state == JobWorker::State::Busy)
+		if (gameWorker->m_state.load() == JobWorker::State::Busy)
 		{
 			return false;
 		}
 	}
-	return m_jobQueue.empty();
+	return true;
 }
 
 u16 JobManager::workerCount() const
 {
 	return (u16)m_jobWorkers.size();
 }
+
+HJob JobManager::submit(JobRecord* pJob)
+{
+	HJob ret = pJob->handle();
+	schedule(pJob);
+	return ret;
+}
+
+bool JobManager::popJob(size_t queueIdx, bool bOwn, JobRecord*& out)
+{
+	if (m_queuedCount.load() <= 0)
+	{
+		return false;
+	}
+	size_t const count = m_queues.size();
+	bool bPopped = bOwn && m_queues[queueIdx]->pop(out);
+	for (size_t offset = bOwn ? 1 : 0; !bPopped && offset < count; ++offset)
+	{
+		bPopped = m_queues[(queueIdx + offset) % count]->steal(out);
+	}
+	if (bPopped)
+	{
+		m_queuedCount.fetch_sub(1);
+	}
+	return bPopped;
+}
+
+void JobManager::sleep()
+{
+	std::unique_lock<std::mutex> lock(m_wakeMutex);
+	++m_sleepingCount;
+	// Sleep until notified and new job exists / exiting
+	m_wakeCV.wait(lock, [&]() { return m_queuedCount.load() > 0 || !JobWorker::s_bWork.load(); });
+	--m_sleepingCount;
+	return;
+}
 } // namespace le
@@ -1,11 +1,15 @@
 #pragma once
 #include <any>
-#include <future>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <list>
-#include <queue>
 #include <memory>
+#include <mutex>
+#include <string_view>
 #include <vector>
 #include "le3d/core/jobs/job_handle.hpp"
+#include "le3d/core/jobs/job_task.hpp"
 
 namespace le
 {
@@ -15,51 +19,65 @@ public:
 	static constexpr s32 INVALID_ID = -1;
 
 private:
-	using Task = std::function<std::any()>;
-
-	class Job
+	// Per-worker deque: owner pushes/pops at the back (LIFO), thieves take from the front (FIFO)
+	class Queue
 	{
 	private:
-		std::packaged_task<std::any()> m_task;
-
-	public:
-		std::string m_logName;
-		std::string m_exception;
-		std::shared_ptr<HJob> m_shJob;
-		s64 m_id = -1;
-		bool m_bSilent = true;
+		std::deque<class JobRecord*> m_jobs;
+		mutable std::mutex m_mutex;
 
 	public:
-		Job();
-		Job(s64 id, Task task, std::string name, bool bSilent);
-		Job(Job&& rhs) = default;
-		Job& operator=(Job&& rhs) = default;
-
-		void run();
+		void push(JobRecord* pJob);
+		bool pop(JobRecord*& out);
+		bool steal(JobRecord*& out);
+		bool isEmpty() const;
 	};
 
+private:
+	static thread_local class JobWorker* s_pThisWorker;
+
 private:
 	std::vector<std::unique_ptr<class JobWorker>> m_jobWorkers;
+	std::vector<std::unique_ptr<Queue>> m_queues;
 	std::list<std::unique_ptr<class JobCatalog>> m_catalogs;
-	std::queue<Job> m_jobQueue;
+	std::atomic<s64> m_nextJobID = 0;
+	std::atomic<s64> m_queuedCount = 0;
+	std::atomic<u32> m_sleepingCount = 0;
+	std::atomic<u32> m_nextQueue = 0;
 	mutable std::mutex m_wakeMutex;
 	std::condition_variable m_wakeCV;
-	s64 m_nextJobID = 0;
 
 public:
 	JobManager(u8 workerCount);
 	~JobManager();
 
 public:
-	std::shared_ptr<HJob> enqueue(Task task, std::string name = "", bool bSilent = false);
+	HJob enqueue(JobTask task, std::string_view name = "", bool bSilent = false);
+	HJob enqueue(std::function<std::any()> task, std::string_view name = "", bool bSilent = false);
 	JobCatalog* createCatalogue(std::string name);
-	std::vector<std::shared_ptr<HJob>> forEach(IndexedTask const& indexedTask);
+	std::vector<HJob> forEach(IndexedTask const& indexedTask);
+	void parallelFor(size_t begin, size_t end, std::function<void(size_t, size_t)> const& rangeTask, size_t grainSize);
+	// Queues a prepared record, taking over the caller's reference
+	void schedule(JobRecord* pJob);
+	s64 nextID();
+	// Pops and runs one queued job on the calling thread (if any); returns false if none were available
+	bool helpOne();
 
 	void update();
 	bool areWorkersIdle() const;
 	u16 workerCount() const;
 
+private:
+	HJob submit(JobRecord* pJob);
+	bool popJob(size_t queueIdx, bool bOwn, JobRecord*& out);
+	void sleep();
+
 private:
 	friend class JobWorker;
 };
+
+namespace jobs
+{
+extern JobManager* g_pJobManager;
+} // namespace jobs
 } // namespace le
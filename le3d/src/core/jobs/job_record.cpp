@@ -0,0 +1,251 @@
+#include <array>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "le3d/core/assert.hpp"
+#include "le3d/core/log.hpp"
+#include "job_manager.hpp"
+#include "job_record.hpp"
+
+namespace le
+{
+class JobPool final
+{
+private:
+	static constexpr size_t BLOCK_SIZE = 64;
+	using Block = std::array<JobRecord, BLOCK_SIZE>;
+
+	std::vector<std::unique_ptr<Block>> m_blocks;
+	JobRecord* m_pFree = nullptr;
+	std::mutex m_mutex;
+
+public:
+	JobRecord* pop();
+	void push(JobRecord* pRecord);
+};
+
+namespace
+{
+JobPool g_pool;
+
+// Shared by all records: completion only takes the mutex when some thread is blocked in waitFor()
+std::mutex g_doneMutex;
+std::condition_variable g_doneCV;
+std::atomic<u32> g_doneWaiters = 0;
+} // namespace
+
+JobRecord* JobPool::pop()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!m_pFree)
+	{
+		m_blocks.push_back(std::make_unique<Block>());
+		for (auto& record : *m_blocks.back())
+		{
+			record.m_pNextFree = m_pFree;
+			m_pFree = &record;
+		}
+	}
+	JobRecord* pRet = m_pFree;
+	m_pFree = pRet->m_pNextFree;
+	pRet->m_pNextFree = nullptr;
+	return pRet;
+}
+
+void JobPool::push(JobRecord* pRecord)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	pRecord->m_pNextFree = m_pFree;
+	m_pFree = pRecord;
+	return;
+}
+
+JobRecord* JobRecord::acquire(s64 id, JobTask task, std::string_view name, bool bSilent)
+{
+	JobRecord* pRet = g_pool.pop();
+	pRet->task = std::move(task);
+	pRet->id = id;
+	pRet->bSilent = bSilent;
+	pRet->status.store(Status::Queued, std::memory_order_relaxed);
+	pRet->refCount.store(1, std::memory_order_relaxed);
+	pRet->pendingCount.store(0, std::memory_order_relaxed);
+	if (!bSilent)
+	{
+		pRet->logName = "[";
+		pRet->logName += std::to_string(id);
+		if (!name.empty())
+		{
+			pRet->logName += "-";
+			pRet->logName += name;
+		}
+		pRet->logName += "]";
+	}
+	return pRet;
+}
+
+JobRecord* JobRecord::acquire(s64 id, std::function<std::any()> task, std::string_view name, bool bSilent)
+{
+	JobRecord* pRet = acquire(id, JobTask(), name, bSilent);
+	if (!pRet->uResult)
+	{
+		pRet->uResult = std::make_unique<std::any>();
+	}
+	pRet->task = [pRet, task = std::move(task)]() { *pRet->uResult = task(); };
+	return pRet;
+}
+
+JobRecord* JobRecord::from(HJob const& handle)
+{
+	return handle.m_pRecord;
+}
+
+HJob JobRecord::handle()
+{
+	return HJob(this);
+}
+
+void JobRecord::addRef()
+{
+	refCount.fetch_add(1, std::memory_order_relaxed);
+	return;
+}
+
+void JobRecord::release()
+{
+	if (refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		task.reset();
+		if (uResult)
+		{
+			uResult->reset();
+		}
+		exception = nullptr;
+		error.clear();
+		logName.clear();
+		id = -1;
+		g_pool.push(this);
+	}
+	return;
+}
+
+bool JobRecord::addDependent(JobRecord* pDependent)
+{
+	bool bRet = false;
+	while (m_dependentsLock.test_and_set(std::memory_order_acquire))
+	{
+	}
+	if (status.load(std::memory_order_relaxed) != Status::Done)
+	{
+		m_dependents.push_back(pDependent);
+		bRet = true;
+	}
+	m_dependentsLock.clear(std::memory_order_release);
+	return bRet;
+}
+
+void JobRecord::releaseDependency()
+{
+	if (pendingCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		if (jobs::g_pJobManager)
+		{
+			jobs::g_pJobManager->schedule(this);
+		}
+		else
+		{
+			run();
+			release();
+		}
+	}
+	return;
+}
+
+bool JobRecord::run()
+{
+	bool bRet = true;
+	try
+	{
+		if (task)
+		{
+			task();
+		}
+	}
+	catch (std::exception const& e)
+	{
+		ASSERT_STR(false, e.what());
+		exception = std::current_exception();
+		error = e.what();
+		bRet = false;
+	}
+	catch (...)
+	{
+		exception = std::current_exception();
+		error = "Unknown exception";
+		bRet = false;
+	}
+	complete(false);
+	return bRet;
+}
+
+void JobRecord::cancel()
+{
+	exception = std::make_exception_ptr(std::future_error(std::future_errc::broken_promise));
+	complete(true);
+	return;
+}
+
+bool JobRecord::waitFor(std::chrono::microseconds timeout) const
+{
+	g_doneWaiters.fetch_add(1);
+	bool bRet;
+	{
+		std::unique_lock<std::mutex> lock(g_doneMutex);
+		bRet = g_doneCV.wait_for(lock, timeout, [this]() { return status.load() == Status::Done; });
+	}
+	g_doneWaiters.fetch_sub(1);
+	return bRet;
+}
+
+void JobRecord::logError(std::string_view runner) const
+{
+	// Silent jobs don't build a log name
+	std::string const name = logName.empty() ? "[" + std::to_string(id) + "]" : logName;
+	LOG_E("%s Threw an exception running Job %s\n\t%s!", runner.data(), name.data(), error.data());
+	return;
+}
+
+void JobRecord::complete(bool bCancelled)
+{
+	task.reset();
+	while (m_dependentsLock.test_and_set(std::memory_order_acquire))
+	{
+	}
+	// seq_cst pairs with g_doneWaiters: either a blocked waiter sees Done, or this sees the waiter and notifies it
+	status.store(Status::Done);
+	m_dependentsLock.clear(std::memory_order_release);
+	if (g_doneWaiters.load() > 0)
+	{
+		{
+			std::lock_guard<std::mutex> lock(g_doneMutex);
+		}
+		g_doneCV.notify_all();
+	}
+	// No further dependents can be added once Done is set: the vector is exclusively ours now
+	for (auto pDependent : m_dependents)
+	{
+		if (!bCancelled)
+		{
+			pDependent->releaseDependency();
+		}
+		else if (pDependent->pendingCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			pDependent->cancel();
+			pDependent->release();
+		}
+	}
+	m_dependents.clear();
+	return;
+}
+} // namespace le
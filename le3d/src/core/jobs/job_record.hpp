@@ -0,0 +1,76 @@
+#pragma once
+#include <any>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "le3d/core/jobs/job_handle.hpp"
+#include "le3d/core/jobs/job_task.hpp"
+
+namespace le
+{
+// Pooled storage for one job: task, result slot and completion state, shared by HJob handles and the queues
+class JobRecord final
+{
+public:
+	enum class Status : u8
+	{
+		Queued,
+		Done,
+	};
+
+public:
+	JobTask task;
+	// Only allocated for jobs that return a value (void jobs never box a std::any); kept across reuse of the record
+	std::unique_ptr<std::any> uResult;
+	std::exception_ptr exception;
+	// what() of the exception thrown by the task (if any)
+	std::string error;
+	std::string logName;
+	std::atomic<Status> status = Status::Queued;
+	std::atomic<u32> refCount = 0;
+	// Incomplete predecessors (+1 while dependencies are being wired); the job is scheduled when this reaches 0
+	std::atomic<u32> pendingCount = 0;
+	s64 id = -1;
+	bool bSilent = true;
+
+private:
+	std::vector<JobRecord*> m_dependents;
+	std::atomic_flag m_dependentsLock = ATOMIC_FLAG_INIT;
+	JobRecord* m_pNextFree = nullptr;
+
+public:
+	// Returns a pooled record holding one reference (owned by the caller / queue)
+	static JobRecord* acquire(s64 id, JobTask task, std::string_view name, bool bSilent);
+	static JobRecord* acquire(s64 id, std::function<std::any()> task, std::string_view name, bool bSilent);
+	static JobRecord* from(HJob const& handle);
+
+public:
+	HJob handle();
+	void addRef();
+	void release();
+
+	// Registers pDependent to be released when this job completes; returns false if it already has
+	bool addDependent(JobRecord* pDependent);
+	// Drops one pending predecessor; schedules this job (transferring the caller's reference) when none remain
+	void releaseDependency();
+
+	// Runs the task (capturing any exception), flags completion and releases dependents; returns false if the task threw
+	bool run();
+	// Completes the record (and its dependents) without running its task
+	void cancel();
+	// Blocks until the record completes or timeout elapses; returns true if it has completed
+	bool waitFor(std::chrono::microseconds timeout) const;
+	// Logs the exception thrown by the task (after run() returns false); runner identifies the calling thread
+	void logError(std::string_view runner) const;
+
+private:
+	void complete(bool bCancelled);
+
+private:
+	friend class JobPool;
+};
+} // namespace le
@@ -0,0 +1,644 @@
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include "le3d/core/json.hpp"
+
+namespace le::json
+{
+namespace
+{
+constexpr u32 s_maxDepth = 128;
+
+bool isSpace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+void appendUTF8(std::string& out, u32 codepoint)
+{
+	if (codepoint < 0x80)
+	{
+		out += (char)codepoint;
+	}
+	else if (codepoint < 0x800)
+	{
+		out += (char)(0xc0 | (codepoint >> 6));
+		out += (char)(0x80 | (codepoint & 0x3f));
+	}
+	else if (codepoint < 0x10000)
+	{
+		out += (char)(0xe0 | (codepoint >> 12));
+		out += (char)(0x80 | ((codepoint >> 6) & 0x3f));
+		out += (char)(0x80 | (codepoint & 0x3f));
+	}
+	else
+	{
+		out += (char)(0xf0 | (codepoint >> 18));
+		out += (char)(0x80 | ((codepoint >> 12) & 0x3f));
+		out += (char)(0x80 | ((codepoint >> 6) & 0x3f));
+		out += (char)(0x80 | (codepoint & 0x3f));
+	}
+	return;
+}
+
+bool parseHex4(std::string_view text, size_t pos, u32& outValue)
+{
+	if (pos + 4 > text.size())
+	{
+		return false;
+	}
+	outValue = 0;
+	for (size_t i = pos; i < pos + 4; ++i)
+	{
+		char const c = text[i];
+		outValue <<= 4;
+		if (c >= '0' && c <= '9')
+		{
+			outValue |= (u32)(c - '0');
+		}
+		else if (c >= 'a' && c <= 'f')
+		{
+			outValue |= (u32)(c - 'a' + 10);
+		}
+		else if (c >= 'A' && c <= 'F')
+		{
+			outValue |= (u32)(c - 'A' + 10);
+		}
+		else
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Copies text into a null-terminated buffer for strtol/strtod (which need one); avoids allocating for typical literals
+template <typename F>
+auto withCStr(std::string_view text, F&& func)
+{
+	char buf[64];
+	if (text.size() < sizeof(buf))
+	{
+		std::memcpy(buf, text.data(), text.size());
+		buf[text.size()] = '\0';
+		return func(buf);
+	}
+	std::string const str(text);
+	return func(str.data());
+}
+} // namespace
+
+class Document::Parser final
+{
+private:
+	Document& m_doc;
+	std::string_view m_text;
+	size_t m_pos = 0;
+
+public:
+	explicit Parser(Document& doc);
+
+public:
+	bool parse();
+
+private:
+	bool value(u32 depth);
+	bool string(u32& outBegin, u32& outLength, bool& bOutEscaped);
+	bool number(Node& outNode);
+	bool literal(std::string_view expected, Type type);
+	bool container(u32 depth, char close, bool bObject);
+	void skipSpace();
+	bool fail(char const* szWhat);
+};
+
+Document::Parser::Parser(Document& doc) : m_doc(doc), m_text(doc.text()) {}
+
+bool Document::Parser::parse()
+{
+	if (m_text.size() >= (size_t)std::numeric_limits<u32>::max())
+	{
+		return fail("Source too large");
+	}
+	skipSpace();
+	if (!value(0))
+	{
+		return false;
+	}
+	skipSpace();
+	if (m_pos != m_text.size())
+	{
+		return fail("Unexpected trailing characters");
+	}
+	return true;
+}
+
+bool Document::Parser::value(u32 depth)
+{
+	if (depth > s_maxDepth)
+	{
+		return fail("Nesting too deep");
+	}
+	if (m_pos >= m_text.size())
+	{
+		return fail("Unexpected end of input");
+	}
+	switch (m_text[m_pos])
+	{
+	case '{':
+		return container(depth, '}', true);
+	case '[':
+		return container(depth, ']', false);
+	case '"':
+	{
+		Node node;
+		node.type = Type::String;
+		if (!string(node.begin, node.length, node.bEscaped))
+		{
+			return false;
+		}
+		m_doc.m_nodes.push_back(node);
+		return true;
+	}
+	case 't':
+		return literal("true", Type::Bool);
+	case 'f':
+		return literal("false", Type::Bool);
+	case 'n':
+		return literal("null", Type::Null);
+	default:
+	{
+		Node node;
+		if (!number(node))
+		{
+			return false;
+		}
+		m_doc.m_nodes.push_back(node);
+		return true;
+	}
+	}
+}
+
+bool Document::Parser::string(u32& outBegin, u32& outLength, bool& bOutEscaped)
+{
+	// Opening quote
+	++m_pos;
+	size_t const begin = m_pos;
+	bOutEscaped = false;
+	while (m_pos < m_text.size())
+	{
+		char const c = m_text[m_pos];
+		if (c == '"')
+		{
+			outBegin = (u32)begin;
+			outLength = (u32)(m_pos - begin);
+			++m_pos;
+			return true;
+		}
+		if (c == '\\')
+		{
+			bOutEscaped = true;
+			++m_pos;
+		}
+		else if ((u8)c < 0x20)
+		{
+			return fail("Control character in string");
+		}
+		++m_pos;
+	}
+	return fail("Unterminated string");
+}
+
+bool Document::Parser::number(Node& outNode)
+{
+	size_t const begin = m_pos;
+	if (m_pos < m_text.size() && (m_text[m_pos] == '-' || m_text[m_pos] == '+'))
+	{
+		++m_pos;
+	}
+	size_t const digits = m_pos;
+	while (m_pos < m_text.size())
+	{
+		char const c = m_text[m_pos];
+		if ((c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || ((c == '-' || c == '+') && m_pos > digits))
+		{
+			++m_pos;
+		}
+		else
+		{
+			break;
+		}
+	}
+	if (m_pos == digits)
+	{
+		return fail("Unexpected character");
+	}
+	outNode.type = Type::Number;
+	outNode.begin = (u32)begin;
+	outNode.length = (u32)(m_pos - begin);
+	return true;
+}
+
+bool Document::Parser::literal(std::string_view expected, Type type)
+{
+	if (m_text.substr(m_pos, expected.size()) != expected)
+	{
+		return fail("Invalid literal");
+	}
+	Node node;
+	node.type = type;
+	node.begin = (u32)m_pos;
+	node.length = (u32)expected.size();
+	m_doc.m_nodes.push_back(node);
+	m_pos += expected.size();
+	return true;
+}
+
+bool Document::Parser::container(u32 depth, char close, bool bObject)
+{
+	u32 const self = (u32)m_doc.m_nodes.size();
+	{
+		Node node;
+		node.type = bObject ? Type::Object : Type::Array;
+		node.begin = (u32)m_pos;
+		m_doc.m_nodes.push_back(node);
+	}
+	// Opening brace
+	++m_pos;
+	u32 prev = 0;
+	u32 count = 0;
+	skipSpace();
+	while (m_pos < m_text.size() && m_text[m_pos] != close)
+	{
+		u32 keyBegin = 0, keyLength = 0;
+		bool bKeyEscaped = false;
+		if (bObject)
+		{
+			if (m_text[m_pos] != '"')
+			{
+				return fail("Expected member key");
+			}
+			if (!string(keyBegin, keyLength, bKeyEscaped))
+			{
+				return false;
+			}
+			skipSpace();
+			if (m_pos >= m_text.size() || m_text[m_pos] != ':')
+			{
+				return fail("Expected ':'");
+			}
+			++m_pos;
+			skipSpace();
+		}
+		u32 const child = (u32)m_doc.m_nodes.size();
+		if (!value(depth + 1))
+		{
+			return false;
+		}
+		auto& childNode = m_doc.m_nodes[child];
+		childNode.keyBegin = keyBegin;
+		childNode.keyLength = keyLength;
+		childNode.bKeyEscaped = bKeyEscaped;
+		if (count == 0)
+		{
+			m_doc.m_nodes[self].firstChild = child;
+		}
+		else
+		{
+			m_doc.m_nodes[prev].next = child;
+		}
+		prev = child;
+		++count;
+		skipSpace();
+		if (m_pos < m_text.size() && m_text[m_pos] == ',')
+		{
+			++m_pos;
+			skipSpace();
+			// Tolerate trailing commas, as the previous tokenising parser did
+		}
+		else if (m_pos < m_text.size() && m_text[m_pos] != close)
+		{
+			return fail("Expected ',' or closing bracket");
+		}
+	}
+	if (m_pos >= m_text.size())
+	{
+		return fail("Unexpected end of input");
+	}
+	// Closing brace
+	++m_pos;
+	auto& node = m_doc.m_nodes[self];
+	node.childCount = count;
+	node.length = (u32)m_pos - node.begin;
+	return true;
+}
+
+void Document::Parser::skipSpace()
+{
+	while (m_pos < m_text.size() && isSpace(m_text[m_pos]))
+	{
+		++m_pos;
+	}
+	return;
+}
+
+bool Document::Parser::fail(char const* szWhat)
+{
+	m_doc.m_error = szWhat;
+	m_doc.m_error += " at offset ";
+	m_doc.m_error += std::to_string(m_pos);
+	return false;
+}
+
+Value::Value(Document const& doc, u32 idx) : m_pDoc(&doc), m_idx(idx) {}
+
+Value::operator bool() const
+{
+	return m_pDoc != nullptr;
+}
+
+Type Value::type() const
+{
+	return m_pDoc ? m_pDoc->m_nodes[m_idx].type : Type::Null;
+}
+
+bool Value::isObject() const
+{
+	return type() == Type::Object;
+}
+
+bool Value::isArray() const
+{
+	return type() == Type::Array;
+}
+
+bool Value::isString() const
+{
+	return type() == Type::String;
+}
+
+std::string_view Value::raw() const
+{
+	if (!m_pDoc)
+	{
+		return {};
+	}
+	auto const& node = m_pDoc->m_nodes[m_idx];
+	return m_pDoc->text().substr(node.begin, node.length);
+}
+
+std::string_view Value::key() const
+{
+	if (!m_pDoc)
+	{
+		return {};
+	}
+	auto const& node = m_pDoc->m_nodes[m_idx];
+	return m_pDoc->text().substr(node.keyBegin, node.keyLength);
+}
+
+std::string Value::asString(std::string_view defaultValue) const
+{
+	if (!m_pDoc)
+	{
+		return std::string(defaultValue);
+	}
+	auto const& node = m_pDoc->m_nodes[m_idx];
+	return node.bEscaped ? unescape(raw()) : std::string(raw());
+}
+
+bool Value::asBool(bool bDefaultValue) const
+{
+	auto const text = raw();
+	if (text == "true" || text == "1")
+	{
+		return true;
+	}
+	if (text == "false" || text == "0")
+	{
+		return false;
+	}
+	return bDefaultValue;
+}
+
+s32 Value::asS32(s32 defaultValue) const
+{
+	auto const text = raw();
+	if (text.empty() || isObject() || isArray())
+	{
+		return defaultValue;
+	}
+	return withCStr(text, [defaultValue](char const* szText) {
+		char* szEnd = nullptr;
+		auto const ret = std::strtol(szText, &szEnd, 10);
+		return szEnd == szText ? defaultValue : (s32)ret;
+	});
+}
+
+f64 Value::asF64(f64 defaultValue) const
+{
+	auto const text = raw();
+	if (text.empty() || isObject() || isArray())
+	{
+		return defaultValue;
+	}
+	return withCStr(text, [defaultValue](char const* szText) {
+		char* szEnd = nullptr;
+		auto const ret = std::strtod(szText, &szEnd);
+		return szEnd == szText ? defaultValue : (f64)ret;
+	});
+}
+
+u32 Value::size() const
+{
+	return m_pDoc ? m_pDoc->m_nodes[m_idx].childCount : 0;
+}
+
+Value Value::operator[](std::string_view key) const
+{
+	if (isObject())
+	{
+		for (auto const& child : *this)
+		{
+			auto const& node = m_pDoc->m_nodes[child.m_idx];
+			if (node.bKeyEscaped ? unescape(child.key()) == key : child.key() == key)
+			{
+				return child;
+			}
+		}
+	}
+	return {};
+}
+
+Value::Iter Value::begin() const
+{
+	if (!m_pDoc || m_pDoc->m_nodes[m_idx].childCount == 0)
+	{
+		return {};
+	}
+	return Iter(Value(*m_pDoc, m_pDoc->m_nodes[m_idx].firstChild));
+}
+
+Value::Iter Value::end() const
+{
+	return {};
+}
+
+bool operator==(Value const& lhs, Value const& rhs)
+{
+	return lhs.m_pDoc == rhs.m_pDoc && lhs.m_idx == rhs.m_idx;
+}
+
+bool operator!=(Value const& lhs, Value const& rhs)
+{
+	return !(lhs == rhs);
+}
+
+Value::Iter::Iter(Value value) : m_value(value) {}
+
+Value const& Value::Iter::operator*() const
+{
+	return m_value;
+}
+
+Value const* Value::Iter::operator->() const
+{
+	return &m_value;
+}
+
+Value::Iter& Value::Iter::operator++()
+{
+	u32 const next = m_value.m_pDoc->m_nodes[m_value.m_idx].next;
+	m_value = next == 0 ? Value() : Value(*m_value.m_pDoc, next);
+	return *this;
+}
+
+bool Value::Iter::operator==(Iter const& rhs) const
+{
+	return m_value == rhs.m_value;
+}
+
+bool Value::Iter::operator!=(Iter const& rhs) const
+{
+	return !(*this == rhs);
+}
+
+Document::Document(std::string source)
+{
+	parse(std::move(source));
+}
+
+bool Document::parse(std::string source)
+{
+	clear();
+	m_source = std::move(source);
+	return parse();
+}
+
+bool Document::parse(std::string_view text, std::shared_ptr<void const> token)
+{
+	clear();
+	m_external = text;
+	m_token = std::move(token);
+	m_bExternal = true;
+	return parse();
+}
+
+void Document::clear()
+{
+	m_source.clear();
+	m_external = {};
+	m_token.reset();
+	m_bExternal = false;
+	m_nodes.clear();
+	m_error.clear();
+	return;
+}
+
+std::string_view Document::text() const
+{
+	// m_external is never set to point into m_source: copies / moves of a Document stay valid
+	return m_bExternal ? m_external : std::string_view(m_source);
+}
+
+bool Document::parse()
+{
+	// Rough upper bound on node count: avoids most reallocations for dense data (eg font glyph tables)
+	m_nodes.reserve(text().size() / 8 + 1);
+	Parser parser(*this);
+	if (!parser.parse())
+	{
+		m_nodes.clear();
+		return false;
+	}
+	return true;
+}
+
+Value Document::root() const
+{
+	return m_nodes.empty() ? Value() : Value(*this, 0);
+}
+
+std::string_view Document::error() const
+{
+	return m_error;
+}
+
+std::string unescape(std::string_view escaped)
+{
+	std::string ret;
+	ret.reserve(escaped.size());
+	for (size_t i = 0; i < escaped.size(); ++i)
+	{
+		char const c = escaped[i];
+		if (c != '\\' || i + 1 >= escaped.size())
+		{
+			ret += c;
+			continue;
+		}
+		char const e = escaped[++i];
+		switch (e)
+		{
+		case 'b':
+			ret += '\b';
+			break;
+		case 'f':
+			ret += '\f';
+			break;
+		case 'n':
+			ret += '\n';
+			break;
+		case 'r':
+			ret += '\r';
+			break;
+		case 't':
+			ret += '\t';
+			break;
+		case 'u':
+		{
+			u32 codepoint = 0;
+			if (!parseHex4(escaped, i + 1, codepoint))
+			{
+				ret += e;
+				break;
+			}
+			i += 4;
+			// Surrogate pair
+			u32 low = 0;
+			if (codepoint >= 0xd800 && codepoint < 0xdc00 && i + 2 < escaped.size() && escaped[i + 1] == '\\' && escaped[i + 2] == 'u'
+				&& parseHex4(escaped, i + 3, low) && low >= 0xdc00 && low < 0xe000)
+			{
+				codepoint = 0x10000 + ((codepoint - 0xd800) << 10) + (low - 0xdc00);
+				i += 6;
+			}
+			appendUTF8(ret, codepoint);
+			break;
+		}
+		default:
+			// \" \\ \/ (and anything unknown) map to the character itself
+			ret += e;
+			break;
+		}
+	}
+	return ret;
+}
+} // namespace le::json
@@ -0,0 +1,202 @@
+#include <cstring>
+#include <vector>
+#include "core/lz4.hpp"
+
+namespace le
+{
+namespace
+{
+constexpr size_t g_minMatch = 4;
+// Block format end conditions: the last 5 bytes are literals, and the last match starts at least 12 bytes before the end
+constexpr size_t g_lastLiterals = 5;
+constexpr size_t g_matchStartLimit = 12;
+constexpr size_t g_maxOffset = 0xffff;
+constexpr u32 g_hashBits = 16;
+
+u32 read32(u8 const* pData)
+{
+	u32 ret;
+	std::memcpy(&ret, pData, sizeof(ret));
+	return ret;
+}
+
+u32 hash(u32 sequence)
+{
+	return (sequence * 2654435761U) >> (32 - g_hashBits);
+}
+
+// Writes the 255-run continuation of a length whose 4-bit token field saturated
+u8* writeLength(u8* pOut, size_t length)
+{
+	for (; length >= 255; length -= 255)
+	{
+		*pOut++ = 255;
+	}
+	*pOut++ = (u8)length;
+	return pOut;
+}
+
+// Emits one sequence: literals, then a match (skipped if matchLength is 0: the last sequence)
+// Returns nullptr if it does not fit
+u8* writeSequence(u8* pOut, u8 const* pOutEnd, u8 const* pLiterals, size_t literalCount, size_t offset, size_t matchLength)
+{
+	size_t const needed = 1 + literalCount + literalCount / 255 + 1 + (matchLength > 0 ? 2 + matchLength / 255 + 1 : 0);
+	if ((size_t)(pOutEnd - pOut) < needed)
+	{
+		return nullptr;
+	}
+	size_t const matchCode = matchLength > 0 ? matchLength - g_minMatch : 0;
+	u8* pToken = pOut++;
+	*pToken = (u8)(((literalCount < 15 ? literalCount : 15) << 4) | (matchCode < 15 ? matchCode : 15));
+	if (literalCount >= 15)
+	{
+		pOut = writeLength(pOut, literalCount - 15);
+	}
+	if (literalCount > 0)
+	{
+		std::memcpy(pOut, pLiterals, literalCount);
+		pOut += literalCount;
+	}
+	if (matchLength > 0)
+	{
+		*pOut++ = (u8)(offset & 0xff);
+		*pOut++ = (u8)(offset >> 8);
+		if (matchCode >= 15)
+		{
+			pOut = writeLength(pOut, matchCode - 15);
+		}
+	}
+	return pOut;
+}
+
+// Reads the 255-run continuation of a saturated length; returns false if the input ends first
+bool readLength(u8 const*& pIn, u8 const* pInEnd, size_t& outLength)
+{
+	u8 byte;
+	do
+	{
+		if (pIn >= pInEnd)
+		{
+			return false;
+		}
+		byte = *pIn++;
+		outLength += byte;
+	} while (byte == 255);
+	return true;
+}
+} // namespace
+
+size_t lz4::compressBound(size_t inSize)
+{
+	return inSize + inSize / 255 + 16;
+}
+
+size_t lz4::compress(u8 const* pIn, size_t inSize, u8* pOut, size_t outCapacity)
+{
+	u8* pDst = pOut;
+	u8 const* pDstEnd = pOut + outCapacity;
+	size_t anchor = 0;
+	if (inSize > g_matchStartLimit)
+	{
+		// Greedy single-probe matcher: positions of the last sequence seen per hash bucket
+		std::vector<u32> table((size_t)1 << g_hashBits, 0);
+		size_t const matchEnd = inSize - g_lastLiterals;
+		size_t const startEnd = inSize - g_matchStartLimit + 1;
+		size_t pos = 0;
+		while (pos < startEnd)
+		{
+			u32 const sequence = read32(pIn + pos);
+			u32& entry = table[hash(sequence)];
+			size_t match = entry;
+			entry = (u32)pos;
+			if (match >= pos || pos - match > g_maxOffset || read32(pIn + match) != sequence)
+			{
+				++pos;
+				continue;
+			}
+			size_t length = g_minMatch;
+			while (pos + length < matchEnd && pIn[match + length] == pIn[pos + length])
+			{
+				++length;
+			}
+			while (pos > anchor && match > 0 && pIn[pos - 1] == pIn[match - 1])
+			{
+				--pos;
+				--match;
+				++length;
+			}
+			pDst = writeSequence(pDst, pDstEnd, pIn + anchor, pos - anchor, pos - match, length);
+			if (!pDst)
+			{
+				return 0;
+			}
+			pos += length;
+			anchor = pos;
+		}
+	}
+	pDst = writeSequence(pDst, pDstEnd, pIn + anchor, inSize - anchor, 0, 0);
+	return pDst ? (size_t)(pDst - pOut) : 0;
+}
+
+bool lz4::decompress(u8 const* pIn, size_t inSize, u8* pOut, size_t outSize)
+{
+	u8 const* pInEnd = pIn + inSize;
+	u8* const pOutStart = pOut;
+	u8* const pOutEnd = pOut + outSize;
+	while (pIn < pInEnd)
+	{
+		u8 const token = *pIn++;
+		size_t literalCount = token >> 4;
+		if (literalCount == 15 && !readLength(pIn, pInEnd, literalCount))
+		{
+			return false;
+		}
+		if (literalCount > (size_t)(pInEnd - pIn) || literalCount > (size_t)(pOutEnd - pOut))
+		{
+			return false;
+		}
+		if (literalCount > 0)
+		{
+			std::memcpy(pOut, pIn, literalCount);
+			pIn += literalCount;
+			pOut += literalCount;
+		}
+		if (pIn == pInEnd)
+		{
+			// The last sequence has no match
+			return pOut == pOutEnd;
+		}
+		if (pInEnd - pIn < 2)
+		{
+			return false;
+		}
+		size_t const offset = (size_t)pIn[0] | ((size_t)pIn[1] << 8);
+		pIn += 2;
+		size_t length = token & 0xf;
+		if (length == 15 && !readLength(pIn, pInEnd, length))
+		{
+			return false;
+		}
+		length += g_minMatch;
+		if (offset == 0 || offset > (size_t)(pOut - pOutStart) || length > (size_t)(pOutEnd - pOut))
+		{
+			return false;
+		}
+		u8 const* pMatch = pOut - offset;
+		if (offset >= length)
+		{
+			std::memcpy(pOut, pMatch, length);
+			pOut += length;
+		}
+		else
+		{
+			// Overlapping copy repeats the last offset bytes
+			for (size_t idx = 0; idx < length; ++idx)
+			{
+				*pOut++ = pMatch[idx];
+			}
+		}
+	}
+	return false;
+}
+} // namespace le
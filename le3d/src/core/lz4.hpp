@@ -0,0 +1,15 @@
+#pragma once
+#include "le3d/core/std_types.hpp"
+
+namespace le::lz4
+{
+// Worst case size of an LZ4 block holding inSize bytes
+size_t compressBound(size_t inSize);
+
+// Compresses into a raw LZ4 block (no frame / checksum); returns the compressed size, or 0 if it does not fit in outCapacity
+size_t compress(u8 const* pIn, size_t inSize, u8* pOut, size_t outCapacity);
+
+// Decompresses a raw LZ4 block into exactly outSize bytes
+// Returns false on malformed / truncated input or a size mismatch; never reads or writes out of bounds
+bool decompress(u8 const* pIn, size_t inSize, u8* pOut, size_t outSize);
+} // namespace le::lz4
@@ -0,0 +1,418 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+#include <unordered_set>
+#include "le3d/core/log.hpp"
+#include "le3d/core/pack.hpp"
+#include "inflate.hpp"
+#include "io_impl.hpp"
+#include "lz4.hpp"
+
+namespace le
+{
+namespace
+{
+constexpr u32 MAGIC = 0x4b50454c; // "LEPK"
+constexpr u32 VERSION = 1;
+
+// Layout (host byte order, like the mesh cache):
+//	Header | Record x entryCount, sorted by (pathHash, path) | path pool | blobs, each aligned to Header::alignment
+struct Header final
+{
+	u32 magic = MAGIC;
+	u32 version = VERSION;
+	u32 entryCount = 0;
+	u32 namesSize = 0;
+	// CRC-32 of the records and path pool
+	u32 indexChecksum = 0;
+	u32 alignment = 0;
+	u64 dataOffset = 0;
+};
+static_assert(sizeof(Header) == 32, "Invalid Header size!");
+
+struct Record final
+{
+	u64 pathHash = 0;
+	u64 offset = 0;
+	u64 size = 0;
+	u64 rawSize = 0;
+	// CRC-32 of the uncompressed bytes
+	u32 checksum = 0;
+	u32 nameOffset = 0;
+	u16 nameSize = 0;
+	u8 compression = 0;
+	u8 padding[5] = {};
+};
+static_assert(sizeof(Record) == 48, "Invalid Record size!");
+
+u64 pathHash(std::string_view path)
+{
+	// FNV-1a
+	u64 hash = 14695981039346656037ULL;
+	for (char c : path)
+	{
+		hash ^= (u8)c;
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+Record record(std::byte const* pRecords, u32 idx)
+{
+	Record ret;
+	std::memcpy(&ret, pRecords + (size_t)idx * sizeof(Record), sizeof(Record));
+	return ret;
+}
+
+// Checks everything lookups rely on, so that reads need no further bounds checks
+bool validate(ByteView const& bytes, Header& outHeader)
+{
+	if (bytes.size < sizeof(Header))
+	{
+		return false;
+	}
+	std::memcpy(&outHeader, bytes.pData, sizeof(Header));
+	u64 const indexSize = (u64)outHeader.entryCount * sizeof(Record) + outHeader.namesSize;
+	if (outHeader.magic != MAGIC || outHeader.version != VERSION || indexSize > bytes.size - sizeof(Header))
+	{
+		return false;
+	}
+	auto const pIndex = reinterpret_cast<u8 const*>(bytes.pData + sizeof(Header));
+	if (inflate::crc32(pIndex, (size_t)indexSize) != outHeader.indexChecksum)
+	{
+		return false;
+	}
+	auto const pRecords = bytes.pData + sizeof(Header);
+	u64 prevHash = 0;
+	for (u32 idx = 0; idx < outHeader.entryCount; ++idx)
+	{
+		auto const entry = record(pRecords, idx);
+		if (entry.pathHash < prevHash || (u64)entry.nameOffset + entry.nameSize > outHeader.namesSize || entry.offset > bytes.size
+			|| bytes.size - entry.offset < entry.size || entry.compression >= (u8)pack::Compression::COUNT_
+			|| (entry.compression == (u8)pack::Compression::None && entry.size != entry.rawSize))
+		{
+			return false;
+		}
+		prevHash = entry.pathHash;
+	}
+	return true;
+}
+
+u64 align(u64 offset, u32 alignment)
+{
+	return (offset + alignment - 1) & ~(u64)(alignment - 1);
+}
+
+bool readInput(pack::Input const& input, bytearray& out)
+{
+	std::ifstream file(input.file, std::ios::binary | std::ios::ate);
+	if (!file.good())
+	{
+		return false;
+	}
+	auto const size = file.tellg();
+	out = bytearray((size_t)size);
+	file.seekg(0, std::ios::beg);
+	return (bool)file.read((char*)out.data(), (std::streamsize)size);
+}
+} // namespace
+
+struct PackReader::Pack final
+{
+	ByteView bytes;
+	std::byte const* pRecords = nullptr;
+	char const* pNames = nullptr;
+	u32 entryCount = 0;
+};
+
+struct PackReader::Entry final
+{
+	u64 offset = 0;
+	u64 size = 0;
+	u64 rawSize = 0;
+	u32 checksum = 0;
+	pack::Compression compression = pack::Compression::None;
+};
+
+PackReader::PackReader(stdfs::path packPath, stdfs::path idPrefix /* = "" */)
+	: IOReader(std::move(idPrefix)), m_packPath(std::move(packPath))
+{
+	m_medium = "Pack (";
+	m_medium += std::move(m_packPath.generic_string());
+	m_medium += ")";
+	std::error_code errCode;
+	auto const size = stdfs::is_regular_file(m_packPath) ? (size_t)stdfs::file_size(m_packPath, errCode) : 0;
+	if (size == 0 || errCode)
+	{
+		LOG_E("[%s] [%s] not found on Filesystem!", typeName<PackReader>().data(), m_packPath.generic_string().data());
+		return;
+	}
+	auto pPack = std::make_shared<Pack>();
+	// Faults the whole pack in up front: a few large sequential reads instead of one per entry
+	pPack->bytes = ioImpl::mapFile(m_packPath, size);
+	if (pPack->bytes.empty())
+	{
+		LOG_W("[%s] Failed to map [%s], reading instead", typeName<PackReader>().data(), m_packPath.generic_string().data());
+		pPack->bytes = ioImpl::readFile(m_packPath, size);
+	}
+	Header header;
+	if (!validate(pPack->bytes, header))
+	{
+		LOG_E("[%s] [%s] is not a valid pack!", typeName<PackReader>().data(), m_packPath.generic_string().data());
+		return;
+	}
+	pPack->pRecords = pPack->bytes.pData + sizeof(Header);
+	pPack->pNames = reinterpret_cast<char const*>(pPack->pRecords + (size_t)header.entryCount * sizeof(Record));
+	pPack->entryCount = header.entryCount;
+	LOG_D("[%s] [%s] pack mapped (%u entries), idPrefix: [%s]", typeName(*this).data(), m_packPath.generic_string().data(), header.entryCount,
+		  m_prefix.generic_string().data());
+	m_pPack = std::move(pPack);
+}
+
+bool PackReader::isPresent(stdfs::path const& id) const
+{
+	Entry entry;
+	return find(id, entry);
+}
+
+std::stringstream PackReader::getStr(stdfs::path const& id) const
+{
+	std::stringstream buf;
+	auto const view = getView(id);
+	buf.write(reinterpret_cast<char const*>(view.pData), (std::streamsize)view.size);
+	return buf;
+}
+
+bytearray PackReader::getBytes(stdfs::path const& id) const
+{
+	bytearray buf;
+	Entry entry;
+	if (!find(id, entry))
+	{
+		LOG_E("!! [%s] not found in %s!", id.generic_string().data(), m_medium.data());
+	}
+	else if (entry.compression == pack::Compression::None)
+	{
+		buf = slice(entry, id).bytes();
+	}
+	else if (!decompress(entry, buf, id))
+	{
+		buf.clear();
+	}
+	return buf;
+}
+
+ByteView PackReader::getView(stdfs::path const& id) const
+{
+	ByteView ret;
+	Entry entry;
+	if (!find(id, entry))
+	{
+		LOG_E("!! [%s] not found in %s!", id.generic_string().data(), m_medium.data());
+	}
+	else if (entry.compression == pack::Compression::None)
+	{
+		ret = slice(entry, id);
+	}
+	else
+	{
+		bytearray buf;
+		if (decompress(entry, buf, id))
+		{
+			ret = ByteView::from(std::move(buf));
+		}
+	}
+	return ret;
+}
+
+bool PackReader::find(stdfs::path const& id, Entry& outEntry) const
+{
+	if (!m_pPack)
+	{
+		return false;
+	}
+	auto const& packData = *m_pPack;
+	auto const path = (m_prefix / id).generic_string();
+	u64 const hash = pathHash(path);
+	// Lower bound of hash; colliding paths are adjacent
+	u32 first = 0;
+	u32 count = packData.entryCount;
+	while (count > 0)
+	{
+		u32 const half = count / 2;
+		if (record(packData.pRecords, first + half).pathHash < hash)
+		{
+			first += half + 1;
+			count -= half + 1;
+		}
+		else
+		{
+			count = half;
+		}
+	}
+	for (; first < packData.entryCount; ++first)
+	{
+		auto const entry = record(packData.pRecords, first);
+		if (entry.pathHash != hash)
+		{
+			break;
+		}
+		if (std::string_view(packData.pNames + entry.nameOffset, entry.nameSize) == path)
+		{
+			outEntry.offset = entry.offset;
+			outEntry.size = entry.size;
+			outEntry.rawSize = entry.rawSize;
+			outEntry.checksum = entry.checksum;
+			outEntry.compression = (pack::Compression)entry.compression;
+			return true;
+		}
+	}
+	return false;
+}
+
+ByteView PackReader::slice(Entry const& entry, stdfs::path const& id) const
+{
+	ByteView ret;
+	ret.pData = m_pPack->bytes.pData + entry.offset;
+	ret.size = (size_t)entry.size;
+#if defined(LE3D_DEBUG)
+	// Release builds trust stored entries: checking them would touch every page of every view
+	if (inflate::crc32(reinterpret_cast<u8 const*>(ret.pData), ret.size) != entry.checksum)
+	{
+		LOG_E("[%s] [%s] Corrupt data in %s!", typeName<PackReader>().data(), id.generic_string().data(), m_medium.data());
+		return {};
+	}
+#else
+	(void)id;
+#endif
+	ret.token = m_pPack->bytes.token;
+	return ret;
+}
+
+bool PackReader::decompress(Entry const& entry, bytearray& out, stdfs::path const& id) const
+{
+	out = bytearray((size_t)entry.rawSize);
+	auto const pOut = reinterpret_cast<u8*>(out.data());
+	auto const pIn = reinterpret_cast<u8 const*>(m_pPack->bytes.pData + entry.offset);
+	if (!lz4::decompress(pIn, (size_t)entry.size, pOut, out.size()) || inflate::crc32(pOut, out.size()) != entry.checksum)
+	{
+		LOG_E("[%s] [%s] Corrupt data in %s!", typeName<PackReader>().data(), id.generic_string().data(), m_medium.data());
+		return false;
+	}
+	return true;
+}
+
+bool pack::write(stdfs::path const& packPath, std::vector<Input> const& inputs, Options const& options)
+{
+	if (options.alignment == 0 || (options.alignment & (options.alignment - 1)) != 0)
+	{
+		LOG_E("[%s] Invalid alignment: %u (must be a power of two)", typeName<PackReader>().data(), options.alignment);
+		return false;
+	}
+	Header header;
+	header.entryCount = (u32)inputs.size();
+	header.alignment = options.alignment;
+	std::vector<Record> records(inputs.size());
+	std::string names;
+	std::unordered_set<std::string_view> ids;
+	for (size_t idx = 0; idx < inputs.size(); ++idx)
+	{
+		auto const& id = inputs[idx].id;
+		if (id.empty() || id.size() > 0xffff || !ids.insert(id).second)
+		{
+			LOG_E("[%s] Invalid or duplicate id: [%s]", typeName<PackReader>().data(), id.data());
+			return false;
+		}
+		records[idx].pathHash = pathHash(id);
+		records[idx].nameOffset = (u32)names.size();
+		records[idx].nameSize = (u16)id.size();
+		names += id;
+	}
+	header.namesSize = (u32)names.size();
+	header.dataOffset = align(sizeof(Header) + records.size() * sizeof(Record) + names.size(), options.alignment);
+	auto tempPath = packPath;
+	tempPath += ".tmp";
+	std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+	if (!file.good())
+	{
+		LOG_E("[%s] Failed to open [%s] for writing", typeName<PackReader>().data(), tempPath.generic_string().data());
+		return false;
+	}
+	// Blobs first (in input order), then the index once every offset is known
+	std::vector<char> const padding(options.alignment, 0);
+	u64 offset = header.dataOffset;
+	u64 rawTotal = 0;
+	file.seekp((std::streamoff)offset);
+	bytearray raw;
+	bytearray compressed;
+	for (size_t idx = 0; idx < inputs.size(); ++idx)
+	{
+		auto& entry = records[idx];
+		if (!readInput(inputs[idx], raw))
+		{
+			LOG_E("[%s] Failed to read [%s]", typeName<PackReader>().data(), inputs[idx].file.generic_string().data());
+			return false;
+		}
+		auto const pRaw = reinterpret_cast<u8 const*>(raw.data());
+		entry.rawSize = entry.size = raw.size();
+		entry.checksum = inflate::crc32(pRaw, raw.size());
+		entry.offset = offset;
+		entry.compression = (u8)Compression::None;
+		bytearray const* pBlob = &raw;
+		if (options.bCompress && !raw.empty())
+		{
+			compressed.resize(lz4::compressBound(raw.size()));
+			size_t const size = lz4::compress(pRaw, raw.size(), reinterpret_cast<u8*>(compressed.data()), compressed.size());
+			if (size > 0 && size <= raw.size() - raw.size() / 8)
+			{
+				compressed.resize(size);
+				entry.size = size;
+				entry.compression = (u8)Compression::LZ4;
+				pBlob = &compressed;
+			}
+		}
+		file.write((char const*)pBlob->data(), (std::streamsize)pBlob->size());
+		u64 const next = align(offset + entry.size, options.alignment);
+		file.write(padding.data(), (std::streamsize)(next - offset - entry.size));
+		offset = next;
+		rawTotal += entry.rawSize;
+	}
+	std::sort(records.begin(), records.end(), [&names](Record const& lhs, Record const& rhs) {
+		if (lhs.pathHash != rhs.pathHash)
+		{
+			return lhs.pathHash < rhs.pathHash;
+		}
+		return names.compare(lhs.nameOffset, lhs.nameSize, names, rhs.nameOffset, rhs.nameSize) < 0;
+	});
+	bytearray index(records.size() * sizeof(Record) + names.size());
+	if (!records.empty())
+	{
+		std::memcpy(index.data(), records.data(), records.size() * sizeof(Record));
+	}
+	if (!names.empty())
+	{
+		std::memcpy(index.data() + records.size() * sizeof(Record), names.data(), names.size());
+	}
+	header.indexChecksum = inflate::crc32(reinterpret_cast<u8 const*>(index.data()), index.size());
+	file.seekp(0);
+	file.write((char const*)&header, sizeof(Header));
+	file.write((char const*)index.data(), (std::streamsize)index.size());
+	file.close();
+	if (!file.good())
+	{
+		LOG_E("[%s] Failed to write [%s]", typeName<PackReader>().data(), tempPath.generic_string().data());
+		return false;
+	}
+	std::error_code errCode;
+	stdfs::rename(tempPath, packPath, errCode);
+	if (errCode)
+	{
+		LOG_E("[%s] Failed to write [%s]", typeName<PackReader>().data(), packPath.generic_string().data());
+		return false;
+	}
+	LOG_I("[%s] [%s] Packed %u entries: %u KiB => %u KiB", typeName<PackReader>().data(), packPath.generic_string().data(), header.entryCount,
+		  (u32)(rawTotal >> 10), (u32)(offset >> 10));
+	return true;
+}
+} // namespace le
@@ -0,0 +1,295 @@
+#include "le3d/core/assert.hpp"
+#include "le3d/core/range_allocator.hpp"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace le
+{
+namespace
+{
+constexpr u32 g_mantissaBits = 3;
+constexpr u32 g_mantissaValue = 1 << g_mantissaBits;
+constexpr u32 g_mantissaMask = g_mantissaValue - 1;
+
+u32 lowestBit(u32 value)
+{
+#if defined(_MSC_VER)
+	unsigned long ret = 0;
+	_BitScanForward(&ret, value);
+	return (u32)ret;
+#else
+	return (u32)__builtin_ctz(value);
+#endif
+}
+
+u32 highestBit(u32 value)
+{
+#if defined(_MSC_VER)
+	unsigned long ret = 0;
+	_BitScanReverse(&ret, value);
+	return (u32)ret;
+#else
+	return 31 - (u32)__builtin_clz(value);
+#endif
+}
+
+// Largest bin whose minimum size is <= size (free ranges are filed here)
+u32 binFloor(u32 size)
+{
+	if (size < g_mantissaValue)
+	{
+		return size;
+	}
+	u32 const mantissaStart = highestBit(size) - g_mantissaBits;
+	u32 const exponent = mantissaStart + 1;
+	u32 const mantissa = (size >> mantissaStart) & g_mantissaMask;
+	return (exponent << g_mantissaBits) | mantissa;
+}
+
+// Smallest bin whose every range is >= size (requests are served from here up)
+u32 binCeil(u32 size)
+{
+	if (size < g_mantissaValue)
+	{
+		return size;
+	}
+	u32 const mantissaStart = highestBit(size) - g_mantissaBits;
+	u32 const exponent = mantissaStart + 1;
+	u32 const mantissa = (size >> mantissaStart) & g_mantissaMask;
+	u32 const lowMask = (1U << mantissaStart) - 1;
+	// A carry into the exponent is just the next bin
+	return ((exponent << g_mantissaBits) | mantissa) + ((size & lowMask) ? 1 : 0);
+}
+
+u32 binSize(u32 bin)
+{
+	u32 const exponent = bin >> g_mantissaBits;
+	u32 const mantissa = bin & g_mantissaMask;
+	return exponent == 0 ? mantissa : (mantissa | g_mantissaValue) << (exponent - 1);
+}
+} // namespace
+
+bool RangeAllocator::Allocation::isValid() const
+{
+	return node != s_invalid;
+}
+
+RangeAllocator::RangeAllocator(u32 capacity)
+{
+	reset(capacity);
+}
+
+void RangeAllocator::reset(u32 capacity)
+{
+	m_nodes.clear();
+	m_unusedNodes.clear();
+	m_binHeads.fill(s_invalid);
+	m_leafMasks.fill(0);
+	m_topMask = 0;
+	m_capacity = m_free = capacity;
+	m_allocations = 0;
+	if (capacity > 0)
+	{
+		insertFree(newNode(0, capacity, s_invalid, s_invalid));
+	}
+	return;
+}
+
+RangeAllocator::Allocation RangeAllocator::allocate(u32 size)
+{
+	Allocation ret;
+	if (size == 0 || size > m_free)
+	{
+		return ret;
+	}
+	u32 const minBin = binCeil(size);
+	if (minBin >= s_binCount)
+	{
+		return ret;
+	}
+	// First non-empty bin at or above minBin: in minBin's leaf row, else the lowest leaf of the next non-empty row
+	u32 const minTop = minBin / s_leafBins;
+	u32 bin = s_invalid;
+	u32 const leaves = m_leafMasks[minTop] & (0xffU << (minBin % s_leafBins));
+	if (leaves != 0)
+	{
+		bin = minTop * s_leafBins + lowestBit(leaves);
+	}
+	else if (minTop + 1 < s_topBins)
+	{
+		u32 const tops = m_topMask & (0xffffffffU << (minTop + 1));
+		if (tops != 0)
+		{
+			u32 const top = lowestBit(tops);
+			bin = top * s_leafBins + lowestBit(m_leafMasks[top]);
+		}
+	}
+	if (bin == s_invalid)
+	{
+		return ret;
+	}
+	u32 const nodeIdx = m_binHeads[bin];
+	removeFree(nodeIdx);
+	Node& node = m_nodes[nodeIdx];
+	u32 const remainder = node.size - size;
+	node.size = size;
+	node.bUsed = true;
+	if (remainder > 0)
+	{
+		u32 const offset = node.offset + size;
+		u32 const next = node.next;
+		u32 const split = newNode(offset, remainder, nodeIdx, next);
+		if (next != s_invalid)
+		{
+			m_nodes[next].prev = split;
+		}
+		m_nodes[nodeIdx].next = split;
+		insertFree(split);
+	}
+	m_free -= size;
+	++m_allocations;
+	ret.offset = m_nodes[nodeIdx].offset;
+	ret.node = nodeIdx;
+	return ret;
+}
+
+void RangeAllocator::release(Allocation allocation)
+{
+	if (!allocation.isValid())
+	{
+		return;
+	}
+	ASSERT(allocation.node < m_nodes.size() && m_nodes[allocation.node].bUsed, "Invalid allocation!");
+	u32 nodeIdx = allocation.node;
+	m_free += m_nodes[nodeIdx].size;
+	--m_allocations;
+	m_nodes[nodeIdx].bUsed = false;
+	// Coalesce with free neighbours
+	u32 const prev = m_nodes[nodeIdx].prev;
+	if (prev != s_invalid && !m_nodes[prev].bUsed)
+	{
+		removeFree(prev);
+		m_nodes[prev].size += m_nodes[nodeIdx].size;
+		m_nodes[prev].next = m_nodes[nodeIdx].next;
+		if (m_nodes[prev].next != s_invalid)
+		{
+			m_nodes[m_nodes[prev].next].prev = prev;
+		}
+		m_unusedNodes.push_back(nodeIdx);
+		nodeIdx = prev;
+	}
+	u32 const next = m_nodes[nodeIdx].next;
+	if (next != s_invalid && !m_nodes[next].bUsed)
+	{
+		removeFree(next);
+		m_nodes[nodeIdx].size += m_nodes[next].size;
+		m_nodes[nodeIdx].next = m_nodes[next].next;
+		if (m_nodes[nodeIdx].next != s_invalid)
+		{
+			m_nodes[m_nodes[nodeIdx].next].prev = nodeIdx;
+		}
+		m_unusedNodes.push_back(next);
+	}
+	insertFree(nodeIdx);
+	return;
+}
+
+u32 RangeAllocator::capacity() const
+{
+	return m_capacity;
+}
+
+u32 RangeAllocator::freeSpace() const
+{
+	return m_free;
+}
+
+u32 RangeAllocator::allocationCount() const
+{
+	return m_allocations;
+}
+
+u32 RangeAllocator::sizeOf(Allocation allocation) const
+{
+	return allocation.isValid() ? m_nodes[allocation.node].size : 0;
+}
+
+u32 RangeAllocator::largestFree() const
+{
+	if (m_topMask == 0)
+	{
+		return 0;
+	}
+	u32 const top = highestBit(m_topMask);
+	u32 const bin = top * s_leafBins + highestBit(m_leafMasks[top]);
+	// Every range in bin is at least binSize(bin); only requests rounding up into it are guaranteed to succeed
+	return binSize(bin);
+}
+
+u32 RangeAllocator::newNode(u32 offset, u32 size, u32 prev, u32 next)
+{
+	u32 idx = 0;
+	if (!m_unusedNodes.empty())
+	{
+		idx = m_unusedNodes.back();
+		m_unusedNodes.pop_back();
+	}
+	else
+	{
+		idx = (u32)m_nodes.size();
+		m_nodes.push_back({});
+	}
+	Node& node = m_nodes[idx];
+	node = Node();
+	node.offset = offset;
+	node.size = size;
+	node.prev = prev;
+	node.next = next;
+	return idx;
+}
+
+void RangeAllocator::insertFree(u32 nodeIdx)
+{
+	Node& node = m_nodes[nodeIdx];
+	u32 const bin = binFloor(node.size);
+	node.binPrev = s_invalid;
+	node.binNext = m_binHeads[bin];
+	if (node.binNext != s_invalid)
+	{
+		m_nodes[node.binNext].binPrev = nodeIdx;
+	}
+	m_binHeads[bin] = nodeIdx;
+	m_leafMasks[bin / s_leafBins] |= (u8)(1U << (bin % s_leafBins));
+	m_topMask |= 1U << (bin / s_leafBins);
+	return;
+}
+
+void RangeAllocator::removeFree(u32 nodeIdx)
+{
+	Node& node = m_nodes[nodeIdx];
+	u32 const bin = binFloor(node.size);
+	if (node.binPrev != s_invalid)
+	{
+		m_nodes[node.binPrev].binNext = node.binNext;
+	}
+	else
+	{
+		m_binHeads[bin] = node.binNext;
+	}
+	if (node.binNext != s_invalid)
+	{
+		m_nodes[node.binNext].binPrev = node.binPrev;
+	}
+	node.binPrev = node.binNext = s_invalid;
+	if (m_binHeads[bin] == s_invalid)
+	{
+		m_leafMasks[bin / s_leafBins] &= (u8)~(1U << (bin % s_leafBins));
+		if (m_leafMasks[bin / s_leafBins] == 0)
+		{
+			m_topMask &= ~(1U << (bin / s_leafBins));
+		}
+	}
+	return;
+}
+} // namespace le
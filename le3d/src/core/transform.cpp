@@ -1,9 +1,14 @@
 #include <algorithm>
-#include <glm/gtx/matrix_decompose.hpp>
+#include <atomic>
 #include "le3d/core/transform.hpp"
 
 namespace le
 {
+namespace
+{
+std::atomic<u32> g_hierarchyVersion = 0;
+}
+
 Transform::Transform() = default;
 Transform::Transform(Transform&&) = default;
 Transform& Transform::operator=(Transform&&) = default;
@@ -11,39 +16,42 @@ Transform::~Transform()
 {
 	if (m_pParent)
 	{
-		m_pParent->m_children.remove(this);
+		auto& siblings = m_pParent->m_children;
+		siblings.erase(std::remove(siblings.begin(), siblings.end(), this), siblings.end());
 	}
 	for (auto pChild : m_children)
 	{
 		pChild->m_pParent = nullptr;
+		pChild->setDirty();
 	}
+	++g_hierarchyVersion;
 }
 
 Transform& Transform::setPosition(glm::vec3 position)
 {
 	m_position = position;
-	m_bDirty = true;
+	setDirty();
 	return *this;
 }
 
 Transform& Transform::setOrientation(glm::quat orientation)
 {
 	m_orientation = orientation;
-	m_bDirty = true;
+	setDirty();
 	return *this;
 }
 
 Transform& Transform::setScale(f32 scale)
 {
 	m_scale = {scale, scale, scale};
-	m_bDirty = true;
+	setDirty();
 	return *this;
 }
 
 Transform& Transform::setScale(glm::vec3 scale)
 {
 	m_scale = scale;
-	m_bDirty = true;
+	setDirty();
 	return *this;
 }
 
@@ -51,13 +59,16 @@ Transform& Transform::setParent(Transform* pParent)
 {
 	if (m_pParent)
 	{
-		m_pParent->m_children.remove(this);
+		auto& siblings = m_pParent->m_children;
+		siblings.erase(std::remove(siblings.begin(), siblings.end(), this), siblings.end());
 	}
 	m_pParent = pParent;
 	if (m_pParent)
 	{
 		m_pParent->m_children.push_back(this);
 	}
+	setDirty();
+	++g_hierarchyVersion;
 	return *this;
 }
 
@@ -88,46 +99,85 @@ glm::vec3 Transform::worldPos() const
 
 glm::quat Transform::worldOrn() const
 {
-	glm::vec3 pos;
-	glm::quat orn;
-	glm::vec3 scl;
-	glm::vec3 skw;
-	glm::vec4 psp;
-	glm::decompose(model(), scl, orn, pos, skw, psp);
-	return glm::conjugate(orn);
+	updateWorld();
+	return m_worldOrn;
 }
 
 glm::vec3 Transform::worldScl() const
 {
-	glm::vec3 pos;
-	glm::quat orn;
-	glm::vec3 scl;
-	glm::vec3 skw;
-	glm::vec4 psp;
-	glm::decompose(model(), scl, orn, pos, skw, psp);
-	return scl;
+	updateWorld();
+	return m_worldScl;
 }
 
 glm::mat4 Transform::model() const
 {
-	if (m_bDirty || m_pParent)
+	updateWorld();
+	return m_world;
+}
+
+glm::mat4 Transform::normalModel() const
+{
+	updateWorld();
+	return m_normal;
+}
+
+Transform const* Transform::parent() const
+{
+	return m_pParent;
+}
+
+bool Transform::isDirty() const
+{
+	return m_bDirty;
+}
+
+void Transform::updateWorld() const
+{
+	if (m_bDirty)
 	{
-		m_mat = m_pParent ? m_pParent->model() : glm::mat4(1.0f);
-		m_mat = glm::translate(m_mat, m_position) * glm::toMat4(m_orientation);
-		m_mat = glm::scale(m_mat, m_scale);
+		// T * R * S, without the intermediate matrices
+		glm::mat4 local = glm::toMat4(m_orientation);
+		local[0] *= m_scale.x;
+		local[1] *= m_scale.y;
+		local[2] *= m_scale.z;
+		local[3] = glm::vec4(m_position, 1.0f);
+		if (m_pParent)
+		{
+			m_pParent->updateWorld();
+			m_world = m_pParent->m_world * local;
+			// Exact unless a non-uniformly scaled parent shears this subtree
+			m_worldOrn = m_pParent->m_worldOrn * m_orientation;
+			m_worldScl = m_pParent->m_worldScl * m_scale;
+		}
+		else
+		{
+			m_world = local;
+			m_worldOrn = m_orientation;
+			m_worldScl = m_scale;
+		}
+		m_normal = isIsotropic() ? m_world : glm::mat4(glm::inverse(glm::transpose(glm::mat3(m_world))));
 		m_bDirty = false;
 	}
-	return m_mat;
+	return;
 }
 
-glm::mat4 Transform::normalModel() const
+u32 Transform::hierarchyVersion()
 {
-	if (!isIsotropic())
+	return g_hierarchyVersion.load();
+}
+
+void Transform::setDirty()
+{
+	// A node is only cleaned after its ancestors are, so a dirty node's subtree is already dirty
+	if (m_bDirty)
+	{
+		return;
+	}
+	m_bDirty = true;
+	for (auto pChild : m_children)
 	{
-		glm::mat3 normal = model();
-		normal = glm::inverse(glm::transpose(normal));
-		return glm::mat4(normal);
+		pChild->setDirty();
 	}
-	return model();
+	return;
 }
 } // namespace le
@@ -5,6 +5,7 @@
 #include "le3d/env/env.hpp"
 #include "le3d/env/threads.hpp"
 #include "le3d/engine/context.hpp"
+#include "le3d/engine/gfx/geometry_arena.hpp"
 #include "le3d/engine/gfx/gfx_enums.hpp"
 #include "le3d/engine/gfx/gfx_store.hpp"
 #include "le3d/engine/gfx/gfx_thread.hpp"
@@ -337,6 +338,7 @@ void contextImpl::destroy()
 		LOG_D("[Context] Destroying context, terminating session...");
 		inputImpl::clear();
 		gfx::GFXStore::destroyInstance();
+		gfx::GeometryArena::destroyInstance();
 		gfx::setMode(GFXMode::ImmediateMainThread);
 		glfwSetWindowShouldClose(g_pWindow, true);
 		while (!glfwWindowShouldClose(g_pWindow))
@@ -349,6 +351,7 @@ void contextImpl::destroy()
 		bool bJoinThreads = g_context.bJoinThreadsOnDestroy;
 		g_contextThreadID = std::thread::id();
 		LOG_I("-- Context destroyed");
+		ioImpl::stopIOThread();
 		ioImpl::deinitPhysfs();
 		g_context = LEContext();
 		if (bJoinThreads)
@@ -1,6 +1,7 @@
 #include "le3d/core/maths.hpp"
 #include "le3d/core/log.hpp"
 #include "le3d/core/io.hpp"
+#include "le3d/core/pack.hpp"
 #include "le3d/core/profiler.hpp"
 #include "le3d/engine/context.hpp"
 #include "le3d/engine/engine_loop.hpp"
@@ -25,6 +26,7 @@ namespace
 {
 gfx::Text2D* g_pFpsText = nullptr;
 gfx::Text2D* g_pVersionText = nullptr;
+PropRenderer const* g_pPropRenderer = nullptr;
 
 void tickDebugTexts(Time dt)
 {
@@ -39,7 +41,14 @@ void tickDebugTexts(Time dt)
 		frameCount = 0;
 		if (g_pFpsText)
 		{
-			g_pFpsText->updateText(std::to_string(fps) + " FPS");
+			std::string text = std::to_string(fps) + " FPS | " + std::to_string(gfx::lastFrameCommandCount()) + " cmds | ";
+			text += std::to_string(gfx::lastFrameDrawCount()) + " draws";
+			if (g_pPropRenderer)
+			{
+				auto const stats = g_pPropRenderer->cullStats();
+				text += " | " + std::to_string(stats.visible) + " visible | " + std::to_string(stats.culled) + " culled";
+			}
+			g_pFpsText->updateText(std::move(text));
 		}
 	}
 	elapsed += dt;
@@ -69,9 +78,15 @@ void runTest()
 	ClearFlags clearFlags;
 	clearFlags.set({ClearFlag::ColorBuffer, ClearFlag::DepthBuffer}, true);
 	stdfs::path const resources = stdfs::path(env::dirPath(env::Dir::Executable)).parent_path() / "demo/resources";
+	stdfs::path const resourcesPack = resources.parent_path() / "resources.pack";
 	stdfs::path const resourcesZip = resources.parent_path() / "resources.zip";
 	std::unique_ptr<IOReader> uReader;
-	if (std::filesystem::is_regular_file(resourcesZip))
+	if (std::filesystem::is_regular_file(resourcesPack))
+	{
+		uReader = std::make_unique<PackReader>(resourcesPack);
+		LOG_I("[GameLoop] Using pack");
+	}
+	else if (std::filesystem::is_regular_file(resourcesZip))
 	{
 		uReader = std::make_unique<ZIPReader>(resourcesZip, "resources");
 		LOG_I("[GameLoop] Using ZIP archive");
@@ -84,6 +99,7 @@ void runTest()
 	manifestLoader::Manifest manifest{"engine_manifest.json", uReader.get()};
 	manifestLoader::Request manifestRequest;
 	manifestRequest.manifest = manifest;
+	manifestRequest.meshCacheDir = env::dirPath(env::Dir::Executable) / ".cache/meshes";
 	manifestLoader::load(manifestRequest);
 
 	static s32 const s_reloadCount = 0;
@@ -166,7 +182,8 @@ void runTest()
 
 	auto eFreecam = ecsdb.spawnEntity("freeCam");
 	auto pFreecam = ecsdb.addComponent<CFreeCam>(eFreecam);
-	ecsdb.addSystem<FreeCamController, PropRenderer, debug::GizmoSystem>();
+	ecsdb.addSystem<FreeCamController, TransformSystem, SpatialSystem, PropRenderer, debug::GizmoSystem>();
+	g_pPropRenderer = ecsdb.getSystem<PropRenderer>();
 	pFreecam->m_position = {0.0f, 0.0f, 3.0f};
 
 	gfx::Albedo lightsAlbedo;
@@ -511,6 +528,11 @@ void runTest()
 		gfx::ubo::Matrices uboMatrices{v, p, p * v, pFreecam->uiProj(uiSpace)};
 		uboMatrices.setViewPos(pFreecam->m_position);
 		pUbo0->copyData(uboMatrices);
+		if (auto pPropRenderer = ecsdb.getSystem<PropRenderer>())
+		{
+			pPropRenderer->m_viewPos = pFreecam->m_position;
+			pPropRenderer->m_oViewProj = p * v;
+		}
 		pUbo1->copyData(uboLights);
 
 		// Render
@@ -562,6 +584,7 @@ void runTest()
 	{
 		ecsdb.destroyEntity(eID);
 	}
+	g_pPropRenderer = nullptr;
 }
 } // namespace
 
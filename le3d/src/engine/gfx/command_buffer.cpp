@@ -0,0 +1,113 @@
+#include <algorithm>
+#include "le3d/engine/gfx/command_buffer.hpp"
+
+namespace le::gfx
+{
+namespace
+{
+constexpr size_t alignUp(size_t value, size_t align)
+{
+	return (value + align - 1) & ~(align - 1);
+}
+} // namespace
+
+CommandBuffer::CommandBuffer() = default;
+CommandBuffer::CommandBuffer(CommandBuffer&&) = default;
+
+CommandBuffer& CommandBuffer::operator=(CommandBuffer&& rhs)
+{
+	if (&rhs != this)
+	{
+		clear();
+		m_blocks = std::move(rhs.m_blocks);
+		m_active = rhs.m_active;
+		m_count = rhs.m_count;
+		rhs.m_active = 0;
+		rhs.m_count = 0;
+	}
+	return *this;
+}
+
+CommandBuffer::~CommandBuffer()
+{
+	clear();
+}
+
+void CommandBuffer::flush(bool bRun)
+{
+	// Commands may not enqueue into the buffer being flushed (gfx::enqueue records into the other buffer)
+	for (size_t idx = 0; idx <= m_active && idx < m_blocks.size(); ++idx)
+	{
+		auto& block = m_blocks[idx];
+		size_t offset = 0;
+		while (offset < block.size)
+		{
+			auto pHeader = reinterpret_cast<Header*>(block.uBytes.get() + offset);
+			pHeader->consume(block.uBytes.get() + offset + pHeader->payloadOffset, bRun);
+			offset += pHeader->stride;
+		}
+		block.size = 0;
+	}
+	m_active = 0;
+	m_count = 0;
+	return;
+}
+
+void CommandBuffer::clear()
+{
+	flush(false);
+	return;
+}
+
+bool CommandBuffer::empty() const
+{
+	return m_count == 0;
+}
+
+u32 CommandBuffer::count() const
+{
+	return m_count;
+}
+
+size_t CommandBuffer::bytesUsed() const
+{
+	size_t ret = 0;
+	for (size_t idx = 0; idx <= m_active && idx < m_blocks.size(); ++idx)
+	{
+		ret += m_blocks[idx].size;
+	}
+	return ret;
+}
+
+void* CommandBuffer::allocate(size_t payloadSize, size_t payloadAlign, u32& outPayloadOffset, u32& outStride, Header*& outHeader)
+{
+	// Every command starts max-aligned, so payload offsets are independent of the block offset
+	size_t const payloadOffset = alignUp(sizeof(Header), payloadAlign);
+	size_t const stride = alignUp(payloadOffset + payloadSize, alignof(std::max_align_t));
+	if (m_blocks.empty())
+	{
+		m_blocks.push_back({});
+	}
+	while (m_blocks[m_active].size + stride > m_blocks[m_active].capacity)
+	{
+		auto& block = m_blocks[m_active];
+		if (block.size == 0)
+		{
+			// Unused (or new) block that is too small: (re)allocate it
+			block.capacity = std::max(BLOCK_SIZE, stride);
+			block.uBytes = std::make_unique<std::byte[]>(block.capacity);
+			break;
+		}
+		if (++m_active == m_blocks.size())
+		{
+			m_blocks.push_back({});
+		}
+	}
+	auto& block = m_blocks[m_active];
+	std::byte* pCommand = block.uBytes.get() + block.size;
+	outHeader = new (pCommand) Header{};
+	outPayloadOffset = (u32)payloadOffset;
+	outStride = (u32)stride;
+	return pCommand + payloadOffset;
+}
+} // namespace le::gfx
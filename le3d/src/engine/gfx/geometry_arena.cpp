@@ -0,0 +1,250 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include "le3d/core/assert.hpp"
+#include "le3d/core/log.hpp"
+#include "le3d/engine/gfx/geometry_arena.hpp"
+#include "le3d/engine/gfx/gfx_objects.hpp"
+#include "le3d/engine/gfx/gfx_thread.hpp"
+#include "le3d/engine/gfx/utils.hpp"
+#include "le3d/engine/gfx/vertex_format.hpp"
+#include "engine/gfx/le3dgl.hpp"
+
+namespace le::gfx
+{
+namespace
+{
+std::unique_ptr<GeometryArena> g_arena;
+using Lock = std::lock_guard<std::mutex>;
+
+template <typename T>
+bytearray toBytes(std::vector<T> const& vertices)
+{
+	bytearray ret(vertices.size() * sizeof(T));
+	std::memcpy(ret.data(), vertices.data(), ret.size());
+	return ret;
+}
+} // namespace
+
+u32 GeometryArena::s_pageVertices = 256 * 1024;
+u32 GeometryArena::s_pageIndices = 1024 * 1024;
+
+GeometryArena::Allocation::Allocation() = default;
+
+GeometryArena::Allocation::Allocation(Allocation&& rhs) noexcept
+{
+	*this = std::move(rhs);
+}
+
+GeometryArena::Allocation& GeometryArena::Allocation::operator=(Allocation&& rhs) noexcept
+{
+	if (&rhs != this)
+	{
+		release(*this);
+		pPage = std::move(rhs.pPage);
+		vertices = rhs.vertices;
+		indices = rhs.indices;
+		rhs.vertices = rhs.indices = {};
+	}
+	return *this;
+}
+
+GeometryArena::Allocation::~Allocation()
+{
+	release(*this);
+}
+
+bool GeometryArena::Allocation::isValid() const
+{
+	return pPage != nullptr;
+}
+
+u32 GeometryArena::Allocation::firstVertex() const
+{
+	return vertices.isValid() ? vertices.offset : 0;
+}
+
+u32 GeometryArena::Allocation::firstIndex() const
+{
+	return indices.isValid() ? indices.offset : 0;
+}
+
+GeometryArena* GeometryArena::instance()
+{
+	if (!g_arena)
+	{
+		g_arena = std::make_unique<GeometryArena>();
+	}
+	return g_arena.get();
+}
+
+bool GeometryArena::destroyInstance()
+{
+	if (g_arena)
+	{
+		g_arena.reset();
+		return true;
+	}
+	return false;
+}
+
+GeometryArena::GeometryArena() = default;
+
+GeometryArena::~GeometryArena()
+{
+	Lock lock(m_mutex);
+	for (auto& pPage : m_pages)
+	{
+		// Captures the Page: any remaining VertexArrays keep theirs alive, but not its GL objects
+		gfx::enqueue([pPage]() {
+			glChk(glDeleteVertexArrays(1, &pPage->vao.handle));
+			glChk(glDeleteBuffers(1, &pPage->vbo.handle));
+			glChk(glDeleteBuffers(1, &pPage->ebo.handle));
+			return;
+		});
+	}
+	LOGIF_I(!m_pages.empty(), "[GeometryArena] destroyed [%u] pages", (u32)m_pages.size());
+}
+
+GeometryArena::Allocation GeometryArena::add(Geometry const& geometry, VertexFormat format)
+{
+	u32 const vertexCount = geometry.vertexCount();
+	u32 const indexCount = (u32)geometry.indices.size();
+	Allocation ret;
+	if (vertexCount == 0 || vertexCount > s_pageVertices || indexCount > s_pageIndices)
+	{
+		return ret;
+	}
+	{
+		Lock lock(m_mutex);
+		for (auto& pPage : m_pages)
+		{
+			if (pPage->format == format)
+			{
+				ret = allocate(pPage, vertexCount, indexCount);
+				if (ret.isValid())
+				{
+					break;
+				}
+			}
+		}
+		if (!ret.isValid())
+		{
+			ret = allocate(newPage(format), vertexCount, indexCount);
+		}
+	}
+	ASSERT(ret.isValid(), "Empty page too small!");
+	if (!ret.isValid())
+	{
+		return ret;
+	}
+	// Interleave / pack and rebase here; the render thread only copies
+	auto vertices = format == VertexFormat::Packed ? toBytes(vertexFormat::pack(geometry)) : toBytes(vertexFormat::interleave(geometry));
+	std::vector<u32> indices(geometry.indices.size());
+	u32 const firstVertex = ret.firstVertex();
+	std::transform(geometry.indices.begin(), geometry.indices.end(), indices.begin(), [firstVertex](u32 index) { return index + firstVertex; });
+	gfx::enqueue([pPage = ret.pPage, vertices = std::move(vertices), indices = std::move(indices), firstVertex,
+				  firstIndex = ret.firstIndex()]() {
+		glChk(glBindVertexArray(pPage->vao));
+		glChk(glBindBuffer(GL_ARRAY_BUFFER, pPage->vbo));
+		auto const vOffset = (GLintptr)(firstVertex * vertexFormat::vertexSize(pPage->format));
+		glChk(glBufferSubData(GL_ARRAY_BUFFER, vOffset, (GLsizeiptr)vertices.size(), vertices.data()));
+		if (!indices.empty())
+		{
+			auto const iOffset = (GLintptr)(firstIndex * sizeof(u32));
+			glChk(glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, iOffset, (GLsizeiptr)(indices.size() * sizeof(u32)), indices.data()));
+		}
+		glChk(glBindBuffer(GL_ARRAY_BUFFER, 0));
+		glChk(glBindVertexArray(0));
+		return;
+	});
+	return ret;
+}
+
+void GeometryArena::release(Allocation& outAllocation)
+{
+	if (outAllocation.pPage)
+	{
+		Lock lock(outAllocation.pPage->mutex);
+		outAllocation.pPage->vertices.release(outAllocation.vertices);
+		outAllocation.pPage->indices.release(outAllocation.indices);
+	}
+	outAllocation.pPage.reset();
+	outAllocation.vertices = outAllocation.indices = {};
+	return;
+}
+
+size_t GeometryArena::pageCount() const
+{
+	Lock lock(m_mutex);
+	return m_pages.size();
+}
+
+GeometryArena::Allocation GeometryArena::allocate(std::shared_ptr<Page> const& pPage, u32 vertexCount, u32 indexCount)
+{
+	Allocation ret;
+	Page& page = *pPage;
+	Lock lock(page.mutex);
+	auto vertices = page.vertices.allocate(vertexCount);
+	if (!vertices.isValid())
+	{
+		return ret;
+	}
+	RangeAllocator::Allocation indices;
+	if (indexCount > 0)
+	{
+		indices = page.indices.allocate(indexCount);
+		if (!indices.isValid())
+		{
+			page.vertices.release(vertices);
+			return ret;
+		}
+	}
+	ret.pPage = pPage;
+	ret.vertices = vertices;
+	ret.indices = indices;
+	return ret;
+}
+
+std::shared_ptr<GeometryArena::Page> GeometryArena::newPage(VertexFormat format)
+{
+	auto pPage = std::make_shared<Page>();
+	pPage->vertices.reset(s_pageVertices);
+	pPage->indices.reset(s_pageIndices);
+	pPage->format = format;
+	m_pages.push_back(pPage);
+	LOG_D("[GeometryArena] Page [%u] created: [%u] vertices, [%u] indices%s", (u32)m_pages.size(), s_pageVertices, s_pageIndices,
+		  format == VertexFormat::Packed ? " (packed)" : "");
+	gfx::enqueue([pPage, vCount = s_pageVertices, iCount = s_pageIndices]() {
+		glChk(glGenVertexArrays(1, &pPage->vao.handle));
+		glChk(glGenBuffers(1, &pPage->vbo.handle));
+		glChk(glGenBuffers(1, &pPage->ebo.handle));
+		glChk(glBindVertexArray(pPage->vao));
+		glChk(glBindBuffer(GL_ARRAY_BUFFER, pPage->vbo));
+		auto const stride = (GLsizei)vertexFormat::vertexSize(pPage->format);
+		glChk(glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)vCount * stride, nullptr, GL_STATIC_DRAW));
+		glChk(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, pPage->ebo));
+		glChk(glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(iCount * sizeof(u32)), nullptr, GL_STATIC_DRAW));
+		// Same locations as VertexArray: 0 => position, 1 => normal, 2 => tex coord
+		if (pPage->format == VertexFormat::Packed)
+		{
+			glChk(glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(PackedVertex, position)));
+			glChk(glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)offsetof(PackedVertex, normal)));
+			glChk(glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offsetof(PackedVertex, texCoord)));
+		}
+		else
+		{
+			glChk(glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Vertex, position)));
+			glChk(glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Vertex, normal)));
+			glChk(glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Vertex, texCoord)));
+		}
+		glChk(glEnableVertexAttribArray(0));
+		glChk(glEnableVertexAttribArray(1));
+		glChk(glEnableVertexAttribArray(2));
+		glChk(glBindVertexArray(0));
+		glChk(glBindBuffer(GL_ARRAY_BUFFER, 0));
+		return;
+	});
+	return pPage;
+}
+} // namespace le::gfx
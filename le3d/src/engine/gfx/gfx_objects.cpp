@@ -1,5 +1,7 @@
 #include <algorithm>
 #include <array>
+#include <cstddef>
+#include <cstring>
 #include <unordered_map>
 #include <glad/glad.h>
 #include <stb/stb_image.h>
@@ -12,6 +14,7 @@
 #include "le3d/engine/gfx/gfx_objects.hpp"
 #include "le3d/engine/gfx/gfx_store.hpp"
 #include "le3d/engine/gfx/utils.hpp"
+#include "le3d/engine/gfx/vertex_format.hpp"
 #include "le3d/env/env.hpp"
 #include "engine/context_impl.hpp"
 #include "engine/gfx/le3dgl.hpp"
@@ -30,9 +33,6 @@ namespace le::gfx
 
 namespace
 {
-std::mutex g_stbiMutex;
-using Lock = std::lock_guard<std::mutex>;
-
 std::unordered_map<std::string, TexType> g_strToTexType = {
 
 	{"diffuse", TexType::Diffuse}, {"specular", TexType::Specular}
@@ -126,6 +126,16 @@ u32 Geometry::vertexCount() const
 	return (u32)points.size();
 }
 
+AABB Geometry::bounds() const
+{
+	AABB ret;
+	for (auto const& point : points)
+	{
+		ret.add(glm::vec3(point.x, point.y, point.z));
+	}
+	return ret;
+}
+
 void Geometry::addPoint(glm::vec3 const& point)
 {
 	points.push_back({point.x, point.y, point.z});
@@ -198,6 +208,19 @@ u32 InstanceBuffer::instanceCount() const
 	return (u32)models.size();
 }
 
+std::vector<glm::mat4> InstanceBuffer::interleaved() const
+{
+	ASSERT(normals.empty() || normals.size() == models.size(), "Instance models / normals size mismatch!");
+	std::vector<glm::mat4> ret;
+	ret.reserve(models.size() * 2);
+	for (size_t idx = 0; idx < models.size(); ++idx)
+	{
+		ret.push_back(models[idx]);
+		ret.push_back(normals.empty() ? models[idx] : normals[idx]);
+	}
+	return ret;
+}
+
 void Material::deserialise(JSONObj const& serialised)
 {
 	id = serialised.getString("id", "UNNAMED");
@@ -388,6 +411,139 @@ void UniformBuffer::copyData(u32 offset, size_t size, void const* pData)
 	return;
 }
 
+struct Shader::Uniforms final
+{
+	struct Entry final
+	{
+		std::array<f32, 4> cache;
+		UniformID id = 0;
+		s32 location = -1;
+		bool bCached = false;
+	};
+
+	std::vector<Entry> entries;
+	GFXID program;
+
+	void reflect(GFXID glID, stdfs::path const& shaderID);
+	Entry* find(UniformID id);
+	void apply(UniformWrite const* pWrites, size_t count);
+};
+
+void Shader::Uniforms::reflect(GFXID glID, stdfs::path const& shaderID)
+{
+	program = glID;
+	entries.clear();
+	GLint count = 0;
+	GLint maxLength = 0;
+	glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+	glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+	std::string name((size_t)std::max(maxLength, 1), '\0');
+	entries.reserve((size_t)count);
+	for (GLint idx = 0; idx < count; ++idx)
+	{
+		GLsizei length = 0;
+		GLint size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(program, (GLuint)idx, (GLsizei)name.size(), &length, &size, &type, name.data());
+		std::string_view id(name.data(), (size_t)length);
+		s32 const location = glGetUniformLocation(program, name.data());
+		// Uniform block members have no location
+		if (location >= 0)
+		{
+			Entry entry;
+			entry.id = uniformID(id);
+			entry.location = location;
+			entries.push_back(entry);
+			// Arrays are reported as "name[0]"; also register "name"
+			auto const subscript = id.find("[0]");
+			if (subscript != std::string_view::npos && subscript + 3 == id.size())
+			{
+				entry.id = uniformID(id.substr(0, subscript));
+				entries.push_back(entry);
+			}
+		}
+	}
+	std::sort(entries.begin(), entries.end(), [](Entry const& lhs, Entry const& rhs) { return lhs.id < rhs.id; });
+	for (size_t idx = 1; idx < entries.size(); ++idx)
+	{
+		LOGIF_W(entries[idx].id == entries[idx - 1].id, "[%s] [%s] Uniform ID collision!", typeName<Shader>().data(),
+				shaderID.generic_string().data());
+	}
+	return;
+}
+
+Shader::Uniforms::Entry* Shader::Uniforms::find(UniformID id)
+{
+	auto search = std::lower_bound(entries.begin(), entries.end(), id, [](Entry const& entry, UniformID id) { return entry.id < id; });
+	return search != entries.end() && search->id == id ? &*search : nullptr;
+}
+
+void Shader::Uniforms::apply(UniformWrite const* pWrites, size_t count)
+{
+	for (size_t idx = 0; idx < count; ++idx)
+	{
+		auto const& write = pWrites[idx];
+		auto pEntry = find(write.id);
+		if (!pEntry)
+		{
+			continue;
+		}
+		auto const& data = write.data;
+		if (write.type != UniformWrite::Type::Mat4)
+		{
+			// Skip redundant uploads: uniform values persist in the program
+			size_t count = 1;
+			switch (write.type)
+			{
+			default:
+				break;
+			case UniformWrite::Type::V2:
+				count = 2;
+				break;
+			case UniformWrite::Type::V3:
+				count = 3;
+				break;
+			case UniformWrite::Type::V4:
+				count = 4;
+				break;
+			}
+			if (pEntry->bCached && std::equal(data.begin(), data.begin() + (std::ptrdiff_t)count, pEntry->cache.begin()))
+			{
+				continue;
+			}
+			std::copy(data.begin(), data.begin() + (std::ptrdiff_t)count, pEntry->cache.begin());
+			pEntry->bCached = true;
+		}
+		Shader::bind(program);
+		switch (write.type)
+		{
+		case UniformWrite::Type::S32:
+		{
+			s32 val;
+			std::memcpy(&val, data.data(), sizeof(val));
+			glChk(glUniform1i(pEntry->location, (GLint)val));
+			break;
+		}
+		case UniformWrite::Type::F32:
+			glChk(glUniform1f(pEntry->location, data[0]));
+			break;
+		case UniformWrite::Type::V2:
+			glChk(glUniform2f(pEntry->location, data[0], data[1]));
+			break;
+		case UniformWrite::Type::V3:
+			glChk(glUniform3f(pEntry->location, data[0], data[1], data[2]));
+			break;
+		case UniformWrite::Type::V4:
+			glChk(glUniform4f(pEntry->location, data[0], data[1], data[2], data[3]));
+			break;
+		case UniformWrite::Type::Mat4:
+			glChk(glUniformMatrix4fv(pEntry->location, 1, GL_FALSE, data.data()));
+			break;
+		}
+	}
+	return;
+}
+
 Shader::Shader() = default;
 
 Shader::Shader(Descriptor descriptor)
@@ -401,7 +557,11 @@ Shader::~Shader()
 {
 	if (preDestroy())
 	{
-		gfx::enqueue([glID = m_glID]() { glDeleteProgram(glID); });
+		// Staged / pending commands may still reference the uniform table
+		gfx::enqueue([glID = m_glID, pUniforms = m_uUniforms.release()]() {
+			glDeleteProgram(glID);
+			delete pUniforms;
+		});
 	}
 }
 
@@ -433,7 +593,8 @@ bool Shader::setup(Descriptor descriptor)
 			  descriptor.id.generic_string().data());
 		return false;
 	}
-	gfx::enqueue([this, descriptor]() {
+	m_uUniforms = std::make_unique<Uniforms>();
+	gfx::enqueue([this, pUniforms = m_uUniforms.get(), descriptor]() {
 		LOG_SETUP_ENTER(Shader, m_id);
 		std::array<char, 512> buf;
 		s32 success;
@@ -481,6 +642,7 @@ bool Shader::setup(Descriptor descriptor)
 		}
 		glDeleteShader(vsh);
 		glDeleteShader(fsh);
+		pUniforms->reflect(m_glID, descriptor.id);
 		for (auto const& uboID : descriptor.uboIDs)
 		{
 			if (auto pUniformBuffer = GFXStore::instance()->get<UniformBuffer>(uboID))
@@ -515,115 +677,34 @@ void Shader::use() const
 
 void Shader::setBool(std::string_view id, bool bVal) const
 {
-	if (isReady() && !id.empty())
-	{
-#if defined(LE3D_GFX_DEBUG_LOGS)
-		gfx::enqueue([bDebug = m_bDEBUG, glID = m_glID, id = std::string(id), bVal]() {
-#else
-		gfx::enqueue([glID = m_glID, id = std::string(id), bVal]() {
-#endif
-			LOGIF_X_Y(bDebug, Shader, "Entered setBool()", glID);
-			bind(glID);
-			auto glLoc = glGetUniformLocation(glID, id.data());
-			if (glLoc >= 0)
-			{
-				glChk(glUniform1i(glLoc, (GLint)bVal));
-			}
-			LOGIF_X_Y(bDebug, Shader, "Exiting setBool()", glID);
-			return;
-		});
-	}
+	setS32(id, bVal ? 1 : 0);
 	return;
 }
 
 void Shader::setS32(std::string_view id, s32 val) const
 {
-	if (isReady() && !id.empty())
-	{
-#if defined(LE3D_GFX_DEBUG_LOGS)
-		gfx::enqueue([bDebug = m_bDEBUG, glID = m_glID, id = std::string(id), val]() {
-#else
-		gfx::enqueue([glID = m_glID, id = std::string(id), val]() {
-#endif
-			LOGIF_X_Y(bDebug, Shader, "Entered setS32()", glID);
-			bind(glID);
-			auto glLoc = glGetUniformLocation(glID, id.data());
-			if (glLoc >= 0)
-			{
-				glChk(glUniform1i(glLoc, (GLint)val));
-			}
-			LOGIF_X_Y(bDebug, Shader, "Exiting setS32()", glID);
-			return;
-		});
-	}
+	// Stored as raw bits in the f32 payload
+	f32 bits;
+	std::memcpy(&bits, &val, sizeof(bits));
+	stage(id, UniformWrite::Type::S32, &bits, 1);
 	return;
 }
+
 void Shader::setF32(std::string_view id, f32 val) const
 {
-	if (isReady() && !id.empty())
-	{
-#if defined(LE3D_GFX_DEBUG_LOGS)
-		gfx::enqueue([bDebug = m_bDEBUG, glID = m_glID, id = std::string(id), val]() {
-#else
-		gfx::enqueue([glID = m_glID, id = std::string(id), val]() {
-#endif
-			LOGIF_X_Y(bDebug, Shader, "Entered setF32()", glID);
-			bind(glID);
-			auto glLoc = glGetUniformLocation(glID, id.data());
-			if (glLoc >= 0)
-			{
-				glChk(glUniform1f(glLoc, val));
-			}
-			LOGIF_X_Y(bDebug, Shader, "Exiting setF32()", glID);
-			return;
-		});
-	}
+	stage(id, UniformWrite::Type::F32, &val, 1);
 	return;
 }
 
 void Shader::setV2(std::string_view id, glm::vec2 const& val) const
 {
-	if (isReady() && !id.empty())
-	{
-#if defined(LE3D_GFX_DEBUG_LOGS)
-		gfx::enqueue([bDebug = m_bDEBUG, glID = m_glID, id = std::string(id), val = val]() {
-#else
-		gfx::enqueue([glID = m_glID, id = std::string(id), val = val]() {
-#endif
-			LOGIF_X_Y(bDebug, Shader, "Entered setV2()", glID);
-			bind(glID);
-			auto glLoc = glGetUniformLocation(glID, id.data());
-			if (glLoc >= 0)
-			{
-				glChk(glUniform2f(glLoc, val.x, val.y));
-			}
-			LOGIF_X_Y(bDebug, Shader, "Exiting setV2()", glID);
-		});
-		return;
-	}
+	stage(id, UniformWrite::Type::V2, glm::value_ptr(val), 2);
 	return;
 }
 
 void Shader::setV3(std::string_view id, glm::vec3 const& val) const
 {
-	if (isReady() && !id.empty())
-	{
-#if defined(LE3D_GFX_DEBUG_LOGS)
-		gfx::enqueue([bDebug = m_bDEBUG, glID = m_glID, id = std::string(id), val = val]() {
-#else
-		gfx::enqueue([glID = m_glID, id = std::string(id), val = val]() {
-#endif
-			LOGIF_X_Y(bDebug, Shader, "Entered setV3()", glID);
-			bind(glID);
-			auto glLoc = glGetUniformLocation(glID, id.data());
-			if (glLoc >= 0)
-			{
-				glChk(glUniform3f(glLoc, val.x, val.y, val.z));
-			}
-			LOGIF_X_Y(bDebug, Shader, "Exiting setV3()", glID);
-		});
-		return;
-	}
+	stage(id, UniformWrite::Type::V3, glm::value_ptr(val), 3);
 	return;
 }
 
@@ -634,46 +715,15 @@ void Shader::setV4(std::string_view id, Colour colour) const
 
 void Shader::setV4(std::string_view id, glm::vec4 const& val) const
 {
-	if (isReady() && !id.empty())
-	{
-#if defined(LE3D_GFX_DEBUG_LOGS)
-		gfx::enqueue([bDebug = m_bDEBUG, glID = m_glID, id = std::string(id), val = val]() {
-#else
-		gfx::enqueue([glID = m_glID, id = std::string(id), val = val]() {
-#endif
-			LOGIF_X_Y(bDebug, Shader, "Entered setV4()", glID);
-			bind(glID);
-			auto glLoc = glGetUniformLocation(glID, id.data());
-			if (glLoc >= 0)
-			{
-				glChk(glUniform4f(glLoc, val.x, val.y, val.z, val.w));
-			}
-			LOGIF_X_Y(bDebug, Shader, "Exiting setV4()", glID);
-		});
-		return;
-	}
+	stage(id, UniformWrite::Type::V4, glm::value_ptr(val), 4);
 	return;
 }
 
 void Shader::setModelMats(ModelMats const& mats) const
 {
-	if (isReady())
-	{
-#if defined(LE3D_GFX_DEBUG_LOGS)
-		gfx::enqueue([bDebug = m_bDEBUG, glID = m_glID, mats = mats]() {
-#else
-		gfx::enqueue([glID = m_glID, mats = mats]() {
-#endif
-			LOGIF_X_Y(bDebug, Shader, "Exiting setModelMats()", glID);
-			bind(glID);
-			auto temp = glGetUniformLocation(glID, env::g_config.uniforms.modelMatrix.data());
-			glChk(glUniformMatrix4fv(temp, 1, GL_FALSE, glm::value_ptr(mats.model)));
-			temp = glGetUniformLocation(glID, env::g_config.uniforms.normalMatrix.data());
-			glUniformMatrix4fv(temp, 1, GL_FALSE, glm::value_ptr(mats.normals));
-			LOGIF_X_Y(bDebug, Shader, "Exiting setModelMats()", glID);
-			return;
-		});
-	}
+	auto const& u = env::g_config.uniforms;
+	stage(u.modelMatrix, UniformWrite::Type::Mat4, glm::value_ptr(mats.model), 16);
+	stage(u.normalMatrix, UniformWrite::Type::Mat4, glm::value_ptr(mats.normals), 16);
 	return;
 }
 
@@ -832,6 +882,43 @@ void Shader::unbind(std::initializer_list<TexType> units) const
 	}
 }
 
+void Shader::flush() const
+{
+	if (isReady())
+	{
+		// Binds the program for the following draw; writes are copied into the command's payload: m_staged keeps its capacity across draws
+#if defined(LE3D_GFX_DEBUG_LOGS)
+		gfx::enqueue(
+			[bDebug = m_bDEBUG, glID = m_glID, pUniforms = m_uUniforms.get()](UniformWrite const* pWrites, size_t count) {
+#else
+		gfx::enqueue(
+			[glID = m_glID, pUniforms = m_uUniforms.get()](UniformWrite const* pWrites, size_t count) {
+#endif
+				LOGIF_X_Y(bDebug, Shader, "Entered flush()", glID);
+				bind(glID);
+				pUniforms->apply(pWrites, count);
+				LOGIF_X_Y(bDebug, Shader, "Exiting flush()", glID);
+				return;
+			},
+			m_staged.data(), m_staged.size());
+	}
+	m_staged.clear();
+	return;
+}
+
+void Shader::stage(std::string_view id, UniformWrite::Type type, f32 const* pData, size_t count) const
+{
+	if (isReady() && !id.empty())
+	{
+		UniformWrite write;
+		write.id = uniformID(id);
+		write.type = type;
+		std::copy(pData, pData + count, write.data.begin());
+		m_staged.push_back(write);
+	}
+	return;
+}
+
 VertexArray::VertexArray() = default;
 
 VertexArray::VertexArray(Descriptor descriptor, Geometry geometry)
@@ -846,15 +933,22 @@ VertexArray::~VertexArray()
 	if (preDestroy())
 	{
 #if defined(LE3D_GFX_DEBUG_LOGS)
-		gfx::enqueue([id = m_id, vao = m_glID, ebo = m_ebo, vbo = m_geometryVBO, instanceVBO = m_instanceVBO]() {
+		gfx::enqueue([id = m_id, vao = m_glID, ebo = m_ebo, vbo = m_geometryVBO, instanceVBO = m_instanceVBO, batchVBO = m_batchVBO,
+					  bShared = m_allocation.isValid()]() {
 #else
-		gfx::enqueue([vao = m_glID, ebo = m_ebo, vbo = m_geometryVBO, instanceVBO = m_instanceVBO]() {
+		gfx::enqueue([vao = m_glID, ebo = m_ebo, vbo = m_geometryVBO, instanceVBO = m_instanceVBO, batchVBO = m_batchVBO,
+					  bShared = m_allocation.isValid()]() {
 #endif
 			LOGIF_X_Y(true, VertexArray, "Entered ~dtor()", vao);
-			glChk(glDeleteVertexArrays(1, &vao.handle));
+			// A shared VAO (and its buffers) belongs to GeometryArena
+			if (!bShared)
+			{
+				glChk(glDeleteVertexArrays(1, &vao.handle));
+			}
 			glChk(glDeleteBuffers(1, &ebo.handle));
 			glChk(glDeleteBuffers(1, &vbo.handle));
 			glChk(glDeleteBuffers(1, &instanceVBO.handle));
+			glChk(glDeleteBuffers(1, &batchVBO.handle));
 			LOGIF_X_Y(true, VertexArray, "Exiting ~dtor()", vao);
 			return;
 		});
@@ -876,6 +970,7 @@ bool VertexArray::setup(Descriptor descriptor, Geometry geometry)
 			glChk(glGenBuffers(1, &m_geometryVBO.handle));
 			glChk(glGenBuffers(1, &m_ebo.handle));
 			glChk(glGenBuffers(1, &m_instanceVBO.handle));
+			glChk(glGenBuffers(1, &m_batchVBO.handle));
 			LOG_SETUP_EXIT(VertexArray, m_id);
 			return;
 		});
@@ -886,13 +981,31 @@ bool VertexArray::setup(Descriptor descriptor, Geometry geometry)
 		ASSERT(geometry.texCoords.empty() || geometry.texCoords.size() == geometry.points.size(), "Point/UV count mismatch!");
 		m_vertexCount = geometry.vertexCount();
 		m_indexCount = (u32)geometry.indices.size();
+		if (m_descriptor.drawType == DrawType::Static)
+		{
+			m_allocation = GeometryArena::instance()->add(geometry, m_descriptor.format);
+		}
+		if (m_allocation.isValid())
+		{
+			gfx::enqueue([this, pPage = m_allocation.pPage]() {
+				LOG_SETUP_ENTER(VertexArray, m_id);
+				glChk(glGenBuffers(1, &m_instanceVBO.handle));
+				glChk(glGenBuffers(1, &m_batchVBO.handle));
+				m_glID = pPage->vao;
+				LOG_SETUP_EXIT(VertexArray, m_id);
+				return;
+			});
+			init(std::move(m_descriptor.id));
+			return true;
+		}
 		gfx::enqueue([this, geometry = std::move(geometry)]() {
 			LOG_SETUP_ENTER(VertexArray, m_id);
 			glChk(glGenVertexArrays(1, &m_glID.handle));
 			glChk(glGenBuffers(1, &m_geometryVBO.handle));
 			glChk(glGenBuffers(1, &m_ebo.handle));
 			glChk(glGenBuffers(1, &m_instanceVBO.handle));
-			setGeometryAttributes(std::move(geometry), m_glID, m_geometryVBO, m_ebo, m_descriptor.drawType);
+			glChk(glGenBuffers(1, &m_batchVBO.handle));
+			setGeometryAttributes(std::move(geometry), m_glID, m_geometryVBO, m_ebo, m_descriptor.drawType, m_descriptor.format);
 			glChk(glBindVertexArray(0));
 			LOG_SETUP_EXIT(VertexArray, m_id);
 			return;
@@ -910,14 +1023,31 @@ void VertexArray::updateGeometry(Geometry geometry)
 		ASSERT(geometry.texCoords.empty() || geometry.texCoords.size() == geometry.points.size(), "Point/UV count mismatch!");
 		m_vertexCount = geometry.vertexCount();
 		m_indexCount = (u32)geometry.indices.size();
+		if (m_allocation.isValid())
+		{
+			// Draws recorded before this still use the old ranges: releasing them only lets later uploads reuse them
+			auto allocation = GeometryArena::instance()->add(geometry, m_descriptor.format);
+			if (allocation.isValid())
+			{
+				m_allocation = std::move(allocation);
+				gfx::enqueue([this, pPage = m_allocation.pPage]() { m_glID = pPage->vao; });
+			}
+			else
+			{
+				LOG_E("[%s] [%s] Geometry too large for GeometryArena; not updated!", m_type.data(), m_id.generic_string().data());
+				m_vertexCount = m_indexCount = 0;
+			}
+			return;
+		}
 #if defined(LE3D_GFX_DEBUG_LOGS)
 		gfx::enqueue([bDebug = m_bDEBUG, geometry = std::move(geometry), vao = m_glID, vbo = m_geometryVBO, ebo = m_ebo,
-					  type = m_descriptor.drawType]() {
+					  type = m_descriptor.drawType, format = m_descriptor.format]() {
 #else
-		gfx::enqueue([geometry = std::move(geometry), vao = m_glID, vbo = m_geometryVBO, ebo = m_ebo, type = m_descriptor.drawType]() {
+		gfx::enqueue([geometry = std::move(geometry), vao = m_glID, vbo = m_geometryVBO, ebo = m_ebo, type = m_descriptor.drawType,
+					  format = m_descriptor.format]() {
 #endif
 			LOGIF_X_Y(bDebug, VertexArray, "Entered updateGeometry()", vao);
-			setGeometryAttributes(std::move(geometry), vao, vbo, ebo, type);
+			setGeometryAttributes(std::move(geometry), vao, vbo, ebo, type, format);
 			LOGIF_X_Y(bDebug, VertexArray, "Exiting updateGeometry()", vao);
 			return;
 		});
@@ -934,30 +1064,12 @@ void VertexArray::setInstances(InstanceBuffer instances)
 		if (m_instanceCount > 0)
 		{
 #if defined(LE3D_GFX_DEBUG_LOGS)
-			gfx::enqueue([bDebug = m_bDEBUG, instances = std::move(instances), glID = m_glID, vbo = m_instanceVBO]() {
+			gfx::enqueue([bDebug = m_bDEBUG, data = instances.interleaved(), type = instances.drawType, glID = m_glID, vbo = m_instanceVBO]() {
 #else
-			gfx::enqueue([instances = std::move(instances), glID = m_glID, vbo = m_instanceVBO]() {
+			gfx::enqueue([data = instances.interleaved(), type = instances.drawType, glID = m_glID, vbo = m_instanceVBO]() {
 #endif
 				LOGIF_X_Y(bDebug, VertexArray, "Entered setInstances()", glID);
-				GLint constexpr vaSize = 4;
-				auto constexpr vaBytes = sizeof(glm::mat4);
-				GLboolean constexpr glNorm = GL_FALSE;
-				u32 const vec4sPerAttrib = vaSize;
-				GLenum glDrawType = instances.drawType == DrawType::Dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW;
-				auto const size = instances.models.size() * vaBytes;
-				glChk(glBindBuffer(GL_ARRAY_BUFFER, vbo));
-				glChk(glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)size, instances.models.data(), glDrawType));
-				glChk(glBindVertexArray(glID));
-				for (u32 idx = 0; idx < vec4sPerAttrib; ++idx)
-				{
-					auto offset = idx * sizeof(glm::vec4);
-					u32 loc = u32(s_instanceAttribLoc) + idx;
-					glChk(glVertexAttribPointer(loc, vaSize, GL_FLOAT, glNorm, vaBytes, (void*)offset));
-					glChk(glEnableVertexAttribArray(loc));
-					glChk(glVertexAttribDivisor(loc, 1));
-				}
-				glChk(glBindBuffer(GL_ARRAY_BUFFER, 0));
-				glChk(glBindVertexArray(0));
+				setInstanceAttributes(data, glID, vbo, type);
 				LOGIF_X_Y(bDebug, VertexArray, "Exiting setInstances()", glID);
 				return;
 			});
@@ -970,45 +1082,60 @@ void VertexArray::draw(Shader const& shader) const
 	if (isReady() && shader.isReady())
 	{
 		shader.setBool(env::g_config.uniforms.transform.isInstanced, m_instanceCount > 0);
+		shader.flush();
+		threadImpl::countDraw();
+		// The VAO's instance attributes may point at a batch buffer (or, if shared, at another VertexArray's buffers)
+		GFXID const rebindVBO = m_instanceCount > 0 ? m_instanceVBO : GFXID();
 #if defined(LE3D_GFX_DEBUG_LOGS)
 		auto drawArrays = [bDebug = m_bDEBUG, id = m_id, vao = m_glID, shaderID = shader.gfxID(), instanceCount = m_instanceCount,
-						   vCount = m_vertexCount]() {
+						   vCount = m_vertexCount, first = m_allocation.firstVertex(), rebindVBO]() {
 #else
-		auto drawArrays = [vao = m_glID, shaderID = shader.gfxID(), instanceCount = m_instanceCount, vCount = m_vertexCount]() {
+		auto drawArrays = [vao = m_glID, shaderID = shader.gfxID(), instanceCount = m_instanceCount, vCount = m_vertexCount,
+						   first = m_allocation.firstVertex(), rebindVBO]() {
 #endif
 			LOGIF_X_Y(bDebug, VertexArray, "Entered draw()", vao);
+			if (rebindVBO > 0)
+			{
+				bindInstanceAttributes(vao, rebindVBO);
+			}
 			glChk(glBindVertexArray(vao));
 			if (instanceCount > 0)
 			{
-				glChk(glDrawArraysInstanced(GL_TRIANGLES, 0, (GLsizei)vCount, (GLsizei)instanceCount));
+				glChk(glDrawArraysInstanced(GL_TRIANGLES, (GLint)first, (GLsizei)vCount, (GLsizei)instanceCount));
 			}
 			else
 			{
-				glChk(glDrawArrays(GL_TRIANGLES, 0, (GLsizei)vCount));
+				glChk(glDrawArrays(GL_TRIANGLES, (GLint)first, (GLsizei)vCount));
 			}
 			LOGIF_X_Y(bDebug, VertexArray, "Exiting draw()", vao);
 			return;
 		};
 #if defined(LE3D_GFX_DEBUG_LOGS)
 		auto drawElements = [bDebug = m_bDEBUG, id = m_id, vao = m_glID, shaderID = shader.gfxID(), instanceCount = m_instanceCount,
-							 iCount = m_indexCount]() {
+							 iCount = m_indexCount, first = m_allocation.firstIndex(), rebindVBO]() {
 #else
-		auto drawElements = [vao = m_glID, shaderID = shader.gfxID(), instanceCount = m_instanceCount, iCount = m_indexCount]() {
+		auto drawElements = [vao = m_glID, shaderID = shader.gfxID(), instanceCount = m_instanceCount, iCount = m_indexCount,
+							 first = m_allocation.firstIndex(), rebindVBO]() {
 #endif
 			LOGIF_X_Y(bDebug, VertexArray, "Entered draw()", vao);
+			if (rebindVBO > 0)
+			{
+				bindInstanceAttributes(vao, rebindVBO);
+			}
 			glChk(glBindVertexArray(vao));
+			auto const pOffset = (void const*)(first * sizeof(u32));
 			if (instanceCount > 0)
 			{
-				glChk(glDrawElementsInstanced(GL_TRIANGLES, (GLsizei)iCount, GL_UNSIGNED_INT, 0, (GLsizei)instanceCount));
+				glChk(glDrawElementsInstanced(GL_TRIANGLES, (GLsizei)iCount, GL_UNSIGNED_INT, pOffset, (GLsizei)instanceCount));
 			}
 			else
 			{
-				glChk(glDrawElements(GL_TRIANGLES, (GLsizei)iCount, GL_UNSIGNED_INT, 0));
+				glChk(glDrawElements(GL_TRIANGLES, (GLsizei)iCount, GL_UNSIGNED_INT, pOffset));
 			}
 			LOGIF_X_Y(bDebug, VertexArray, "Exiting draw()", vao);
 			return;
 		};
-		if (m_ebo > 0 && m_indexCount > 0)
+		if ((m_ebo > 0 || m_allocation.isValid()) && m_indexCount > 0)
 		{
 			gfx::enqueue(drawElements);
 		}
@@ -1020,11 +1147,92 @@ void VertexArray::draw(Shader const& shader) const
 	return;
 }
 
-void VertexArray::setGeometryAttributes(Geometry geometry, GFXID vao, GFXID vbo, GFXID ebo, DrawType type)
+void VertexArray::drawInstanced(Shader const& shader, InstanceBuffer const& instances) const
+{
+	u32 const instanceCount = instances.instanceCount();
+	if (isReady() && shader.isReady() && instanceCount > 0)
+	{
+		shader.setBool(env::g_config.uniforms.transform.isInstanced, true);
+		shader.flush();
+		threadImpl::countDraw();
+		bool const bIndexed = (m_ebo > 0 || m_allocation.isValid()) && m_indexCount > 0;
+		gfx::enqueue([data = instances.interleaved(), type = instances.drawType, vao = m_glID, vbo = m_batchVBO, instanceCount,
+					  vCount = m_vertexCount, iCount = bIndexed ? m_indexCount : 0, firstVertex = m_allocation.firstVertex(),
+					  firstIndex = m_allocation.firstIndex()]() {
+			setInstanceAttributes(data, vao, vbo, type);
+			glChk(glBindVertexArray(vao));
+			if (iCount > 0)
+			{
+				auto const pOffset = (void const*)(firstIndex * sizeof(u32));
+				glChk(glDrawElementsInstanced(GL_TRIANGLES, (GLsizei)iCount, GL_UNSIGNED_INT, pOffset, (GLsizei)instanceCount));
+			}
+			else
+			{
+				glChk(glDrawArraysInstanced(GL_TRIANGLES, (GLint)firstVertex, (GLsizei)vCount, (GLsizei)instanceCount));
+			}
+			return;
+		});
+	}
+	return;
+}
+
+void VertexArray::setInstanceAttributes(std::vector<glm::mat4> const& interleaved, GFXID vao, GFXID vbo, DrawType type)
+{
+	GLenum glType = type == DrawType::Dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW;
+	glChk(glBindBuffer(GL_ARRAY_BUFFER, vbo));
+	glChk(glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(interleaved.size() * sizeof(glm::mat4)), interleaved.data(), glType));
+	bindInstanceAttributes(vao, vbo);
+	return;
+}
+
+void VertexArray::bindInstanceAttributes(GFXID vao, GFXID vbo)
+{
+	GLint constexpr vaSize = 4;
+	auto constexpr stride = (GLsizei)(2 * sizeof(glm::mat4));
+	glChk(glBindVertexArray(vao));
+	glChk(glBindBuffer(GL_ARRAY_BUFFER, vbo));
+	for (u32 idx = 0; idx < (u32)vaSize; ++idx)
+	{
+		auto const offset = idx * sizeof(glm::vec4);
+		u32 const modelLoc = u32(s_instanceAttribLoc) + idx;
+		u32 const normalsLoc = u32(s_instanceNormalsAttribLoc) + idx;
+		glChk(glVertexAttribPointer(modelLoc, vaSize, GL_FLOAT, GL_FALSE, stride, (void*)offset));
+		glChk(glEnableVertexAttribArray(modelLoc));
+		glChk(glVertexAttribDivisor(modelLoc, 1));
+		glChk(glVertexAttribPointer(normalsLoc, vaSize, GL_FLOAT, GL_FALSE, stride, (void*)(offset + sizeof(glm::mat4))));
+		glChk(glEnableVertexAttribArray(normalsLoc));
+		glChk(glVertexAttribDivisor(normalsLoc, 1));
+	}
+	glChk(glBindBuffer(GL_ARRAY_BUFFER, 0));
+	glChk(glBindVertexArray(0));
+	return;
+}
+
+void VertexArray::setGeometryAttributes(Geometry geometry, GFXID vao, GFXID vbo, GFXID ebo, DrawType type, VertexFormat format)
 {
 	glChk(glBindVertexArray(vao));
 	glChk(glBindBuffer(GL_ARRAY_BUFFER, vbo));
 	GLenum glType = type == DrawType::Dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW;
+	if (!geometry.indices.empty())
+	{
+		GLsizeiptr size = GLsizeiptr(geometry.indices.size() * sizeof(u32));
+		glChk(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo));
+		glChk(glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, geometry.indices.data(), glType));
+	}
+	if (format == VertexFormat::Packed)
+	{
+		auto const vertices = vertexFormat::pack(geometry);
+		auto constexpr stride = (GLsizei)sizeof(PackedVertex);
+		glChk(glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(vertices.size() * sizeof(PackedVertex)), vertices.data(), glType));
+		glChk(glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(PackedVertex, position)));
+		glChk(glEnableVertexAttribArray(0));
+		// Normalised signed 10:10:10:2 => vec4 (aNormal reads xyz)
+		glChk(glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)offsetof(PackedVertex, normal)));
+		glChk(glEnableVertexAttribArray(1));
+		glChk(glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offsetof(PackedVertex, texCoord)));
+		glChk(glEnableVertexAttribArray(2));
+		return;
+	}
 	glChk(glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)geometry.byteCount(), nullptr, glType));
 	auto constexpr sv3 = (size_t)sizeof(Geometry::V3);
 	auto constexpr sv2 = (size_t)sizeof(Geometry::V2);
@@ -1034,12 +1242,6 @@ void VertexArray::setGeometryAttributes(Geometry geometry, GFXID vao, GFXID vbo,
 	glChk(glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)(sv3 * p.size()), p.data()));
 	glChk(glBufferSubData(GL_ARRAY_BUFFER, (GLsizeiptr)(sv3 * p.size()), (GLsizeiptr)(sv3 * n.size()), n.data()));
 	glChk(glBufferSubData(GL_ARRAY_BUFFER, (GLsizeiptr)(sv3 * (p.size() + n.size())), (GLsizeiptr)(sv2 * t.size()), t.data()));
-	if (!geometry.indices.empty())
-	{
-		GLsizeiptr size = GLsizeiptr(geometry.indices.size() * sizeof(u32));
-		glChk(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo));
-		glChk(glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, geometry.indices.data(), glType));
-	}
 	auto constexpr sf = (size_t)sizeof(f32);
 	// Position		: 3x vec3
 	GLint loc = 0;
@@ -1228,28 +1430,50 @@ bool Texture::setup(Descriptor descriptor, bytearray texBytes, u8 ch, u16 w, u16
 
 bool Texture::setup(Descriptor descriptor, bytearray image)
 {
-	s32 w, h, ch;
-	bool bRet;
-	stbi_uc* pData = nullptr;
+	auto decoded = decode(image);
+	if (decoded.pixels.empty())
 	{
-		Lock lock(g_stbiMutex);
-		stbi_set_flip_vertically_on_load(1);
-		pData = stbi_load_from_memory(reinterpret_cast<u8 const*>(image.data()), (s32)image.size(), &w, &h, &ch, 0);
+		LOG_E("[%s] Failed to load texture: [%s]!", typeName<Texture>().data(), descriptor.id.generic_string().data());
+		return false;
 	}
+	return setup(std::move(descriptor), std::move(decoded.pixels), decoded.channels, decoded.width, decoded.height);
+}
+
+Texture::Image Texture::decode(bytearray const& image, bool bFlipV)
+{
+	ByteView view;
+	view.pData = image.data();
+	view.size = image.size();
+	return decode(view, bFlipV);
+}
+
+Texture::Image Texture::decode(ByteView const& image, bool bFlipV)
+{
+	Image ret;
+	s32 w, h, ch;
+	// stbi_set_flip_vertically_on_load() is process-wide (and stb has no per-thread flag): never set it, flip while copying out instead
+	stbi_uc* pData = stbi_load_from_memory(reinterpret_cast<u8 const*>(image.pData), (s32)image.size, &w, &h, &ch, 0);
 	if (pData)
 	{
-		size_t size = size_t(w * h * ch);
-		bytearray texBytes(size);
-		std::memcpy(texBytes.data(), pData, size);
-		bRet = setup(std::move(descriptor), std::move(texBytes), (u8)ch, (u16)w, (u16)h);
-	}
-	else
-	{
-		LOG_E("[%s] Failed to load texture: [%s]!", typeName<Texture>().data(), descriptor.id.generic_string().data());
-		bRet = false;
+		auto const rowSize = (size_t)w * (size_t)ch;
+		ret.pixels.resize(rowSize * (size_t)h);
+		if (bFlipV)
+		{
+			for (s32 row = 0; row < h; ++row)
+			{
+				std::memcpy(ret.pixels.data() + (size_t)row * rowSize, pData + (size_t)(h - 1 - row) * rowSize, rowSize);
+			}
+		}
+		else
+		{
+			std::memcpy(ret.pixels.data(), pData, ret.pixels.size());
+		}
+		ret.width = (u16)w;
+		ret.height = (u16)h;
+		ret.channels = (u8)ch;
+		stbi_image_free(pData);
 	}
-	stbi_image_free(pData);
-	return bRet;
+	return ret;
 }
 
 void Texture::setSampler(Sampler const* pSampler)
@@ -1283,12 +1507,12 @@ bool Font::Descriptor::deserialise(JSONObj const& json)
 		sheetID = json.getString("sheetID");
 		samplerID = json.getString("sampler", "font");
 		auto glyphsData = json.getGData("glyphs");
-		for (auto const kvp : glyphsData.allFields())
+		for (auto const& kvp : glyphsData.allGDatas())
 		{
 			if (!kvp.first.empty())
 			{
 				Glyph glyph;
-				glyph.deserialise((u8)kvp.first.at(0), GData(kvp.second));
+				glyph.deserialise((u8)kvp.first.at(0), kvp.second);
 				if (glyph.cell.x > 0 && glyph.cell.y > 0)
 				{
 					glyphs.push_back(std::move(glyph));
@@ -1480,37 +1704,33 @@ bool Cubemap::setup(Descriptor descriptor, std::array<bytearray, 6> rludfb)
 	{
 		return false;
 	}
-	gfx::enqueue([this, rludfb = std::move(rludfb)]() {
+	// Decode here rather than on the render thread
+	std::array<Texture::Image, 6> sides;
+	for (size_t idx = 0; idx < sides.size(); ++idx)
+	{
+		sides[idx] = Texture::decode(rludfb[idx], false);
+		LOGIF_E(sides[idx].pixels.empty(), "Failed to load cubemap texture #%u!", (u32)idx);
+	}
+	gfx::enqueue([this, sides = std::move(sides)]() {
 		LOG_SETUP_ENTER(Cubemap, m_id);
 		glChk(glGenTextures(1, &m_glID.handle));
 		glChk(glBindTexture(GL_TEXTURE_CUBE_MAP, m_glID));
-		s32 w, h, ch;
 		u32 idx = 0;
-		for (auto const& side : rludfb)
+		for (auto const& side : sides)
 		{
-			stbi_uc* pData = nullptr;
-			{
-				Lock lock(g_stbiMutex);
-				stbi_set_flip_vertically_on_load(0);
-				pData = stbi_load_from_memory(reinterpret_cast<u8 const*>(side.data()), (s32)side.size(), &w, &h, &ch, 0);
-			}
-			if (pData)
+			if (!side.pixels.empty())
 			{
-				bool bAlpha = ch > 3;
+				bool bAlpha = side.channels > 3;
 				s32 channels = bAlpha ? GL_RGBA : GL_RGB;
-				glChk(glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + idx, 0, channels, w, h, 0, (u32)channels, GL_UNSIGNED_BYTE, pData));
+				glChk(glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + idx, 0, channels, side.width, side.height, 0, (u32)channels, GL_UNSIGNED_BYTE,
+								   side.pixels.data()));
 				glChk(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
 				glChk(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
 				glChk(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
 				glChk(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
 				glChk(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE));
 			}
-			else
-			{
-				LOG_E("Failed to load cubemap texture #%d!", idx);
-			}
 			++idx;
-			stbi_image_free(pData);
 		}
 		LOG_SETUP_ENTER(Cubemap, m_id);
 		return;
@@ -1642,10 +1862,12 @@ bool Mesh::setup(Descriptor descriptor)
 		return false;
 	}
 	m_geometry = std::move(descriptor.geometry);
+	m_bounds = m_geometry.bounds();
 	m_material = std::move(descriptor.material);
 	VertexArray::Descriptor desc;
 	desc.id = descriptor.id;
 	m_drawType = desc.drawType = descriptor.drawType;
+	m_vertexFormat = desc.format = descriptor.vertexFormat;
 	if (m_verts.setup(std::move(desc), m_geometry))
 	{
 		init(std::move(descriptor.id));
@@ -1660,6 +1882,7 @@ bool Mesh::regenerate(Geometry geometry)
 	if (isReady() && m_verts.isReady())
 	{
 		m_geometry = std::move(geometry);
+		m_bounds = m_geometry.bounds();
 		m_verts.updateGeometry(m_geometry);
 		return true;
 	}
@@ -1687,7 +1910,17 @@ void Mesh::draw(Shader const& shader) const
 	return;
 }
 
-void Mesh::render(Shader const& shader, Material const* pMaterial /* = nullptr */) const
+void Mesh::drawInstanced(Shader const& shader, InstanceBuffer const& instances) const
+{
+	if (isReady() && m_verts.isReady() && shader.isReady())
+	{
+		shader.setS32(env::g_config.uniforms.transform.isUI, false);
+		m_verts.drawInstanced(shader, instances);
+	}
+	return;
+}
+
+void Mesh::render(Shader const& shader, Material const* pMaterial /* = nullptr */, InstanceBuffer const* pInstances /* = nullptr */) const
 {
 	if (!pMaterial)
 	{
@@ -1698,7 +1931,14 @@ void Mesh::render(Shader const& shader, Material const* pMaterial /* = nullptr *
 		shader.setMaterial(*pMaterial);
 		shader.bind(m_textures);
 		shader.setS32(env::g_config.uniforms.transform.isUI, false);
-		m_verts.draw(shader);
+		if (pInstances)
+		{
+			m_verts.drawInstanced(shader, *pInstances);
+		}
+		else
+		{
+			m_verts.draw(shader);
+		}
 	}
 	return;
 }
@@ -1708,6 +1948,11 @@ DrawType Mesh::drawType() const
 	return m_drawType;
 }
 
+VertexFormat Mesh::vertexFormat() const
+{
+	return m_vertexFormat;
+}
+
 VertexArray const& Mesh::verts() const
 {
 	return m_verts;
@@ -1722,4 +1967,9 @@ InstanceBuffer const& Mesh::instances() const
 {
 	return m_instances;
 }
+
+AABB const& Mesh::bounds() const
+{
+	return m_bounds;
+}
 } // namespace le::gfx
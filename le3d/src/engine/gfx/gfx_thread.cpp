@@ -1,5 +1,4 @@
 #include <condition_variable>
-#include <deque>
 #include <mutex>
 #include <glad/glad.h>
 #include "le3d/defines.hpp"
@@ -18,7 +17,7 @@ namespace
 class DoubleBufferRenderer final
 {
 public:
-	using Buffer = std::deque<gfx::Deferred>;
+	using Buffer = gfx::CommandBuffer;
 
 public:
 	std::atomic_bool m_bWork = false;
@@ -28,6 +27,8 @@ public:
 	std::mutex m_renderMutex;
 	std::condition_variable m_renderDone;
 	bool m_bBusy = false;
+	// Headless render threads never own the GL context (there may be no window)
+	bool m_bOwnsContext = false;
 	HThread m_hWorker = 0;
 
 	Buffer m_bufA;
@@ -42,12 +43,12 @@ public:
 
 	bool isIdle() const;
 	bool isRunning() const;
+	void render(Buffer& buffer);
 
 private:
 	void work();
 	void swap();
 	void wait();
-	void render(Buffer& buffer);
 };
 
 #if defined(LE3D_HEAVY_RENDER_TOGGLE)
@@ -55,10 +56,19 @@ bool g_bForceHeavyRender = false;
 #endif
 DoubleBufferRenderer g_renderer;
 GFXMode g_mode = GFXMode::ImmediateMainThread;
+bool g_bHeadless = false;
+std::atomic<u32> g_enqueuedCount = 0;
+u32 g_lastFrameCommandCount = 0;
+std::atomic<u32> g_drawCount = 0;
+u32 g_lastFrameDrawCount = 0;
 
 void DoubleBufferRenderer::start()
 {
-	context::releaseContextThread();
+	m_bOwnsContext = !g_bHeadless;
+	if (m_bOwnsContext)
+	{
+		context::releaseContextThread();
+	}
 	m_bReady = false;
 	m_bWork = true;
 	m_hWorker = threads::newThread([this]() { work(); });
@@ -75,11 +85,13 @@ void DoubleBufferRenderer::stop()
 	LOG_I("[%s] Stopping Render Thread ...", typeName(*this).data());
 	m_bWork = false;
 	threads::join(m_hWorker);
-	context::setContextThread();
+	if (m_bOwnsContext)
+	{
+		context::setContextThread();
+	}
 	if (!m_pRenderBuf->empty())
 	{
-		auto buffer = std::move(*m_pRenderBuf);
-		render(buffer);
+		render(*m_pRenderBuf);
 	}
 	return;
 }
@@ -92,8 +104,7 @@ void DoubleBufferRenderer::present()
 	}
 	else
 	{
-		auto buffer = std::move(*m_pRenderBuf);
-		render(buffer);
+		render(*m_pRenderBuf);
 	}
 	swap();
 	return;
@@ -111,7 +122,10 @@ bool DoubleBufferRenderer::isRunning() const
 
 void DoubleBufferRenderer::work()
 {
-	context::setContextThread();
+	if (m_bOwnsContext)
+	{
+		context::setContextThread();
+	}
 	LOG_I("[%s] ... Render Thread Started", typeName(*this).data());
 	m_bReady = true;
 	while (m_bWork)
@@ -129,12 +143,16 @@ void DoubleBufferRenderer::work()
 		{
 			break;
 		}
+		// Rendered in place (retaining its blocks); present() waits on !m_bBusy before swapping
 		m_bBusy = true;
-		auto buffer = std::move(*m_pRenderBuf);
+		auto pBuffer = m_pRenderBuf;
 		lock.unlock();
-		render(buffer);
+		render(*pBuffer);
+	}
+	if (m_bOwnsContext)
+	{
+		context::releaseContextThread();
 	}
-	context::releaseContextThread();
 	LOG_I("[%s] ... Render Thread Stopped", typeName(*this).data());
 	return;
 }
@@ -157,11 +175,11 @@ void DoubleBufferRenderer::wait()
 
 void DoubleBufferRenderer::render(Buffer& buffer)
 {
-	for (auto& task : buffer)
+	if (!g_bHeadless)
 	{
 		cxChk();
-		task();
 	}
+	buffer.flush(!g_bHeadless);
 	return;
 }
 } // namespace
@@ -199,12 +217,7 @@ bool gfx::setMode(GFXMode mode)
 				g_renderer.stop();
 			}
 			std::lock_guard<std::mutex> lock(g_renderer.m_renderMutex);
-			auto pEnqueueBuf = g_renderer.m_pEnqueueBuf;
-			for (auto& task : *pEnqueueBuf)
-			{
-				cxChk();
-				task();
-			}
+			g_renderer.render(*g_renderer.m_pEnqueueBuf);
 			LOG_D("[%s] GFXMode set to ImmediateMainThread", typeName<DoubleBufferRenderer>().data());
 			break;
 		}
@@ -220,25 +233,43 @@ GFXMode gfx::mode()
 	return g_mode;
 }
 
-void gfx::enqueue(Deferred task)
+void gfx::setHeadless(bool bHeadless)
+{
+	g_bHeadless = bHeadless;
+	return;
+}
+
+bool gfx::isHeadless()
+{
+	return g_bHeadless;
+}
+
+gfx::CommandBuffer* gfx::threadImpl::lockRecordBuffer()
 {
+	g_enqueuedCount.fetch_add(1, std::memory_order_relaxed);
 	switch (g_mode)
 	{
 	default:
 	case GFXMode::BufferedMainThread:
 	case GFXMode::BufferedThreaded:
 	{
-		std::lock_guard<std::mutex> lock(g_renderer.m_renderMutex);
-		g_renderer.m_pEnqueueBuf->push_back(std::move(task));
-		break;
+		g_renderer.m_renderMutex.lock();
+		return g_renderer.m_pEnqueueBuf;
 	}
 	case GFXMode::ImmediateMainThread:
 	{
-		cxChk();
-		task();
-		break;
+		if (!g_bHeadless)
+		{
+			cxChk();
+		}
+		return nullptr;
 	}
 	}
+}
+
+void gfx::threadImpl::unlockRecordBuffer()
+{
+	g_renderer.m_renderMutex.unlock();
 	return;
 }
 
@@ -258,6 +289,13 @@ void gfx::present(Deferred onSwap)
 		}
 	});
 	++contextImpl::g_context.swapCount;
+	if (g_bHeadless)
+	{
+		// The swap command above is dropped, not run: count the frame as rendered here
+		++contextImpl::g_context.framesRendered;
+	}
+	g_lastFrameCommandCount = g_enqueuedCount.exchange(0, std::memory_order_relaxed);
+	g_lastFrameDrawCount = g_drawCount.exchange(0, std::memory_order_relaxed);
 	g_renderer.present();
 #if defined(LE3D_ASSERTS)
 	u64 diff = contextImpl::g_context.swapCount - contextImpl::g_context.framesRendered;
@@ -268,4 +306,20 @@ void gfx::present(Deferred onSwap)
 	// LOG_D("Ticked: %lu, Rendered: %lu", context::framesTicked(), context::framesRendered());
 	return;
 }
+
+u32 gfx::lastFrameCommandCount()
+{
+	return g_lastFrameCommandCount;
+}
+
+u32 gfx::lastFrameDrawCount()
+{
+	return g_lastFrameDrawCount;
+}
+
+void gfx::threadImpl::countDraw()
+{
+	g_drawCount.fetch_add(1, std::memory_order_relaxed);
+	return;
+}
 } // namespace le
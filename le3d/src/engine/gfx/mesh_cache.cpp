@@ -0,0 +1,325 @@
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+#include "le3d/core/log.hpp"
+#include "engine/gfx/mesh_cache.hpp"
+
+namespace le::gfx
+{
+namespace
+{
+constexpr u32 MAGIC = 0x4d33454c; // "LE3M"
+constexpr u32 VERSION = 1;
+
+struct Writer final
+{
+	bytearray bytes;
+
+	template <typename T>
+	void pod(T const& value);
+	void str(std::string_view value);
+	void raw(void const* pData, size_t size);
+};
+
+struct Reader final
+{
+	ByteView const& bytes;
+	size_t pos = 0;
+	bool bOK = true;
+
+	template <typename T>
+	T pod();
+	std::string str();
+	void raw(void* pData, size_t size);
+	// Fails the reader unless at least count * size bytes remain (guards reserve() / resize() against corrupt counts)
+	bool expect(size_t count, size_t size);
+};
+
+// Smallest possible serialised texture entry / mesh (empty strings, no texture indices, vertices or indices)
+constexpr size_t MIN_TEX_SIZE = 3 * sizeof(u32) + sizeof(u8);
+constexpr size_t MIN_MESH_SIZE = 2 * sizeof(u32) + sizeof(u32) + 3 * sizeof(glm::vec3) + 2 * sizeof(f32) + 4 * sizeof(u8) + 3 * sizeof(u32);
+
+template <typename T>
+void Writer::pod(T const& value)
+{
+	static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable!");
+	raw(&value, sizeof(T));
+	return;
+}
+
+void Writer::str(std::string_view value)
+{
+	pod((u32)value.size());
+	raw(value.data(), value.size());
+	return;
+}
+
+void Writer::raw(void const* pData, size_t size)
+{
+	size_t const offset = bytes.size();
+	bytes.resize(offset + size);
+	if (size > 0)
+	{
+		std::memcpy(bytes.data() + offset, pData, size);
+	}
+	return;
+}
+
+template <typename T>
+T Reader::pod()
+{
+	static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable!");
+	T ret{};
+	raw(&ret, sizeof(T));
+	return ret;
+}
+
+std::string Reader::str()
+{
+	u32 const size = pod<u32>();
+	if (!expect(size, 1))
+	{
+		return {};
+	}
+	std::string ret(size, '\0');
+	raw(ret.data(), ret.size());
+	return ret;
+}
+
+void Reader::raw(void* pData, size_t size)
+{
+	if (!bOK || pos + size > bytes.size)
+	{
+		bOK = false;
+		return;
+	}
+	if (size > 0)
+	{
+		std::memcpy(pData, bytes.pData + pos, size);
+	}
+	pos += size;
+	return;
+}
+
+bool Reader::expect(size_t count, size_t size)
+{
+	if (bOK && (size > 0 && count > (bytes.size - pos) / size))
+	{
+		bOK = false;
+	}
+	return bOK;
+}
+} // namespace
+
+u64 meshCache::sourceHash(std::initializer_list<std::string_view> sources)
+{
+	// FNV-1a, salted with the format version so that a layout change invalidates old caches
+	u64 hash = 14695981039346656037ULL ^ VERSION;
+	for (auto source : sources)
+	{
+		for (auto c : source)
+		{
+			hash ^= (u8)c;
+			hash *= 1099511628211ULL;
+		}
+		hash ^= 0xff;
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+stdfs::path meshCache::cacheID(stdfs::path const& modelID)
+{
+	std::string ret = modelID.generic_string();
+	for (auto& c : ret)
+	{
+		if (c == '/' || c == ':')
+		{
+			c = '_';
+		}
+	}
+	ret += ".le3dmesh";
+	return ret;
+}
+
+bool meshCache::read(ByteView const& bytes, u64 sourceHash, Model::Descriptor& outDescriptor)
+{
+	Reader reader{bytes};
+	if (reader.pod<u32>() != MAGIC || reader.pod<u32>() != VERSION || reader.pod<u64>() != sourceHash || !reader.bOK)
+	{
+		return false;
+	}
+	Model::Descriptor descriptor;
+	descriptor.id = reader.str();
+	u32 const texCount = reader.pod<u32>();
+	u32 const meshCount = reader.pod<u32>();
+	if (!reader.expect(texCount, MIN_TEX_SIZE))
+	{
+		return false;
+	}
+	descriptor.textures.reserve(texCount);
+	for (u32 t = 0; t < texCount && reader.bOK; ++t)
+	{
+		Model::TexData tex;
+		tex.id = reader.str();
+		tex.filename = reader.str();
+		tex.samplerID = reader.str();
+		u8 const type = reader.pod<u8>();
+		if (type > (u8)TexType::Specular)
+		{
+			return false;
+		}
+		tex.type = (TexType)type;
+		descriptor.textures.push_back(std::move(tex));
+	}
+	if (!reader.expect(meshCount, MIN_MESH_SIZE))
+	{
+		return false;
+	}
+	descriptor.meshes.reserve(meshCount);
+	for (u32 m = 0; m < meshCount && reader.bOK; ++m)
+	{
+		Model::MeshData mesh;
+		mesh.id = reader.str();
+		mesh.material.id = reader.str();
+		mesh.material.flags.bits = decltype(mesh.material.flags.bits)(reader.pod<u32>());
+		mesh.material.albedo.ambient = reader.pod<glm::vec3>();
+		mesh.material.albedo.diffuse = reader.pod<glm::vec3>();
+		mesh.material.albedo.specular = reader.pod<glm::vec3>();
+		mesh.material.albedo.shininess = reader.pod<f32>();
+		auto const tint = reader.pod<std::array<u8, 4>>();
+		mesh.material.tint = Colour(tint[0], tint[1], tint[2], tint[3]);
+		mesh.shininess = reader.pod<f32>();
+		u32 const texIdxCount = reader.pod<u32>();
+		if (!reader.expect(texIdxCount, sizeof(u32)))
+		{
+			return false;
+		}
+		mesh.texIndices.reserve(texIdxCount);
+		for (u32 i = 0; i < texIdxCount; ++i)
+		{
+			u32 const texIdx = reader.pod<u32>();
+			if (texIdx >= texCount)
+			{
+				return false;
+			}
+			mesh.texIndices.push_back((size_t)texIdx);
+		}
+		u32 const vertCount = reader.pod<u32>();
+		u32 const idxCount = reader.pod<u32>();
+		if (!reader.expect((size_t)vertCount * 8 * sizeof(f32) + (size_t)idxCount * sizeof(u32), 1))
+		{
+			return false;
+		}
+		auto& geometry = mesh.geometry;
+		geometry.points.resize(vertCount);
+		geometry.normals.resize(vertCount);
+		geometry.texCoords.resize(vertCount);
+		geometry.indices.resize(idxCount);
+		for (u32 v = 0; v < vertCount; ++v)
+		{
+			reader.raw(&geometry.points[v], sizeof(Geometry::V3));
+			reader.raw(&geometry.normals[v], sizeof(Geometry::V3));
+			reader.raw(&geometry.texCoords[v], sizeof(Geometry::V2));
+		}
+		reader.raw(geometry.indices.data(), idxCount * sizeof(u32));
+		for (auto index : geometry.indices)
+		{
+			if (index >= vertCount)
+			{
+				return false;
+			}
+		}
+		descriptor.meshes.push_back(std::move(mesh));
+	}
+	if (!reader.bOK)
+	{
+		return false;
+	}
+	outDescriptor = std::move(descriptor);
+	return true;
+}
+
+bool meshCache::write(Model::Descriptor const& descriptor, u64 sourceHash, stdfs::path const& filePath)
+{
+	Writer writer;
+	// Reserved once up front: vertex / index payloads dominate, strings and materials may still grow it slightly
+	size_t reserve = 256 + descriptor.textures.size() * 256;
+	for (auto const& mesh : descriptor.meshes)
+	{
+		reserve += MIN_MESH_SIZE + 256 + mesh.texIndices.size() * sizeof(u32);
+		reserve += mesh.geometry.vertexCount() * 8 * sizeof(f32) + mesh.geometry.indices.size() * sizeof(u32);
+	}
+	writer.bytes.reserve(reserve);
+	writer.pod(MAGIC);
+	writer.pod(VERSION);
+	writer.pod(sourceHash);
+	writer.str(descriptor.id.generic_string());
+	writer.pod((u32)descriptor.textures.size());
+	writer.pod((u32)descriptor.meshes.size());
+	for (auto const& tex : descriptor.textures)
+	{
+		writer.str(tex.id);
+		writer.str(tex.filename.generic_string());
+		writer.str(tex.samplerID);
+		writer.pod((u8)tex.type);
+	}
+	for (auto const& mesh : descriptor.meshes)
+	{
+		auto const& geometry = mesh.geometry;
+		u32 const vertCount = geometry.vertexCount();
+		if (geometry.normals.size() != vertCount || geometry.texCoords.size() != vertCount)
+		{
+			LOG_W("[%s] [%s] Non-uniform vertex streams, not caching", typeName<Model>().data(), mesh.id.data());
+			return false;
+		}
+		writer.str(mesh.id);
+		writer.str(mesh.material.id.generic_string());
+		writer.pod((u32)mesh.material.flags.bits.to_ulong());
+		writer.pod(mesh.material.albedo.ambient);
+		writer.pod(mesh.material.albedo.diffuse);
+		writer.pod(mesh.material.albedo.specular);
+		writer.pod(mesh.material.albedo.shininess);
+		writer.pod(mesh.material.tint.r.rawValue);
+		writer.pod(mesh.material.tint.g.rawValue);
+		writer.pod(mesh.material.tint.b.rawValue);
+		writer.pod(mesh.material.tint.a.rawValue);
+		writer.pod(mesh.shininess);
+		writer.pod((u32)mesh.texIndices.size());
+		for (auto texIdx : mesh.texIndices)
+		{
+			writer.pod((u32)texIdx);
+		}
+		writer.pod(vertCount);
+		writer.pod((u32)geometry.indices.size());
+		for (u32 v = 0; v < vertCount; ++v)
+		{
+			writer.pod(geometry.points[v]);
+			writer.pod(geometry.normals[v]);
+			writer.pod(geometry.texCoords[v]);
+		}
+		writer.raw(geometry.indices.data(), geometry.indices.size() * sizeof(u32));
+	}
+	std::error_code ec;
+	stdfs::create_directories(filePath.parent_path(), ec);
+	// Write to a temporary and rename, so that a concurrent reader never sees a partial file
+	auto tempPath = filePath;
+	tempPath += ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file.good())
+		{
+			LOG_W("[%s] Failed to open [%s] for writing", typeName<Model>().data(), tempPath.generic_string().data());
+			return false;
+		}
+		file.write((char const*)writer.bytes.data(), (std::streamsize)writer.bytes.size());
+		if (!file.good())
+		{
+			return false;
+		}
+	}
+	stdfs::rename(tempPath, filePath, ec);
+	return !ec;
+}
+} // namespace le::gfx
@@ -0,0 +1,18 @@
+#pragma once
+#include <initializer_list>
+#include <string_view>
+#include "le3d/engine/gfx/model.hpp"
+
+namespace le::gfx::meshCache
+{
+// Binary container for a parsed Model::Descriptor (everything except texture bytes):
+// header (magic, version, source hash), texture table, then per mesh: material, texture indices,
+// interleaved vertices (pos3 | normal3 | uv2) and u32 indices.
+
+u64 sourceHash(std::initializer_list<std::string_view> sources);
+stdfs::path cacheID(stdfs::path const& modelID);
+
+// Returns false (leaving outDescriptor untouched) if bytes are malformed or were built from a different source
+bool read(ByteView const& bytes, u64 sourceHash, Model::Descriptor& outDescriptor);
+bool write(Model::Descriptor const& descriptor, u64 sourceHash, stdfs::path const& filePath);
+} // namespace le::gfx::meshCache
@@ -1,19 +1,77 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
 #include <memory>
+#include <unordered_map>
 #include <unordered_set>
 #include <tinyobjloader/tiny_obj_loader.h>
 #include "le3d/defines.hpp"
 #include "le3d/core/assert.hpp"
+#include "le3d/core/jobs.hpp"
 #include "le3d/core/profiler.hpp"
+#include "le3d/core/utils.hpp"
 #include "le3d/env/env.hpp"
 #include "le3d/engine/context.hpp"
 #include "le3d/engine/gfx/gfx_store.hpp"
 #include "le3d/engine/gfx/gfx_thread.hpp"
 #include "le3d/engine/gfx/model.hpp"
+#include "engine/gfx/mesh_cache.hpp"
 
 namespace le::gfx
 {
 namespace
 {
+// Bit patterns (or quantised cells, when welding with an epsilon) of position, normal and UV
+struct VertexKey final
+{
+	std::array<u64, 8> components;
+
+	bool operator==(VertexKey const& rhs) const;
+};
+
+struct VertexKeyHasher final
+{
+	size_t operator()(VertexKey const& key) const;
+};
+
+bool VertexKey::operator==(VertexKey const& rhs) const
+{
+	return components == rhs.components;
+}
+
+size_t VertexKeyHasher::operator()(VertexKey const& key) const
+{
+	// FNV-1a over the eight components
+	u64 hash = 14695981039346656037ULL;
+	for (auto component : key.components)
+	{
+		hash ^= component;
+		hash *= 1099511628211ULL;
+	}
+	return (size_t)hash;
+}
+
+u64 weldComponent(f32 value, f32 epsilon)
+{
+	if (epsilon > 0.0f)
+	{
+		// 64-bit cells never wrap (values far apart can't share a key); cells are clamped to a range llround() can represent,
+		// and NaNs get a key outside it
+		constexpr f64 maxCell = (f64)(1LL << 62);
+		if (std::isnan(value))
+		{
+			return 1ULL << 63;
+		}
+		return (u64)std::llround(std::clamp((f64)value / (f64)epsilon, -maxCell, maxCell));
+	}
+	// Treat -0.0f and 0.0f as equal, as operator== on the attributes did
+	value = value == 0.0f ? 0.0f : value;
+	u32 ret;
+	std::memcpy(&ret, &value, sizeof(ret));
+	return (u64)ret;
+}
+
 class OBJParser final
 {
 public:
@@ -28,14 +86,18 @@ private:
 	Model::LoadRequest const& m_request;
 	std::string m_samplerID;
 	f32 m_scale = 1.0f;
+	f32 m_weldEpsilon = 0.0f;
+	VertexFormat m_vertexFormat = VertexFormat::Float32;
 
 public:
 	OBJParser(Model::LoadRequest const& loadRequest);
 
 private:
+	bool loadCache(stdfs::path const& cacheID, u64 sourceHash);
+	void loadTextures();
 	size_t getTexIdx(std::string id, std::string_view texName, TexType type);
-	Model::MeshData processShape(tinyobj::shape_t const& shape);
-	void setName(Model::MeshData& outMesh, tinyobj::shape_t const& shape);
+	void processShapes();
+	void setName(Model::MeshData& outMesh, tinyobj::shape_t const& shape, size_t shapeIdx);
 	void setVertices(Model::MeshData& outMesh, tinyobj::shape_t const& shape);
 	void setMaterials(Model::MeshData& outMesh, tinyobj::shape_t const& shape);
 };
@@ -44,7 +106,8 @@ OBJParser::OBJParser(Model::LoadRequest const& loadRequest) : m_request(loadRequ
 {
 	ASSERT(m_request.pReader, "Reader is null!");
 	auto const jsonID = (m_request.jsonID / m_request.jsonID.filename()).string() + ".json";
-	GData json(m_request.pReader->getString(jsonID));
+	auto const jsonView = m_request.pReader->getView(jsonID);
+	GData json(jsonView);
 	if (!m_request.pReader)
 	{
 		LOG_E("[%s] Reader is null!", typeName<Model>().data());
@@ -60,25 +123,46 @@ OBJParser::OBJParser(Model::LoadRequest const& loadRequest) : m_request(loadRequ
 	auto mtlPath = m_request.jsonID / json.getString("mtl", "");
 	m_samplerID = json.getString("sampler", "samplers/default");
 	m_scale = (f32)json.getF64("scale", 1.0f);
+	m_weldEpsilon = (f32)json.getF64("weldEpsilon", 0.0f);
+	auto vertexFormat = json.getString("vertexFormat", "float32");
+	utils::strings::toLower(vertexFormat);
+	m_vertexFormat = vertexFormat == "packed" ? VertexFormat::Packed : VertexFormat::Float32;
 	auto id = json.getString("id", "models/UNNAMED");
-	auto objBuf = m_request.pReader->getStr(objPath);
-	auto mtlBuf = m_request.pReader->getStr(mtlPath);
 	if (!m_request.pReader->checkPresence(objPath) || !m_request.pReader->checkPresence(mtlPath))
 	{
 		LOG_E("[%s] .OBJ / .MTL data not present in [%s]: [%s], [%s]!", typeName<Model>().data(), m_request.pReader->medium().data(),
 			  objPath.generic_string().data(), mtlPath.generic_string().data());
 		return;
 	}
+	// Parsed in place (mapped, for FileReader)
+	auto const objView = m_request.pReader->getView(objPath);
+	auto const mtlView = m_request.pReader->getView(mtlPath);
 
-	m_uMatStrReader = std::make_unique<tinyobj::MaterialStreamReader>(mtlBuf);
 	auto idStr = m_request.jsonID.generic_string();
+	u64 sourceHash = 0;
+	stdfs::path cacheID;
+	if (!m_request.cacheDir.empty())
+	{
+		sourceHash = meshCache::sourceHash({jsonView.str(), objView.str(), mtlView.str()});
+		cacheID = meshCache::cacheID(m_request.jsonID);
+		if (loadCache(cacheID, sourceHash))
+		{
+			m_descriptor.vertexFormat = m_vertexFormat;
+			loadTextures();
+			return;
+		}
+	}
+
+	ByteViewStream objStream(objView);
+	ByteViewStream mtlStream(mtlView);
+	m_uMatStrReader = std::make_unique<tinyobj::MaterialStreamReader>(mtlStream);
 	std::string warn, err;
 	bool bOK = false;
 	{
 #if defined(LE3D_PROFILE_MODEL_LOADS)
 		Profiler pr(idStr + "-TinyObj", LogLevel::Info);
 #endif
-		bOK = tinyobj::LoadObj(&m_attrib, &m_shapes, &m_materials, &warn, &err, &objBuf, m_uMatStrReader.get());
+		bOK = tinyobj::LoadObj(&m_attrib, &m_shapes, &m_materials, &warn, &err, &objStream, m_uMatStrReader.get());
 	}
 	if (m_shapes.empty())
 	{
@@ -101,23 +185,53 @@ OBJParser::OBJParser(Model::LoadRequest const& loadRequest) : m_request(loadRequ
 	if (bOK)
 	{
 		m_descriptor.id = id;
+		m_descriptor.vertexFormat = m_vertexFormat;
 		{
 #if defined(LE3D_PROFILE_MODEL_LOADS)
 			Profiler pr(idStr + "-MeshData", LogLevel::Info);
 #endif
-			for (auto const& shape : m_shapes)
+			processShapes();
+		}
+		if (!cacheID.empty())
+		{
+			if (meshCache::write(m_descriptor, sourceHash, m_request.cacheDir / cacheID))
 			{
-				m_descriptor.meshes.push_back(processShape(shape));
+				LOG_D("[%s] [%s] Mesh cache written", typeName<Model>().data(), idStr.data());
 			}
 		}
+		loadTextures();
+	}
+}
+
+bool OBJParser::loadCache(stdfs::path const& cacheID, u64 sourceHash)
+{
 #if defined(LE3D_PROFILE_MODEL_LOADS)
-		Profiler pr(idStr + "-TexData", LogLevel::Info);
+	Profiler pr(m_request.jsonID.generic_string() + "-MeshCache", LogLevel::Info);
 #endif
-		for (size_t i = 0; i < m_descriptor.textures.size(); ++i)
-		{
-			m_descriptor.textures[i].bytes = m_request.pReader->getBytes(m_descriptor.textures[i].filename);
-		}
+	FileReader cacheReader(m_request.cacheDir);
+	if (!cacheReader.isPresent(cacheID))
+	{
+		return false;
 	}
+	if (!meshCache::read(cacheReader.getView(cacheID), sourceHash, m_descriptor))
+	{
+		LOG_D("[%s] [%s] Stale or invalid mesh cache, rebuilding", typeName<Model>().data(), m_request.jsonID.generic_string().data());
+		return false;
+	}
+	return true;
+}
+
+void OBJParser::loadTextures()
+{
+#if defined(LE3D_PROFILE_MODEL_LOADS)
+	Profiler pr(m_request.jsonID.generic_string() + "-TexData", LogLevel::Info);
+#endif
+	auto& textures = m_descriptor.textures;
+	auto const pReader = m_request.pReader;
+	jobs::parallelFor(
+		0, textures.size(), [pReader, &textures](size_t idx) { textures[idx].image = Texture::decode(pReader->getView(textures[idx].filename)); },
+		1);
+	return;
 }
 
 size_t OBJParser::getTexIdx(std::string id, std::string_view texName, TexType type)
@@ -138,22 +252,28 @@ size_t OBJParser::getTexIdx(std::string id, std::string_view texName, TexType ty
 	return m_descriptor.textures.size() - 1;
 }
 
-Model::MeshData OBJParser::processShape(tinyobj::shape_t const& shape)
+void OBJParser::processShapes()
 {
-	Model::MeshData meshData;
-	setName(meshData, shape);
-	setVertices(meshData, shape);
-	setMaterials(meshData, shape);
-	return meshData;
+	auto& meshes = m_descriptor.meshes;
+	meshes.resize(m_shapes.size());
+	// Names and materials mutate shared tables (mesh IDs, texture list); keep them serial so indices are deterministic
+	for (size_t idx = 0; idx < m_shapes.size(); ++idx)
+	{
+		setName(meshes[idx], m_shapes[idx], idx);
+		setMaterials(meshes[idx], m_shapes[idx]);
+	}
+	// Vertex welding only reads m_attrib and writes its own mesh
+	jobs::parallelFor(0, m_shapes.size(), [this, &meshes](size_t idx) { setVertices(meshes[idx], m_shapes[idx]); }, 1);
+	return;
 }
 
-void OBJParser::setName(Model::MeshData& outMesh, tinyobj::shape_t const& shape)
+void OBJParser::setName(Model::MeshData& outMesh, tinyobj::shape_t const& shape, size_t shapeIdx)
 {
 	std::stringstream id;
 	id << m_request.jsonID.generic_string() << "-" << shape.name;
-	if (m_meshIDs.find(outMesh.id) != m_meshIDs.end())
+	if (m_meshIDs.find(id.str()) != m_meshIDs.end())
 	{
-		id << "-" << m_descriptor.meshes.size();
+		id << "-" << shapeIdx;
 		LOG_W("[Model::Data] [%s] Duplicate mesh name in [%s]!", shape.name.data(), m_request.jsonID.generic_string().data());
 	}
 	outMesh.id = id.str();
@@ -163,6 +283,9 @@ void OBJParser::setName(Model::MeshData& outMesh, tinyobj::shape_t const& shape)
 
 void OBJParser::setVertices(Model::MeshData& outMesh, tinyobj::shape_t const& shape)
 {
+	std::unordered_map<VertexKey, u32, VertexKeyHasher> welded;
+	welded.reserve(shape.mesh.indices.size());
+	outMesh.geometry.indices.reserve(shape.mesh.indices.size());
 	for (auto const& idx : shape.mesh.indices)
 	{
 		f32 vx = m_attrib.vertices[3 * (size_t)idx.vertex_index + 0] * m_scale;
@@ -173,23 +296,19 @@ void OBJParser::setVertices(Model::MeshData& outMesh, tinyobj::shape_t const& sh
 		f32 nz = m_attrib.normals.empty() || idx.normal_index < 0 ? 0.0f : m_attrib.normals[3 * (size_t)idx.normal_index + 2];
 		f32 tx = m_attrib.texcoords.empty() || idx.texcoord_index < 0 ? 0.0f : m_attrib.texcoords[2 * (size_t)idx.texcoord_index + 0];
 		f32 ty = m_attrib.texcoords.empty() || idx.texcoord_index < 0 ? 0.0f : m_attrib.texcoords[2 * (size_t)idx.texcoord_index + 1];
-		size_t vertCount = outMesh.geometry.vertexCount();
-		bool bFound = false;
-		for (size_t i = 0; i < vertCount; ++i)
+		VertexKey const key = {{weldComponent(vx, m_weldEpsilon), weldComponent(vy, m_weldEpsilon), weldComponent(vz, m_weldEpsilon),
+								weldComponent(nx, m_weldEpsilon), weldComponent(ny, m_weldEpsilon), weldComponent(nz, m_weldEpsilon),
+								weldComponent(tx, m_weldEpsilon), weldComponent(ty, m_weldEpsilon)}};
+		auto search = welded.find(key);
+		if (search != welded.end())
 		{
-			auto const& p = outMesh.geometry.points;
-			auto const& n = outMesh.geometry.normals;
-			auto const& t = outMesh.geometry.texCoords;
-			if (p[i] == Geometry::V3{vx, vy, vz} && n[i] == Geometry::V3{nx, ny, nz} && t[i] == Geometry::V2{tx, ty})
-			{
-				bFound = true;
-				outMesh.geometry.indices.push_back((u32)i);
-				break;
-			}
+			outMesh.geometry.indices.push_back(search->second);
 		}
-		if (!bFound)
+		else
 		{
-			outMesh.geometry.indices.push_back(outMesh.geometry.addVertex({vx, vy, vz}, {nx, ny, nz}, glm::vec2(tx, ty)));
+			u32 const newIdx = outMesh.geometry.addVertex({vx, vy, vz}, {nx, ny, nz}, glm::vec2(tx, ty));
+			welded.emplace(key, newIdx);
+			outMesh.geometry.indices.push_back(newIdx);
 		}
 	}
 	return;
@@ -295,8 +414,9 @@ bool Model::setup(Descriptor descriptor)
 			ASSERT(search == m_loadedTextures.end(), "Duplicate texture!");
 			if (search == m_loadedTextures.end())
 			{
-				ASSERT(!texData.bytes.empty(), "Texture has no data!");
-				if (texData.bytes.empty())
+				bool const bDecoded = !texData.image.pixels.empty();
+				ASSERT(bDecoded || !texData.bytes.empty(), "Texture has no data!");
+				if (!bDecoded && texData.bytes.empty())
 				{
 					LOG_E("[%s] [%s] Data::Tex has no data!", typeName(*this).data(), texData.id.data());
 				}
@@ -307,7 +427,10 @@ bool Model::setup(Descriptor descriptor)
 					newTexDesc.id = texData.id;
 					newTexDesc.type = texData.type;
 					newTexDesc.samplerID = std::move(texData.samplerID);
-					if (uNewTex->setup(std::move(newTexDesc), std::move(texData.bytes)))
+					auto& image = texData.image;
+					bool const bSetup = bDecoded ? uNewTex->setup(std::move(newTexDesc), std::move(image.pixels), image.channels, image.width, image.height)
+												 : uNewTex->setup(std::move(newTexDesc), std::move(texData.bytes));
+					if (bSetup)
 					{
 						m_loadedTextures.emplace(texData.id, std::move(uNewTex));
 					}
@@ -319,13 +442,20 @@ bool Model::setup(Descriptor descriptor)
 			auto uNewMesh = std::make_unique<Mesh>();
 			Mesh::Descriptor newMeshDesc;
 			newMeshDesc.id = meshData.id;
-			newMeshDesc.drawType = DrawType::Dynamic;
+			// Packed into shared GeometryArena buffers
+			newMeshDesc.drawType = DrawType::Static;
+			newMeshDesc.vertexFormat = descriptor.vertexFormat;
 			newMeshDesc.material = std::move(meshData.material);
 			newMeshDesc.geometry = std::move(meshData.geometry);
 			if (uNewMesh->setup(std::move(newMeshDesc)))
 			{
 				for (auto texIdx : meshData.texIndices)
 				{
+					if (texIdx >= descriptor.textures.size())
+					{
+						LOG_E("[%s] [%s] Invalid texture index [%zu]!", typeName(*this).data(), meshData.id.data(), texIdx);
+						continue;
+					}
 					auto const& texData = descriptor.textures[texIdx];
 					auto search = m_loadedTextures.find(texData.id);
 					if (search != m_loadedTextures.end())
@@ -342,7 +472,14 @@ bool Model::setup(Descriptor descriptor)
 			}
 		}
 	}
-	std::copy(descriptor.meshRefs.begin(), descriptor.meshRefs.end(), std::back_inserter(m_meshes));
+	for (auto pMesh : descriptor.meshRefs)
+	{
+		ASSERT(pMesh, "Mesh is null!");
+		if (pMesh)
+		{
+			addMesh(*pMesh);
+		}
+	}
 	LOGIF_W(m_meshes.empty(), "[%s] [%s] Model: No meshes present in passed data!", typeName(*this).data(), m_id.data());
 	gfx::enqueue([this]() { m_glID = ++s_nextID.handle; });
 	init(std::move(descriptor.id));
@@ -353,58 +490,75 @@ void Model::addMesh(Mesh const& mesh)
 {
 	ASSERT(&mesh, "Mesh is null!");
 	m_meshes.push_back(&mesh);
+	m_bounds.add(mesh.bounds());
 }
 
-void Model::render(Shader const& shader) const
+void Model::render(Shader const& shader, InstanceBuffer const* pInstances /* = nullptr */) const
 {
 	if (!shader.isReady())
 	{
 		return;
 	}
-	auto const& m = env::g_config.uniforms.material;
 	for (auto pMesh : m_meshes)
 	{
 		ASSERT(pMesh, "Mesh is null!");
-		if (!pMesh || !pMesh->isReady())
+		if (pMesh)
 		{
-			continue;
+			render(shader, *pMesh, pInstances);
 		}
-		shader.setMaterial(pMesh->m_material);
-		auto pBlank = GFXStore::instance()->m_pBlankTexture;
+	}
+	shader.unbind({TexType::Diffuse, TexType::Specular});
+	return;
+}
+
+void Model::render(Shader const& shader, Mesh const& mesh, InstanceBuffer const* pInstances /* = nullptr */) const
+{
+	if (!shader.isReady() || !mesh.isReady())
+	{
+		return;
+	}
+	auto const& m = env::g_config.uniforms.material;
+	shader.setMaterial(mesh.m_material);
+	auto pBlank = GFXStore::instance()->m_pBlankTexture;
 #if defined(LE3D_DEBUG)
-		if (m_bDEBUG && pBlank)
-		{
-			shader.bind({pBlank});
-			shader.setV4(m.tint, Colour::Magenta);
-		}
-		else
-		{
+	if (m_bDEBUG && pBlank)
+	{
+		shader.bind({pBlank});
+		shader.setV4(m.tint, Colour::Magenta);
+	}
+	else
+	{
 #endif
-			if (pMesh->m_material.flags.isSet(Material::Flag::Textured))
+		if (mesh.m_material.flags.isSet(Material::Flag::Textured))
+		{
+			if (mesh.m_textures.empty())
 			{
-				if (pMesh->m_textures.empty())
-				{
-					shader.bind({pBlank});
-					shader.setV4(m.tint, Colour::Magenta);
-				}
-				else
-				{
-					shader.bind(pMesh->m_textures);
-				}
-				shader.setS32(m.isTextured, 1);
+				shader.bind({pBlank});
+				shader.setV4(m.tint, Colour::Magenta);
 			}
 			else
 			{
-				shader.unbind({TexType::Diffuse, TexType::Specular});
-				shader.setS32(m.isTextured, 0);
+				shader.bind(mesh.m_textures);
 			}
-#if defined(LE3D_DEBUG)
+			shader.setS32(m.isTextured, 1);
 		}
+		else
+		{
+			shader.unbind({TexType::Diffuse, TexType::Specular});
+			shader.setS32(m.isTextured, 0);
+		}
+#if defined(LE3D_DEBUG)
+	}
 #endif
-		pMesh->draw(shader);
-		shader.setV4(m.tint, Colour::White);
+	if (pInstances)
+	{
+		mesh.drawInstanced(shader, *pInstances);
 	}
-	shader.unbind({TexType::Diffuse, TexType::Specular});
+	else
+	{
+		mesh.draw(shader);
+	}
+	shader.setV4(m.tint, Colour::White);
 	return;
 }
 
@@ -412,4 +566,9 @@ u32 Model::meshCount() const
 {
 	return (u32)m_meshes.size();
 }
+
+AABB const& Model::bounds() const
+{
+	return m_bounds;
+}
 } // namespace le::gfx
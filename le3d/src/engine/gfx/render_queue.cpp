@@ -0,0 +1,176 @@
+#include <array>
+#include <cstring>
+#include "le3d/core/assert.hpp"
+#include "le3d/engine/gfx/model.hpp"
+#include "le3d/engine/gfx/render_queue.hpp"
+#include "le3d/engine/gfx/utils.hpp"
+
+namespace le::gfx
+{
+namespace
+{
+// Top `bits` bits of a non-negative float (its bit pattern is monotonic)
+u64 depthBits(f32 depth, u32 bits)
+{
+	depth = depth > 0.0f ? depth : 0.0f;
+	u32 raw;
+	std::memcpy(&raw, &depth, sizeof(raw));
+	return (u64)(raw >> (32 - bits));
+}
+
+u64 field(u64 value, u32 bits, u32 shift)
+{
+	return (value & ((1ULL << bits) - 1)) << shift;
+}
+} // namespace
+
+u32 RenderQueue::addInstance(glm::mat4 const& model, glm::mat4 const& normals)
+{
+	m_models.push_back(model);
+	m_normals.push_back(normals);
+	return (u32)m_models.size() - 1;
+}
+
+void RenderQueue::submit(Draw const& draw, Pass pass, f32 depth)
+{
+	ASSERT(draw.pShader && draw.pMesh, "Invalid draw!");
+	m_items.push_back({makeKey(draw, pass, depth), (u32)m_draws.size()});
+	m_draws.push_back(draw);
+	return;
+}
+
+void RenderQueue::flush()
+{
+	sort();
+	bool bWireframe = false;
+	for (auto const& item : m_items)
+	{
+		auto const& draw = m_draws[item.draw];
+		if (draw.bWireframe != bWireframe)
+		{
+			bWireframe = draw.bWireframe;
+			setPolygonMode(bWireframe ? PolygonMode::Line : PolygonMode::Fill);
+		}
+		execute(draw);
+	}
+	if (bWireframe)
+	{
+		setPolygonMode(PolygonMode::Fill);
+	}
+	m_lastFlushCount = (u32)m_items.size();
+	clear();
+	return;
+}
+
+void RenderQueue::clear()
+{
+	m_draws.clear();
+	m_items.clear();
+	m_models.clear();
+	m_normals.clear();
+	m_ids.clear();
+	return;
+}
+
+u32 RenderQueue::size() const
+{
+	return (u32)m_items.size();
+}
+
+u32 RenderQueue::lastFlushCount() const
+{
+	return m_lastFlushCount;
+}
+
+u64 RenderQueue::makeKey(Draw const& draw, Pass pass, f32 depth)
+{
+	u64 const textures = draw.pMesh->m_textures.empty() ? 0 : id(draw.pMesh->m_textures.front(), 16);
+	u64 ret = field((u64)pass, 2, 62);
+	if (pass == Pass::Translucent)
+	{
+		// Farthest first
+		ret |= field(~depthBits(depth, 24), 24, 38);
+		ret |= field(draw.bWireframe ? 1 : 0, 1, 37);
+		ret |= field(id(draw.pShader, 12), 12, 25);
+		ret |= field(id(&draw.pMesh->m_material, 12), 12, 13);
+		ret |= field(textures, 13, 0);
+	}
+	else
+	{
+		ret |= field(draw.bWireframe ? 1 : 0, 1, 61);
+		ret |= field(id(draw.pShader, 12), 12, 49);
+		ret |= field(id(&draw.pMesh->m_material, 16), 16, 33);
+		ret |= field(textures, 16, 17);
+		// Nearest first (early depth rejection)
+		ret |= field(depthBits(depth, 17), 17, 0);
+	}
+	return ret;
+}
+
+u32 RenderQueue::id(void const* ptr, u32 bits)
+{
+	// Dense per-flush IDs (in submission order); overflowing IDs only weaken grouping
+	auto [iter, bInserted] = m_ids.emplace(ptr, (u32)m_ids.size());
+	return iter->second & ((1U << bits) - 1);
+}
+
+void RenderQueue::sort()
+{
+	// LSD radix sort, 8 bits per pass; passes where every key shares the digit are skipped
+	size_t const count = m_items.size();
+	m_scratch.resize(count);
+	for (u32 shift = 0; shift < 64; shift += 8)
+	{
+		std::array<size_t, 256> counts = {};
+		for (auto const& item : m_items)
+		{
+			++counts[(item.key >> shift) & 0xff];
+		}
+		if (count == 0 || counts[(m_items.front().key >> shift) & 0xff] == count)
+		{
+			continue;
+		}
+		size_t offset = 0;
+		for (auto& c : counts)
+		{
+			size_t const n = c;
+			c = offset;
+			offset += n;
+		}
+		for (auto const& item : m_items)
+		{
+			m_scratch[counts[(item.key >> shift) & 0xff]++] = item;
+		}
+		std::swap(m_items, m_scratch);
+	}
+	return;
+}
+
+void RenderQueue::execute(Draw const& draw)
+{
+	InstanceBuffer const* pInstances = nullptr;
+	if (draw.instanceCount > 1)
+	{
+		m_batch.models.assign(m_models.begin() + draw.firstInstance, m_models.begin() + draw.firstInstance + draw.instanceCount);
+		m_batch.normals.assign(m_normals.begin() + draw.firstInstance, m_normals.begin() + draw.firstInstance + draw.instanceCount);
+		m_batch.drawType = DrawType::Dynamic;
+		pInstances = &m_batch;
+	}
+	else
+	{
+		Shader::ModelMats mats;
+		mats.model = m_models[draw.firstInstance];
+		mats.normals = m_normals[draw.firstInstance];
+		draw.pShader->setModelMats(mats);
+	}
+	if (draw.pModel)
+	{
+		draw.pModel->render(*draw.pShader, *draw.pMesh, pInstances);
+	}
+	else
+	{
+		draw.pMesh->render(*draw.pShader, nullptr, pInstances);
+	}
+	return;
+}
+} // namespace le::gfx
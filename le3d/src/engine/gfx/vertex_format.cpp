@@ -0,0 +1,159 @@
+#include <cmath>
+#include <cstring>
+#include "le3d/engine/gfx/gfx_objects.hpp"
+#include "le3d/engine/gfx/vertex_format.hpp"
+
+namespace le::gfx
+{
+namespace
+{
+u32 toSNorm10(f32 value)
+{
+	f32 const clamped = value > 1.0f ? 1.0f : (value > -1.0f ? value : -1.0f);
+	return (u32)(s32)std::lround(clamped * 511.0f) & 0x3ff;
+}
+
+f32 fromSNorm10(u32 bits)
+{
+	auto value = (s32)(bits & 0x3ff);
+	if (value & 0x200)
+	{
+		value -= 0x400;
+	}
+	// -512 and -511 both map to -1
+	f32 const ret = (f32)value / 511.0f;
+	return ret < -1.0f ? -1.0f : ret;
+}
+
+template <typename T>
+void setAttributes(T& outVertex, Geometry const& geometry, u32 idx);
+
+template <>
+void setAttributes(Vertex& outVertex, Geometry const& geometry, u32 idx)
+{
+	if (idx < geometry.normals.size())
+	{
+		auto const& n = geometry.normals[idx];
+		outVertex.normal[0] = n.x;
+		outVertex.normal[1] = n.y;
+		outVertex.normal[2] = n.z;
+	}
+	if (idx < geometry.texCoords.size())
+	{
+		auto const& t = geometry.texCoords[idx];
+		outVertex.texCoord[0] = t.x;
+		outVertex.texCoord[1] = t.y;
+	}
+	return;
+}
+
+template <>
+void setAttributes(PackedVertex& outVertex, Geometry const& geometry, u32 idx)
+{
+	if (idx < geometry.normals.size())
+	{
+		auto const& n = geometry.normals[idx];
+		outVertex.normal = vertexFormat::packNormal({n.x, n.y, n.z});
+	}
+	if (idx < geometry.texCoords.size())
+	{
+		auto const& t = geometry.texCoords[idx];
+		outVertex.texCoord[0] = vertexFormat::packHalf(t.x);
+		outVertex.texCoord[1] = vertexFormat::packHalf(t.y);
+	}
+	return;
+}
+
+template <typename T>
+std::vector<T> convert(Geometry const& geometry)
+{
+	u32 const vertexCount = geometry.vertexCount();
+	std::vector<T> ret(vertexCount, T{});
+	for (u32 idx = 0; idx < vertexCount; ++idx)
+	{
+		auto& vertex = ret[idx];
+		auto const& p = geometry.points[idx];
+		vertex.position[0] = p.x;
+		vertex.position[1] = p.y;
+		vertex.position[2] = p.z;
+		setAttributes(vertex, geometry, idx);
+	}
+	return ret;
+}
+} // namespace
+
+u32 vertexFormat::vertexSize(VertexFormat format)
+{
+	return format == VertexFormat::Packed ? (u32)sizeof(PackedVertex) : (u32)sizeof(Vertex);
+}
+
+u32 vertexFormat::packNormal(glm::vec3 const& normal)
+{
+	// w (bits 30-31) stays 0
+	return toSNorm10(normal.x) | (toSNorm10(normal.y) << 10) | (toSNorm10(normal.z) << 20);
+}
+
+glm::vec3 vertexFormat::unpackNormal(u32 packed)
+{
+	return {fromSNorm10(packed), fromSNorm10(packed >> 10), fromSNorm10(packed >> 20)};
+}
+
+u16 vertexFormat::packHalf(f32 value)
+{
+	u32 bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	u32 const sign = (bits >> 16) & 0x8000;
+	u32 const absBits = bits & 0x7fffffff;
+	if (absBits >= 0x7f800000)
+	{
+		// Inf / NaN (NaNs stay quiet NaNs)
+		return (u16)(sign | 0x7c00 | (absBits > 0x7f800000 ? 0x200 : 0));
+	}
+	if (absBits >= 0x477ff000)
+	{
+		// >= 65520 rounds to infinity
+		return (u16)(sign | 0x7c00);
+	}
+	if (absBits < 0x38800000)
+	{
+		// Below 2^-14: subnormal (in units of 2^-24); scaling by a power of two is exact
+		f32 absValue;
+		std::memcpy(&absValue, &absBits, sizeof(absValue));
+		return (u16)(sign | (u32)std::nearbyint(absValue * 16777216.0f));
+	}
+	// Rebias the exponent (127 => 15) and round the 13 dropped mantissa bits to nearest even (a carry bumps the exponent)
+	u32 ret = (absBits - 0x38000000) >> 13;
+	u32 const dropped = absBits & 0x1fff;
+	if (dropped > 0x1000 || (dropped == 0x1000 && (ret & 1)))
+	{
+		++ret;
+	}
+	return (u16)(sign | ret);
+}
+
+f32 vertexFormat::unpackHalf(u16 half)
+{
+	u32 const sign = (u32)(half & 0x8000) << 16;
+	u32 const exponent = (half >> 10) & 0x1f;
+	u32 const mantissa = half & 0x3ff;
+	if (exponent == 0)
+	{
+		f32 const ret = std::ldexp((f32)mantissa, -24);
+		return sign ? -ret : ret;
+	}
+	u32 const bits = sign | (exponent == 0x1f ? 0x7f800000 : ((exponent + 112) << 23)) | (mantissa << 13);
+	f32 ret;
+	std::memcpy(&ret, &bits, sizeof(ret));
+	return ret;
+}
+
+std::vector<Vertex> vertexFormat::interleave(Geometry const& geometry)
+{
+	return convert<Vertex>(geometry);
+}
+
+std::vector<PackedVertex> vertexFormat::pack(Geometry const& geometry)
+{
+	return convert<PackedVertex>(geometry);
+}
+} // namespace le::gfx
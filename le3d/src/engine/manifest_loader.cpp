@@ -32,7 +32,7 @@ void unloadT(GData const& manifest, std::string const& key)
 void manifestLoader::load(Request request)
 {
 	using Lock = std::lock_guard<std::mutex>;
-	std::unordered_map<std::string, std::pair<gfx::Texture::Descriptor, bytearray>> textures;
+	std::unordered_map<std::string, std::pair<gfx::Texture::Descriptor, gfx::Texture::Image>> textures;
 	std::mutex texturesMutex;
 	std::unordered_map<std::string, std::string> shaderCodes;
 	std::mutex shaderCodesMutex;
@@ -60,7 +60,7 @@ void manifestLoader::load(Request request)
 		request = Request();
 		return;
 	}
-	auto manifest = GData(request.manifest.pReader->getString(request.manifest.id));
+	auto manifest = GData(request.manifest.pReader->getView(request.manifest.id));
 	auto pStore = gfx::GFXStore::instance();
 	auto const texturesData = manifest.getGDatas("textures");
 	auto const shadersData = manifest.getGDatas("shaders");
@@ -87,6 +87,7 @@ void manifestLoader::load(Request request)
 					gfx::Model::LoadRequest mlr;
 					mlr.jsonID = id;
 					mlr.pReader = request.manifest.pReader;
+					mlr.cacheDir = request.meshCacheDir;
 					auto modelDesc = gfx::Model::loadOBJ(std::move(mlr));
 					Lock lock(modelsMutex);
 					models[id.generic_string()] = std::move(modelDesc);
@@ -105,9 +106,13 @@ void manifestLoader::load(Request request)
 				{
 					StagedLoader::Request loadReq;
 					loadReq.name = id;
-					loadReq.task = [id, request, &texturesMutex, &textures]() {
+					auto hRead = request.manifest.pReader->readAsync(id);
+					loadReq.reads.push_back(hRead);
+					loadReq.task = [id, hRead, &texturesMutex, &textures]() {
+						// Decode on this worker; the gfx-load stage only uploads
+						auto image = gfx::Texture::decode(hRead.wait());
 						Lock lock(texturesMutex);
-						textures[id].second = request.manifest.pReader->getBytes(id);
+						textures[id].second = std::move(image);
 					};
 					loader.enqueue(stageIdx, std::move(loadReq));
 				}
@@ -123,17 +128,25 @@ void manifestLoader::load(Request request)
 				auto const fcID = shader.getString("fragCodeID");
 				if (request.manifest.pReader->checkPresence(vcID) && request.manifest.pReader->checkPresence(fcID))
 				{
+					// Small and needed by the first gfx-load stage: ahead of textures
+					auto const priority = IOReader::Priority::High;
 					StagedLoader::Request loadReq;
 					loadReq.name = vcID;
-					loadReq.task = [vcID = vcID, request, &shaderCodesMutex, &shaderCodes]() {
+					auto hRead = request.manifest.pReader->readAsync(vcID, priority);
+					loadReq.reads = {hRead};
+					loadReq.task = [vcID = vcID, hRead, &shaderCodesMutex, &shaderCodes]() {
+						auto code = std::string(hRead.wait().str());
 						Lock lock(shaderCodesMutex);
-						shaderCodes[vcID] = request.manifest.pReader->getString(vcID);
+						shaderCodes[vcID] = std::move(code);
 					};
 					loader.enqueue(stageIdx, std::move(loadReq));
 					loadReq.name = fcID;
-					loadReq.task = [fcID, request, &shaderCodesMutex, &shaderCodes]() {
+					hRead = request.manifest.pReader->readAsync(fcID, priority);
+					loadReq.reads = {hRead};
+					loadReq.task = [fcID, hRead, &shaderCodesMutex, &shaderCodes]() {
+						auto code = std::string(hRead.wait().str());
 						Lock lock(shaderCodesMutex);
-						shaderCodes[fcID] = request.manifest.pReader->getString(fcID);
+						shaderCodes[fcID] = std::move(code);
 					};
 					loader.enqueue(stageIdx, std::move(loadReq));
 				}
@@ -148,15 +161,18 @@ void manifestLoader::load(Request request)
 				if (request.manifest.pReader->checkPresence(id))
 				{
 					gfx::Font::Descriptor desc;
-					desc.deserialise(GData(request.manifest.pReader->getString(font.getString("fontID"))));
+					desc.deserialise(GData(request.manifest.pReader->getView(font.getString("fontID"))));
 					auto const idStr = id.generic_string();
 					auto const sheetID = id.parent_path() / desc.sheetID;
 					fontDescriptors[idStr].first = std::move(desc);
 					StagedLoader::Request loadReq;
 					loadReq.name = sheetID.generic_string();
-					loadReq.task = [idStr, sheetID, request, &fontDescriptorsMutex, &fontDescriptors]() {
+					auto hRead = request.manifest.pReader->readAsync(sheetID);
+					loadReq.reads.push_back(hRead);
+					loadReq.task = [idStr, hRead, &fontDescriptorsMutex, &fontDescriptors]() {
+						auto bytes = hRead.wait().bytes();
 						Lock lock(fontDescriptorsMutex);
-						fontDescriptors[idStr].second = request.manifest.pReader->getBytes(sheetID);
+						fontDescriptors[idStr].second = std::move(bytes);
 					};
 					loader.enqueue(stageIdx, std::move(loadReq));
 				}
@@ -179,9 +195,12 @@ void manifestLoader::load(Request request)
 					auto enqueue = [&](std::string texID, size_t idx) {
 						StagedLoader::Request loadReq;
 						loadReq.name = id + std::to_string(idx);
-						loadReq.task = [id, texID, idx, request, &cubemapsMutex, &cubemaps]() {
+						auto hRead = request.manifest.pReader->readAsync(std::move(texID));
+						loadReq.reads.push_back(hRead);
+						loadReq.task = [id, hRead, idx, &cubemapsMutex, &cubemaps]() {
+							auto bytes = hRead.wait().bytes();
 							Lock lock(cubemapsMutex);
-							cubemaps[id][idx] = request.manifest.pReader->getBytes(texID);
+							cubemaps[id][idx] = std::move(bytes);
 						};
 						loader.enqueue(stageIdx, std::move(loadReq));
 					};
@@ -264,7 +283,15 @@ void manifestLoader::load(Request request)
 				auto id = texture.getString("id");
 				StagedLoader::Request loadReq;
 				loadReq.name = id;
-				loadReq.task = [id, pStore, &textures]() { pStore->load(std::move(textures[id].first), std::move(textures[id].second)); };
+				loadReq.task = [id, pStore, &textures]() {
+					auto& [descriptor, image] = textures[id];
+					if (image.pixels.empty())
+					{
+						LOG_E("[%s] Failed to load texture: [%s]!", typeName<StagedLoader>().data(), id.data());
+						return;
+					}
+					pStore->load(std::move(descriptor), std::move(image.pixels), image.channels, image.width, image.height);
+				};
 				loader.enqueue(stageIdx, std::move(loadReq));
 				pending.push_back(id);
 			}
@@ -343,7 +370,7 @@ void manifestLoader::load(Request request)
 			stdfs::path resourceID(modelID);
 			resourceID = resourceID / resourceID.filename();
 			resourceID += ".json";
-			auto modelJSON = GData(request.manifest.pReader->getString(resourceID));
+			auto modelJSON = GData(request.manifest.pReader->getView(resourceID));
 			pending.push_back(modelJSON.getString("id"));
 		}
 		++stageIdx;
@@ -401,7 +428,7 @@ void manifestLoader::load(Request request)
 	if (!context::isAlive())
 	{
 		LOG_W("[%s] Context killed! Aborting...", typeName<StagedLoader>().data());
-		jobs::waitForIdle();
+		loader.abort();
 	}
 	return;
 }
@@ -414,7 +441,7 @@ void manifestLoader::unload(Manifest manifest)
 		LOG_E("[%s] Manifest file: [%s] not present on [%s]!", typeName<StagedLoader>().data(), manifest.id.generic_string().data(),
 			  manifest.pReader->medium().data());
 	}
-	GData gData(manifest.pReader->getString(manifest.id));
+	GData gData(manifest.pReader->getView(manifest.id));
 	unloadT<gfx::Font>(gData, "fonts");
 	unloadT<gfx::Shader>(gData, "shaders");
 	unloadT<gfx::UniformBuffer>(gData, "uniformBuffers");
@@ -20,7 +20,7 @@ void StagedLoader::addStage(std::string name, s32 stageIdx, u16 mainThreadUpdate
 void StagedLoader::enqueue(s32 stageIdx, Request request)
 {
 	auto& stage = m_stages[stageIdx];
-	stage.tasks.push_back(Task{request.task, stage.name + "_" + request.name, {}, ++m_nextID});
+	stage.tasks.push_back(Task{std::move(request.task), stage.name + "_" + request.name, std::move(request.reads), {}, ++m_nextID});
 	m_taskIDs.insert(m_nextID);
 	return;
 }
@@ -40,9 +40,19 @@ bool StagedLoader::runActive()
 		LOG_D("[%s] [%s] started", typeName(*this).data(), stage.name.data());
 		if (stage.flags.isSet(Flag::UseJobs))
 		{
-			for (auto& task : stage.tasks)
+			if (!stage.bStarted)
 			{
-				task.shJob = jobs::enqueue(task.task, task.name, stage.flags.isSet(Flag::Silent));
+				startJobs(stage, {});
+			}
+			// Chain consecutive job stages onto the previous stage's completion so that they start on the workers directly
+			Stage* pPrev = &stage;
+			for (auto iter = std::next(m_activeStage); iter != m_stages.end() && iter->second.flags.isSet(Flag::UseJobs); ++iter)
+			{
+				if (!iter->second.bStarted)
+				{
+					startJobs(iter->second, pPrev->hDone);
+				}
+				pPrev = &iter->second;
 			}
 		}
 		return false;
@@ -50,14 +60,27 @@ bool StagedLoader::runActive()
 	return true;
 }
 
+void StagedLoader::startJobs(Stage& stage, HJob const& after)
+{
+	std::vector<HJob> handles;
+	handles.reserve(stage.tasks.size());
+	bool const bSilent = stage.flags.isSet(Flag::Silent);
+	for (auto& task : stage.tasks)
+	{
+		task.hJob = after ? jobs::then(after, task.task, task.name, bSilent) : jobs::enqueue(task.task, task.name, bSilent);
+		handles.push_back(task.hJob);
+	}
+	stage.hDone = jobs::whenAll(handles);
+	stage.bStarted = true;
+	return;
+}
+
 bool StagedLoader::update()
 {
 	if (!context::isAlive())
 	{
 		LOG_W("[%s] Context killed! Aborting...", typeName<StagedLoader>().data());
-		jobs::waitForIdle();
-		m_stages.clear();
-		m_activeStage = m_stages.begin();
+		abort();
 	}
 	if (m_activeStage != m_stages.end())
 	{
@@ -65,14 +88,10 @@ bool StagedLoader::update()
 		bool bPending = false;
 		if (stage.flags.isSet(Flag::UseJobs))
 		{
-			bPending = std::any_of(stage.tasks.begin(), stage.tasks.end(), [](Task const& task) { return !task.shJob->hasCompleted(); });
+			bPending = !stage.hDone.hasCompleted();
 			for (auto const& task : stage.tasks)
 			{
-				if (!task.shJob->hasCompleted())
-				{
-					bPending = true;
-				}
-				else
+				if (task.hJob.hasCompleted())
 				{
 					m_doneIDs.insert(task.id);
 				}
@@ -114,6 +133,25 @@ bool StagedLoader::update()
 	return true;
 }
 
+void StagedLoader::abort()
+{
+	// Tasks blocked on cancelled reads get empty views instead of waiting for the I/O thread
+	for (auto& kvp : m_stages)
+	{
+		for (auto& task : kvp.second.tasks)
+		{
+			for (auto const& hRead : task.reads)
+			{
+				hRead.cancel();
+			}
+		}
+	}
+	jobs::waitForIdle();
+	m_stages.clear();
+	m_activeStage = m_stages.begin();
+	return;
+}
+
 std::pair<u64, u64> StagedLoader::progress() const
 {
 	return {(u64)m_doneIDs.size(), (u64)m_taskIDs.size()};
@@ -0,0 +1,60 @@
+#include <algorithm>
+#include "le3d/game/ecs/archetype.hpp"
+
+namespace le::ecs
+{
+ComponentPool::~ComponentPool() = default;
+
+Archetype::Archetype(std::vector<Signature> signs) : m_signs(std::move(signs))
+{
+	m_columns.resize(m_signs.size());
+}
+
+s32 Archetype::column(Signature sign) const
+{
+	auto search = std::lower_bound(m_signs.begin(), m_signs.end(), sign);
+	return search != m_signs.end() && *search == sign ? (s32)(search - m_signs.begin()) : -1;
+}
+
+Component* Archetype::get(Signature sign, size_t row) const
+{
+	s32 const col = column(sign);
+	return col >= 0 ? m_columns[(size_t)col][row] : nullptr;
+}
+
+size_t Archetype::size() const
+{
+	return m_entities.size();
+}
+
+size_t Archetype::addRow(SpawnID entityID)
+{
+	m_entities.push_back(entityID);
+	for (auto& column : m_columns)
+	{
+		column.push_back(nullptr);
+	}
+	return m_entities.size() - 1;
+}
+
+SpawnID Archetype::removeRow(size_t row)
+{
+	size_t const last = m_entities.size() - 1;
+	SpawnID moved;
+	if (row != last)
+	{
+		m_entities[row] = m_entities[last];
+		for (auto& column : m_columns)
+		{
+			column[row] = column[last];
+		}
+		moved = m_entities[row];
+	}
+	m_entities.pop_back();
+	for (auto& column : m_columns)
+	{
+		column.pop_back();
+	}
+	return moved;
+}
+} // namespace le::ecs
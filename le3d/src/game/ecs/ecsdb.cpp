@@ -1,5 +1,6 @@
 #include <algorithm>
-#include <map>
+#include "le3d/core/jobs.hpp"
+#include "le3d/core/assert.hpp"
 #include "le3d/core/log.hpp"
 #include "le3d/env/env.hpp"
 #include "le3d/game/ecs/component.hpp"
@@ -35,33 +36,25 @@ void SlotSystem::render(ECSDB const& db) const
 	return;
 }
 
-using SortedSystems = std::map<ecs::Timing, std::deque<System*>>;
-
-SortedSystems sortSystems(ECSDB::SystemMap const& systems, std::deque<std::unique_ptr<System>>& outSlots)
+// Returns true if any expired slot was removed
+bool pruneSlots(std::deque<std::unique_ptr<System>>& outSlots)
 {
-	SortedSystems ret;
-	for (auto& kvp : systems)
-	{
-		auto& uSystem = kvp.second;
-		auto& deq = ret[uSystem->timing()];
-		deq.push_back(uSystem.get());
-	}
 	auto iter = std::remove_if(outSlots.begin(), outSlots.end(), [](auto const& uSys) {
 		auto pSlot = dynamic_cast<SlotSystem*>(uSys.get());
 		return !pSlot || (!pSlot->m_onTick.isAlive() && !pSlot->m_onRender.isAlive());
 	});
+	bool const bPruned = iter != outSlots.end();
 	outSlots.erase(iter, outSlots.end());
-	for (auto& uSystem : outSlots)
-	{
-		auto& deq = ret[uSystem->timing()];
-		deq.push_back(uSystem.get());
-	}
-	return ret;
+	return bPruned;
 }
 } // namespace
 
-ECSDB::ECSDB()
+ECSDB::ECSDB() : m_uViewsMutex(std::make_unique<std::mutex>()), m_uViewSlots(std::make_unique<ViewSlots>())
 {
+	for (auto& slot : *m_uViewSlots)
+	{
+		slot.store(nullptr, std::memory_order_relaxed);
+	}
 	LOG_D("[%s] Constructed", typeName(*this).data());
 }
 
@@ -72,7 +65,24 @@ ECSDB::~ECSDB()
 {
 	if (!m_entities.empty())
 	{
-		LOG_I("[%s] %u Entities and %u Components destroyed", typeName(*this).data(), m_entities.size(), m_components.size());
+		size_t componentCount = 0;
+		for (auto const& kvp : m_pools)
+		{
+			componentCount += kvp.second->count();
+		}
+		for (auto& kvp : m_archetypes)
+		{
+			auto& archetype = *kvp.second;
+			for (size_t col = 0; col < archetype.m_signs.size(); ++col)
+			{
+				auto& pool = *m_pools[archetype.m_signs[col]];
+				for (auto pComp : archetype.m_columns[col])
+				{
+					pool.destroy(pComp);
+				}
+			}
+		}
+		LOG_I("[%s] %u Entities and %u Components destroyed", typeName(*this).data(), m_entities.size(), componentCount);
 	}
 	LOG_D("[%s] Destroyed", typeName(*this).data());
 }
@@ -116,11 +126,7 @@ bool ECSDB::destroyComponents(ecs::SpawnID entityID)
 	auto search = m_entities.find(entityID);
 	if (search != m_entities.end())
 	{
-		Entity& entity = search->second;
-		for (auto const& kvp : entity.m_components)
-		{
-			detach(*kvp.second, entityID);
-		}
+		detachAll(search->second);
 		return true;
 	}
 	return false;
@@ -150,6 +156,7 @@ ECSDB::OnTick::Token ECSDB::addTickSlot(OnTick::Callback callback, ecs::Timing t
 	uSlot->m_defaultTiming = timing;
 	auto ret = uSlot->m_onTick.subscribe(callback);
 	m_tickSlots.push_back(std::move(uSlot));
+	m_tickSchedule.bDirty = true;
 	return ret;
 }
 
@@ -159,39 +166,53 @@ ECSDB::OnRender::Token ECSDB::addRenderSlot(OnRender::Callback callback, ecs::Ti
 	uSlot->m_defaultTiming = timing;
 	auto ret = uSlot->m_onRender.subscribe(callback);
 	m_renderSlots.push_back(std::move(uSlot));
+	m_renderSchedule.bDirty = true;
 	return ret;
 }
 
 void ECSDB::tick(Time dt)
 {
 	cleanDestroyed();
-	SortedSystems sorted = sortSystems(m_systems, m_tickSlots);
-	for (auto& kvp : sorted)
+	if (pruneSlots(m_tickSlots) || isStale(m_tickSchedule))
 	{
-		auto& deq = kvp.second;
-		for (auto& uSys : deq)
+		build(m_tickSchedule, m_systems, m_tickSlots, true);
+	}
+	for (auto const& wave : m_tickSchedule.waves)
+	{
+		if (wave.size() == 1)
 		{
-			if (uSys->isTicking())
+			// Exclusive (undeclared) systems and slots are always alone in a wave: run them on this thread
+			if (wave.front()->isTicking())
 			{
-				uSys->tick(*this, dt);
+				wave.front()->tick(*this, dt);
 			}
+			continue;
 		}
+		jobs::parallelFor(
+			0, wave.size(),
+			[this, &wave, dt](size_t idx) {
+				if (wave[idx]->isTicking())
+				{
+					wave[idx]->tick(*this, dt);
+				}
+			},
+			1);
 	}
 	return;
 }
 
 void ECSDB::render() const
 {
-	SortedSystems sorted = sortSystems(m_systems, m_renderSlots);
-	for (auto& kvp : sorted)
+	// Render order defines draw order: always serial
+	if (pruneSlots(m_renderSlots) || isStale(m_renderSchedule))
+	{
+		build(m_renderSchedule, m_systems, m_renderSlots, false);
+	}
+	for (auto pSystem : m_renderSchedule.ordered)
 	{
-		auto& deq = kvp.second;
-		for (auto& uSys : deq)
+		if (pSystem->isRendering())
 		{
-			if (uSys->isRendering())
-			{
-				uSys->render(*this);
-			}
+			pSystem->render(*this);
 		}
 	}
 	return;
@@ -204,10 +225,7 @@ void ECSDB::cleanDestroyed()
 		auto& entity = iter->second;
 		if (entity.isDestroyed())
 		{
-			for (auto const& kvp : entity.m_components)
-			{
-				detach(*kvp.second, entity.m_id);
-			}
+			detachAll(entity);
 			iter = destroyEntity(iter, entity.m_id);
 			continue;
 		}
@@ -216,15 +234,23 @@ void ECSDB::cleanDestroyed()
 	return;
 }
 
-Component* ECSDB::attach(ecs::Signature sign, std::unique_ptr<Component>&& uComp, Entity& entity)
+Component* ECSDB::attach(ecs::Signature sign, Component* pComp, Entity& entity)
 {
-	auto& cmap = m_components[sign];
-	auto const tName = typeName(*uComp);
-	uComp->create(&entity, this, sign);
-	entity.m_components[sign] = uComp.get();
-	cmap[entity.m_id] = std::move(uComp);
+	auto const tName = typeName(*pComp);
+	if (auto pExisting = Entity::getComponent(&entity, sign))
+	{
+		// Replace in place: same archetype, same column
+		destroy(*pExisting);
+	}
+	else
+	{
+		migrate(entity, withAdded(entity.m_pArchetype, sign));
+	}
+	auto& archetype = *entity.m_pArchetype;
+	archetype.m_columns[(size_t)archetype.column(sign)][entity.m_row] = pComp;
+	pComp->create(&entity, this, sign);
 	LOG_I("[%s] spawned and attached to [%s]", tName.data(), m_entityNames[entity.m_id].data());
-	return cmap[entity.m_id].get();
+	return pComp;
 }
 
 System* ECSDB::attach(ecs::Signature sign, std::unique_ptr<System>&& uSys)
@@ -232,6 +258,7 @@ System* ECSDB::attach(ecs::Signature sign, std::unique_ptr<System>&& uSys)
 	uSys->m_signature = sign;
 	auto const tName = typeName(*uSys);
 	m_systems[sign] = std::move(uSys);
+	m_tickSchedule.bDirty = m_renderSchedule.bDirty = true;
 	LOG_I("[%s] (System) spawned", tName.data());
 	return m_systems[sign].get();
 }
@@ -239,21 +266,233 @@ System* ECSDB::attach(ecs::Signature sign, std::unique_ptr<System>&& uSys)
 void ECSDB::detach(Component& component, ecs::SpawnID id)
 {
 	auto const tName = typeName(component);
-	auto const sign = component.m_signature;
-	m_components[sign].erase(id);
+	if (auto pEntity = component.m_pOwner)
+	{
+		migrate(*pEntity, withRemoved(pEntity->m_pArchetype, component.m_signature));
+	}
+	destroy(component);
 	LOG_I("[%s] detached from [%s] and destroyed", tName.data(), m_entityNames[id].data());
 	return;
 }
 
+void ECSDB::detachAll(Entity& entity)
+{
+	if (auto pArchetype = entity.m_pArchetype)
+	{
+		std::vector<Component*> components;
+		components.reserve(pArchetype->m_signs.size());
+		for (auto const& column : pArchetype->m_columns)
+		{
+			components.push_back(column[entity.m_row]);
+		}
+		migrate(entity, nullptr);
+		for (auto pComp : components)
+		{
+			auto const tName = typeName(*pComp);
+			destroy(*pComp);
+			LOG_I("[%s] detached from [%s] and destroyed", tName.data(), m_entityNames[entity.m_id].data());
+		}
+	}
+	return;
+}
+
 void ECSDB::detach(System& system)
 {
 	auto const tName = typeName(system);
 	auto const sign = system.m_signature;
 	m_systems.erase(sign);
+	m_tickSchedule.bDirty = m_renderSchedule.bDirty = true;
 	LOG_I("[%s] (System) destroyed", tName.data());
 	return;
 }
 
+ecs::Archetype* ECSDB::archetype(std::vector<ecs::Signature> signs)
+{
+	if (signs.empty())
+	{
+		return nullptr;
+	}
+	auto& uArchetype = m_archetypes[signs];
+	if (!uArchetype)
+	{
+		uArchetype = std::make_unique<ecs::Archetype>(std::move(signs));
+		std::lock_guard<std::mutex> lock(*m_uViewsMutex);
+		for (auto& kvp : m_views)
+		{
+			kvp.second->tryAdd(*uArchetype);
+		}
+	}
+	return uArchetype.get();
+}
+
+size_t ECSDB::nextViewSlot()
+{
+	static std::atomic<size_t> s_nextSlot = 0;
+	return s_nextSlot++;
+}
+
+ecs::ViewCache const* ECSDB::viewCache(ecs::Signature const* pSigns, size_t count) const
+{
+	std::lock_guard<std::mutex> lock(*m_uViewsMutex);
+	auto search = m_views.find(ecs::SignsLess::SignSpan{pSigns, count});
+	if (search != m_views.end())
+	{
+		return search->second.get();
+	}
+	auto uCache = std::make_unique<ecs::ViewCache>(std::vector<ecs::Signature>(pSigns, pSigns + count));
+	for (auto const& kvp : m_archetypes)
+	{
+		uCache->tryAdd(*kvp.second);
+	}
+	auto pRet = uCache.get();
+	m_views.emplace(pRet->m_signs, std::move(uCache));
+	return pRet;
+}
+
+ecs::Archetype* ECSDB::withAdded(ecs::Archetype* pSource, ecs::Signature sign)
+{
+	if (!pSource)
+	{
+		return archetype({sign});
+	}
+	auto search = pSource->m_addEdges.find(sign);
+	if (search != pSource->m_addEdges.end())
+	{
+		return search->second;
+	}
+	auto signs = pSource->m_signs;
+	signs.insert(std::upper_bound(signs.begin(), signs.end(), sign), sign);
+	auto pTarget = archetype(std::move(signs));
+	pSource->m_addEdges[sign] = pTarget;
+	pTarget->m_removeEdges[sign] = pSource;
+	return pTarget;
+}
+
+ecs::Archetype* ECSDB::withRemoved(ecs::Archetype* pSource, ecs::Signature sign)
+{
+	ASSERT(pSource, "Null archetype!");
+	auto search = pSource->m_removeEdges.find(sign);
+	if (search != pSource->m_removeEdges.end())
+	{
+		return search->second;
+	}
+	auto signs = pSource->m_signs;
+	signs.erase(std::remove(signs.begin(), signs.end(), sign), signs.end());
+	auto pTarget = archetype(std::move(signs));
+	pSource->m_removeEdges[sign] = pTarget;
+	if (pTarget)
+	{
+		pTarget->m_addEdges[sign] = pSource;
+	}
+	return pTarget;
+}
+
+void ECSDB::migrate(Entity& entity, ecs::Archetype* pTarget)
+{
+	auto pSource = entity.m_pArchetype;
+	if (pSource == pTarget)
+	{
+		return;
+	}
+	size_t row = 0;
+	if (pTarget)
+	{
+		row = pTarget->addRow(entity.m_id);
+		if (pSource)
+		{
+			// Carry over every component the target shares with the source
+			for (size_t col = 0; col < pTarget->m_signs.size(); ++col)
+			{
+				s32 const srcCol = pSource->column(pTarget->m_signs[col]);
+				if (srcCol >= 0)
+				{
+					pTarget->m_columns[col][row] = pSource->m_columns[(size_t)srcCol][entity.m_row];
+				}
+			}
+		}
+	}
+	if (pSource)
+	{
+		auto const movedID = pSource->removeRow(entity.m_row);
+		if (movedID > 0)
+		{
+			m_entities[movedID].m_row = entity.m_row;
+		}
+	}
+	entity.m_pArchetype = pTarget;
+	entity.m_row = row;
+	return;
+}
+
+void ECSDB::destroy(Component& component)
+{
+	m_pools[component.m_signature]->destroy(&component);
+	return;
+}
+
+void ECSDB::build(Schedule& out, SystemMap const& systems, std::deque<std::unique_ptr<System>> const& slots, bool bWaves)
+{
+	out.ordered.clear();
+	for (auto const& kvp : systems)
+	{
+		// Render-only systems have nothing to tick
+		if (!bWaves || kvp.second->access().bTicks)
+		{
+			out.ordered.push_back(kvp.second.get());
+		}
+	}
+	for (auto const& uSlot : slots)
+	{
+		out.ordered.push_back(uSlot.get());
+	}
+	std::stable_sort(out.ordered.begin(), out.ordered.end(), [](System const* pL, System const* pR) { return pL->timing() < pR->timing(); });
+	out.timings.clear();
+	for (auto pSystem : out.ordered)
+	{
+		out.timings.push_back(pSystem->timing());
+	}
+	out.waves.clear();
+	if (bWaves)
+	{
+		// A system's wave follows that of every earlier (by Timing) system it conflicts with
+		std::vector<size_t> waveIdx(out.ordered.size(), 0);
+		for (size_t idx = 0; idx < out.ordered.size(); ++idx)
+		{
+			for (size_t prev = 0; prev < idx; ++prev)
+			{
+				if (out.ordered[idx]->conflicts(*out.ordered[prev]))
+				{
+					waveIdx[idx] = std::max(waveIdx[idx], waveIdx[prev] + 1);
+				}
+			}
+			if (waveIdx[idx] >= out.waves.size())
+			{
+				out.waves.resize(waveIdx[idx] + 1);
+			}
+			out.waves[waveIdx[idx]].push_back(out.ordered[idx]);
+		}
+	}
+	out.bDirty = false;
+	return;
+}
+
+bool ECSDB::isStale(Schedule const& schedule)
+{
+	if (schedule.bDirty)
+	{
+		return true;
+	}
+	// timing() is virtual and may change at runtime
+	for (size_t idx = 0; idx < schedule.ordered.size(); ++idx)
+	{
+		if (schedule.ordered[idx]->timing() != schedule.timings[idx])
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
 ECSDB::EntityMap::iterator ECSDB::destroyEntity(EntityMap::iterator iter, ecs::SpawnID id)
 {
 	iter = m_entities.erase(iter);
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "le3d/game/ecs/system.hpp"
 
 namespace le
@@ -26,6 +27,30 @@ void System::setFlag(Flag flag, bool bValue)
 	m_flags.set(flag, bValue);
 }
 
+System::Access const& System::access() const
+{
+	return m_access;
+}
+
+bool System::conflicts(System const& rhs) const
+{
+	if (!m_access.bDeclared || !rhs.m_access.bDeclared)
+	{
+		return true;
+	}
+	auto overlaps = [](std::vector<ecs::Signature> const& lhs, std::vector<ecs::Signature> const& rhs) -> bool {
+		return std::any_of(lhs.begin(), lhs.end(), [&rhs](auto sign) { return std::find(rhs.begin(), rhs.end(), sign) != rhs.end(); });
+	};
+	return overlaps(m_access.writes, rhs.m_access.writes) || overlaps(m_access.writes, rhs.m_access.reads)
+		   || overlaps(m_access.reads, rhs.m_access.writes);
+}
+
+void System::renderOnly()
+{
+	m_access.bTicks = false;
+	return;
+}
+
 ecs::Timing System::timing() const
 {
 	return m_defaultTiming;
@@ -6,13 +6,15 @@
 
 namespace le
 {
+FreeCamController::FreeCamController()
+{
+	writes<CFreeCam>();
+}
+
 void FreeCamController::tick(ECSDB& db, Time dt)
 {
-	auto freeCams = db.all<CFreeCam>();
-	for (auto& kvp : freeCams)
+	for (auto [pCam] : db.view<CFreeCam>())
 	{
-		auto& results = kvp.second;
-		auto pCam = results.get<CFreeCam>();
 		if (!pCam->m_state.flags.isSet(CFreeCam::Flag::Enabled))
 		{
 			return;
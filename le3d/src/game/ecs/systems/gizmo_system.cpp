@@ -8,6 +8,12 @@ namespace le::debug
 {
 ecs::Timing GizmoSystem::s_timingDelta = 500.0f;
 
+GizmoSystem::GizmoSystem()
+{
+	reads<CGizmo, CTransform>();
+	renderOnly();
+}
+
 ecs::Timing GizmoSystem::timing() const
 {
 	return m_defaultTiming + s_timingDelta;
@@ -15,13 +21,9 @@ ecs::Timing GizmoSystem::timing() const
 
 void GizmoSystem::render(ECSDB const& db) const
 {
-	auto gizmos = db.all<CGizmo, CTransform>();
-	for (auto const& kvp : gizmos)
+	for (auto [pGizmo, pTransform] : db.view<CGizmo, CTransform>())
 	{
 		auto const& u = env::g_config.uniforms;
-		auto const& results = kvp.second;
-		auto pGizmo = results.get<CGizmo>();
-		auto pTransform = results.get<CTransform>();
 		auto pShader = gfx::GFXStore::instance()->get<gfx::Shader>("shaders/monolithic");
 		if (pShader)
 		{
@@ -1,69 +1,189 @@
+#include <algorithm>
+#include <tuple>
 #include "le3d/core/assert.hpp"
-#include "le3d/core/profiler.hpp"
 #include "le3d/engine/context.hpp"
 #include "le3d/game/ecs.hpp"
 #include "le3d/game/ecs/systems/prop_renderer.hpp"
+#include "le3d/engine/gfx/model.hpp"
 #include "le3d/engine/gfx/utils.hpp"
 
 namespace le
 {
+size_t PropRenderer::s_minInstances = 2;
+
+PropRenderer::PropRenderer()
+{
+	reads<CProp, CTransform>();
+	renderOnly();
+}
+
+PropRenderer::CullStats PropRenderer::cullStats() const
+{
+	return m_cullStats;
+}
+
 void PropRenderer::render(ECSDB const& db) const
 {
-	std::unordered_map<s64, CompQuery> props;
+	m_instances.clear();
+	m_bounds.clear();
+	for (auto [pProp, pTransform] : db.view<CProp, CTransform>())
 	{
-		// Profiler p("allProps");
-		props = db.all<CProp, CTransform>();
-	}
-	for (auto const& kvp : props)
-	{
-		auto const& results = kvp.second;
-		auto const& pProp = results.get<CProp>();
-		auto const& pTransform = results.get<CTransform>();
-		if (pProp->m_flags.isSet(CProp::Flag::Wireframe))
+		ASSERT(pProp->m_pShader, "null shader!");
+		if (!pProp->m_pShader)
 		{
-			gfx::setPolygonMode(PolygonMode::Line);
+			continue;
 		}
-		for (auto fixture : pProp->m_fixtures)
+		Instance instance;
+		instance.pShader = pProp->m_pShader;
+		instance.bWireframe = pProp->m_flags.isSet(CProp::Flag::Wireframe);
+		instance.bTranslucent = pProp->m_flags.isSet(CProp::Flag::Translucent);
+		for (auto const& fixture : pProp->m_fixtures)
 		{
-			ASSERT(pProp->m_pShader, "null shader!");
-			auto const oWorld = fixture.oWorld;
-			gfx::Shader::ModelMats mats;
-			mats.model = pTransform->m_transform.model();
-			mats.normals = pTransform->m_transform.normalModel();
-			if (oWorld)
+			instance.model = pTransform->m_transform.model();
+			instance.normals = pTransform->m_transform.normalModel();
+			if (fixture.oWorld)
 			{
-				mats.model *= *oWorld;
-				mats.normals *= *oWorld;
+				instance.model *= *fixture.oWorld;
+				instance.normals *= *fixture.oWorld;
 			}
-			pProp->m_pShader->setModelMats(mats);
-			auto const pModel = fixture.pModel;
-			auto const pMesh = fixture.pMesh;
-			if (pModel)
+			instance.pModel = fixture.pModel;
+			instance.pMesh = fixture.pModel ? nullptr : fixture.pMesh;
+			if (!instance.pModel && !instance.pMesh)
 			{
+				continue;
+			}
+			instance.depth = glm::length(glm::vec3(instance.model[3]) - m_viewPos);
 #if defined(LE3D_DEBUG)
-				bool bWasDebug = pModel->m_bDEBUG;
-				if (pProp->getOwner()->m_bDebugThis)
-				{
-					pModel->m_bDEBUG = true;
-				}
-#endif
-				pModel->render(*pProp->m_pShader);
-#if defined(LE3D_DEBUG)
-				if (pProp->getOwner()->m_bDebugThis)
-				{
-					pModel->m_bDEBUG = bWasDebug;
-				}
+			if (instance.pModel && pProp->getOwner()->m_bDebugThis)
+			{
+				gfx::setPolygonMode(instance.bWireframe ? PolygonMode::Line : PolygonMode::Fill);
+				bool const bWasDebug = instance.pModel->m_bDEBUG;
+				instance.pModel->m_bDEBUG = true;
+				gfx::Shader::ModelMats mats;
+				mats.model = instance.model;
+				mats.normals = instance.normals;
+				instance.pShader->setModelMats(mats);
+				instance.pModel->render(*instance.pShader);
+				instance.pModel->m_bDEBUG = bWasDebug;
+				gfx::setPolygonMode(PolygonMode::Fill);
+				continue;
+			}
 #endif
+			if (m_oViewProj)
+			{
+				// Meshes (or models with meshes) with their own instances are drawn all over the place: never cull them
+				bool const bUnbounded = hasOwnInstances(instance);
+				AABB const& local = instance.pModel ? instance.pModel->bounds() : instance.pMesh->bounds();
+				m_bounds.push_back(bUnbounded ? AABB() : local.transformed(instance.model));
 			}
-			else if (pMesh)
+			m_instances.push_back(instance);
+		}
+	}
+	if (m_oViewProj)
+	{
+		cull(Frustum::fromViewProj(*m_oViewProj));
+	}
+	else
+	{
+		m_cullStats = {(u32)m_instances.size(), 0};
+	}
+	// Translucent fixtures are never batched (they must be sorted individually)
+	std::sort(m_instances.begin(), m_instances.end(), [](Instance const& lhs, Instance const& rhs) {
+		return std::tie(lhs.bTranslucent, lhs.bWireframe, lhs.pShader, lhs.pModel, lhs.pMesh)
+			   < std::tie(rhs.bTranslucent, rhs.bWireframe, rhs.pShader, rhs.pModel, rhs.pMesh);
+	});
+	for (size_t begin = 0; begin < m_instances.size();)
+	{
+		auto const& first = m_instances[begin];
+		size_t end = begin + 1;
+		while (end < m_instances.size() && sameBatch(first, m_instances[end]))
+		{
+			++end;
+		}
+		// Meshes with their own instances keep them
+		bool const bInstanced = !first.bTranslucent && !hasOwnInstances(first);
+		if (bInstanced && end - begin >= s_minInstances)
+		{
+			u32 const firstInstance = m_queue.addInstance(first.model, first.normals);
+			for (size_t idx = begin + 1; idx < end; ++idx)
 			{
-				pMesh->render(*pProp->m_pShader);
+				m_queue.addInstance(m_instances[idx].model, m_instances[idx].normals);
 			}
+			submit(first, firstInstance, (u32)(end - begin));
 		}
-		if (pProp->m_flags.isSet(CProp::Flag::Wireframe))
+		else
 		{
-			gfx::setPolygonMode(PolygonMode::Fill);
+			for (size_t idx = begin; idx < end; ++idx)
+			{
+				submit(m_instances[idx], m_queue.addInstance(m_instances[idx].model, m_instances[idx].normals), 1);
+			}
 		}
+		begin = end;
+	}
+	m_queue.flush();
+	return;
+}
+
+void PropRenderer::cull(Frustum const& frustum) const
+{
+	ASSERT(m_bounds.size() == m_instances.size(), "Invariant violated!");
+	size_t const visible = le::cull(frustum, m_bounds, m_visible);
+	m_cullStats = {(u32)visible, (u32)(m_instances.size() - visible)};
+	if (visible < m_instances.size())
+	{
+		size_t kept = 0;
+		for (size_t idx = 0; idx < m_instances.size(); ++idx)
+		{
+			if (m_visible[idx])
+			{
+				m_instances[kept++] = m_instances[idx];
+			}
+		}
+		m_instances.resize(kept);
+	}
+	return;
+}
+
+bool PropRenderer::sameBatch(Instance const& lhs, Instance const& rhs)
+{
+	return lhs.bTranslucent == rhs.bTranslucent && lhs.bWireframe == rhs.bWireframe && lhs.pShader == rhs.pShader
+		   && lhs.pModel == rhs.pModel && lhs.pMesh == rhs.pMesh;
+}
+
+bool PropRenderer::hasOwnInstances(Instance const& instance)
+{
+	if (instance.pModel)
+	{
+		return std::any_of(instance.pModel->m_meshes.begin(), instance.pModel->m_meshes.end(),
+						   [](gfx::Mesh const* pMesh) { return pMesh && pMesh->instances().instanceCount() > 0; });
+	}
+	return instance.pMesh && instance.pMesh->instances().instanceCount() > 0;
+}
+
+void PropRenderer::submit(Instance const& instance, u32 firstInstance, u32 instanceCount) const
+{
+	gfx::RenderQueue::Draw draw;
+	draw.pShader = instance.pShader;
+	draw.pModel = instance.pModel;
+	draw.firstInstance = firstInstance;
+	draw.instanceCount = instanceCount;
+	draw.bWireframe = instance.bWireframe;
+	auto const pass = instance.bTranslucent ? gfx::RenderQueue::Pass::Translucent : gfx::RenderQueue::Pass::Opaque;
+	if (instance.pModel)
+	{
+		for (auto pMesh : instance.pModel->m_meshes)
+		{
+			if (pMesh && pMesh->isReady())
+			{
+				draw.pMesh = pMesh;
+				m_queue.submit(draw, pass, instance.depth);
+			}
+		}
+	}
+	else
+	{
+		draw.pMesh = instance.pMesh;
+		m_queue.submit(draw, pass, instance.depth);
 	}
 	return;
 }
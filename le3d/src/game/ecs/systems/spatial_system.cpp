@@ -0,0 +1,125 @@
+#include "le3d/game/ecs.hpp"
+#include "le3d/game/ecs/systems/spatial_system.hpp"
+#include "le3d/engine/gfx/model.hpp"
+
+namespace le
+{
+ecs::Timing SpatialSystem::s_timingDelta = 1010.0f;
+
+SpatialSystem::SpatialSystem()
+{
+	reads<CTransform, CProp>();
+}
+
+ecs::Timing SpatialSystem::timing() const
+{
+	return m_defaultTiming + s_timingDelta;
+}
+
+void SpatialSystem::query(AABB const& aabb, std::vector<ecs::SpawnID>& outIDs) const
+{
+	std::vector<BVH::Key> keys;
+	m_bvh.query(aabb, keys);
+	append(keys, outIDs);
+	return;
+}
+
+void SpatialSystem::query(Frustum const& frustum, std::vector<ecs::SpawnID>& outIDs) const
+{
+	std::vector<BVH::Key> keys;
+	m_bvh.query(frustum, keys);
+	append(keys, outIDs);
+	return;
+}
+
+std::optional<SpatialSystem::RayHit> SpatialSystem::raycast(glm::vec3 const& origin, glm::vec3 const& direction, f32 maxT) const
+{
+	if (auto oHit = m_bvh.raycast(origin, direction, maxT))
+	{
+		return RayHit{oHit->key, oHit->t};
+	}
+	return std::nullopt;
+}
+
+BVH const& SpatialSystem::bvh() const
+{
+	return m_bvh;
+}
+
+AABB SpatialSystem::worldBounds(CTransform const& transform, CProp const* pProp)
+{
+	glm::mat4 const& model = transform.m_transform.model();
+	AABB ret;
+	if (pProp)
+	{
+		for (auto const& fixture : pProp->m_fixtures)
+		{
+			AABB const local = fixture.pModel ? fixture.pModel->bounds() : (fixture.pMesh ? fixture.pMesh->bounds() : AABB());
+			ret.add(local.transformed(fixture.oWorld ? model * *fixture.oWorld : model));
+		}
+	}
+	if (ret.isEmpty())
+	{
+		ret.add(glm::vec3(model[3]));
+	}
+	return ret;
+}
+
+void SpatialSystem::tick(ECSDB& db, Time)
+{
+	++m_tick;
+	m_added.clear();
+	m_removed.clear();
+	size_t visited = 0;
+	for (auto [pTransform] : db.view<CTransform>())
+	{
+		auto pOwner = pTransform->getOwner();
+		if (!pOwner || !pOwner->isEnabled() || pOwner->isDestroyed())
+		{
+			continue;
+		}
+		s64 const key = pOwner->spawnID().handle;
+		AABB const bounds = worldBounds(*pTransform, pTransform->getComponent<CProp>());
+		auto [iter, bNew] = m_stamps.emplace(key, m_tick);
+		if (bNew)
+		{
+			m_added.push_back({key, bounds});
+		}
+		else
+		{
+			iter->second = m_tick;
+			m_bvh.update(key, bounds);
+		}
+		++visited;
+	}
+	if (m_stamps.size() > visited)
+	{
+		for (auto iter = m_stamps.begin(); iter != m_stamps.end();)
+		{
+			if (iter->second != m_tick)
+			{
+				m_removed.push_back(iter->first);
+				iter = m_stamps.erase(iter);
+			}
+			else
+			{
+				++iter;
+			}
+		}
+	}
+	// Batched: large changes (eg first tick, level unload) rebuild the tree instead
+	m_bvh.remove(m_removed);
+	m_bvh.insert(m_added);
+	return;
+}
+
+void SpatialSystem::append(std::vector<BVH::Key> const& keys, std::vector<ecs::SpawnID>& outIDs)
+{
+	outIDs.reserve(outIDs.size() + keys.size());
+	for (auto key : keys)
+	{
+		outIDs.push_back(key);
+	}
+	return;
+}
+} // namespace le
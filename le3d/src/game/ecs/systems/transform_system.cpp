@@ -0,0 +1,110 @@
+#include <unordered_map>
+#include "le3d/core/jobs.hpp"
+#include "le3d/core/transform.hpp"
+#include "le3d/game/ecs.hpp"
+#include "le3d/game/ecs/systems/transform_system.hpp"
+
+namespace le
+{
+ecs::Timing TransformSystem::s_timingDelta = 1000.0f;
+size_t TransformSystem::s_parallelThreshold = 1024;
+
+TransformSystem::TransformSystem()
+{
+	writes<CTransform>();
+}
+
+ecs::Timing TransformSystem::timing() const
+{
+	return m_defaultTiming + s_timingDelta;
+}
+
+void TransformSystem::tick(ECSDB& db, Time)
+{
+	auto transforms = db.view<CTransform>();
+	if (transforms.size() != m_count || Transform::hierarchyVersion() != m_version)
+	{
+		rebuild(db);
+	}
+	for (size_t level = 0; level + 1 < m_levels.size(); ++level)
+	{
+		size_t const begin = m_levels[level];
+		size_t const end = m_levels[level + 1];
+		// Parents are all in earlier levels (and already clean), so nodes in one level are independent
+		auto update = [this](size_t idx) {
+			auto pTransform = m_ordered[idx];
+			if (pTransform->isDirty())
+			{
+				pTransform->updateWorld();
+			}
+		};
+		if (end - begin >= s_parallelThreshold)
+		{
+			jobs::parallelFor(begin, end, update);
+		}
+		else
+		{
+			for (size_t idx = begin; idx < end; ++idx)
+			{
+				update(idx);
+			}
+		}
+	}
+	return;
+}
+
+void TransformSystem::rebuild(ECSDB& db)
+{
+	m_version = Transform::hierarchyVersion();
+	m_count = 0;
+	// Depth of every transform, including ancestors that are not CTransforms
+	std::unordered_map<Transform const*, size_t> depths;
+	size_t maxDepth = 0;
+	auto depthOf = [&depths, &maxDepth](Transform const* pTransform) {
+		std::vector<Transform const*> chain;
+		size_t depth = 0;
+		for (auto pNode = pTransform; pNode; pNode = pNode->parent())
+		{
+			auto search = depths.find(pNode);
+			if (search != depths.end())
+			{
+				depth = search->second + 1;
+				break;
+			}
+			chain.push_back(pNode);
+		}
+		for (auto iter = chain.rbegin(); iter != chain.rend(); ++iter)
+		{
+			depths[*iter] = depth;
+			maxDepth = std::max(maxDepth, depth);
+			++depth;
+		}
+	};
+	for (auto [pTransform] : db.view<CTransform>())
+	{
+		depthOf(&pTransform->m_transform);
+		++m_count;
+	}
+	// Counting sort by depth
+	m_levels.assign(maxDepth + 2, 0);
+	for (auto const& kvp : depths)
+	{
+		++m_levels[kvp.second + 1];
+	}
+	for (size_t level = 1; level < m_levels.size(); ++level)
+	{
+		m_levels[level] += m_levels[level - 1];
+	}
+	m_ordered.resize(depths.size());
+	std::vector<size_t> next(m_levels.begin(), m_levels.end() - 1);
+	for (auto const& kvp : depths)
+	{
+		m_ordered[next[kvp.second]++] = kvp.first;
+	}
+	if (depths.empty())
+	{
+		m_levels.clear();
+	}
+	return;
+}
+} // namespace le
@@ -0,0 +1,40 @@
+#include <algorithm>
+#include "le3d/game/ecs/view.hpp"
+
+namespace le::ecs
+{
+ViewCache::ViewCache(std::vector<Signature> signs) : m_signs(std::move(signs)) {}
+
+bool ViewCache::tryAdd(Archetype const& archetype)
+{
+	Match match;
+	match.columns.reserve(m_signs.size());
+	for (auto sign : m_signs)
+	{
+		s32 const col = archetype.column(sign);
+		if (col < 0)
+		{
+			return false;
+		}
+		match.columns.push_back((size_t)col);
+	}
+	match.pArchetype = &archetype;
+	m_matches.push_back(std::move(match));
+	return true;
+}
+
+bool SignsLess::operator()(std::vector<Signature> const& lhs, std::vector<Signature> const& rhs) const
+{
+	return lhs < rhs;
+}
+
+bool SignsLess::operator()(std::vector<Signature> const& lhs, SignSpan rhs) const
+{
+	return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.pData, rhs.pData + rhs.count);
+}
+
+bool SignsLess::operator()(SignSpan lhs, std::vector<Signature> const& rhs) const
+{
+	return std::lexicographical_compare(lhs.pData, lhs.pData + lhs.count, rhs.begin(), rhs.end());
+}
+} // namespace le::ecs
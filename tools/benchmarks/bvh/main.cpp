@@ -0,0 +1,322 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+#include "le3d/core/bvh.hpp"
+#include "le3d/core/log.hpp"
+
+using namespace le;
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+std::mt19937 g_rng(42);
+std::uniform_real_distribution<f32> g_position(-500.0f, 500.0f);
+std::uniform_real_distribution<f32> g_size(0.25f, 2.0f);
+std::uniform_real_distribution<f32> g_direction(-1.0f, 1.0f);
+// Stays inside BVH::s_fatMargin, so updates only refit
+std::uniform_real_distribution<f32> g_jitter(-0.05f, 0.05f);
+
+constexpr u32 AABB_QUERIES = 200;
+constexpr u32 FRUSTUM_QUERIES = 20;
+constexpr u32 RAYCASTS = 200;
+
+glm::vec3 randomPoint()
+{
+	return {g_position(g_rng), g_position(g_rng), g_position(g_rng)};
+}
+
+AABB randomBox()
+{
+	glm::vec3 const centre = randomPoint();
+	glm::vec3 const extents(g_size(g_rng), g_size(g_rng), g_size(g_rng));
+	return {centre - extents, centre + extents};
+}
+
+bool overlaps(AABB const& lhs, AABB const& rhs)
+{
+	return lhs.min.x <= rhs.max.x && lhs.max.x >= rhs.min.x && lhs.min.y <= rhs.max.y && lhs.max.y >= rhs.min.y && lhs.min.z <= rhs.max.z
+		   && lhs.max.z >= rhs.min.z;
+}
+
+struct Ray final
+{
+	glm::vec3 origin;
+	glm::vec3 direction;
+};
+
+// The brute-force paths the tree replaces: every query tests every box
+void query(std::vector<BVH::Item> const& items, AABB const& aabb, std::vector<BVH::Key>& outKeys)
+{
+	for (auto const& item : items)
+	{
+		if (overlaps(item.bounds, aabb))
+		{
+			outKeys.push_back(item.key);
+		}
+	}
+	return;
+}
+
+std::optional<BVH::RayHit> raycast(std::vector<BVH::Item> const& items, Ray const& ray, f32 maxT)
+{
+	std::optional<BVH::RayHit> ret;
+	glm::vec3 const invDir = 1.0f / ray.direction;
+	for (auto const& item : items)
+	{
+		glm::vec3 const t0 = (item.bounds.min - ray.origin) * invDir;
+		glm::vec3 const t1 = (item.bounds.max - ray.origin) * invDir;
+		glm::vec3 const tMin = glm::min(t0, t1);
+		glm::vec3 const tMax = glm::max(t0, t1);
+		f32 const tNear = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.0f));
+		f32 const tFar = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, ret ? ret->t : maxT));
+		if (tNear <= tFar)
+		{
+			ret = BVH::RayHit{item.key, tNear};
+		}
+	}
+	return ret;
+}
+
+f64 best(u32 runs, std::function<f64()> const& bench)
+{
+	f64 ret = bench();
+	for (u32 run = 1; run < runs; ++run)
+	{
+		ret = std::min(ret, bench());
+	}
+	return ret;
+}
+
+f64 elapsedMS(std::function<void()> const& pass)
+{
+	auto const start = Clock::now();
+	pass();
+	return std::chrono::duration<f64, std::milli>(Clock::now() - start).count();
+}
+
+// Microseconds per iteration of a pass over count queries, best of runs
+f64 measure(u32 runs, u32 count, std::function<void()> const& pass)
+{
+	return best(runs, [&]() { return elapsedMS(pass) * 1000.0 / (f64)count; });
+}
+
+void sort(std::vector<BVH::Key>& out)
+{
+	std::sort(out.begin(), out.end());
+	return;
+}
+
+void printUsage()
+{
+	std::printf("Usage: le3d-bench-bvh [box counts...]\n");
+	std::printf("  Builds a BVH over N random boxes (default: 10000 100000 1000000) top-down and by incremental insertion, refits it\n");
+	std::printf("  after a small jitter and after teleporting 5%% of the boxes, and times AABB / frustum / ray queries against a linear\n");
+	std::printf("  scan (and cull() over an AABBBatch for frusta); every query's result is cross-checked against the linear scan\n");
+	return;
+}
+} // namespace
+
+s32 main(s32 argc, char const** argv)
+{
+	std::vector<u32> boxCounts;
+	for (s32 idx = 1; idx < argc; ++idx)
+	{
+		u32 const count = (u32)std::strtoul(argv[idx], nullptr, 10);
+		if (count == 0)
+		{
+			printUsage();
+			return std::string_view(argv[idx]) == "-h" || std::string_view(argv[idx]) == "--help" ? 0 : 1;
+		}
+		boxCounts.push_back(count);
+	}
+	if (boxCounts.empty())
+	{
+		boxCounts = {10000, 100000, 1000000};
+	}
+	u32 const runs = 3;
+	u32 mismatches = 0;
+	std::printf("Maintenance, ms (reinserted: updates that escaped their fat box)\n");
+	std::printf("%10s | %10s %10s %7s %7s | %10s %10s | %10s %10s\n", "boxes", "build", "insert", "h build", "h ins", "jitter",
+				"reinserted", "5% moved", "reinserted");
+	std::vector<std::string> queryRows;
+	for (auto const boxCount : boxCounts)
+	{
+		std::vector<BVH::Item> items(boxCount);
+		for (u32 idx = 0; idx < boxCount; ++idx)
+		{
+			items[idx] = {(BVH::Key)idx, randomBox()};
+		}
+		BVH tree;
+		BVH inserted;
+		f64 const buildMS = best(runs, [&]() { return elapsedMS([&]() { tree.build(items); }); });
+		f64 const insertMS = elapsedMS([&]() {
+			for (auto const& item : items)
+			{
+				inserted.insert(item.key, item.bounds);
+			}
+		});
+		for (auto& item : items)
+		{
+			glm::vec3 const delta(g_jitter(g_rng), g_jitter(g_rng), g_jitter(g_rng));
+			item.bounds.min += delta;
+			item.bounds.max += delta;
+		}
+		size_t jitterReinserts = 0;
+		f64 const jitterMS = elapsedMS([&]() {
+			for (auto const& item : items)
+			{
+				jitterReinserts += tree.update(item.key, item.bounds) ? 1 : 0;
+			}
+		});
+		for (u32 idx = 0; idx < boxCount / 20; ++idx)
+		{
+			items[g_rng() % boxCount].bounds = randomBox();
+		}
+		size_t teleportReinserts = 0;
+		f64 const teleportMS = elapsedMS([&]() {
+			for (auto const& item : items)
+			{
+				teleportReinserts += tree.update(item.key, item.bounds) ? 1 : 0;
+			}
+		});
+		std::printf("%10u | %10.2f %10.2f %7d %7d | %10.2f %10zu | %10.2f %10zu\n", boxCount, buildMS, insertMS, tree.height(),
+					inserted.height(), jitterMS, jitterReinserts, teleportMS, teleportReinserts);
+
+		std::vector<AABB> aabbs(AABB_QUERIES);
+		for (auto& aabb : aabbs)
+		{
+			glm::vec3 const centre = randomPoint();
+			aabb = {centre - glm::vec3(10.0f), centre + glm::vec3(10.0f)};
+		}
+		std::vector<Frustum> frusta(FRUSTUM_QUERIES);
+		glm::mat4 const proj = glm::perspective(1.0f, 1.5f, 0.1f, 100.0f);
+		for (auto& frustum : frusta)
+		{
+			glm::vec3 const eye = randomPoint();
+			frustum = Frustum::fromViewProj(proj * glm::lookAt(eye, eye + randomPoint(), glm::vec3(0.0f, 1.0f, 0.0f)));
+		}
+		// Half the rays aim near a random box (random directions almost always miss at this density)
+		std::vector<Ray> rays(RAYCASTS);
+		for (u32 idx = 0; idx < RAYCASTS; ++idx)
+		{
+			rays[idx].origin = randomPoint();
+			rays[idx].direction = {g_direction(g_rng), g_direction(g_rng), g_direction(g_rng)};
+			if (idx % 2 == 0)
+			{
+				rays[idx].direction += items[g_rng() % boxCount].bounds.centre() - rays[idx].origin;
+			}
+		}
+		AABBBatch batch;
+		batch.reserve(items.size());
+		for (auto const& item : items)
+		{
+			batch.push_back(item.bounds);
+		}
+
+		std::vector<std::vector<BVH::Key>> treeResults(AABB_QUERIES);
+		std::vector<std::vector<BVH::Key>> linearResults(AABB_QUERIES);
+		f64 const aabbTreeUS = measure(runs, AABB_QUERIES, [&]() {
+			for (u32 idx = 0; idx < AABB_QUERIES; ++idx)
+			{
+				treeResults[idx].clear();
+				tree.query(aabbs[idx], treeResults[idx]);
+			}
+		});
+		f64 const aabbLinearUS = measure(runs, AABB_QUERIES, [&]() {
+			for (u32 idx = 0; idx < AABB_QUERIES; ++idx)
+			{
+				linearResults[idx].clear();
+				query(items, aabbs[idx], linearResults[idx]);
+			}
+		});
+		size_t aabbHits = 0;
+		for (u32 idx = 0; idx < AABB_QUERIES; ++idx)
+		{
+			sort(treeResults[idx]);
+			sort(linearResults[idx]);
+			mismatches += treeResults[idx] == linearResults[idx] ? 0 : 1;
+			aabbHits += treeResults[idx].size();
+		}
+
+		treeResults.resize(FRUSTUM_QUERIES);
+		std::vector<std::vector<u32>> visible(FRUSTUM_QUERIES);
+		f64 const frustumTreeUS = measure(runs, FRUSTUM_QUERIES, [&]() {
+			for (u32 idx = 0; idx < FRUSTUM_QUERIES; ++idx)
+			{
+				treeResults[idx].clear();
+				tree.query(frusta[idx], treeResults[idx]);
+			}
+		});
+		f64 const frustumCullUS = measure(runs, FRUSTUM_QUERIES, [&]() {
+			for (u32 idx = 0; idx < FRUSTUM_QUERIES; ++idx)
+			{
+				cull(frusta[idx], batch, visible[idx]);
+			}
+		});
+		size_t frustumHits = 0;
+		for (u32 idx = 0; idx < FRUSTUM_QUERIES; ++idx)
+		{
+			std::vector<BVH::Key> expected;
+			for (u32 key = 0; key < boxCount; ++key)
+			{
+				if (visible[idx][key] != 0)
+				{
+					expected.push_back((BVH::Key)key);
+				}
+			}
+			sort(treeResults[idx]);
+			mismatches += treeResults[idx] == expected ? 0 : 1;
+			frustumHits += treeResults[idx].size();
+		}
+
+		std::vector<std::optional<BVH::RayHit>> treeHits(RAYCASTS);
+		std::vector<std::optional<BVH::RayHit>> linearHits(RAYCASTS);
+		f64 const rayTreeUS = measure(runs, RAYCASTS, [&]() {
+			for (u32 idx = 0; idx < RAYCASTS; ++idx)
+			{
+				treeHits[idx] = tree.raycast(rays[idx].origin, rays[idx].direction, 2000.0f);
+			}
+		});
+		f64 const rayLinearUS = measure(runs, RAYCASTS, [&]() {
+			for (u32 idx = 0; idx < RAYCASTS; ++idx)
+			{
+				linearHits[idx] = raycast(items, rays[idx], 2000.0f);
+			}
+		});
+		u32 rayHits = 0;
+		for (u32 idx = 0; idx < RAYCASTS; ++idx)
+		{
+			// Ties between boxes at the same distance may resolve to either key
+			auto const& hit = treeHits[idx];
+			auto const& expected = linearHits[idx];
+			mismatches += hit.has_value() == expected.has_value() && (!hit || std::abs(hit->t - expected->t) <= 1e-3f) ? 0 : 1;
+			rayHits += hit ? 1 : 0;
+		}
+
+		char row[256];
+		std::snprintf(row, sizeof(row), "%10u | %10.2f %10.2f %7.1f | %10.2f %10.2f %7.1f | %10.2f %10.2f %7u", boxCount, aabbTreeUS,
+					  aabbLinearUS, (f64)aabbHits / AABB_QUERIES, frustumTreeUS, frustumCullUS, (f64)frustumHits / FRUSTUM_QUERIES,
+					  rayTreeUS, rayLinearUS, rayHits);
+		queryRows.push_back(row);
+	}
+	std::printf("\nQueries, us per query, best of %u runs (%u AABBs of 20^3, %u frusta of 100 units depth, %u rays)\n", runs, AABB_QUERIES,
+				FRUSTUM_QUERIES, RAYCASTS);
+	std::printf("%10s | %10s %10s %7s | %10s %10s %7s | %10s %10s %7s\n", "boxes", "aabb bvh", "linear", "hits", "frustum", "cull()",
+				"hits", "ray bvh", "linear", "hits");
+	for (auto const& row : queryRows)
+	{
+		std::printf("%s\n", row.data());
+	}
+	std::printf("\nQuery results differing from the linear scan: %u\n", mismatches);
+	LOGIF_E(mismatches > 0, "[Bench] BVH queries disagree with the linear scan!");
+	return mismatches == 0 ? 0 : 1;
+}
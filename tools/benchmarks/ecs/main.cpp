@@ -0,0 +1,261 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "le3d/core/log.hpp"
+#include "le3d/game/ecs/ecs_impl.hpp"
+
+using namespace le;
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+struct CPosition : Component
+{
+	f32 x = 0.0f;
+	f32 y = 0.0f;
+	f32 z = 0.0f;
+};
+
+struct CVelocity : Component
+{
+	f32 x = 1.0f;
+	f32 y = 2.0f;
+	f32 z = 3.0f;
+};
+
+struct CTag : Component
+{
+	s32 value = 1;
+};
+
+// Reproduction of the storage the archetype pools replaced: one heap allocation per component, in a per-type
+// unordered_map keyed by entity ID, accessed through dynamic_cast
+class LegacyStorage final
+{
+private:
+	using EntToComp = std::unordered_map<s64, std::unique_ptr<Component>>;
+
+	std::unordered_map<ecs::Signature, EntToComp> m_components;
+
+public:
+	template <typename Comp>
+	Comp* addComponent(s64 entityID);
+
+	template <typename Comp>
+	Comp* getComponent(s64 entityID);
+};
+
+template <typename Comp>
+Comp* LegacyStorage::addComponent(s64 entityID)
+{
+	auto uComp = std::make_unique<Comp>();
+	auto pComp = uComp.get();
+	m_components[ECSDB::getSignature<Comp>()][entityID] = std::move(uComp);
+	return pComp;
+}
+
+template <typename Comp>
+Comp* LegacyStorage::getComponent(s64 entityID)
+{
+	auto cSearch = m_components.find(ECSDB::getSignature<Comp>());
+	if (cSearch != m_components.end())
+	{
+		auto& cmap = cSearch->second;
+		auto search = cmap.find(entityID);
+		if (search != cmap.end())
+		{
+			return dynamic_cast<Comp*>(search->second.get());
+		}
+	}
+	return nullptr;
+}
+
+// Spawning and destroying entities / components logs at Info (once per call): silenced while worlds are built / torn down
+class MuteLogs final
+{
+private:
+	std::streambuf* m_pBuf;
+
+public:
+	MuteLogs() : m_pBuf(std::cout.rdbuf(nullptr)) {}
+	~MuteLogs()
+	{
+		std::cout.rdbuf(m_pBuf);
+		std::cout.clear();
+	}
+};
+
+// Every entity has a CPosition, every other one a CVelocity, every fifth one a CTag (four archetypes)
+struct World final
+{
+	ECSDB db;
+	LegacyStorage legacy;
+	std::vector<ecs::SpawnID> ids;
+	size_t movingCount = 0;
+};
+
+void populate(World& out, u32 entityCount)
+{
+	MuteLogs mute;
+	out.ids.reserve(entityCount);
+	for (u32 idx = 0; idx < entityCount; ++idx)
+	{
+		auto const id = out.db.spawnEntity("e");
+		out.ids.push_back(id);
+		out.db.addComponent<CPosition>(id);
+		out.legacy.addComponent<CPosition>(id);
+		if (idx % 2 == 1)
+		{
+			out.db.addComponent<CVelocity>(id);
+			out.legacy.addComponent<CVelocity>(id);
+			++out.movingCount;
+		}
+		if (idx % 5 == 0)
+		{
+			out.db.addComponent<CTag>(id);
+			out.legacy.addComponent<CTag>(id);
+		}
+	}
+	return;
+}
+
+template <typename T>
+f32 integrate(T& storage, std::vector<ecs::SpawnID> const& ids)
+{
+	f32 ret = 0.0f;
+	for (auto id : ids)
+	{
+		auto pPos = storage.template getComponent<CPosition>(id);
+		auto pVel = storage.template getComponent<CVelocity>(id);
+		if (pPos && pVel)
+		{
+			pPos->x += pVel->x * 0.01f;
+			pPos->y += pVel->y * 0.01f;
+			pPos->z += pVel->z * 0.01f;
+			ret += pPos->x;
+		}
+	}
+	return ret;
+}
+
+f32 integrate(ECSDB& db)
+{
+	f32 ret = 0.0f;
+	for (auto [pPos, pVel] : db.view<CPosition, CVelocity>())
+	{
+		pPos->x += pVel->x * 0.01f;
+		pPos->y += pVel->y * 0.01f;
+		pPos->z += pVel->z * 0.01f;
+		ret += pPos->x;
+	}
+	return ret;
+}
+
+// The query path views replaced: all<>() builds a Query (a map of per-entity maps) on every call
+f32 integrateQuery(ECSDB& db)
+{
+	f32 ret = 0.0f;
+	auto query = db.all<CPosition, CVelocity>();
+	for (auto& kvp : query)
+	{
+		auto pPos = kvp.second.get<CPosition>();
+		auto pVel = kvp.second.get<CVelocity>();
+		pPos->x += pVel->x * 0.01f;
+		pPos->y += pVel->y * 0.01f;
+		pPos->z += pVel->z * 0.01f;
+		ret += pPos->x;
+	}
+	return ret;
+}
+
+f64 best(u32 runs, std::function<f64()> const& bench)
+{
+	f64 ret = bench();
+	for (u32 run = 1; run < runs; ++run)
+	{
+		ret = std::min(ret, bench());
+	}
+	return ret;
+}
+
+// Microseconds per pass, best of runs
+f64 measure(u32 runs, u32 passes, std::function<void()> const& pass)
+{
+	return best(runs, [&]() {
+		auto const start = Clock::now();
+		for (u32 idx = 0; idx < passes; ++idx)
+		{
+			pass();
+		}
+		return std::chrono::duration<f64, std::micro>(Clock::now() - start).count() / (f64)passes;
+	});
+}
+
+void printUsage()
+{
+	std::printf("Usage: le3d-bench-ecs [entity counts...]\n");
+	std::printf("  Times a CPosition += CVelocity pass over N entities (default: 1000 10000 100000) through ECSDB::getComponent\n");
+	std::printf("  and ECSDB::view (archetype pools) against the previous per-component heap storage and the ECSDB::all query path\n");
+	return;
+}
+} // namespace
+
+s32 main(s32 argc, char const** argv)
+{
+	std::vector<u32> entityCounts;
+	for (s32 idx = 1; idx < argc; ++idx)
+	{
+		u32 const count = (u32)std::strtoul(argv[idx], nullptr, 10);
+		if (count == 0)
+		{
+			printUsage();
+			return std::string_view(argv[idx]) == "-h" || std::string_view(argv[idx]) == "--help" ? 0 : 1;
+		}
+		entityCounts.push_back(count);
+	}
+	if (entityCounts.empty())
+	{
+		entityCounts = {1000, 10000, 100000};
+	}
+	u32 const runs = 5;
+	f32 sink = 0.0f;
+	std::printf("CPosition += CVelocity over all entities (half moving), best of %u runs, us per pass\n", runs);
+	std::printf("%10s %10s | %12s %12s %12s %12s | %10s %10s\n", "entities", "moving", "legacy get", "pooled get", "all<> query", "view", "get/view",
+				"all/view");
+	for (auto entityCount : entityCounts)
+	{
+		auto uWorld = std::make_unique<World>();
+		auto& world = *uWorld;
+		populate(world, entityCount);
+		u32 const passes = std::max(1000000U / entityCount, 1U);
+		f64 const legacyUS = measure(runs, passes, [&]() { sink += integrate(world.legacy, world.ids); });
+		f64 const pooledUS = measure(runs, passes, [&]() { sink += integrate(world.db, world.ids); });
+		f64 const queryUS = measure(runs, std::max(passes / 10, 1U), [&]() { sink += integrateQuery(world.db); });
+		f64 const viewUS = measure(runs, passes, [&]() { sink += integrate(world.db); });
+		std::printf("%10u %10u | %12.2f %12.2f %12.2f %12.2f | %9.1fx %9.1fx\n", entityCount, (u32)world.movingCount, legacyUS, pooledUS,
+					queryUS, viewUS, legacyUS / viewUS, queryUS / viewUS);
+		MuteLogs mute;
+		uWorld.reset();
+	}
+	// view() itself, once its cache exists (every system calls it every frame)
+	World empty;
+	u32 const lookups = 10000000;
+	size_t matches = 0;
+	auto const start = Clock::now();
+	for (u32 idx = 0; idx < lookups; ++idx)
+	{
+		matches += empty.db.view<CPosition, CVelocity>().size();
+	}
+	f64 const lookupNS = std::chrono::duration<f64, std::nano>(Clock::now() - start).count() / (f64)lookups;
+	std::printf("ECSDB::view<CPosition, CVelocity>() lookup: %.1f ns (%u matches)\n", lookupNS, (u32)matches);
+	LOGIF_E(sink == 0.0f, "[Bench] Nothing was integrated!");
+	return 0;
+}
@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "le3d/core/log.hpp"
+#include "le3d/engine/gfx/gfx_thread.hpp"
+
+using namespace le;
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+// Same footprint as Shader::UniformWrite
+struct UniformWrite final
+{
+	std::array<f32, 16> data;
+	u32 id;
+	u8 type;
+};
+
+// Uniform writes staged per draw (model / normal matrices, material)
+constexpr size_t WRITES_PER_DRAW = 8;
+
+u64 g_sink = 0;
+
+// Reproduction of the recording path the command buffer replaced: a std::deque<std::function<void()>> behind a mutex,
+// swapped on present and replayed on the main thread; uniform writes moved into each flush's closure
+class LegacyQueue final
+{
+private:
+	std::mutex m_mutex;
+	std::deque<std::function<void()>> m_enqueued;
+	std::deque<std::function<void()>> m_render;
+
+public:
+	void enqueue(std::function<void()> task);
+	void present();
+};
+
+void LegacyQueue::enqueue(std::function<void()> task)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_enqueued.push_back(std::move(task));
+	return;
+}
+
+void LegacyQueue::present()
+{
+	for (auto& task : m_render)
+	{
+		task();
+	}
+	m_render.clear();
+	std::lock_guard<std::mutex> lock(m_mutex);
+	std::swap(m_render, m_enqueued);
+	return;
+}
+
+struct Result final
+{
+	f64 nsPerCommand = 0.0;
+	f64 fps = 0.0;
+};
+
+// Records draws x (uniform flush + draw) commands per frame, then presents
+template <typename Enqueue, typename Present>
+Result measure(u32 frames, u32 draws, Enqueue enqueue, Present present)
+{
+	std::vector<UniformWrite> staged;
+	auto const start = Clock::now();
+	for (u32 frame = 0; frame < frames; ++frame)
+	{
+		for (u32 draw = 0; draw < draws; ++draw)
+		{
+			for (size_t idx = 0; idx < WRITES_PER_DRAW; ++idx)
+			{
+				UniformWrite write{};
+				write.id = (u32)idx;
+				write.data[0] = (f32)draw;
+				staged.push_back(write);
+			}
+			enqueue(staged, draw);
+			staged.clear();
+		}
+		present();
+	}
+	f64 const seconds = std::chrono::duration<f64>(Clock::now() - start).count();
+	Result ret;
+	ret.nsPerCommand = seconds * 1e9 / ((f64)frames * (f64)(draws * 2 + 1));
+	ret.fps = (f64)frames / seconds;
+	return ret;
+}
+
+Result measureLegacy(u32 frames, u32 draws)
+{
+	LegacyQueue queue;
+	auto const ret = measure(
+		frames, draws,
+		[&queue](std::vector<UniformWrite>& staged, u32 draw) {
+			queue.enqueue([writes = std::move(staged)]() { g_sink += writes.size(); });
+			queue.enqueue([vao = draw, count = (u32)36, first = draw * 36]() { g_sink += vao + count + first; });
+		},
+		[&queue]() { queue.present(); });
+	queue.present();
+	return ret;
+}
+
+Result measureGFX(u32 frames, u32 draws, GFXMode mode, bool& bOutCountsOK)
+{
+	gfx::setMode(mode);
+	auto const ret = measure(
+		frames, draws,
+		[](std::vector<UniformWrite> const& staged, u32 draw) {
+			gfx::enqueue([](UniformWrite const* pWrites, size_t count) { g_sink += count + pWrites[0].id; }, staged.data(), staged.size());
+			gfx::enqueue([vao = draw, count = (u32)36, first = draw * 36]() { g_sink += vao + count + first; });
+		},
+		[]() { gfx::present([]() {}); });
+	bOutCountsOK = gfx::lastFrameCommandCount() == draws * 2 + 1;
+	gfx::setMode(GFXMode::ImmediateMainThread);
+	return ret;
+}
+
+void printUsage()
+{
+	std::printf("Usage: le3d-bench-gfx [--frames=N] [--draws=N]\n");
+	std::printf("  Headless: records N draws per frame (a uniform flush with %u writes + a draw) through gfx::enqueue and presents,\n",
+				(u32)WRITES_PER_DRAW);
+	std::printf("  in each GFXMode, against the previous std::deque<std::function> recording path (default: 200 frames x 2000 draws)\n");
+	return;
+}
+} // namespace
+
+s32 main(s32 argc, char const** argv)
+{
+	u32 frames = 200;
+	u32 draws = 2000;
+	for (s32 idx = 1; idx < argc; ++idx)
+	{
+		std::string_view const arg = argv[idx];
+		if (arg.substr(0, 9) == "--frames=")
+		{
+			frames = (u32)std::strtoul(argv[idx] + 9, nullptr, 10);
+		}
+		else if (arg.substr(0, 8) == "--draws=")
+		{
+			draws = (u32)std::strtoul(argv[idx] + 8, nullptr, 10);
+		}
+		else
+		{
+			printUsage();
+			return arg == "-h" || arg == "--help" ? 0 : 1;
+		}
+	}
+	if (frames == 0 || draws == 0)
+	{
+		printUsage();
+		return 1;
+	}
+	gfx::setHeadless(true);
+	std::printf("Headless, %u frames x %u draws (%u commands per frame)\n", frames, draws, draws * 2 + 1);
+	std::printf("%-28s %12s %12s\n", "path", "ns / command", "frames / s");
+	auto const legacy = measureLegacy(frames, draws);
+	std::printf("%-28s %12.1f %12.1f\n", "deque<function> (old)", legacy.nsPerCommand, legacy.fps);
+	std::array<std::pair<char const*, GFXMode>, 3> const modes = {{{"ImmediateMainThread", GFXMode::ImmediateMainThread},
+																   {"BufferedMainThread", GFXMode::BufferedMainThread},
+																   {"BufferedThreaded", GFXMode::BufferedThreaded}}};
+	s32 ret = 0;
+	for (auto const& [name, mode] : modes)
+	{
+		bool bCountsOK = false;
+		auto const result = measureGFX(frames, draws, mode, bCountsOK);
+		std::printf("%-28s %12.1f %12.1f\n", name, result.nsPerCommand, result.fps);
+		if (!bCountsOK)
+		{
+			LOG_E("[Bench] [%s] Unexpected command count: %u", name, gfx::lastFrameCommandCount());
+			ret = 1;
+		}
+	}
+	return ret;
+}
@@ -0,0 +1,265 @@
+#include <algorithm>
+#include <any>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <vector>
+#include "le3d/core/jobs.hpp"
+#include "le3d/env/threads.hpp"
+
+using namespace le;
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+// Reproduction of the JobManager queue this scheduler replaced: one std::queue behind one mutex + condition variable,
+// a packaged_task and shared handle per job, and a notify_one after every pop
+class SharedQueue final
+{
+public:
+	using Handle = std::shared_ptr<std::future<std::any>>;
+
+private:
+	struct Job
+	{
+		std::packaged_task<std::any()> task;
+		std::string logName;
+		Handle hJob;
+		s64 id = -1;
+	};
+
+private:
+	std::vector<HThread> m_threads;
+	std::queue<Job> m_jobQueue;
+	std::mutex m_wakeMutex;
+	std::condition_variable m_wakeCV;
+	s64 m_nextJobID = 0;
+	bool m_bWork = true;
+
+public:
+	SharedQueue(u32 workerCount);
+	~SharedQueue();
+
+public:
+	Handle enqueue(std::function<std::any()> task);
+
+private:
+	void run();
+};
+
+SharedQueue::SharedQueue(u32 workerCount)
+{
+	for (u32 idx = 0; idx < workerCount; ++idx)
+	{
+		m_threads.push_back(threads::newThread([this]() { run(); }));
+	}
+}
+
+SharedQueue::~SharedQueue()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_wakeMutex);
+		m_bWork = false;
+	}
+	m_wakeCV.notify_all();
+	for (auto& hThread : m_threads)
+	{
+		threads::join(hThread);
+	}
+}
+
+SharedQueue::Handle SharedQueue::enqueue(std::function<std::any()> task)
+{
+	Handle ret;
+	{
+		std::lock_guard<std::mutex> lock(m_wakeMutex);
+		Job job;
+		job.id = ++m_nextJobID;
+		job.logName = "[" + std::to_string(job.id) + "]";
+		job.task = std::packaged_task<std::any()>(std::move(task));
+		job.hJob = std::make_shared<std::future<std::any>>(job.task.get_future());
+		ret = job.hJob;
+		m_jobQueue.push(std::move(job));
+	}
+	m_wakeCV.notify_one();
+	return ret;
+}
+
+void SharedQueue::run()
+{
+	while (true)
+	{
+		std::unique_lock<std::mutex> lock(m_wakeMutex);
+		m_wakeCV.wait(lock, [&]() { return !m_jobQueue.empty() || !m_bWork; });
+		if (m_jobQueue.empty())
+		{
+			return;
+		}
+		Job job = std::move(m_jobQueue.front());
+		m_jobQueue.pop();
+		lock.unlock();
+		m_wakeCV.notify_one();
+		job.task();
+	}
+}
+
+// Enough work per job to make the scheduler, not the task, dominate
+void work(std::atomic<u64>& sink)
+{
+	u64 value = 0;
+	for (u32 idx = 0; idx < 64; ++idx)
+	{
+		value = value * 31 + idx;
+	}
+	sink.fetch_add(value, std::memory_order_relaxed);
+	return;
+}
+
+// Every job enqueued by the main thread, then waited on
+f64 externalShared(u32 workers, u32 jobCount, std::atomic<u64>& sink)
+{
+	SharedQueue queue(workers);
+	std::vector<SharedQueue::Handle> handles;
+	handles.reserve(jobCount);
+	auto const start = Clock::now();
+	for (u32 idx = 0; idx < jobCount; ++idx)
+	{
+		handles.push_back(queue.enqueue([&sink]() -> std::any {
+			work(sink);
+			return {};
+		}));
+	}
+	for (auto& hJob : handles)
+	{
+		hJob->wait();
+	}
+	return std::chrono::duration<f64>(Clock::now() - start).count();
+}
+
+f64 externalStealing(u32 workers, u32 jobCount, std::atomic<u64>& sink)
+{
+	jobs::init(workers);
+	std::vector<HJob> handles;
+	handles.reserve(jobCount);
+	auto const start = Clock::now();
+	for (u32 idx = 0; idx < jobCount; ++idx)
+	{
+		handles.push_back(jobs::enqueue([&sink]() { work(sink); }, "", true));
+	}
+	jobs::waitAll(handles);
+	f64 const ret = std::chrono::duration<f64>(Clock::now() - start).count();
+	jobs::cleanup();
+	return ret;
+}
+
+// Jobs enqueued by jobs (fan-out from 16 roots), as forEach / loader tasks do
+f64 nestedShared(u32 workers, u32 jobCount, std::atomic<u64>& sink)
+{
+	SharedQueue queue(workers);
+	u32 const roots = 16;
+	std::vector<std::vector<SharedQueue::Handle>> children(roots);
+	std::vector<SharedQueue::Handle> rootHandles;
+	auto const start = Clock::now();
+	for (u32 root = 0; root < roots; ++root)
+	{
+		rootHandles.push_back(queue.enqueue([&, root]() -> std::any {
+			for (u32 idx = root; idx < jobCount; idx += roots)
+			{
+				children[root].push_back(queue.enqueue([&sink]() -> std::any {
+					work(sink);
+					return {};
+				}));
+			}
+			return {};
+		}));
+	}
+	for (u32 root = 0; root < roots; ++root)
+	{
+		rootHandles[root]->wait();
+		for (auto& hJob : children[root])
+		{
+			hJob->wait();
+		}
+	}
+	return std::chrono::duration<f64>(Clock::now() - start).count();
+}
+
+f64 nestedStealing(u32 workers, u32 jobCount, std::atomic<u64>& sink)
+{
+	jobs::init(workers);
+	u32 const roots = 16;
+	std::vector<std::vector<HJob>> children(roots);
+	std::vector<HJob> rootHandles;
+	auto const start = Clock::now();
+	for (u32 root = 0; root < roots; ++root)
+	{
+		rootHandles.push_back(jobs::enqueue(
+			[&, root]() {
+				for (u32 idx = root; idx < jobCount; idx += roots)
+				{
+					children[root].push_back(jobs::enqueue([&sink]() { work(sink); }, "", true));
+				}
+			},
+			"", true));
+	}
+	for (u32 root = 0; root < roots; ++root)
+	{
+		rootHandles[root].wait();
+		jobs::waitAll(children[root]);
+	}
+	f64 const ret = std::chrono::duration<f64>(Clock::now() - start).count();
+	jobs::cleanup();
+	return ret;
+}
+
+f64 best(u32 runs, std::function<f64()> const& bench)
+{
+	f64 ret = bench();
+	for (u32 run = 1; run < runs; ++run)
+	{
+		ret = std::min(ret, bench());
+	}
+	return ret;
+}
+} // namespace
+
+s32 main(s32 argc, char const** argv)
+{
+	u32 const jobCount = argc > 1 ? (u32)std::strtoul(argv[1], nullptr, 10) : 100000;
+	// jobs::init() caps workers at the hardware thread count
+	u32 const maxWorkers = std::min(argc > 2 ? (u32)std::strtoul(argv[2], nullptr, 10) : 64U, threads::maxHardwareThreads());
+	u32 const runs = 5;
+	if (jobCount == 0 || maxWorkers == 0)
+	{
+		std::printf("Usage: le3d-bench-jobs [job count (default: 100000)] [max workers (default: hardware threads)]\n");
+		return 1;
+	}
+	std::printf("Enqueue + drain of %u jobs, best of %u runs (Mjobs/s)\n", jobCount, runs);
+	std::printf("%8s | %12s %12s | %12s %12s\n", "workers", "shared", "stealing", "nested sh.", "nested st.");
+	std::atomic<u64> sink = 0;
+	std::vector<u32> workerCounts;
+	for (u32 workers = 1; workers < maxWorkers; workers *= 2)
+	{
+		workerCounts.push_back(workers);
+	}
+	workerCounts.push_back(maxWorkers);
+	for (u32 workers : workerCounts)
+	{
+		auto const rate = [jobCount](f64 secs) { return (f64)jobCount / secs / 1e6; };
+		f64 const shared = best(runs, [&]() { return externalShared(workers, jobCount, sink); });
+		f64 const stealing = best(runs, [&]() { return externalStealing(workers, jobCount, sink); });
+		f64 const nestedSh = best(runs, [&]() { return nestedShared(workers, jobCount, sink); });
+		f64 const nestedSt = best(runs, [&]() { return nestedStealing(workers, jobCount, sink); });
+		std::printf("%8u | %12.2f %12.2f | %12.2f %12.2f\n", workers, rate(shared), rate(stealing), rate(nestedSh), rate(nestedSt));
+	}
+	return 0;
+}
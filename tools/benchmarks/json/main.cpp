@@ -0,0 +1,278 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "le3d/core/gdata.hpp"
+#include "le3d/core/io.hpp"
+#include "le3d/core/json.hpp"
+#include "le3d/core/log.hpp"
+#include "le3d/core/utils.hpp"
+
+using namespace le;
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+// Reproduction of the GData this DOM replaced: strips whitespace, tokenises the text on ',' (skipping enclosed
+// braces / brackets / quotes) into a map of raw strings, and re-tokenises every nested object it is asked for
+class LegacyGData final
+{
+private:
+	std::unordered_map<std::string, std::string> m_fieldMap;
+
+public:
+	LegacyGData() = default;
+	explicit LegacyGData(std::string serialised);
+
+public:
+	bool marshall(std::string serialised);
+	std::string getString(std::string const& key, std::string defaultValue = "") const;
+	bool getBool(std::string const& key, bool defaultValue) const;
+	s32 getS32(std::string const& key, s32 defaultValue) const;
+	LegacyGData getGData(std::string const& key) const;
+	std::unordered_map<std::string, std::string> const& allFields() const;
+	bool contains(std::string const& id) const;
+};
+
+std::initializer_list<std::pair<char, char>> gDataEscapes = {{'{', '}'}, {'[', ']'}, {'"', '"'}};
+
+LegacyGData::LegacyGData(std::string serialised)
+{
+	if (!serialised.empty())
+	{
+		marshall(std::move(serialised));
+	}
+}
+
+bool LegacyGData::marshall(std::string serialised)
+{
+	utils::strings::removeChars(serialised, {'\t', '\r', '\n'});
+	utils::strings::trim(serialised, {' '});
+	if (serialised[0] == '{' && serialised[serialised.size() - 1] == '}')
+	{
+		m_fieldMap.clear();
+		std::string rawText = serialised.substr(1, serialised.size() - 2);
+		std::vector<std::string> tokens = utils::strings::tokenise(rawText, ',', gDataEscapes);
+		for (auto const& token : tokens)
+		{
+			std::pair<std::string, std::string> kvp = utils::strings::bisect(token, ':');
+			if (!kvp.second.empty() && !kvp.first.empty())
+			{
+				utils::strings::trim(kvp.first, {' '});
+				utils::strings::trim(kvp.first, {'"'});
+				if (kvp.first != " ")
+				{
+					utils::strings::trim(kvp.first, {' '});
+				}
+				utils::strings::trim(kvp.second, {' ', '"'});
+				m_fieldMap.emplace(std::move(kvp.first), std::move(kvp.second));
+			}
+		}
+		return true;
+	}
+	return false;
+}
+
+std::string LegacyGData::getString(std::string const& key, std::string defaultValue) const
+{
+	auto search = m_fieldMap.find(key);
+	return search != m_fieldMap.end() ? search->second : defaultValue;
+}
+
+bool LegacyGData::getBool(std::string const& key, bool defaultValue) const
+{
+	auto search = m_fieldMap.find(key);
+	return search != m_fieldMap.end() ? utils::strings::toBool(search->second, defaultValue) : defaultValue;
+}
+
+s32 LegacyGData::getS32(std::string const& key, s32 defaultValue) const
+{
+	auto search = m_fieldMap.find(key);
+	return search != m_fieldMap.end() ? utils::strings::toS32(search->second, defaultValue) : defaultValue;
+}
+
+LegacyGData LegacyGData::getGData(std::string const& key) const
+{
+	auto search = m_fieldMap.find(key);
+	return search != m_fieldMap.end() ? LegacyGData(search->second) : LegacyGData();
+}
+
+std::unordered_map<std::string, std::string> const& LegacyGData::allFields() const
+{
+	return m_fieldMap;
+}
+
+bool LegacyGData::contains(std::string const& id) const
+{
+	return m_fieldMap.find(id) != m_fieldMap.end();
+}
+
+// What Font::Descriptor::deserialise reads: header fields, then nine fields per glyph
+struct FontSummary final
+{
+	std::string id;
+	std::string sheetID;
+	std::string samplerID;
+	size_t glyphCount = 0;
+	s64 checksum = 0;
+
+	bool operator==(FontSummary const& rhs) const
+	{
+		return id == rhs.id && sheetID == rhs.sheetID && samplerID == rhs.samplerID && glyphCount == rhs.glyphCount
+			   && checksum == rhs.checksum;
+	}
+};
+
+template <typename T>
+s64 readGlyph(T const& glyph)
+{
+	s64 ret = glyph.getS32("x", 0) + glyph.getS32("y", 0) + glyph.getS32("width", 0) + glyph.getS32("height", 0);
+	ret += glyph.getS32("originX", 0) + glyph.getS32("originY", 0) + glyph.getS32("advance", 0) + glyph.getS32("size", 0);
+	ret += glyph.getBool("isBlank", false) ? 1 : 0;
+	return ret;
+}
+
+template <typename T>
+void readHeader(T const& json, FontSummary& outSummary)
+{
+	outSummary.id = json.getString("id");
+	outSummary.sheetID = json.getString("sheetID");
+	outSummary.samplerID = json.getString("sampler", "font");
+	return;
+}
+
+FontSummary readLegacy(std::string const& text)
+{
+	FontSummary ret;
+	LegacyGData const json(text);
+	if (json.contains("id"))
+	{
+		readHeader(json, ret);
+		auto const glyphsData = json.getGData("glyphs");
+		for (auto const& kvp : glyphsData.allFields())
+		{
+			ret.checksum += readGlyph(LegacyGData(kvp.second));
+			++ret.glyphCount;
+		}
+	}
+	return ret;
+}
+
+FontSummary readDOM(std::string const& text)
+{
+	FontSummary ret;
+	GData const json(text);
+	if (json.contains("id"))
+	{
+		readHeader(json, ret);
+		auto const glyphsData = json.getGData("glyphs");
+		for (auto const& kvp : glyphsData.allGDatas())
+		{
+			ret.checksum += readGlyph(kvp.second);
+			++ret.glyphCount;
+		}
+	}
+	return ret;
+}
+
+f64 best(u32 runs, std::function<f64()> const& bench)
+{
+	f64 ret = bench();
+	for (u32 run = 1; run < runs; ++run)
+	{
+		ret = std::min(ret, bench());
+	}
+	return ret;
+}
+
+// Microseconds per iteration of task, best of runs
+f64 measure(u32 runs, u32 iterations, std::function<void()> const& task)
+{
+	return best(runs, [&]() {
+		auto const start = Clock::now();
+		for (u32 iter = 0; iter < iterations; ++iter)
+		{
+			task();
+		}
+		return std::chrono::duration<f64, std::micro>(Clock::now() - start).count() / (f64)iterations;
+	});
+}
+
+void printUsage()
+{
+	std::printf("Usage: le3d-bench-json <resources directory> [--file=<id>] [--iterations=N]\n");
+	std::printf("  Times parsing a JSON file (default: fonts/default.json) with json::Document against the previous GData tokeniser,\n");
+	std::printf("  and reading it the way Font::Descriptor::deserialise does through both GData implementations\n");
+	return;
+}
+} // namespace
+
+s32 main(s32 argc, char const** argv)
+{
+	stdfs::path resources;
+	stdfs::path fileID = "fonts/default.json";
+	u32 iterations = 200;
+	for (s32 idx = 1; idx < argc; ++idx)
+	{
+		std::string_view const arg = argv[idx];
+		if (arg.substr(0, 7) == "--file=")
+		{
+			fileID = arg.substr(7);
+		}
+		else if (arg.substr(0, 13) == "--iterations=")
+		{
+			iterations = (u32)std::strtoul(argv[idx] + 13, nullptr, 10);
+		}
+		else if (arg == "-h" || arg == "--help")
+		{
+			printUsage();
+			return 0;
+		}
+		else
+		{
+			resources = arg;
+		}
+	}
+	if (resources.empty() || !stdfs::is_regular_file(resources / fileID) || iterations == 0)
+	{
+		printUsage();
+		return 1;
+	}
+	std::stringstream str;
+	str << std::ifstream(resources / fileID, std::ios::binary).rdbuf();
+	std::string const text = str.str();
+	auto const legacy = readLegacy(text);
+	auto const dom = readDOM(text);
+	if (legacy.glyphCount != dom.glyphCount)
+	{
+		// Glyph keys such as "," and "{" break the tokeniser: those glyphs were silently dropped
+		LOG_W("[Bench] [%s] Old GData read %u glyphs, json DOM read %u", fileID.generic_string().data(), (u32)legacy.glyphCount,
+			  (u32)dom.glyphCount);
+	}
+	else if (!(legacy == dom))
+	{
+		LOG_E("[Bench] [%s] Results differ between old GData and json DOM!", fileID.generic_string().data());
+	}
+	u32 const runs = 5;
+	size_t sink = 0;
+	f64 const legacyParse = measure(runs, iterations, [&]() { sink += LegacyGData(text).allFields().size(); });
+	f64 const domParse = measure(runs, iterations, [&]() {
+		json::Document doc;
+		sink += doc.parse(text) ? doc.root().size() : 0;
+	});
+	f64 const legacyRead = measure(runs, iterations, [&]() { sink += readLegacy(text).glyphCount; });
+	f64 const domRead = measure(runs, iterations, [&]() { sink += readDOM(text).glyphCount; });
+	std::printf("[%s] %u bytes, %u glyphs; best of %u runs x %u iterations, us per document\n", fileID.generic_string().data(),
+				(u32)text.size(), (u32)dom.glyphCount, runs, iterations);
+	std::printf("%-24s %12s %12s %10s\n", "", "GData (old)", "json DOM", "speedup");
+	std::printf("%-24s %12.2f %12.2f %9.1fx\n", "parse", legacyParse, domParse, legacyParse / domParse);
+	std::printf("%-24s %12.2f %12.2f %9.1fx\n", "parse + read glyphs", legacyRead, domRead, legacyRead / domRead);
+	return sink > 0 ? 0 : 1;
+}
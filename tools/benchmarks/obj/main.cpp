@@ -0,0 +1,240 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+#include <tinyobjloader/tiny_obj_loader.h>
+#include "le3d/core/io.hpp"
+#include "le3d/core/log.hpp"
+#include "le3d/engine/gfx/model.hpp"
+
+using namespace le;
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+struct Subject final
+{
+	stdfs::path resources;
+	stdfs::path jsonID;
+	stdfs::path obj;
+	stdfs::path mtlDir;
+	f32 scale = 1.0f;
+};
+
+struct Result final
+{
+	size_t indexCount = 0;
+	size_t vertexCount = 0;
+	f64 parseMS = 0.0;
+	f64 linearMS = 0.0;
+	f64 loadMS = 0.0;
+};
+
+f64 elapsedMS(Clock::time_point start)
+{
+	return std::chrono::duration<f64, std::milli>(Clock::now() - start).count();
+}
+
+// The welding pass Model::loadOBJ used before hashing: every OBJ index scans every vertex emitted so far
+size_t weldLinear(tinyobj::attrib_t const& attrib, tinyobj::shape_t const& shape, f32 scale, gfx::Geometry& outGeometry)
+{
+	for (auto const& idx : shape.mesh.indices)
+	{
+		f32 vx = attrib.vertices[3 * (size_t)idx.vertex_index + 0] * scale;
+		f32 vy = attrib.vertices[3 * (size_t)idx.vertex_index + 1] * scale;
+		f32 vz = attrib.vertices[3 * (size_t)idx.vertex_index + 2] * scale;
+		f32 nx = attrib.normals.empty() || idx.normal_index < 0 ? 0.0f : attrib.normals[3 * (size_t)idx.normal_index + 0];
+		f32 ny = attrib.normals.empty() || idx.normal_index < 0 ? 0.0f : attrib.normals[3 * (size_t)idx.normal_index + 1];
+		f32 nz = attrib.normals.empty() || idx.normal_index < 0 ? 0.0f : attrib.normals[3 * (size_t)idx.normal_index + 2];
+		f32 tx = attrib.texcoords.empty() || idx.texcoord_index < 0 ? 0.0f : attrib.texcoords[2 * (size_t)idx.texcoord_index + 0];
+		f32 ty = attrib.texcoords.empty() || idx.texcoord_index < 0 ? 0.0f : attrib.texcoords[2 * (size_t)idx.texcoord_index + 1];
+		size_t vertCount = outGeometry.vertexCount();
+		bool bFound = false;
+		for (size_t i = 0; i < vertCount; ++i)
+		{
+			auto const& p = outGeometry.points;
+			auto const& n = outGeometry.normals;
+			auto const& t = outGeometry.texCoords;
+			if (p[i] == gfx::Geometry::V3{vx, vy, vz} && n[i] == gfx::Geometry::V3{nx, ny, nz} && t[i] == gfx::Geometry::V2{tx, ty})
+			{
+				bFound = true;
+				outGeometry.indices.push_back((u32)i);
+				break;
+			}
+		}
+		if (!bFound)
+		{
+			outGeometry.indices.push_back(outGeometry.addVertex({vx, vy, vz}, {nx, ny, nz}, glm::vec2(tx, ty)));
+		}
+	}
+	return outGeometry.vertexCount();
+}
+
+f64 best(u32 runs, std::function<f64()> const& bench)
+{
+	f64 ret = bench();
+	for (u32 run = 1; run < runs; ++run)
+	{
+		ret = std::min(ret, bench());
+	}
+	return ret;
+}
+
+Result measure(Subject const& subject, u32 runs, bool bLinear)
+{
+	Result ret;
+	tinyobj::attrib_t attrib;
+	std::vector<tinyobj::shape_t> shapes;
+	ret.parseMS = best(runs, [&]() {
+		std::vector<tinyobj::material_t> materials;
+		std::string warn, err;
+		attrib = {};
+		shapes.clear();
+		auto const start = Clock::now();
+		tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, subject.obj.string().data(), subject.mtlDir.string().data());
+		return elapsedMS(start);
+	});
+	for (auto const& shape : shapes)
+	{
+		ret.indexCount += shape.mesh.indices.size();
+	}
+	if (bLinear)
+	{
+		// Quadratic: a single run
+		auto const start = Clock::now();
+		for (auto const& shape : shapes)
+		{
+			gfx::Geometry geometry;
+			ret.vertexCount += weldLinear(attrib, shape, subject.scale, geometry);
+		}
+		ret.linearMS = elapsedMS(start);
+	}
+	FileReader reader(subject.resources);
+	ret.loadMS = best(runs, [&]() {
+		auto const start = Clock::now();
+		auto const descriptor = gfx::Model::loadOBJ({subject.jsonID, &reader, {}});
+		f64 const ms = elapsedMS(start);
+		size_t vertexCount = 0;
+		for (auto const& mesh : descriptor.meshes)
+		{
+			vertexCount += mesh.geometry.vertexCount();
+		}
+		if (bLinear && vertexCount != ret.vertexCount)
+		{
+			LOG_E("[Bench] [%s] Welded to %u vertices, expected %u!", subject.jsonID.generic_string().data(), (u32)vertexCount,
+				  (u32)ret.vertexCount);
+		}
+		ret.vertexCount = vertexCount;
+		return ms;
+	});
+	return ret;
+}
+
+// Writes a (gridSize x gridSize) quad grid as an OBJ model under root: every interior vertex is referenced by six triangles
+Subject writeGrid(stdfs::path const& root, u32 gridSize)
+{
+	Subject ret;
+	ret.resources = root;
+	ret.jsonID = "models/grid";
+	ret.mtlDir = root / ret.jsonID;
+	ret.obj = ret.mtlDir / "grid.obj";
+	stdfs::create_directories(ret.mtlDir);
+	std::ofstream(ret.mtlDir / "grid.json") << R"({ "id": "models/grid", "obj": "grid.obj", "mtl": "grid.mtl" })";
+	std::ofstream(ret.mtlDir / "grid.mtl") << "newmtl grid\nKd 0.5 0.5 0.5\nillum 2\n";
+	std::ofstream obj(ret.obj);
+	obj << "mtllib grid.mtl\no grid\n";
+	u32 const side = gridSize + 1;
+	for (u32 y = 0; y < side; ++y)
+	{
+		for (u32 x = 0; x < side; ++x)
+		{
+			f32 const u = (f32)x / (f32)gridSize;
+			f32 const v = (f32)y / (f32)gridSize;
+			obj << "v " << u << " 0 " << v << "\nvt " << u << " " << v << "\n";
+		}
+	}
+	obj << "vn 0 1 0\nusemtl grid\n";
+	for (u32 y = 0; y < gridSize; ++y)
+	{
+		for (u32 x = 0; x < gridSize; ++x)
+		{
+			u32 const idx = y * side + x + 1;
+			auto const corner = [&obj](u32 i) { obj << " " << i << "/" << i << "/1"; };
+			obj << "f";
+			corner(idx);
+			corner(idx + side);
+			corner(idx + 1);
+			obj << "\nf";
+			corner(idx + 1);
+			corner(idx + side);
+			corner(idx + side + 1);
+			obj << "\n";
+		}
+	}
+	return ret;
+}
+
+void printUsage()
+{
+	std::printf("Usage: le3d-bench-obj <resources directory> [--grid=N] [--no-linear]\n");
+	std::printf("  Times Model::loadOBJ (hashed welding) on the demo fox and plant and a synthetic N x N grid (default: 128),\n");
+	std::printf("  against tinyobj parsing plus the previous linear-scan welding of the same data\n");
+	std::printf("  --no-linear  Skip the linear-scan reference (quadratic in vertex count)\n");
+	return;
+}
+} // namespace
+
+s32 main(s32 argc, char const** argv)
+{
+	stdfs::path resources;
+	u32 gridSize = 128;
+	bool bLinear = true;
+	for (s32 idx = 1; idx < argc; ++idx)
+	{
+		std::string_view const arg = argv[idx];
+		if (arg.substr(0, 7) == "--grid=")
+		{
+			gridSize = (u32)std::strtoul(argv[idx] + 7, nullptr, 10);
+		}
+		else if (arg == "--no-linear")
+		{
+			bLinear = false;
+		}
+		else if (arg == "-h" || arg == "--help")
+		{
+			printUsage();
+			return 0;
+		}
+		else
+		{
+			resources = arg;
+		}
+	}
+	if (resources.empty() || !stdfs::is_directory(resources) || gridSize == 0)
+	{
+		printUsage();
+		return 1;
+	}
+	auto const gridRoot = stdfs::temp_directory_path() / "le3d-bench-obj";
+	std::vector<std::pair<std::string, Subject>> subjects;
+	subjects.push_back({"fox", {resources, "models/test/fox", resources / "models/test/fox/fox2.obj", resources / "models/test/fox", 0.02f}});
+	subjects.push_back({"plant", {resources, "models/plant", resources / "models/plant/plant.obj", resources / "models/plant", 0.05f}});
+	subjects.push_back({"grid" + std::to_string(gridSize), writeGrid(gridRoot, gridSize)});
+	u32 const runs = 5;
+	std::printf("Best of %u runs (linear: 1 run); load = Model::loadOBJ (parse + hashed weld + texture decode), ms\n", runs);
+	std::printf("%-10s %10s %10s | %10s %10s | %10s\n", "model", "indices", "vertices", "parse", "linear", "load");
+	for (auto const& [name, subject] : subjects)
+	{
+		auto const result = measure(subject, runs, bLinear);
+		std::printf("%-10s %10u %10u | %10.2f %10.2f | %10.2f\n", name.data(), (u32)result.indexCount, (u32)result.vertexCount, result.parseMS,
+					result.linearMS, result.loadMS);
+	}
+	std::error_code errCode;
+	stdfs::remove_all(gridRoot, errCode);
+	return 0;
+}
@@ -0,0 +1,248 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "le3d/core/log.hpp"
+#include "le3d/core/range_allocator.hpp"
+
+using namespace le;
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+// Best-fit allocator over ordered maps (free ranges by offset, and by size) with neighbour coalescing: the usual alternative
+// to TLSF, O(log n) per operation
+class MapAllocator final
+{
+private:
+	std::map<u32, u32> m_freeByOffset;
+	std::multimap<u32, u32> m_freeBySize;
+
+public:
+	explicit MapAllocator(u32 capacity);
+
+public:
+	u32 allocate(u32 size);
+	void release(u32 offset, u32 size);
+
+private:
+	void addFree(u32 offset, u32 size);
+	void removeFree(u32 offset, u32 size);
+};
+
+MapAllocator::MapAllocator(u32 capacity)
+{
+	addFree(0, capacity);
+}
+
+u32 MapAllocator::allocate(u32 size)
+{
+	auto search = m_freeBySize.lower_bound(size);
+	if (search == m_freeBySize.end())
+	{
+		return RangeAllocator::s_invalid;
+	}
+	u32 const offset = search->second;
+	u32 const freeSize = search->first;
+	removeFree(offset, freeSize);
+	if (freeSize > size)
+	{
+		addFree(offset + size, freeSize - size);
+	}
+	return offset;
+}
+
+void MapAllocator::release(u32 offset, u32 size)
+{
+	auto next = m_freeByOffset.lower_bound(offset);
+	if (next != m_freeByOffset.end() && next->first == offset + size)
+	{
+		u32 const nextSize = next->second;
+		removeFree(next->first, nextSize);
+		size += nextSize;
+	}
+	auto prev = m_freeByOffset.lower_bound(offset);
+	if (prev != m_freeByOffset.begin())
+	{
+		--prev;
+		if (prev->first + prev->second == offset)
+		{
+			u32 const prevOffset = prev->first;
+			u32 const prevSize = prev->second;
+			removeFree(prevOffset, prevSize);
+			offset = prevOffset;
+			size += prevSize;
+		}
+	}
+	addFree(offset, size);
+	return;
+}
+
+void MapAllocator::addFree(u32 offset, u32 size)
+{
+	m_freeByOffset[offset] = size;
+	m_freeBySize.emplace(size, offset);
+	return;
+}
+
+void MapAllocator::removeFree(u32 offset, u32 size)
+{
+	m_freeByOffset.erase(offset);
+	auto range = m_freeBySize.equal_range(size);
+	for (auto iter = range.first; iter != range.second; ++iter)
+	{
+		if (iter->second == offset)
+		{
+			m_freeBySize.erase(iter);
+			break;
+		}
+	}
+	return;
+}
+
+struct Timings final
+{
+	f64 allocateNS = 0.0;
+	f64 churnNS = 0.0;
+	f64 releaseNS = 0.0;
+	f64 perOpNS = 0.0;
+};
+
+constexpr u32 CHURN_ROUNDS = 4;
+
+// Mesh-sized requests (vertex / index bytes): allocate all, then release + re-allocate half of them in shuffled order
+// CHURN_ROUNDS times, then release all; nanoseconds per operation of each phase
+template <typename Alloc, typename Handle>
+Timings run(std::vector<u32> const& sizes, std::vector<u32> const& order, u32 capacity, std::function<Handle(Alloc&, u32)> const& allocate,
+			std::function<void(Alloc&, Handle, u32)> const& release)
+{
+	Timings ret;
+	u32 const count = (u32)sizes.size();
+	Alloc allocator(capacity);
+	std::vector<Handle> handles(count);
+	auto start = Clock::now();
+	for (u32 idx = 0; idx < count; ++idx)
+	{
+		handles[idx] = allocate(allocator, sizes[idx]);
+	}
+	f64 const allocateNS = std::chrono::duration<f64, std::nano>(Clock::now() - start).count();
+	start = Clock::now();
+	for (u32 round = 0; round < CHURN_ROUNDS; ++round)
+	{
+		for (u32 step = 0; step < count / 2; ++step)
+		{
+			u32 const idx = order[(step + round * 7919) % count];
+			release(allocator, handles[idx], sizes[idx]);
+			handles[idx] = allocate(allocator, sizes[idx]);
+		}
+	}
+	f64 const churnNS = std::chrono::duration<f64, std::nano>(Clock::now() - start).count();
+	start = Clock::now();
+	for (auto const idx : order)
+	{
+		release(allocator, handles[idx], sizes[idx]);
+	}
+	f64 const releaseNS = std::chrono::duration<f64, std::nano>(Clock::now() - start).count();
+	u32 const churnOps = CHURN_ROUNDS * (count / 2) * 2;
+	ret.allocateNS = allocateNS / (f64)count;
+	ret.churnNS = churnNS / (f64)std::max(churnOps, 1U);
+	ret.releaseNS = releaseNS / (f64)count;
+	ret.perOpNS = (allocateNS + churnNS + releaseNS) / (f64)(count * 2 + churnOps);
+	return ret;
+}
+
+Timings best(u32 runs, std::function<Timings()> const& bench)
+{
+	Timings ret = bench();
+	for (u32 run = 1; run < runs; ++run)
+	{
+		Timings const timings = bench();
+		if (timings.perOpNS < ret.perOpNS)
+		{
+			ret = timings;
+		}
+	}
+	return ret;
+}
+
+void printUsage()
+{
+	std::printf("Usage: le3d-bench-range-allocator [allocation counts...]\n");
+	std::printf("  Allocates N mesh-sized ranges (default: 1000 10000 100000), re-allocates half of them %u times in shuffled order and\n",
+				CHURN_ROUNDS);
+	std::printf("  releases them all, through RangeAllocator (TLSF) and a std::map best-fit allocator\n");
+	return;
+}
+} // namespace
+
+s32 main(s32 argc, char const** argv)
+{
+	std::vector<u32> allocationCounts;
+	for (s32 idx = 1; idx < argc; ++idx)
+	{
+		u32 const count = (u32)std::strtoul(argv[idx], nullptr, 10);
+		if (count == 0)
+		{
+			printUsage();
+			return std::string_view(argv[idx]) == "-h" || std::string_view(argv[idx]) == "--help" ? 0 : 1;
+		}
+		allocationCounts.push_back(count);
+	}
+	if (allocationCounts.empty())
+	{
+		allocationCounts = {1000, 10000, 100000};
+	}
+	u32 const runs = 5;
+	// Large enough that no request fails, so both allocators do the same work
+	u32 const capacity = 0xfff00000;
+	std::mt19937 rng(7);
+	u32 failures = 0;
+	std::printf("Best of %u runs, ns per operation (allocate / churn: release + allocate / release / all)\n", runs);
+	std::printf("%12s | %8s %8s %8s %8s | %8s %8s %8s %8s | %8s\n", "allocations", "TLSF", "churn", "release", "all", "map", "churn",
+				"release", "all", "speedup");
+	for (auto const count : allocationCounts)
+	{
+		std::vector<u32> sizes(count);
+		for (auto& size : sizes)
+		{
+			size = 24 + rng() % 4000;
+		}
+		std::vector<u32> order(count);
+		for (u32 idx = 0; idx < count; ++idx)
+		{
+			order[idx] = idx;
+		}
+		std::shuffle(order.begin(), order.end(), rng);
+		using Allocation = RangeAllocator::Allocation;
+		Timings const tlsf = best(runs, [&]() {
+			return run<RangeAllocator, Allocation>(
+				sizes, order, capacity,
+				[&failures](RangeAllocator& allocator, u32 size) {
+					auto const ret = allocator.allocate(size);
+					failures += ret.isValid() ? 0 : 1;
+					return ret;
+				},
+				[](RangeAllocator& allocator, Allocation allocation, u32) { allocator.release(allocation); });
+		});
+		Timings const map = best(runs, [&]() {
+			return run<MapAllocator, u32>(
+				sizes, order, capacity,
+				[&failures](MapAllocator& allocator, u32 size) {
+					u32 const ret = allocator.allocate(size);
+					failures += ret != RangeAllocator::s_invalid ? 0 : 1;
+					return ret;
+				},
+				[](MapAllocator& allocator, u32 offset, u32 size) { allocator.release(offset, size); });
+		});
+		std::printf("%12u | %8.1f %8.1f %8.1f %8.1f | %8.1f %8.1f %8.1f %8.1f | %7.2fx\n", count, tlsf.allocateNS, tlsf.churnNS,
+					tlsf.releaseNS, tlsf.perOpNS, map.allocateNS, map.churnNS, map.releaseNS, map.perOpNS, map.perOpNS / tlsf.perOpNS);
+	}
+	LOGIF_E(failures > 0, "[Bench] %u allocations failed!", failures);
+	return failures == 0 ? 0 : 1;
+}
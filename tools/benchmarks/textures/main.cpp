@@ -0,0 +1,230 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <stb/stb_image.h>
+#include "le3d/core/gdata.hpp"
+#include "le3d/core/io.hpp"
+#include "le3d/core/jobs.hpp"
+#include "le3d/core/log.hpp"
+#include "le3d/engine/gfx/gfx_objects.hpp"
+#include "le3d/env/threads.hpp"
+
+using namespace le;
+using namespace le::gfx;
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+struct Subject final
+{
+	std::string id;
+	bytearray bytes;
+	// Cubemap faces are decoded unflipped
+	bool bFlipV = true;
+};
+
+// Reproduction of the decode path Texture::decode replaced: stb's process-wide flip flag, set under a global mutex held
+// across the whole load (so concurrent decodes serialise), then a copy out of stb's buffer (cubemap faces used to be
+// uploaded straight from it; the copy is kept here so both paths return an Image)
+std::mutex g_stbiMutex;
+
+Texture::Image legacyDecode(Subject const& subject)
+{
+	Texture::Image ret;
+	s32 w, h, ch;
+	stbi_uc* pData = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(g_stbiMutex);
+		stbi_set_flip_vertically_on_load(subject.bFlipV ? 1 : 0);
+		pData = stbi_load_from_memory(reinterpret_cast<u8 const*>(subject.bytes.data()), (s32)subject.bytes.size(), &w, &h, &ch, 0);
+		// Texture::decode relies on stb's default (no flip): restore it, or decodes sharing this process come out flipped twice
+		stbi_set_flip_vertically_on_load(0);
+	}
+	if (pData)
+	{
+		ret.pixels.resize((size_t)w * (size_t)h * (size_t)ch);
+		std::memcpy(ret.pixels.data(), pData, ret.pixels.size());
+		ret.width = (u16)w;
+		ret.height = (u16)h;
+		ret.channels = (u8)ch;
+		stbi_image_free(pData);
+	}
+	return ret;
+}
+
+Texture::Image decode(Subject const& subject)
+{
+	return Texture::decode(subject.bytes, subject.bFlipV);
+}
+
+using Decoder = std::function<Texture::Image(Subject const&)>;
+
+// Every texture and cubemap face listed in the manifest, as manifestLoader / Cubemap::setup load them
+std::vector<Subject> loadSubjects(IOReader const& reader, stdfs::path const& manifestID)
+{
+	std::vector<Subject> ret;
+	GData const manifest(reader.getView(manifestID));
+	auto const add = [&reader, &ret](std::string id, bool bFlipV) {
+		if (!id.empty() && reader.checkPresence(id))
+		{
+			auto bytes = reader.getBytes(id);
+			ret.push_back({std::move(id), std::move(bytes), bFlipV});
+		}
+	};
+	for (auto const& texture : manifest.getGDatas("textures"))
+	{
+		add(texture.getString("id"), true);
+	}
+	for (auto const& cubemap : manifest.getGDatas("cubemaps"))
+	{
+		for (auto const side : {"right", "left", "up", "down", "front", "back"})
+		{
+			add(cubemap.getString(side), false);
+		}
+	}
+	return ret;
+}
+
+f64 best(u32 runs, std::function<f64()> const& bench)
+{
+	f64 ret = bench();
+	for (u32 run = 1; run < runs; ++run)
+	{
+		ret = std::min(ret, bench());
+	}
+	return ret;
+}
+
+// Milliseconds to decode every subject, one after another on the calling thread, best of runs
+f64 measureSerial(u32 runs, std::vector<Subject> const& subjects, Decoder const& decoder, std::vector<Texture::Image>& outImages)
+{
+	outImages.resize(subjects.size());
+	return best(runs, [&]() {
+		auto const start = Clock::now();
+		for (size_t idx = 0; idx < subjects.size(); ++idx)
+		{
+			outImages[idx] = decoder(subjects[idx]);
+		}
+		return std::chrono::duration<f64, std::milli>(Clock::now() - start).count();
+	});
+}
+
+// Milliseconds to decode every subject across job workers (one texture per task), best of runs
+f64 measureParallel(u32 runs, std::vector<Subject> const& subjects, Decoder const& decoder, std::vector<Texture::Image>& outImages)
+{
+	outImages.resize(subjects.size());
+	return best(runs, [&]() {
+		auto const start = Clock::now();
+		jobs::parallelFor(
+			0, subjects.size(), [&](size_t idx) { outImages[idx] = decoder(subjects[idx]); }, 1);
+		return std::chrono::duration<f64, std::milli>(Clock::now() - start).count();
+	});
+}
+
+bool equal(Texture::Image const& lhs, Texture::Image const& rhs)
+{
+	return lhs.width == rhs.width && lhs.height == rhs.height && lhs.channels == rhs.channels && lhs.pixels == rhs.pixels;
+}
+
+void printUsage()
+{
+	std::printf("Usage: le3d-bench-textures <resources directory> [--manifest=ID] [--workers=N]\n");
+	std::printf("  Decodes every texture and cubemap face listed in the manifest (default: demo_manifest.json) through Texture::decode,\n");
+	std::printf("  against the previous global-mutex + stbi_set_flip_vertically_on_load path: per texture, then all of them serially\n");
+	std::printf("  and across N job workers (default: hardware threads)\n");
+	return;
+}
+} // namespace
+
+s32 main(s32 argc, char const** argv)
+{
+	stdfs::path resources;
+	stdfs::path manifestID = "demo_manifest.json";
+	u32 workers = threads::maxHardwareThreads();
+	for (s32 idx = 1; idx < argc; ++idx)
+	{
+		std::string_view const arg = argv[idx];
+		if (arg.substr(0, 11) == "--manifest=")
+		{
+			manifestID = arg.substr(11);
+		}
+		else if (arg.substr(0, 10) == "--workers=")
+		{
+			workers = (u32)std::strtoul(argv[idx] + 10, nullptr, 10);
+		}
+		else if (arg == "-h" || arg == "--help")
+		{
+			printUsage();
+			return 0;
+		}
+		else
+		{
+			resources = arg;
+		}
+	}
+	if (resources.empty() || !stdfs::is_directory(resources) || workers == 0)
+	{
+		printUsage();
+		return 1;
+	}
+	FileReader reader(resources);
+	if (!reader.isPresent(manifestID))
+	{
+		std::printf("Manifest [%s] not found in [%s]\n", manifestID.generic_string().data(), resources.generic_string().data());
+		return 1;
+	}
+	auto const subjects = loadSubjects(reader, manifestID);
+	if (subjects.empty())
+	{
+		std::printf("No textures listed in [%s]\n", manifestID.generic_string().data());
+		return 1;
+	}
+	u32 const runs = 10;
+	u32 mismatches = 0;
+	size_t encodedBytes = 0;
+	size_t decodedBytes = 0;
+	std::vector<Texture::Image> legacyImages;
+	std::vector<Texture::Image> images;
+	std::printf("%s: %u textures, best of %u runs, ms\n", manifestID.generic_string().data(), (u32)subjects.size(), runs);
+	std::printf("%-34s %10s %16s | %10s %10s\n", "texture", "KiB", "decoded", "legacy", "decode");
+	for (auto const& subject : subjects)
+	{
+		std::vector<Subject> const single = {subject};
+		f64 const legacyMS = measureSerial(runs, single, &legacyDecode, legacyImages);
+		f64 const decodeMS = measureSerial(runs, single, &decode, images);
+		auto const& image = images.front();
+		// Both paths must produce identical pixels
+		mismatches += equal(image, legacyImages.front()) && !image.pixels.empty() ? 0 : 1;
+		encodedBytes += subject.bytes.size();
+		decodedBytes += image.pixels.size();
+		std::string const dims = std::to_string(image.width) + "x" + std::to_string(image.height) + "x" + std::to_string(image.channels);
+		std::printf("%-34s %10.1f %16s | %10.2f %10.2f\n", subject.id.data(), (f64)subject.bytes.size() / 1024.0, dims.data(), legacyMS,
+					decodeMS);
+	}
+	f64 const legacySerialMS = measureSerial(runs, subjects, &legacyDecode, legacyImages);
+	f64 const serialMS = measureSerial(runs, subjects, &decode, images);
+	jobs::init(workers);
+	f64 const legacyParallelMS = measureParallel(runs, subjects, &legacyDecode, legacyImages);
+	f64 const parallelMS = measureParallel(runs, subjects, &decode, images);
+	jobs::cleanup();
+	for (size_t idx = 0; idx < subjects.size(); ++idx)
+	{
+		mismatches += equal(images[idx], legacyImages[idx]) ? 0 : 1;
+	}
+	std::printf("\nAll %u textures (%.1f MiB encoded, %.1f MiB decoded), ms\n", (u32)subjects.size(), (f64)encodedBytes / (1024.0 * 1024.0),
+				(f64)decodedBytes / (1024.0 * 1024.0));
+	std::printf("%-34s %10s %10s %10s\n", "", "legacy", "decode", "speedup");
+	std::printf("%-34s %10.2f %10.2f %9.2fx\n", "serial", legacySerialMS, serialMS, legacySerialMS / serialMS);
+	std::string const parallel =
+		"jobs: " + std::to_string(workers) + " workers, " + std::to_string(threads::maxHardwareThreads()) + " hw threads";
+	std::printf("%-34s %10.2f %10.2f %9.2fx\n", parallel.data(), legacyParallelMS, parallelMS, legacyParallelMS / parallelMS);
+	LOGIF_E(mismatches > 0, "[Bench] %u decoded textures differ from the previous path!", mismatches);
+	return mismatches == 0 ? 0 : 1;
+}
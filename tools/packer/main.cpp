@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "le3d/core/json.hpp"
+#include "le3d/core/log.hpp"
+#include "le3d/core/pack.hpp"
+
+using namespace le;
+
+namespace
+{
+// Collects pack inputs: manifest references first (depth first, in document order), so that assets loaded together are adjacent
+struct Collector final
+{
+	stdfs::path root;
+	std::vector<pack::Input> inputs;
+	std::unordered_set<std::string> added;
+
+	void addFile(stdfs::path const& file);
+	void addDirectory(stdfs::path const& directory);
+	void addReferences(stdfs::path const& jsonFile);
+	void addReferences(json::Value const& value, stdfs::path const& directory);
+	void addRemaining();
+};
+
+void Collector::addFile(stdfs::path const& file)
+{
+	auto id = stdfs::relative(file, root).generic_string();
+	if (id.empty() || id.compare(0, 2, "..") == 0)
+	{
+		// Outside the resources directory
+		return;
+	}
+	if (added.insert(id).second)
+	{
+		inputs.push_back({std::move(id), file});
+		if (file.extension() == ".json")
+		{
+			addReferences(file);
+		}
+	}
+	return;
+}
+
+void Collector::addDirectory(stdfs::path const& directory)
+{
+	// Models: <id>/<name>.json (which references the rest), then anything else in the directory
+	auto jsonFile = directory / directory.filename();
+	jsonFile += ".json";
+	if (stdfs::is_regular_file(jsonFile))
+	{
+		addFile(jsonFile);
+	}
+	std::vector<stdfs::path> files;
+	for (auto const& entry : stdfs::recursive_directory_iterator(directory))
+	{
+		if (entry.is_regular_file())
+		{
+			files.push_back(entry.path());
+		}
+	}
+	std::sort(files.begin(), files.end());
+	for (auto const& file : files)
+	{
+		addFile(file);
+	}
+	return;
+}
+
+void Collector::addReferences(stdfs::path const& jsonFile)
+{
+	std::ifstream file(jsonFile);
+	std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	json::Document doc;
+	if (!doc.parse(std::move(text)))
+	{
+		LOG_W("[Packer] Failed to parse [%s]: %s", jsonFile.generic_string().data(), doc.error().data());
+		return;
+	}
+	addReferences(doc.root(), jsonFile.parent_path());
+	return;
+}
+
+void Collector::addReferences(json::Value const& value, stdfs::path const& directory)
+{
+	if (value.isObject() || value.isArray())
+	{
+		for (auto const& child : value)
+		{
+			addReferences(child, directory);
+		}
+	}
+	else if (value.isString())
+	{
+		// Asset IDs are relative to the resources root; nested paths (model / font jsons) to their own directory
+		auto const str = value.asString();
+		if (str.empty())
+		{
+			return;
+		}
+		for (auto const& path : {directory / str, root / str})
+		{
+			std::error_code errCode;
+			if (stdfs::is_regular_file(path, errCode))
+			{
+				addFile(path);
+				return;
+			}
+			if (stdfs::is_directory(path, errCode) && !stdfs::equivalent(path, root, errCode))
+			{
+				addDirectory(path);
+				return;
+			}
+		}
+	}
+	return;
+}
+
+void Collector::addRemaining()
+{
+	std::vector<stdfs::path> files;
+	for (auto const& entry : stdfs::recursive_directory_iterator(root))
+	{
+		if (entry.is_regular_file())
+		{
+			files.push_back(entry.path());
+		}
+	}
+	std::sort(files.begin(), files.end());
+	for (auto const& file : files)
+	{
+		addFile(file);
+	}
+	return;
+}
+
+void printUsage()
+{
+	std::printf("Usage: le3d-packer <resources directory> <output pack> [manifest IDs...] [--align=N] [--store]\n");
+	std::printf("  Packs every file under the resources directory; files referenced by the manifests are laid out first, in load order\n");
+	std::printf("  Manifest IDs default to all *manifest.json files at the root\n");
+	std::printf("  --align=N  Blob alignment in bytes (power of two, default: 64)\n");
+	std::printf("  --store    Don't compress\n");
+	return;
+}
+} // namespace
+
+s32 main(s32 argc, char const** argv)
+{
+	std::vector<std::string> positional;
+	pack::Options options;
+	for (s32 idx = 1; idx < argc; ++idx)
+	{
+		std::string_view const arg = argv[idx];
+		if (arg.substr(0, 8) == "--align=")
+		{
+			options.alignment = (u32)std::strtoul(argv[idx] + 8, nullptr, 10);
+		}
+		else if (arg == "--store")
+		{
+			options.bCompress = false;
+		}
+		else if (arg == "-h" || arg == "--help")
+		{
+			printUsage();
+			return 0;
+		}
+		else
+		{
+			positional.emplace_back(arg);
+		}
+	}
+	if (positional.size() < 2)
+	{
+		printUsage();
+		return 1;
+	}
+	if (!stdfs::is_directory(positional[0]))
+	{
+		LOG_E("[Packer] [%s] is not a directory!", positional[0].data());
+		return 1;
+	}
+	Collector collector;
+	collector.root = stdfs::canonical(positional[0]);
+	std::vector<stdfs::path> manifests;
+	for (size_t idx = 2; idx < positional.size(); ++idx)
+	{
+		manifests.push_back(collector.root / positional[idx]);
+	}
+	if (manifests.empty())
+	{
+		for (auto const& entry : stdfs::directory_iterator(collector.root))
+		{
+			auto const filename = entry.path().filename().string();
+			if (entry.is_regular_file() && filename.size() >= 13 && filename.compare(filename.size() - 13, 13, "manifest.json") == 0)
+			{
+				manifests.push_back(entry.path());
+			}
+		}
+		std::sort(manifests.begin(), manifests.end());
+	}
+	for (auto const& manifest : manifests)
+	{
+		if (!stdfs::is_regular_file(manifest))
+		{
+			LOG_E("[Packer] Manifest [%s] not found!", manifest.generic_string().data());
+			return 1;
+		}
+		collector.addFile(manifest);
+	}
+	size_t const referenced = collector.inputs.size();
+	collector.addRemaining();
+	LOG_I("[Packer] %u files (%u referenced by %u manifests)", (u32)collector.inputs.size(), (u32)referenced, (u32)manifests.size());
+	return pack::write(positional[1], collector.inputs, options) ? 0 : 1;
+}
@@ -0,0 +1,317 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <set>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+#include "le3d/core/bvh.hpp"
+
+using namespace le;
+
+namespace
+{
+using Keys = std::set<BVH::Key>;
+
+std::mt19937 g_rng(42);
+std::uniform_real_distribution<f32> g_position(-500.0f, 500.0f);
+std::uniform_real_distribution<f32> g_size(0.25f, 2.0f);
+std::uniform_real_distribution<f32> g_direction(-1.0f, 1.0f);
+// Stays inside BVH::s_fatMargin, so updates only refit
+std::uniform_real_distribution<f32> g_jitter(-0.05f, 0.05f);
+
+glm::vec3 randomPoint()
+{
+	return {g_position(g_rng), g_position(g_rng), g_position(g_rng)};
+}
+
+AABB randomBox()
+{
+	glm::vec3 const centre = randomPoint();
+	glm::vec3 const extents(g_size(g_rng), g_size(g_rng), g_size(g_rng));
+	return {centre - extents, centre + extents};
+}
+
+bool overlaps(AABB const& lhs, AABB const& rhs)
+{
+	return lhs.min.x <= rhs.max.x && lhs.max.x >= rhs.min.x && lhs.min.y <= rhs.max.y && lhs.max.y >= rhs.min.y && lhs.min.z <= rhs.max.z
+		   && lhs.max.z >= rhs.min.z;
+}
+
+bool equal(AABB const& lhs, AABB const& rhs)
+{
+	return lhs.min == rhs.min && lhs.max == rhs.max;
+}
+
+// Reference model: every live box, tested one by one
+struct Reference final
+{
+	std::vector<AABB> boxes;
+	std::vector<bool> alive;
+
+	size_t size() const
+	{
+		return (size_t)std::count(alive.begin(), alive.end(), true);
+	}
+};
+
+// The tree rebalances with rotations, so its height stays logarithmic however it was filled
+s32 maxHeight(size_t count)
+{
+	return count == 0 ? -1 : 2 * (s32)std::ceil(std::log2((f64)count + 1.0)) + 1;
+}
+
+// size / contains / bounds / height, through the public API
+u32 checkInvariants(BVH const& tree, Reference const& reference, char const* szStage)
+{
+	u32 failures = 0;
+	failures += tree.size() == reference.size() ? 0 : 1;
+	for (size_t idx = 0; idx < reference.boxes.size(); ++idx)
+	{
+		auto const key = (BVH::Key)idx;
+		if (tree.contains(key) != reference.alive[idx])
+		{
+			++failures;
+		}
+		else if (reference.alive[idx] ? !equal(tree.bounds(key), reference.boxes[idx]) : !tree.bounds(key).isEmpty())
+		{
+			++failures;
+		}
+	}
+	s32 const height = tree.height();
+	if (height > maxHeight(tree.size()) || (tree.size() > 0) != (height >= 0))
+	{
+		++failures;
+	}
+	std::printf("[%s] %s: %zu leaves (expected %zu), height %d (bound %d)\n", failures == 0 ? "PASS" : "FAIL", szStage, tree.size(),
+				reference.size(), height, maxHeight(tree.size()));
+	return failures;
+}
+
+// Brute-force slab test against every live box, with the same semantics as BVH::raycast
+std::optional<BVH::RayHit> raycast(Reference const& reference, glm::vec3 const& origin, glm::vec3 const& direction, f32 maxT)
+{
+	std::optional<BVH::RayHit> ret;
+	glm::vec3 const invDir = 1.0f / direction;
+	for (size_t idx = 0; idx < reference.boxes.size(); ++idx)
+	{
+		if (reference.alive[idx])
+		{
+			glm::vec3 const t0 = (reference.boxes[idx].min - origin) * invDir;
+			glm::vec3 const t1 = (reference.boxes[idx].max - origin) * invDir;
+			glm::vec3 const tMin = glm::min(t0, t1);
+			glm::vec3 const tMax = glm::max(t0, t1);
+			f32 const tNear = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.0f));
+			f32 const tFar = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, ret ? ret->t : maxT));
+			if (tNear <= tFar)
+			{
+				ret = BVH::RayHit{(BVH::Key)idx, tNear};
+			}
+		}
+	}
+	return ret;
+}
+
+// Every query must return exactly the boxes (and no duplicates) that a linear scan finds
+u32 checkQueries(BVH const& tree, Reference const& reference, u32 count)
+{
+	u32 aabbFailures = 0;
+	u32 frustumFailures = 0;
+	u32 rayFailures = 0;
+	size_t aabbHits = 0;
+	size_t frustumHits = 0;
+	u32 rayHits = 0;
+	glm::mat4 const proj = glm::perspective(1.0f, 1.5f, 0.1f, 200.0f);
+	std::vector<BVH::Key> result;
+	for (u32 query = 0; query < count; ++query)
+	{
+		glm::vec3 const centre = randomPoint();
+		AABB const aabb = {centre - glm::vec3(40.0f), centre + glm::vec3(40.0f)};
+		result.clear();
+		tree.query(aabb, result);
+		Keys expected;
+		for (size_t idx = 0; idx < reference.boxes.size(); ++idx)
+		{
+			if (reference.alive[idx] && overlaps(reference.boxes[idx], aabb))
+			{
+				expected.insert((BVH::Key)idx);
+			}
+		}
+		aabbFailures += (Keys(result.begin(), result.end()) == expected && result.size() == expected.size()) ? 0 : 1;
+		aabbHits += result.size();
+
+		glm::vec3 const eye = randomPoint();
+		auto const frustum = Frustum::fromViewProj(proj * glm::lookAt(eye, eye + randomPoint(), glm::vec3(0.0f, 1.0f, 0.0f)));
+		result.clear();
+		tree.query(frustum, result);
+		expected.clear();
+		for (size_t idx = 0; idx < reference.boxes.size(); ++idx)
+		{
+			if (reference.alive[idx] && frustum.intersects(reference.boxes[idx]))
+			{
+				expected.insert((BVH::Key)idx);
+			}
+		}
+		frustumFailures += (Keys(result.begin(), result.end()) == expected && result.size() == expected.size()) ? 0 : 1;
+		frustumHits += result.size();
+
+		// Half the rays aim near a random box (random directions almost always miss at this density)
+		glm::vec3 const origin = randomPoint();
+		glm::vec3 direction(g_direction(g_rng), g_direction(g_rng), g_direction(g_rng));
+		if (query % 2 == 0)
+		{
+			direction += reference.boxes[g_rng() % reference.boxes.size()].centre() - origin;
+		}
+		auto const hit = tree.raycast(origin, direction, 2000.0f);
+		auto const expectedHit = raycast(reference, origin, direction, 2000.0f);
+		// Ties between boxes at the same distance may resolve to either key
+		if (hit.has_value() != expectedHit.has_value() || (hit && std::abs(hit->t - expectedHit->t) > 1e-3f))
+		{
+			++rayFailures;
+		}
+		rayHits += hit ? 1 : 0;
+	}
+	std::printf("[%s] %u AABB queries: %zu hits, %u mismatches\n", aabbFailures == 0 ? "PASS" : "FAIL", count, aabbHits, aabbFailures);
+	std::printf("[%s] %u frustum queries: %zu hits, %u mismatches\n", frustumFailures == 0 ? "PASS" : "FAIL", count, frustumHits,
+				frustumFailures);
+	std::printf("[%s] %u raycasts: %u hits, %u mismatches\n", rayFailures == 0 ? "PASS" : "FAIL", count, rayHits, rayFailures);
+	return aabbFailures + frustumFailures + rayFailures;
+}
+
+// Refits inside the fat box must not touch the structure; escapes must re-insert
+u32 checkUpdates(BVH& tree, Reference& reference, u32 count)
+{
+	u32 failures = 0;
+	u32 refits = 0;
+	u32 reinserts = 0;
+	for (u32 update = 0; update < count; ++update)
+	{
+		size_t const idx = g_rng() % reference.boxes.size();
+		if (!reference.alive[idx])
+		{
+			continue;
+		}
+		auto& box = reference.boxes[idx];
+		bool const bTeleport = g_rng() % 10 == 0;
+		if (bTeleport)
+		{
+			box = randomBox();
+		}
+		else
+		{
+			glm::vec3 const delta(g_jitter(g_rng), g_jitter(g_rng), g_jitter(g_rng));
+			box.min += delta;
+			box.max += delta;
+		}
+		// A refit may still escape after several jitters in the same direction; a teleport always does
+		bool const bChanged = tree.update((BVH::Key)idx, box);
+		failures += bTeleport && !bChanged ? 1 : 0;
+		++(bChanged ? reinserts : refits);
+	}
+	std::printf("[%s] %u updates: %u refit in place, %u re-inserted\n", failures == 0 && refits > reinserts ? "PASS" : "FAIL", count,
+				refits, reinserts);
+	return failures + (refits > reinserts ? 0 : 1);
+}
+
+u32 checkRemovals(BVH& tree, Reference& reference)
+{
+	u32 failures = 0;
+	// Individual removals, then a small batch (incremental), then one covering over half the tree (rebuild)
+	for (size_t idx = 0; idx < reference.boxes.size(); idx += 11)
+	{
+		failures += tree.remove((BVH::Key)idx) == reference.alive[idx] ? 0 : 1;
+		reference.alive[idx] = false;
+	}
+	failures += tree.remove((BVH::Key)0) ? 1 : 0;
+	failures += checkInvariants(tree, reference, "remove(key)");
+	std::vector<BVH::Key> keys;
+	for (size_t idx = 0; idx < reference.boxes.size(); idx += 7)
+	{
+		keys.push_back((BVH::Key)idx);
+	}
+	size_t expected = 0;
+	for (auto const key : keys)
+	{
+		expected += reference.alive[(size_t)key] ? 1 : 0;
+		reference.alive[(size_t)key] = false;
+	}
+	failures += tree.remove(keys) == expected ? 0 : 1;
+	failures += checkInvariants(tree, reference, "remove(keys), incremental");
+	keys.clear();
+	expected = 0;
+	for (size_t idx = 1; idx < reference.boxes.size() && expected <= tree.size() / 2; idx += 2)
+	{
+		if (reference.alive[idx])
+		{
+			keys.push_back((BVH::Key)idx);
+			reference.alive[idx] = false;
+			++expected;
+		}
+	}
+	failures += tree.remove(keys) == expected ? 0 : 1;
+	failures += checkInvariants(tree, reference, "remove(keys), rebuild");
+	return failures;
+}
+} // namespace
+
+s32 main()
+{
+	u32 failures = 0;
+	Reference reference;
+	reference.boxes.resize(5000);
+	reference.alive.resize(reference.boxes.size(), false);
+	for (auto& box : reference.boxes)
+	{
+		box = randomBox();
+	}
+	BVH tree;
+	failures += checkInvariants(tree, reference, "empty");
+	// One by one, then a small batch (incremental), then one larger than the tree (rebuild)
+	for (size_t idx = 0; idx < 2500; ++idx)
+	{
+		failures += tree.insert((BVH::Key)idx, reference.boxes[idx]) ? 0 : 1;
+		reference.alive[idx] = true;
+	}
+	failures += tree.insert((BVH::Key)0, reference.boxes[0]) ? 1 : 0;
+	failures += tree.insert((BVH::Key)-1, AABB()) ? 1 : 0;
+	failures += checkInvariants(tree, reference, "insert(key)");
+	std::vector<BVH::Item> items;
+	for (size_t idx = 2500; idx < 3000; ++idx)
+	{
+		items.push_back({(BVH::Key)idx, reference.boxes[idx]});
+		reference.alive[idx] = true;
+	}
+	tree.insert(items);
+	failures += checkInvariants(tree, reference, "insert(items), incremental");
+	items.clear();
+	for (size_t idx = 3000; idx < reference.boxes.size(); ++idx)
+	{
+		items.push_back({(BVH::Key)idx, reference.boxes[idx]});
+		reference.alive[idx] = true;
+	}
+	tree.insert(items);
+	failures += checkInvariants(tree, reference, "insert(items), rebuild");
+	failures += checkQueries(tree, reference, 200);
+
+	failures += checkUpdates(tree, reference, 20000);
+	failures += checkInvariants(tree, reference, "update");
+	failures += checkQueries(tree, reference, 200);
+
+	failures += checkRemovals(tree, reference);
+	failures += checkQueries(tree, reference, 200);
+
+	items.clear();
+	for (size_t idx = 0; idx < reference.boxes.size(); ++idx)
+	{
+		items.push_back({(BVH::Key)idx, reference.boxes[idx]});
+		reference.alive[idx] = true;
+	}
+	tree.build(items);
+	failures += checkInvariants(tree, reference, "build");
+	failures += checkQueries(tree, reference, 200);
+
+	tree.clear();
+	std::fill(reference.alive.begin(), reference.alive.end(), false);
+	failures += checkInvariants(tree, reference, "clear");
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "le3d/core/range_allocator.hpp"
+
+using namespace le;
+
+namespace
+{
+struct Live final
+{
+	RangeAllocator::Allocation allocation;
+	u32 size = 0;
+};
+
+u32 report(u32 failures, char const* szCheck)
+{
+	std::printf("[%s] %s\n", failures == 0 ? "PASS" : "FAIL", szCheck);
+	return failures;
+}
+
+// Live ranges must lie within [0, capacity) and never overlap
+u32 checkRanges(std::vector<Live> live, u32 capacity)
+{
+	std::sort(live.begin(), live.end(), [](Live const& lhs, Live const& rhs) { return lhs.allocation.offset < rhs.allocation.offset; });
+	u32 ret = 0;
+	for (size_t idx = 0; idx < live.size(); ++idx)
+	{
+		u64 const end = (u64)live[idx].allocation.offset + live[idx].size;
+		if (end > capacity || (idx + 1 < live.size() && end > live[idx + 1].allocation.offset))
+		{
+			++ret;
+		}
+	}
+	return ret;
+}
+
+u32 checkEdgeCases()
+{
+	u32 failures = 0;
+	RangeAllocator empty;
+	failures += empty.allocate(1).isValid() ? 1 : 0;
+	failures += empty.largestFree() == 0 ? 0 : 1;
+	RangeAllocator allocator(1024);
+	failures += allocator.allocate(0).isValid() ? 1 : 0;
+	failures += allocator.allocate(1025).isValid() ? 1 : 0;
+	failures += allocator.largestFree() == 1024 ? 0 : 1;
+	// Releasing an invalid allocation is a no-op
+	allocator.release({});
+	auto const all = allocator.allocate(1024);
+	failures += all.isValid() && all.offset == 0 && allocator.sizeOf(all) == 1024 ? 0 : 1;
+	failures += allocator.freeSpace() == 0 && allocator.largestFree() == 0 && allocator.allocationCount() == 1 ? 0 : 1;
+	failures += allocator.allocate(1).isValid() ? 1 : 0;
+	failures += allocator.sizeOf({}) == 0 ? 0 : 1;
+	allocator.release(all);
+	failures += allocator.freeSpace() == 1024 && allocator.allocationCount() == 0 ? 0 : 1;
+	allocator.reset(64);
+	failures += allocator.capacity() == 64 && allocator.freeSpace() == 64 && allocator.largestFree() == 64 ? 0 : 1;
+	return report(failures, "edge cases: empty allocator, zero / oversized requests, whole capacity, reset");
+}
+
+// Ranges are handed out back to back; freed neighbours merge into one range
+u32 checkCoalescing()
+{
+	u32 failures = 0;
+	RangeAllocator allocator(4096);
+	std::vector<RangeAllocator::Allocation> blocks;
+	for (u32 idx = 0; idx < 16; ++idx)
+	{
+		blocks.push_back(allocator.allocate(256));
+		failures += blocks.back().offset == idx * 256 ? 0 : 1;
+	}
+	failures += allocator.allocate(1).isValid() ? 1 : 0;
+	// Next, previous, then both neighbours free
+	allocator.release(blocks[5]);
+	allocator.release(blocks[6]);
+	allocator.release(blocks[4]);
+	failures += allocator.largestFree() == 768 ? 0 : 1;
+	auto const merged = allocator.allocate(768);
+	failures += merged.isValid() && merged.offset == 4 * 256 ? 0 : 1;
+	allocator.release(merged);
+	// Out of order: evens, then odds
+	for (u32 const first : {0U, 1U})
+	{
+		for (u32 idx = first; idx < 16; idx += 2)
+		{
+			if (idx < 4 || idx > 6)
+			{
+				allocator.release(blocks[idx]);
+			}
+		}
+	}
+	auto const all = allocator.allocate(4096);
+	failures += all.isValid() && all.offset == 0 && allocator.allocationCount() == 1 ? 0 : 1;
+	return report(failures, "coalescing: 16 x 256 packed back to back, freed neighbours merge, whole capacity reusable");
+}
+
+// Random allocate / release (mixed small and large sizes) under memory pressure
+u32 checkChurn(u32 operations)
+{
+	u32 const capacity = 1 << 20;
+	std::mt19937 rng(7);
+	RangeAllocator allocator(capacity);
+	std::vector<Live> live;
+	u64 used = 0;
+	u32 rangeFailures = 0;
+	u32 accountingFailures = 0;
+	u32 guaranteeFailures = 0;
+	u32 exhausted = 0;
+	for (u32 operation = 0; operation < operations; ++operation)
+	{
+		if (live.empty() || rng() % 100 < 55)
+		{
+			u32 const size = 1 + rng() % (rng() % 10 == 0 ? 20000 : 500);
+			u32 const largest = allocator.largestFree();
+			auto const allocation = allocator.allocate(size);
+			if (!allocation.isValid())
+			{
+				// largestFree() is a promise: anything up to it must succeed
+				guaranteeFailures += size <= largest ? 1 : 0;
+				++exhausted;
+				continue;
+			}
+			accountingFailures += allocator.sizeOf(allocation) == size ? 0 : 1;
+			live.push_back({allocation, size});
+			used += size;
+		}
+		else
+		{
+			size_t const idx = rng() % live.size();
+			allocator.release(live[idx].allocation);
+			used -= live[idx].size;
+			live[idx] = live.back();
+			live.pop_back();
+		}
+		accountingFailures += allocator.freeSpace() == capacity - used && allocator.allocationCount() == live.size() ? 0 : 1;
+		if (operation % 1000 == 0)
+		{
+			rangeFailures += checkRanges(live, capacity);
+		}
+	}
+	rangeFailures += checkRanges(live, capacity);
+	for (auto const& entry : live)
+	{
+		allocator.release(entry.allocation);
+	}
+	// Everything released must coalesce back into a single range
+	auto const all = allocator.allocate(capacity);
+	u32 const coalesceFailures = all.isValid() && all.offset == 0 ? 0 : 1;
+	std::printf("[%s] %u random operations: %u requests exhausted the allocator, %u overlapping / out of bounds ranges, %u accounting "
+				"errors, %u broken largestFree() guarantees, %s\n",
+				rangeFailures + accountingFailures + guaranteeFailures + coalesceFailures == 0 ? "PASS" : "FAIL", operations, exhausted,
+				rangeFailures, accountingFailures, guaranteeFailures, coalesceFailures == 0 ? "fully coalesced" : "NOT coalesced");
+	return rangeFailures + accountingFailures + guaranteeFailures + coalesceFailures;
+}
+} // namespace
+
+s32 main()
+{
+	u32 failures = 0;
+	failures += checkEdgeCases();
+	failures += checkCoalescing();
+	failures += checkChurn(200000);
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include "le3d/core/io.hpp"
+#include "le3d/engine/gfx/model.hpp"
+#include "le3d/engine/gfx/vertex_format.hpp"
+
+using namespace le;
+using namespace le::gfx;
+
+namespace
+{
+// Relative error of binary16 (round to nearest) in its normal range; below it, half the subnormal step
+f32 const g_uvRelEpsilon = std::ldexp(1.0f, -11);
+f32 const g_uvAbsEpsilon = std::ldexp(1.0f, -25);
+f32 const g_halfMinNormal = std::ldexp(1.0f, -14);
+
+struct Errors final
+{
+	u32 vertexCount = 0;
+	f32 normal = 0.0f;
+	f32 uv = 0.0f;
+	u32 failures = 0;
+};
+
+// Every finite half must survive a round trip through f32 unchanged
+u32 checkHalves()
+{
+	u32 ret = 0;
+	for (u32 bits = 0; bits < 0x10000; ++bits)
+	{
+		f32 const value = vertexFormat::unpackHalf((u16)bits);
+		if (!std::isnan(value) && vertexFormat::packHalf(value) != (u16)bits)
+		{
+			++ret;
+		}
+	}
+	return ret;
+}
+
+Errors check(Geometry const& geometry)
+{
+	Errors ret;
+	auto const packed = vertexFormat::pack(geometry);
+	ret.vertexCount = geometry.vertexCount();
+	if (packed.size() != geometry.points.size())
+	{
+		++ret.failures;
+		return ret;
+	}
+	for (size_t idx = 0; idx < packed.size(); ++idx)
+	{
+		auto const& vertex = packed[idx];
+		auto const& point = geometry.points[idx];
+		if (vertex.position[0] != point.x || vertex.position[1] != point.y || vertex.position[2] != point.z)
+		{
+			++ret.failures;
+		}
+		if (idx < geometry.normals.size())
+		{
+			auto const& n = geometry.normals[idx];
+			glm::vec3 const expected(std::clamp(n.x, -1.0f, 1.0f), std::clamp(n.y, -1.0f, 1.0f), std::clamp(n.z, -1.0f, 1.0f));
+			glm::vec3 const decoded = vertexFormat::unpackNormal(vertex.normal);
+			for (s32 axis = 0; axis < 3; ++axis)
+			{
+				f32 const error = std::abs(decoded[axis] - expected[axis]);
+				ret.normal = std::max(ret.normal, error);
+				if (error > vertexFormat::g_normalEpsilon)
+				{
+					++ret.failures;
+				}
+			}
+		}
+		if (idx < geometry.texCoords.size())
+		{
+			auto const& t = geometry.texCoords[idx];
+			f32 const uv[] = {t.x, t.y};
+			for (s32 axis = 0; axis < 2; ++axis)
+			{
+				f32 const error = std::abs(vertexFormat::unpackHalf(vertex.texCoord[axis]) - uv[axis]);
+				bool const bNormal = std::abs(uv[axis]) >= g_halfMinNormal;
+				ret.uv = std::max(ret.uv, bNormal ? error / std::abs(uv[axis]) : 0.0f);
+				if (error > (bNormal ? std::abs(uv[axis]) * g_uvRelEpsilon : g_uvAbsEpsilon))
+				{
+					++ret.failures;
+				}
+			}
+		}
+	}
+	return ret;
+}
+} // namespace
+
+s32 main(s32 argc, char const** argv)
+{
+	if (argc < 2 || !stdfs::is_directory(argv[1]))
+	{
+		std::printf("Usage: le3d-test-vertex-format <resources directory>\n");
+		return 1;
+	}
+	u32 failures = 0;
+	u32 const halfFailures = checkHalves();
+	std::printf("[%s] half round trip: %u mismatches\n", halfFailures == 0 ? "PASS" : "FAIL", halfFailures);
+	failures += halfFailures;
+	FileReader reader(argv[1]);
+	for (auto const id : {"models/plant", "models/test/fox"})
+	{
+		auto const descriptor = Model::loadOBJ({id, &reader, {}});
+		if (descriptor.meshes.empty())
+		{
+			std::printf("[FAIL] %s: no meshes loaded\n", id);
+			++failures;
+			continue;
+		}
+		for (auto const& mesh : descriptor.meshes)
+		{
+			auto const errors = check(mesh.geometry);
+			std::printf("[%s] %s: %u vertices, max normal error %.6f (bound %.6f), max UV relative error %.3g (bound %.3g)\n",
+						errors.failures == 0 ? "PASS" : "FAIL", mesh.id.data(), errors.vertexCount, errors.normal, vertexFormat::g_normalEpsilon,
+						errors.uv, g_uvRelEpsilon);
+			failures += errors.failures;
+		}
+	}
+	return failures == 0 ? 0 : 1;
+}